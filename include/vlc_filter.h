@@ -634,5 +634,70 @@ VLC_API int filter_chain_MouseFilter( filter_chain_t *, struct vlc_mouse_t *,
 VLC_API int filter_chain_ForEach( filter_chain_t *chain,
                           int (*cb)( filter_t *, void * ), void *opaque );
 
+/** @} */
+
+/**
+ * \defgroup filter_slices Slice-parallel filtering
+ * \ingroup filter
+ *
+ * Helpers for video filters whose kernels process independent rows: the rows
+ * of a plane are split in horizontal slices that run in parallel on a worker
+ * pool shared by all filters.
+ *
+ * @{
+ */
+
+typedef struct vlc_filter_slices vlc_filter_slices_t;
+
+/**
+ * Slice callback.
+ *
+ * \param opaque data passed to vlc_filter_slices_Run()
+ * \param first first row of the slice
+ * \param last row after the last row of the slice
+ */
+typedef void (*vlc_filter_slice_cb)(void *opaque, unsigned first,
+                                    unsigned last);
+
+/**
+ * Creates a slice-parallel execution context.
+ *
+ * \param threads number of slices to run in parallel (0 for the number of
+ *                CPUs, 1 to run everything on the calling thread)
+ * \return a context, or NULL on error
+ */
+VLC_API vlc_filter_slices_t *vlc_filter_slices_New(unsigned threads) VLC_USED;
+
+/**
+ * Creates a slice-parallel execution context for a filter, as configured by
+ * the "filter-threads" option.
+ */
+static inline vlc_filter_slices_t *filter_NewSlices(filter_t *filter)
+{
+    return vlc_filter_slices_New(var_InheritInteger(filter, "filter-threads"));
+}
+
+/**
+ * Destroys a slice-parallel execution context.
+ */
+VLC_API void vlc_filter_slices_Delete(vlc_filter_slices_t *);
+
+/**
+ * Runs a callback over rows [0, lines), split in slices.
+ *
+ * The callback is invoked once per slice, possibly from several threads at
+ * the same time. The function returns once all slices are done.
+ *
+ * \param slices the context (if NULL, the callback runs once for all rows)
+ * \param lines number of rows
+ * \param align slices start on multiples of this number of rows (e.g. 2 for
+ *              4:2:0 luma planes, so that chroma rows are not split)
+ * \param cb slice callback
+ * \param opaque data for the callback
+ */
+VLC_API void vlc_filter_slices_Run(vlc_filter_slices_t *slices, unsigned lines,
+                                   unsigned align, vlc_filter_slice_cb cb,
+                                   void *opaque);
+
 /** @} */
 #endif /* _VLC_FILTER_H */
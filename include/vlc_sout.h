@@ -170,6 +170,7 @@ enum sout_stream_query_e {
     SOUT_STREAM_WANTS_SUBSTREAMS,  /* arg1=bool *, res=can fail (assume false) */
     SOUT_STREAM_ID_SPU_HIGHLIGHT,  /* arg1=void *, arg2=const vlc_spu_highlight_t *, res=can fail */
     SOUT_STREAM_IS_SYNCHRONOUS, /* arg1=bool *, can fail (assume false) */
+    SOUT_STREAM_IS_READONLY, /* arg1=bool *, can fail (assume false) */
 };
 
 struct sout_stream_operations {
@@ -223,6 +224,25 @@ static inline bool sout_StreamIsSynchronous(sout_stream_t *s)
     return b;
 }
 
+/**
+ * Checks whether a stream never writes to the payload of the blocks it is
+ * given.
+ *
+ * Such streams may be handed blocks whose payload is shared with other
+ * streams (see the duplicate stream output). They can still change the block
+ * properties (timestamps, flags...) and grow the payload with block_Realloc(),
+ * which copies shared data as needed.
+ */
+static inline bool sout_StreamIsReadOnly(sout_stream_t *s)
+{
+    bool b;
+
+    if (sout_StreamControl(s, SOUT_STREAM_IS_READONLY, &b))
+        b = false;
+
+    return b;
+}
+
 /****************************************************************************
  * Encoder
  ****************************************************************************/
@@ -52,6 +52,9 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -62,12 +65,17 @@
 #include <vlc_fs.h>
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
+#include <vlc_block.h>
 
 typedef struct
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    uint64_t offset; /* next window to map, see BlockMmap() */
+    size_t page_mask;
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -127,6 +135,9 @@ static bool IsRemote (const char *path)
 #endif
 
 static ssize_t Read (stream_t *, void *, size_t);
+#ifdef HAVE_MMAP
+static block_t *BlockMmap (stream_t *, bool *);
+#endif
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
 
@@ -231,6 +242,20 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Remote files could be truncated behind our back (SIGBUS) */
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            off_t offset = lseek (fd, 0, SEEK_CUR);
+
+            p_sys->offset = (offset > 0) ? offset : 0;
+            p_sys->page_mask = sysconf (_SC_PAGESIZE) - 1;
+            p_access->pf_read = NULL;
+            p_access->pf_block = BlockMmap;
+            msg_Dbg (p_access, "using memory mapped reads");
+        }
 #endif
     }
     else
@@ -253,7 +278,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_read == NULL && p_access->pf_block == NULL)
     {
         DirClose (p_this);
         return;
@@ -287,6 +312,69 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_MMAP
+/* Size of the file windows handed out by BlockMmap() */
+#define FILE_MMAP_WINDOW (1 << 20)
+
+/* Serves the file as blocks mapped straight from the page cache. Each block
+ * owns its own mapping, which is released with the last reference. */
+static block_t *BlockMmap (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct stat st;
+
+    /* Check the size again, the file may be still growing */
+    if (fstat (p_sys->fd, &st))
+    {
+        msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+    if ((uint64_t)st.st_size <= p_sys->offset)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    uint64_t start = p_sys->offset & ~(uint64_t)p_sys->page_mask;
+    size_t skip = p_sys->offset - start;
+    size_t length = FILE_MMAP_WINDOW - skip;
+    if (length > st.st_size - p_sys->offset)
+        length = st.st_size - p_sys->offset;
+
+    void *addr = mmap (NULL, skip + length, PROT_READ, MAP_SHARED,
+                       p_sys->fd, start);
+    if (addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "cannot map file: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise (addr, skip + length, POSIX_MADV_SEQUENTIAL);
+    posix_madvise (addr, skip + length, POSIX_MADV_WILLNEED);
+#endif
+    /* Start reading the next window while this one is demuxed */
+    posix_fadvise (p_sys->fd, start + skip + length, FILE_MMAP_WINDOW,
+                   POSIX_FADV_WILLNEED);
+
+    /* Map the whole pages, so that the core unmaps the right range if it
+     * fails to allocate the block, then skip to the current offset */
+    block_t *block = block_mmap_Alloc (addr, skip + length);
+    if (unlikely(block == NULL))
+    {
+        *eof = true;
+        return NULL;
+    }
+    block->p_buffer += skip;
+    block->i_buffer -= skip;
+
+    p_sys->offset += length;
+    return block;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -294,6 +382,13 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
 {
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_MMAP
+    if (p_access->pf_block != NULL)
+    {
+        sys->offset = i_pos;
+        return VLC_SUCCESS;
+    }
+#endif
     if (lseek(sys->fd, i_pos, SEEK_SET) == (off_t)-1)
         return VLC_EGENERIC;
     return VLC_SUCCESS;
@@ -38,6 +38,11 @@ vlc_module_begin ()
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
 
+    add_bool( "file-mmap", false, N_("Memory map files"),
+              N_("Read local files through memory mappings, so that the "
+                 "data is handed over without copying it out of the system "
+                 "cache. The file must not be truncated while it is read.") )
+
     add_submodule()
     set_section( N_("Directory" ), NULL )
     set_capability( "access", 55 )
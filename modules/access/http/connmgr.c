@@ -102,7 +102,9 @@ struct vlc_http_mgr
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
+    vlc_mutex_t lock; /**< Protects creds, conn and multiplex */
     struct vlc_http_conn *conn;
+    bool multiplex; /**< Whether the last connection negotiated HTTP/2 */
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
@@ -121,26 +123,45 @@ static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
     vlc_http_conn_release(conn);
 }
 
+/* Waits for the response header without the lock, so that requests sharing
+ * an HTTP/2 connection do not wait for one another. */
+static struct vlc_http_msg *vlc_http_mgr_response(struct vlc_http_mgr *mgr,
+                                                  struct vlc_http_conn *conn,
+                                                  struct vlc_http_stream *stream)
+{
+    if (stream != NULL)
+    {
+        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
+        if (m != NULL)
+            return m;
+    }
+
+    /* Get rid of closing or reset connection, unless already replaced */
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->conn == conn)
+        vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_unlock(&mgr->lock);
+    return NULL;
+}
+
 static
 struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
                                         const char *host, unsigned port,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
+    vlc_mutex_lock(&mgr->lock);
     struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
     if (conn == NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL;
+    }
 
     struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
-    if (stream != NULL)
-    {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
-    }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
-    return NULL;
+    vlc_mutex_unlock(&mgr->lock);
+
+    return vlc_http_mgr_response(mgr, conn, stream);
 }
 
 static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
@@ -151,15 +172,23 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
+    vlc_mutex_lock(&mgr->lock);
     if (mgr->creds == NULL && mgr->conn != NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL; /* switch from HTTP to HTTPS not implemented */
+    }
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
+        {
+            vlc_mutex_unlock(&mgr->lock);
             return NULL;
+        }
     }
+    vlc_mutex_unlock(&mgr->lock);
 
     if (idempotent)
     {   /* If the request is idempotent, try to reuse an existing connection.
@@ -173,6 +202,22 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
             return resp; /* existing connection reused */
     }
 
+    /* Connect with the lock held, so that concurrent requests wait for this
+     * connection instead of establishing their own. */
+    vlc_mutex_lock(&mgr->lock);
+
+    if (idempotent && mgr->conn != NULL)
+    {   /* Established by another thread in the mean time */
+        struct vlc_http_conn *conn = mgr->conn;
+        struct vlc_http_stream *stream = vlc_http_stream_open(conn, req,
+                                                              payload);
+        if (stream != NULL)
+        {
+            vlc_mutex_unlock(&mgr->lock);
+            return vlc_http_mgr_response(mgr, conn, stream);
+        }
+    }
+
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
     {
@@ -184,7 +229,10 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         tls = vlc_https_connect(mgr->creds, host, port, &http2);
 
     if (tls == NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL;
+    }
 
     struct vlc_http_conn *conn;
 
@@ -202,15 +250,21 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
 
     if (unlikely(conn == NULL))
     {
+        vlc_mutex_unlock(&mgr->lock);
         vlc_tls_Close(tls);
         return NULL;
     }
 
+    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+
     if (mgr->conn != NULL)
         vlc_http_mgr_release(mgr, mgr->conn);
 
     mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    mgr->multiplex = http2;
+    vlc_mutex_unlock(&mgr->lock);
+
+    return vlc_http_mgr_response(mgr, conn, stream);
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -218,7 +272,11 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    bool secure = mgr->creds != NULL && mgr->conn != NULL;
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (secure)
         return NULL; /* switch from HTTPS to HTTP not implemented */
 
     if (idempotent)
@@ -232,6 +290,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
     struct vlc_http_conn *conn;
     struct vlc_http_stream *stream;
 
+    /* HTTP/1 connections cannot be shared: keep the lock until the response
+     * so that the connection is only replaced once usable */
+    vlc_mutex_lock(&mgr->lock);
+
     char *proxy = vlc_http_proxy_find(host, port, false);
     if (proxy != NULL)
     {
@@ -254,11 +316,15 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                 req, idempotent, payload, &conn);
 
     if (stream == NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL;
+    }
 
     struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
     if (resp == NULL)
     {
+        vlc_mutex_unlock(&mgr->lock);
         vlc_http_conn_release(conn);
         return NULL;
     }
@@ -267,6 +333,8 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         vlc_http_mgr_release(mgr, mgr->conn);
 
     mgr->conn = conn;
+    mgr->multiplex = false;
+    vlc_mutex_unlock(&mgr->lock);
     return resp;
 }
 
@@ -287,6 +355,14 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
     return mgr->jar;
 }
 
+bool vlc_http_mgr_can_multiplex(struct vlc_http_mgr *mgr)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool multiplex = mgr->multiplex;
+    vlc_mutex_unlock(&mgr->lock);
+    return multiplex;
+}
+
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
                                          struct vlc_http_cookie_jar_t *jar)
 {
@@ -298,7 +374,9 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
+    vlc_mutex_init(&mgr->lock);
     mgr->conn = NULL;
+    mgr->multiplex = false; /* until ALPN says otherwise */
     return mgr;
 }
 
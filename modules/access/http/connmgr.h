@@ -57,6 +57,18 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Checks whether concurrent requests can share the connection
+ *
+ * A manager can be used by several threads at once. Requests then share its
+ * connection as HTTP/2 streams. Over HTTP/1.1, concurrent requests would
+ * instead keep replacing the connection of each other, and should go through
+ * separate managers.
+ *
+ * @return true if the last connection negotiated HTTP/2, false before any
+ */
+bool vlc_http_mgr_can_multiplex(struct vlc_http_mgr *);
+
 /**
  * Creates an HTTP connection manager
  *
@@ -0,0 +1,384 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connection manager test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_network.h>
+#include <vlc_tls.h>
+#include "conn.h"
+#include "connmgr.h"
+#include "message.h"
+#include "transport.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+#define THREADS 4
+
+/* Protects the counters and the fake connections state */
+static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+static vlc_cond_t cond = VLC_STATIC_COND;
+static const char *alp_reply = "h2";
+static unsigned handshakes = 0;
+static unsigned expected = 1; /* concurrent streams to wait for */
+static unsigned active = 0;
+static unsigned active_max = 0;
+
+/* Fake TLS */
+static vlc_tls_t tls_dummy;
+
+vlc_tls_client_t *vlc_tls_ClientCreate(vlc_object_t *obj)
+{
+    (void) obj;
+    return (vlc_tls_client_t *)&tls_dummy;
+}
+
+void vlc_tls_ClientDelete(vlc_tls_client_t *creds)
+{
+    assert(creds == (vlc_tls_client_t *)&tls_dummy);
+}
+
+vlc_tls_t *vlc_tls_SocketOpenTLS(vlc_tls_client_t *creds, const char *name,
+                                 unsigned port, const char *service,
+                                 const char *const *alpn, char **alp)
+{
+    assert(creds == (vlc_tls_client_t *)&tls_dummy);
+    assert(!strcmp(name, "www.example.com"));
+    assert(port == 443);
+    assert(!strcmp(service, "https"));
+    assert(alpn != NULL);
+
+    vlc_mutex_lock(&lock);
+    handshakes++;
+    vlc_mutex_unlock(&lock);
+
+    *alp = strdup(alp_reply);
+    return &tls_dummy;
+}
+
+char *vlc_getProxyUrl(const char *url)
+{
+    (void) url;
+    return NULL;
+}
+
+vlc_tls_t *vlc_https_connect_proxy(void *ctx, vlc_tls_client_t *creds,
+                                   const char *name, unsigned port,
+                                   bool *restrict two, const char *proxy)
+{
+    (void) ctx; (void) creds; (void) name; (void) port; (void) two;
+    (void) proxy;
+    assert(!"unexpected proxy");
+    return NULL;
+}
+
+struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
+                                       unsigned port, bool proxy,
+                                       const struct vlc_http_msg *req,
+                                       bool idempotent, bool has_data,
+                                       struct vlc_http_conn **restrict connp)
+{
+    (void) ctx; (void) hostname; (void) port; (void) proxy; (void) req;
+    (void) idempotent; (void) has_data; (void) connp;
+    assert(!"unexpected plain HTTP");
+    return NULL;
+}
+
+/* Callback for vlc_http_msg_h2_frame */
+#include "h2frame.h"
+
+struct vlc_h2_frame *
+vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
+                     unsigned count, const char *const tab[][2])
+{
+    (void) id; (void) mtu; (void) count, (void) tab;
+    assert(!eos);
+    return NULL;
+}
+
+/* Fake connection, released once all its streams are closed like HTTP/2 */
+struct test_conn
+{
+    struct vlc_http_conn conn;
+    unsigned streams;
+    bool released;
+    bool dead;
+};
+
+struct test_stream
+{
+    struct vlc_http_stream stream;
+    struct test_conn *conn;
+};
+
+static unsigned conns = 0;
+
+static void conn_destroy(struct test_conn *conn)
+{
+    free(conn);
+    conns--;
+}
+
+static struct vlc_http_msg *stream_read_headers(struct vlc_http_stream *s)
+{
+    vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_SEC(5);
+
+    vlc_mutex_lock(&lock);
+    if (++active > active_max)
+        active_max = active;
+    vlc_cond_broadcast(&cond);
+
+    /* Hold the response until the expected requests all run at once */
+    while (active < expected && active_max < expected)
+        if (vlc_cond_timedwait(&cond, &lock, deadline))
+            break;
+    vlc_mutex_unlock(&lock);
+
+    struct vlc_http_msg *m = vlc_http_resp_create(200);
+    assert(m != NULL);
+    vlc_http_msg_attach(m, s);
+    return m;
+}
+
+static block_t *stream_read(struct vlc_http_stream *s)
+{
+    (void) s;
+    return NULL;
+}
+
+static void stream_close(struct vlc_http_stream *s, bool abort)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+    struct test_conn *conn = ts->conn;
+    (void) abort;
+
+    vlc_mutex_lock(&lock);
+    active--;
+    assert(conn->streams > 0);
+    if (--conn->streams == 0 && conn->released)
+        conn_destroy(conn);
+    vlc_mutex_unlock(&lock);
+    free(ts);
+}
+
+static const struct vlc_http_stream_cbs stream_callbacks =
+{
+    stream_read_headers,
+    NULL,
+    stream_read,
+    stream_close,
+};
+
+static struct vlc_http_stream *conn_stream_open(struct vlc_http_conn *c,
+                                                const struct vlc_http_msg *req,
+                                                bool has_data)
+{
+    struct test_conn *conn = container_of(c, struct test_conn, conn);
+    (void) req;
+    assert(!has_data);
+
+    vlc_mutex_lock(&lock);
+    if (conn->dead)
+    {
+        vlc_mutex_unlock(&lock);
+        return NULL;
+    }
+    conn->streams++;
+    vlc_mutex_unlock(&lock);
+
+    struct test_stream *ts = malloc(sizeof (*ts));
+    assert(ts != NULL);
+    ts->stream.cbs = &stream_callbacks;
+    ts->conn = conn;
+    return &ts->stream;
+}
+
+static void conn_release(struct vlc_http_conn *c)
+{
+    struct test_conn *conn = container_of(c, struct test_conn, conn);
+
+    vlc_mutex_lock(&lock);
+    assert(!conn->released);
+    conn->released = true;
+    if (conn->streams == 0)
+        conn_destroy(conn);
+    vlc_mutex_unlock(&lock);
+}
+
+static const struct vlc_http_conn_cbs conn_callbacks =
+{
+    conn_stream_open,
+    conn_release,
+};
+
+static struct test_conn *last_conn;
+
+static struct vlc_http_conn *conn_create(vlc_tls_t *tls)
+{
+    struct test_conn *conn = malloc(sizeof (*conn));
+    assert(conn != NULL);
+    assert(tls == &tls_dummy);
+    conn->conn.cbs = &conn_callbacks;
+    conn->conn.tls = tls;
+    conn->streams = 0;
+    conn->released = false;
+    conn->dead = false;
+
+    vlc_mutex_lock(&lock);
+    last_conn = conn;
+    conns++;
+    vlc_mutex_unlock(&lock);
+    return &conn->conn;
+}
+
+struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
+{
+    (void) ctx;
+    assert(!strcmp(alp_reply, "h2"));
+    return conn_create(tls);
+}
+
+struct vlc_http_conn *vlc_h1_conn_create(void *ctx, struct vlc_tls *tls,
+                                         bool proxy)
+{
+    (void) ctx;
+    assert(strcmp(alp_reply, "h2"));
+    assert(!proxy);
+    return conn_create(tls);
+}
+
+static struct vlc_http_mgr *mgr;
+static struct vlc_http_msg *req;
+
+static void *request_thread(void *data)
+{
+    struct vlc_http_msg *resp;
+
+    resp = vlc_http_mgr_request(mgr, true, "www.example.com", 0, req,
+                                true, false);
+    assert(resp != NULL);
+    assert(vlc_http_msg_get_status(resp) == 200);
+    vlc_http_msg_destroy(resp);
+    (void) data;
+    return NULL;
+}
+
+static void test_reset(unsigned concurrency)
+{
+    vlc_mutex_lock(&lock);
+    handshakes = 0;
+    expected = concurrency;
+    active_max = 0;
+    vlc_mutex_unlock(&lock);
+}
+
+static void test_check(unsigned handshakes_expected, unsigned conns_expected)
+{
+    vlc_mutex_lock(&lock);
+    assert(handshakes == handshakes_expected);
+    assert(conns == conns_expected);
+    assert(active == 0);
+    vlc_mutex_unlock(&lock);
+}
+
+static void test_kill_conn(void)
+{
+    vlc_mutex_lock(&lock);
+    last_conn->dead = true;
+    vlc_mutex_unlock(&lock);
+}
+
+int main(void)
+{
+    static vlc_object_t obj;
+    struct vlc_http_msg *resp;
+    vlc_thread_t th[THREADS];
+
+    req = vlc_http_req_create("GET", "https", "www.example.com", "/");
+    assert(req != NULL);
+
+    /* Concurrent requests share a single HTTP/2 connection */
+    mgr = vlc_http_mgr_create(&obj, NULL);
+    assert(mgr != NULL);
+    /* Not before the server agreed to HTTP/2 */
+    assert(!vlc_http_mgr_can_multiplex(mgr));
+    test_reset(THREADS);
+
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(vlc_clone(th + i, request_thread, NULL,
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(th[i], NULL);
+
+    test_check(1, 1);
+    vlc_mutex_lock(&lock);
+    assert(active_max == THREADS);
+    vlc_mutex_unlock(&lock);
+    assert(vlc_http_mgr_can_multiplex(mgr));
+
+    /* Sequential requests reuse it */
+    test_reset(1);
+    request_thread(NULL);
+    test_check(0, 1);
+
+    /* A dead connection is replaced */
+    test_kill_conn();
+    request_thread(NULL);
+    test_check(1, 1);
+
+    /* A response left open keeps the connection alive until it is closed */
+    resp = vlc_http_mgr_request(mgr, true, "www.example.com", 0, req,
+                                true, false);
+    assert(resp != NULL);
+    test_kill_conn();
+    request_thread(NULL);
+    vlc_mutex_lock(&lock);
+    assert(handshakes == 2);
+    assert(conns == 2);
+    vlc_mutex_unlock(&lock);
+    vlc_http_msg_destroy(resp);
+    test_check(2, 1);
+
+    vlc_http_mgr_destroy(mgr);
+    test_check(2, 0);
+
+    /* Servers without HTTP/2 */
+    alp_reply = "http/1.1";
+    mgr = vlc_http_mgr_create(&obj, NULL);
+    assert(mgr != NULL);
+    test_reset(1);
+    request_thread(NULL);
+    test_check(1, 1);
+    assert(!vlc_http_mgr_can_multiplex(mgr));
+    vlc_http_mgr_destroy(mgr);
+    test_check(1, 0);
+
+    vlc_http_msg_destroy(req);
+    return 0;
+}
@@ -53,12 +53,34 @@
  */
 #define MRU 65507u
 
+#ifdef HAVE_RECVMMSG
+/* Initial size of batch receive slots, grown to MRU on truncation */
+# define BATCH_SLOT_SIZE 2048u
+#endif
+
 typedef struct {
     int fd;
     int timeout;
 
     size_t length;
     char *offset;
+#ifdef HAVE_RECVMMSG
+    struct {
+        unsigned count;   /* datagrams per recvmmsg() */
+        unsigned next;    /* next received slot to hand out */
+        unsigned received;
+        size_t slot_size;
+        block_t **blocks;
+        struct mmsghdr *msgs;
+        struct iovec *iovecs;
+        char (*cmsgs)[CMSG_SPACE(sizeof (uint32_t))];
+
+        uint64_t datagrams;
+        uint64_t syscalls;
+        uint64_t truncated;
+        uint32_t overflows; /* kernel receive queue drops */
+    } batch;
+#endif
     char buf[MRU];
 } access_sys_t;
 
@@ -132,6 +154,147 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
     return val;
 }
 
+#ifdef HAVE_RECVMMSG
+static block_t *BlockBatch(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->batch.next >= sys->batch.received) {
+        unsigned count;
+
+        /* Refill the slots handed out since the previous call */
+        for (count = 0; count < sys->batch.count; count++) {
+            struct msghdr *hdr = &sys->batch.msgs[count].msg_hdr;
+
+            if (sys->batch.blocks[count] == NULL) {
+                block_t *block = block_Alloc(sys->batch.slot_size);
+                if (unlikely(block == NULL))
+                    break;
+                sys->batch.blocks[count] = block;
+                sys->batch.iovecs[count].iov_base = block->p_buffer;
+                sys->batch.iovecs[count].iov_len = block->i_buffer;
+            }
+            hdr->msg_control = sys->batch.cmsgs[count];
+            hdr->msg_controllen = sizeof (sys->batch.cmsgs[count]);
+            hdr->msg_flags = 0;
+        }
+
+        if (unlikely(count == 0))
+            return NULL;
+
+        struct pollfd ufd[1];
+
+        ufd[0].fd = sys->fd;
+        ufd[0].events = POLLIN;
+
+        switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+            case 0:
+                msg_Err(access, "receive time-out");
+                *eof = true;
+                return NULL;
+            case -1:
+                return NULL;
+        }
+
+        int val = recvmmsg(sys->fd, sys->batch.msgs, count, MSG_DONTWAIT,
+                           NULL);
+        if (val <= 0)
+            return NULL;
+
+        sys->batch.syscalls++;
+        sys->batch.datagrams += val;
+        sys->batch.next = 0;
+        sys->batch.received = val;
+    }
+
+    unsigned i = sys->batch.next++;
+    struct mmsghdr *mmsg = &sys->batch.msgs[i];
+    block_t *block = sys->batch.blocks[i];
+
+#ifdef SO_RXQ_OVFL
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mmsg->msg_hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&mmsg->msg_hdr, cmsg))
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t overflows;
+
+            memcpy(&overflows, CMSG_DATA(cmsg), sizeof (overflows));
+            if (overflows != sys->batch.overflows)
+                msg_Warn(access, "%"PRIu32" datagram(s) dropped by the kernel",
+                         overflows - sys->batch.overflows);
+            sys->batch.overflows = overflows;
+        }
+#endif
+
+    if (mmsg->msg_hdr.msg_flags & MSG_TRUNC) {
+        /* Drop it, and make the slots large enough from now on */
+        if (sys->batch.slot_size < MRU) {
+            msg_Warn(access, "datagram larger than %zu bytes, truncated",
+                     sys->batch.slot_size);
+            sys->batch.slot_size = MRU;
+        }
+        sys->batch.truncated++;
+        sys->batch.blocks[i] = NULL;
+        block_Release(block);
+        return NULL;
+    }
+
+    sys->batch.blocks[i] = NULL;
+    block->i_buffer = mmsg->msg_len;
+    return block;
+}
+
+static void BlockBatchClose(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    for (unsigned i = 0; i < sys->batch.count; i++)
+        if (sys->batch.blocks[i] != NULL)
+            block_Release(sys->batch.blocks[i]);
+
+    if (sys->batch.syscalls > 0)
+        msg_Dbg(access, "received %"PRIu64" datagrams in %"PRIu64
+                " calls (%.1f per call), %"PRIu64" truncated, %"PRIu32
+                " dropped", sys->batch.datagrams, sys->batch.syscalls,
+                (double)sys->batch.datagrams / sys->batch.syscalls,
+                sys->batch.truncated, sys->batch.overflows);
+}
+
+static int BlockBatchOpen(stream_t *access, unsigned count)
+{
+    access_sys_t *sys = access->p_sys;
+    vlc_object_t *obj = VLC_OBJECT(access);
+
+    sys->batch.count = count;
+    sys->batch.next = 0;
+    sys->batch.received = 0;
+    sys->batch.slot_size = BATCH_SLOT_SIZE;
+    sys->batch.datagrams = 0;
+    sys->batch.syscalls = 0;
+    sys->batch.truncated = 0;
+    sys->batch.overflows = 0;
+    sys->batch.blocks = vlc_obj_calloc(obj, count, sizeof (block_t *));
+    sys->batch.msgs = vlc_obj_calloc(obj, count, sizeof (struct mmsghdr));
+    sys->batch.iovecs = vlc_obj_calloc(obj, count, sizeof (struct iovec));
+    sys->batch.cmsgs = vlc_obj_calloc(obj, count, sizeof (*sys->batch.cmsgs));
+    if (unlikely(sys->batch.blocks == NULL || sys->batch.msgs == NULL
+              || sys->batch.iovecs == NULL || sys->batch.cmsgs == NULL))
+        return VLC_ENOMEM;
+
+    for (unsigned i = 0; i < count; i++) {
+        sys->batch.msgs[i].msg_hdr.msg_iov = &sys->batch.iovecs[i];
+        sys->batch.msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+#ifdef SO_RXQ_OVFL
+    setsockopt(sys->fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int));
+#endif
+    access->pf_read = NULL;
+    access->pf_block = BlockBatch;
+    msg_Dbg(access, "receiving up to %u datagrams per call", count);
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Open: open the socket
  *****************************************************************************/
@@ -217,6 +380,17 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->batch.count = 0;
+
+    unsigned i_batch = var_InheritInteger( p_access, "udp-recv-batch" );
+    if( i_batch > 0 && BlockBatchOpen( p_access, i_batch ) != VLC_SUCCESS )
+    {
+        net_Close( sys->fd );
+        return VLC_ENOMEM;
+    }
+#endif
+
     return VLC_SUCCESS;
 }
 
@@ -228,10 +402,17 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    if( sys->batch.count > 0 )
+        BlockBatchClose( p_access );
+#endif
     net_Close( sys->fd );
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Datagrams per receive call")
+#define BATCH_LONGTEXT N_("Receive up to this many datagrams with a single " \
+    "system call, into preallocated buffers. 0 receives datagrams one by one.")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -240,6 +421,10 @@ vlc_module_begin()
 
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL)
+#ifdef HAVE_RECVMMSG
+    add_integer_with_range("udp-recv-batch", 0, 0, 1024, BATCH_TEXT,
+                           BATCH_LONGTEXT)
+#endif
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/LowLatencyAdaptationLogic.hpp"
 #include "logic/BufferingLogic.hpp"
 #include "tools/Debug.hpp"
 #ifdef ADAPTIVE_DEBUGGING_LOGIC
@@ -78,6 +79,8 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     demux.pcr_syncpoint = TimestampSynchronizationPoint::RandomAccess;
     vlc_mutex_init(&demux.lock);
     vlc_cond_init(&demux.cond);
+    latency.f_rate = 1.0f;
+    latency.i_last = VLC_TICK_INVALID;
     vlc_mutex_init(&cached.lock);
     cached.b_live = false;
     cached.f_position = 0.0;
@@ -127,6 +130,8 @@ bool PlaylistManager::setupPeriod()
             if(!tracker)
                 continue;
 
+            tracker->setPrefetchCount(var_InheritInteger(p_demux, "adaptive-prefetch"));
+
             AbstractStream *st = streamFactory->create(p_demux, set->getStreamFormat(),
                                                        tracker, resources->getConnManager());
             if(!st)
@@ -501,6 +506,7 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
             demux.i_nzpcr = i_nzbarrier;
             vlc_tick_t pcr = VLC_TICK_0 + std::max(INT64_C(0), demux.i_nzpcr - VLC_TICK_FROM_MS(100));
             es_out_Control(p_demux->out, ES_OUT_SET_GROUP_PCR, 0, pcr);
+            applyLatencyRate();
         }
         vlc_mutex_unlock(&demux.lock);
         break;
@@ -645,6 +651,38 @@ int PlaylistManager::doControl(int i_query, va_list args)
     return VLC_SUCCESS;
 }
 
+/* Demuxers can't change the input rate: play the correction of the low
+ * latency logic by moving the clock origin instead, right after the PCR
+ * update. The clock reference lasts until the next reset, so the origin gets
+ * anchored to 0 before each relative shift. */
+void PlaylistManager::applyLatencyRate()
+{
+    const LowLatencyAdaptationLogic *latencyLogic =
+            dynamic_cast<const LowLatencyAdaptationLogic *>(logic);
+    if(!latencyLogic)
+        return;
+
+    const float f_rate = latencyLogic->getPlaybackRate();
+    if(f_rate != latency.f_rate)
+    {
+        msg_Dbg(p_demux, "live latency drift, playback rate %.2f", f_rate);
+        latency.f_rate = f_rate;
+    }
+
+    const vlc_tick_t now = vlc_tick_now();
+    const vlc_tick_t i_last = latency.i_last;
+    latency.i_last = now;
+    if(f_rate == 1.0f || i_last == VLC_TICK_INVALID)
+        return;
+
+    /* Don't catch up on pauses or stalls */
+    const vlc_tick_t i_elapsed = std::min(now - i_last, VLC_TICK_FROM_MS(250));
+    const vlc_tick_t i_shift = -(vlc_tick_t) ((f_rate - 1.0f) * i_elapsed);
+    if(es_out_Control(p_demux->out, ES_OUT_MODIFY_PCR_SYSTEM, 0, (vlc_tick_t) 0) ||
+       es_out_Control(p_demux->out, ES_OUT_MODIFY_PCR_SYSTEM, 0, i_shift))
+        latency.i_last = VLC_TICK_INVALID; /* still buffering */
+}
+
 void PlaylistManager::setBufferingRunState(bool b)
 {
     mutex_locker locker {lock};
@@ -847,6 +885,16 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             logic = noplogic;
             break;
         }
+        case AbstractAdaptationLogic::LogicType::LowLatency:
+        {
+            vlc_tick_t target = VLC_TICK_FROM_MS(var_InheritInteger(p_demux, "adaptive-target-latency"));
+            LowLatencyAdaptationLogic *lllogic =
+                    new (std::nothrow) LowLatencyAdaptationLogic(obj, target);
+            if(lllogic)
+                conn->setDownloadRateObserver(lllogic);
+            logic = lllogic;
+            break;
+        }
         case AbstractAdaptationLogic::LogicType::Predictive:
         {
             AbstractAdaptationLogic *predictivelogic =
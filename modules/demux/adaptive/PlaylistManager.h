@@ -90,6 +90,7 @@ namespace adaptive
             void unsetPeriod();
 
             void updateControlsPosition();
+            void applyLatencyRate();
 
             /* local factories */
             virtual AbstractAdaptationLogic *createLogic(AbstractAdaptationLogic::LogicType,
@@ -122,6 +123,13 @@ namespace adaptive
                 vlc_cond_t  cond;
             } demux;
 
+            /* live latency correction, demux thread only */
+            struct
+            {
+                float       f_rate;
+                vlc_tick_t  i_last;
+            } latency;
+
             /* buffering process */
             time_t                               nextPlaylistupdate;
             int                                  failedupdates;
@@ -116,6 +116,7 @@ SegmentTracker::SegmentTracker(SharedResources *res,
     resources = res;
     first = true;
     initializing = true;
+    prefetchCount = 0;
     bufferingLogic = bl;
     setAdaptationLogic(logic_);
     adaptationSet = adaptSet;
@@ -320,6 +321,38 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos,
                       timescale.ToTime(segment->duration.Get()), segment->getDisplayTime());
 }
 
+void SegmentTracker::setPrefetchCount(unsigned count)
+{
+    prefetchCount = count;
+}
+
+/* Prepares the following media segments, which starts their download
+ * while the current one is being demuxed */
+void SegmentTracker::prefetchChunks(bool switch_allowed,
+                                    AbstractConnectionManager *connManager)
+{
+    while(chunkssequence.size() < prefetchCount)
+    {
+        Position pos = next;
+        if(!chunkssequence.empty())
+        {
+            pos = chunkssequence.back().pos;
+            ++pos;
+        }
+        if(!pos.isValid() || !pos.init_sent || !pos.index_sent)
+            break;
+
+        ChunkEntry entry = prepareChunk(switch_allowed, pos, connManager);
+        if(!entry.isValid())
+        {
+            /* not available yet (live), will be prepared on demand */
+            delete entry.chunk;
+            break;
+        }
+        chunkssequence.push_back(entry);
+    }
+}
+
 void SegmentTracker::resetChunksSequence()
 {
     while(!chunkssequence.empty())
@@ -412,7 +445,10 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed,
         notify(DiscontinuityEvent());
 
     if(!b_gap)
+    {
         ++next;
+        prefetchChunks(switch_allowed, connManager);
+    }
 
     return returnedChunk;
 }
@@ -200,6 +200,7 @@ namespace adaptive
             void registerListener(SegmentTrackerListenerInterface *);
             void updateSelected();
             bool bufferingAvailable() const;
+            void setPrefetchCount(unsigned);
 
         private:
             class ChunkEntry
@@ -218,10 +219,12 @@ namespace adaptive
             ChunkEntry prepareChunk(bool switch_allowed, Position pos,
                                     AbstractConnectionManager *connManager) const;
             void resetChunksSequence();
+            void prefetchChunks(bool switch_allowed, AbstractConnectionManager *);
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
             bool first;
             bool initializing;
+            unsigned prefetchCount;
             Position current;
             Position next;
             StreamFormat format;
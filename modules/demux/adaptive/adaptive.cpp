@@ -35,6 +35,7 @@
 #include "SharedResources.hpp"
 #include "playlist/BasePeriod.h"
 #include "logic/BufferingLogic.hpp"
+#include "logic/LowLatencyAdaptationLogic.hpp"
 #include "xml/DOMParser.h"
 
 #include "../dash/DASHManager.h"
@@ -82,6 +83,18 @@ static void Close   (vlc_object_t *);
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
+#define ADAPT_WORKERS_TEXT N_("Concurrent downloads")
+#define ADAPT_WORKERS_LONGTEXT N_("Maximum number of segments downloaded at the same time")
+
+#define ADAPT_STREAMDL_TEXT N_("Concurrent downloads per stream")
+#define ADAPT_STREAMDL_LONGTEXT N_("Maximum number of segments of a same stream downloaded at the same time (0 for no limit)")
+
+#define ADAPT_PREFETCH_TEXT N_("Prefetched segments")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of upcoming segments of each stream requested ahead of their playback")
+
+#define ADAPT_LATENCY_TEXT N_("Target live latency (ms)")
+#define ADAPT_LATENCY_LONGTEXT N_("End-to-end latency held by the low latency adaptive logic")
+
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
@@ -89,6 +102,7 @@ static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::LogicType::Default,
                                 AbstractAdaptationLogic::LogicType::Predictive,
                                 AbstractAdaptationLogic::LogicType::NearOptimal,
+                                AbstractAdaptationLogic::LogicType::LowLatency,
                                 AbstractAdaptationLogic::LogicType::RateBased,
                                 AbstractAdaptationLogic::LogicType::FixedRate,
                                 AbstractAdaptationLogic::LogicType::AlwaysLowest,
@@ -98,6 +112,7 @@ static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
                                 "nearoptimal",
+                                "lowlatency",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -106,6 +121,7 @@ static const char *const ppsz_logics_values[] = {
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
                                            N_("Near Optimal"),
+                                           N_("Low Latency"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -144,6 +160,15 @@ vlc_module_begin ()
                      ADAPT_MAXBUFFER_TEXT, nullptr );
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT );
             change_integer_list(rgi_latency, ppsz_latency)
+        add_integer( "adaptive-target-latency",
+                     MS_FROM_VLC_TICK(LowLatencyAdaptationLogic::DEFAULT_TARGET_LATENCY),
+                     ADAPT_LATENCY_TEXT, ADAPT_LATENCY_LONGTEXT );
+        add_integer_with_range( "adaptive-download-workers", 2, 1, 16,
+                                ADAPT_WORKERS_TEXT, ADAPT_WORKERS_LONGTEXT )
+        add_integer_with_range( "adaptive-stream-downloads", 1, 0, 16,
+                                ADAPT_STREAMDL_TEXT, ADAPT_STREAMDL_LONGTEXT )
+        add_integer_with_range( "adaptive-prefetch", 1, 0, 8,
+                                ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
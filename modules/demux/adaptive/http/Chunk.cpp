@@ -255,10 +255,7 @@ void HTTPChunkSource::recycle()
 std::string HTTPChunkSource::getContentType() const
 {
     mutex_locker locker {lock};
-    if(connection)
-        return connection->getContentType();
-    else
-        return std::string();
+    return contentType;
 }
 
 bool HTTPChunkSource::prepare()
@@ -300,6 +297,7 @@ bool HTTPChunkSource::prepare()
         /* Because we don't know Chunk size at start, we need to get size
                from content length */
         contentLength = connection->getContentLength();
+        contentType = connection->getContentType();
         prepared = true;
         responseTime = vlc_tick_now();
         return true;
@@ -369,6 +367,9 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     {
         mutex_locker locker {lock};
+        if(done) /* connection already released */
+            return;
+
         if(!prepare())
         {
             done = true;
@@ -409,6 +410,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         rate.size = buffered + consumed;
         rate.time = downloadEndTime - requestStartTime;
         rate.latency = responseTime - requestStartTime;
+        releaseConnection();
     }
     else
     {
@@ -423,6 +425,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             rate.size = buffered + consumed;
             rate.time = downloadEndTime - requestStartTime;
             rate.latency = responseTime - requestStartTime;
+            releaseConnection();
         }
     }
 
@@ -435,6 +438,17 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     avail.signal();
 }
 
+void HTTPChunkBufferedSource::releaseConnection()
+{
+    /* Everything is buffered, let prefetched chunks waiting to be
+     * read give back their connection for the next downloads */
+    if(connection)
+    {
+        connection->setUsed(false);
+        connection = nullptr;
+    }
+}
+
 bool HTTPChunkBufferedSource::hasMoreData() const
 {
     mutex_locker locker {lock};
@@ -142,6 +142,7 @@ namespace adaptive
                 vlc_tick_t          requestStartTime;
                 vlc_tick_t          responseTime;
                 vlc_tick_t          downloadEndTime;
+                std::string         contentType;
 
             private:
                 bool init(const std::string &);
@@ -169,6 +170,7 @@ namespace adaptive
                 void               release();
 
             private:
+                void               releaseConnection();
                 block_t            *p_head; /* read cache buffer */
                 block_t           **pp_tail;
                 size_t              buffered; /* read cache size */
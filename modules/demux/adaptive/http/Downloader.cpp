@@ -25,43 +25,49 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned count, unsigned perStream)
+    : workers(count ? count : 1)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    started = 0;
+    maxPerStream = perStream;
+    for(Worker &worker : workers)
+    {
+        worker.owner = this;
+        worker.current = nullptr;
+        worker.cancel_current = false;
+    }
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    for(; started < workers.size(); started++)
     {
-        return false;
+        if(vlc_clone(&workers[started].thread_handle, downloaderThread,
+                     static_cast<void *>(&workers[started]), VLC_THREAD_PRIORITY_INPUT))
+            break;
     }
-    thread_handle_valid = true;
-    return true;
+    /* a partial pool still runs everything, with less concurrency */
+    return started > 0;
 }
 
 Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(unsigned i = 0; i < started; i++)
+        vlc_join(workers[i].thread_handle, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -75,53 +81,89 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    while (countCurrent(source))
     {
-        cancel_current = true;
+        for(Worker &worker : workers)
+            if(worker.current == source)
+                worker.cancel_current = true;
         updated_cond.wait(lock);
     }
 
-    if(!source->isDone())
+    auto it = std::find(chunks.begin(), chunks.end(), source);
+    if(it != chunks.end())
     {
-        chunks.remove(source);
+        chunks.erase(it);
         source->release();
     }
 }
 
+unsigned Downloader::countCurrent(const HTTPChunkBufferedSource *source) const
+{
+    unsigned count = 0;
+    for(const Worker &worker : workers)
+        if(worker.current == source)
+            count++;
+    return count;
+}
+
+/* Oldest queued source whose stream is not already downloading at its limit */
+HTTPChunkBufferedSource * Downloader::getNext() const
+{
+    for(HTTPChunkBufferedSource *source : chunks)
+    {
+        if(!maxPerStream)
+            return source;
+
+        unsigned streamCount = 0;
+        for(const Worker &worker : workers)
+            if(worker.current && worker.current->sourceid == source->sourceid)
+                streamCount++;
+        if(streamCount < maxPerStream)
+            return source;
+    }
+    return nullptr;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
-    Downloader *instance = static_cast<Downloader *>(opaque);
-    instance->Run();
+    Worker *worker = static_cast<Worker *>(opaque);
+    worker->owner->Run(worker);
     return nullptr;
 }
 
-void Downloader::Run()
+void Downloader::Run(Worker *worker)
 {
+    HTTPChunkBufferedSource *source = nullptr;
+
+    lock.lock();
     while(1)
     {
-        lock.lock();
-
-        while(chunks.empty() && !killed)
+        while(!killed && !(source = getNext()))
             wait_cond.wait(lock);
 
         if(killed)
-        {
-            lock.unlock();
             break;
-        }
 
-        current = chunks.front();
-        lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
-        lock.lock();
-        if(current->isDone() || cancel_current)
+        chunks.remove(source);
+        worker->current = source;
+        worker->cancel_current = false;
+
+        /* Download it entirely, so that segments of a stream complete in order */
+        bool done;
+        do
         {
-            chunks.pop_front();
-            current->release();
-        }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
-        lock.unlock();
+            lock.unlock();
+            source->bufferize(HTTPChunkSource::CHUNK_SIZE);
+            done = source->isDone();
+            lock.lock();
+        } while(!done && !worker->cancel_current && !killed);
+
+        source->release();
+        worker->current = nullptr;
+        worker->cancel_current = false;
+        updated_cond.broadcast();
+        /* the stream may now start its next source on another worker */
+        wait_cond.broadcast();
     }
+    lock.unlock();
 }
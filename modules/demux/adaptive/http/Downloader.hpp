@@ -25,6 +25,7 @@
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -35,25 +36,34 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1, unsigned = 0);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
 
             private:
+                class Worker
+                {
+                    public:
+                        Downloader *owner;
+                        vlc_thread_t thread_handle;
+                        HTTPChunkBufferedSource *current;
+                        bool cancel_current;
+                };
                 static void * downloaderThread(void *);
-                void Run();
+                void Run(Worker *);
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNext() const;
+                unsigned countCurrent(const HTTPChunkBufferedSource *) const;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
+                std::vector<Worker> workers;
+                unsigned     started;
+                unsigned     maxPerStream; /* 0 for no limit */
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
         };
 
     }
@@ -88,15 +88,19 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
      friend class LibVLCHTTPConnection;
 
      public:
-        LibVLCHTTPSource(vlc_object_t *p_object, struct vlc_http_cookie_jar_t *jar)
+        LibVLCHTTPSource(vlc_object_t *p_object, struct vlc_http_cookie_jar_t *jar,
+                         struct vlc_http_mgr *shared_mgr)
         {
-            http_mgr = vlc_http_mgr_create(p_object, jar);
+            /* A shared manager lets concurrent downloads from the same origin
+             * run as streams of a single HTTP/2 connection */
+            owned_mgr = (shared_mgr == nullptr);
+            http_mgr = owned_mgr ? vlc_http_mgr_create(p_object, jar) : shared_mgr;
             http_res = nullptr;
             totalRead = 0;
         }
         virtual ~LibVLCHTTPSource()
         {
-            if(http_mgr)
+            if(http_mgr && owned_mgr)
                 vlc_http_mgr_destroy(http_mgr);
         }
         virtual block_t *readNextBlock() override
@@ -186,6 +190,7 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
         static const struct vlc_http_resource_cbs callbacks;
         size_t totalRead;
         struct vlc_http_mgr *http_mgr;
+        bool owned_mgr;
         BytesRange range;
 
     public:
@@ -235,10 +240,11 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
+                                           struct vlc_http_mgr *shared_mgr)
     : AbstractConnection( p_object_ )
 {
-    source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
+    source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar(), shared_mgr);
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
     char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
@@ -541,13 +547,49 @@ LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
     authStorage = auth;
 }
 
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    /* connections, and their pending streams, are gone by now */
+    for(auto it = sharedManagers.begin(); it != sharedManagers.end(); ++it)
+        vlc_http_mgr_destroy((*it).second);
+}
+
+struct vlc_http_mgr * LibVLCHTTPConnectionFactory::getSharedManager(vlc_object_t *p_object,
+                                                                    const ConnectionParams &params)
+{
+    /* HTTP/2 is only negotiated over TLS */
+    if(params.getScheme() != "https")
+        return nullptr;
+
+    const std::string origin = params.getHostname() + ":" +
+                               std::to_string(params.getPort());
+    auto it = sharedManagers.find(origin);
+    if(it != sharedManagers.end())
+    {
+        /* Only share once the first connection negotiated HTTP/2: until
+         * then, or if the server replied HTTP/1.1, concurrent requests would
+         * keep evicting each other's connection, so give each its own */
+        if(!vlc_http_mgr_can_multiplex((*it).second))
+            return nullptr;
+        return (*it).second;
+    }
+
+    /* The first connection to the origin negotiates for the others */
+    struct vlc_http_mgr *mgr = vlc_http_mgr_create(p_object, authStorage->getJar());
+    if(mgr)
+        sharedManagers.insert(std::pair<std::string, struct vlc_http_mgr *>(origin, mgr));
+    return mgr;
+}
+
 AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
                                                                   const ConnectionParams &params)
 {
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    /* Called with the connection manager lock held */
+    return new LibVLCHTTPConnection(p_object, authStorage,
+                                    getSharedManager(p_object, params));
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
@@ -28,8 +28,11 @@
 #include "ConnectionParams.hpp"
 #include "BytesRange.hpp"
 #include <vlc_common.h>
+#include <map>
 #include <string>
 
+struct vlc_http_mgr;
+
 namespace adaptive
 {
     class ChunksSourceStream;
@@ -75,7 +78,8 @@ namespace adaptive
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *,
+                                    struct vlc_http_mgr * = nullptr);
                virtual ~LibVLCHTTPConnection();
                virtual bool    canReuse     (const ConnectionParams &) const override;
                virtual RequestStatus request(const std::string& path,
@@ -123,10 +127,13 @@ namespace adaptive
        {
            public:
                LibVLCHTTPConnectionFactory( AuthStorage * );
-               virtual ~LibVLCHTTPConnectionFactory() = default;
+               virtual ~LibVLCHTTPConnectionFactory();
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
            private:
+               struct vlc_http_mgr * getSharedManager(vlc_object_t *, const ConnectionParams &);
                AuthStorage *authStorage;
+               /* HTTPS origin => manager multiplexing its requests over HTTP/2 */
+               std::map<std::string, struct vlc_http_mgr *> sharedManagers;
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
@@ -75,7 +75,11 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    /* Segments are fetched by a pool, with a limited number of concurrent
+     * downloads per stream so that a prefetching stream can't starve others */
+    unsigned workers = var_InheritInteger(p_object, "adaptive-download-workers");
+    unsigned perStream = var_InheritInteger(p_object, "adaptive-stream-downloads");
+    downloader = new Downloader(workers, perStream);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
@@ -0,0 +1,258 @@
+/*
+ * LowLatencyAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "LowLatencyAdaptationLogic.hpp"
+
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Targets a fixed end-to-end latency on low latency live streams.
+ * Downloads happen at the live edge, so the buffered duration is used as
+ * the latency estimate. Quality follows the chunk throughput with a safety
+ * margin depending on the distance to the target, and a playback rate
+ * correction is proposed to compensate drift.
+ * Chunked transfers at the live edge are paced by the encoder and can't
+ * measure a link faster than the content: higher qualities get probed
+ * instead, one step at a time.
+ */
+
+const vlc_tick_t LowLatencyAdaptationLogic::DEFAULT_TARGET_LATENCY = VLC_TICK_FROM_SEC(3);
+const float LowLatencyAdaptationLogic::MAX_RATE_DEVIATION = 0.05f;
+const unsigned LowLatencyAdaptationLogic::PROBE_INTERVAL = 8;
+
+LowLatencyStats::LowLatencyStats()
+{
+    buffering_level = 0;
+    last_duration = 0;
+    estimated_bps = 0;
+    paced = false;
+    probe_holdoff = 0;
+}
+
+LowLatencyAdaptationLogic::LowLatencyAdaptationLogic(vlc_object_t *obj, vlc_tick_t target)
+    : AbstractAdaptationLogic(obj)
+{
+    targetLatency = target > 0 ? target : DEFAULT_TARGET_LATENCY;
+    playbackRate = 1.0f;
+    vlc_mutex_init(&lock);
+}
+
+LowLatencyAdaptationLogic::~LowLatencyAdaptationLogic()
+{
+}
+
+BaseRepresentation *LowLatencyAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet,
+                                                                     BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+    BaseRepresentation *rep;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, LowLatencyStats>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end() || (*it).second.estimated_bps == 0)
+    {
+        /* No throughput sample yet: start low, stalling costs latency */
+        rep = prevRep ? prevRep : selector.lowest(adaptSet);
+    }
+    else
+    {
+        LowLatencyStats &stats = (*it).second;
+        const double f_latency = (double) stats.buffering_level / targetLatency;
+        if(stats.probe_holdoff)
+            stats.probe_holdoff--;
+
+        /* The closer to the live edge, the less throughput margin we have */
+        double f_safety;
+        if(f_latency < 0.5)
+            f_safety = 0.5;
+        else if(f_latency < 1.0)
+            f_safety = 0.75;
+        else
+            f_safety = 0.9;
+
+        rep = selector.select(adaptSet, (uint64_t) (stats.estimated_bps * f_safety));
+
+        if(prevRep && rep && rep->getBandwidth() > prevRep->getBandwidth())
+        {
+            /* Only step up one quality at a time, and not while draining */
+            rep = (f_latency < 0.75) ? prevRep : selector.higher(adaptSet, prevRep);
+        }
+        else if(prevRep && stats.paced && f_latency >= 0.75)
+        {
+            /* Current quality is sustained: keep it, or probe the next one */
+            rep = prevRep;
+            if(!stats.probe_holdoff)
+            {
+                rep = selector.higher(adaptSet, prevRep);
+                stats.probe_holdoff = PROBE_INTERVAL;
+            }
+        }
+
+        BwDebug( if( rep != prevRep )
+                    msg_Info(p_obj, "Stream %s latency %.2f new bandwidth usage %zu KiB/s",
+                             adaptSet->getID().str().c_str(), f_latency,
+                             rep->getBandwidth() / 8000); );
+    }
+
+    vlc_mutex_unlock(&lock);
+
+    return rep;
+}
+
+void LowLatencyAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
+                                                   vlc_tick_t time, vlc_tick_t)
+{
+    if(unlikely(time == 0))
+        return;
+
+    vlc_mutex_lock(&lock);
+    std::map<ID, LowLatencyStats>::iterator it = streams.find(id);
+    if(it != streams.end())
+    {
+        LowLatencyStats &stats = (*it).second;
+        const uint64_t bps = CLOCK_FREQ * dlsize * 8 / time;
+
+        /* A download lasting about the media duration was paced by the
+         * encoder: it only tells the link is at least that fast, and must
+         * not lower the estimation. */
+        stats.paced = stats.last_duration &&
+                      time > stats.last_duration * 9 / 10 &&
+                      time < stats.last_duration * 11 / 10;
+        if(!stats.paced || bps > stats.estimated_bps)
+            stats.estimated_bps = stats.average.push(bps);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void LowLatencyAdaptationLogic::updatePlaybackRate()
+{
+    /* The latency is the lowest of all streams buffering levels */
+    vlc_tick_t latency = std::numeric_limits<vlc_tick_t>::max();
+    for(auto it = streams.cbegin(); it != streams.cend(); ++it)
+        latency = std::min(latency, (*it).second.buffering_level);
+
+    if(streams.empty())
+    {
+        playbackRate = 1.0f;
+        return;
+    }
+
+    /* Dead zone of 10% around the target, then proportional correction */
+    const vlc_tick_t drift = latency - targetLatency;
+    if(drift > -targetLatency / 10 && drift < targetLatency / 10)
+    {
+        playbackRate = 1.0f;
+        return;
+    }
+
+    float f_correction = 0.1f * drift / targetLatency;
+    f_correction = std::max(-MAX_RATE_DEVIATION, std::min(MAX_RATE_DEVIATION, f_correction));
+    playbackRate = 1.0f + f_correction;
+}
+
+float LowLatencyAdaptationLogic::getPlaybackRate() const
+{
+    vlc_mutex_lock(&lock);
+    float rate = playbackRate;
+    vlc_mutex_unlock(&lock);
+    return rate;
+}
+
+vlc_tick_t LowLatencyAdaptationLogic::getTargetLatency() const
+{
+    return targetLatency;
+}
+
+void LowLatencyAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    LowLatencyStats stats;
+                    streams.insert(std::pair<ID, LowLatencyStats>(id, stats));
+                }
+            }
+            else
+            {
+                std::map<ID, LowLatencyStats>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            updatePlaybackRate();
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            std::map<ID, LowLatencyStats>::iterator it = streams.find(id);
+            if(it != streams.end())
+            {
+                (*it).second.buffering_level = event.current;
+                updatePlaybackRate();
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::SegmentChange:
+        {
+            const SegmentChangedEvent &event =
+                    static_cast<const SegmentChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            std::map<ID, LowLatencyStats>::iterator it = streams.find(id);
+            if(it != streams.end())
+                (*it).second.last_duration = event.duration;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * LowLatencyAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef LOWLATENCYADAPTATIONLOGIC_HPP
+#define LOWLATENCYADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include "../tools/MovingAverage.hpp"
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class LowLatencyStats
+        {
+            friend class LowLatencyAdaptationLogic;
+
+            public:
+                LowLatencyStats();
+
+            private:
+                vlc_tick_t buffering_level;
+                vlc_tick_t last_duration;
+                uint64_t estimated_bps;
+                bool paced;
+                unsigned probe_holdoff;
+                MovingAverage<uint64_t> average;
+        };
+
+        class LowLatencyAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                LowLatencyAdaptationLogic(vlc_object_t *, vlc_tick_t);
+                virtual ~LowLatencyAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *,
+                                                                  BaseRepresentation *) override;
+                virtual void                updateDownloadRate     (const ID &, size_t,
+                                                                    vlc_tick_t, vlc_tick_t) override;
+                virtual void                trackerEvent           (const TrackerEvent &) override;
+                float                       getPlaybackRate() const;
+                vlc_tick_t                  getTargetLatency() const;
+
+                static const vlc_tick_t     DEFAULT_TARGET_LATENCY;
+                static const float          MAX_RATE_DEVIATION;
+                static const unsigned       PROBE_INTERVAL;
+
+            private:
+                void                        updatePlaybackRate();
+                std::map<adaptive::ID, LowLatencyStats> streams;
+                vlc_tick_t                  targetLatency;
+                float                       playbackRate;
+                mutable vlc_mutex_t         lock;
+        };
+    }
+}
+
+#endif // LOWLATENCYADAPTATIONLOGIC_HPP
@@ -39,6 +39,7 @@ SegmentList::SegmentList( SegmentInformation *parent_ ):
     AbstractMultipleSegmentBaseType( parent_, AttrsNode::Type::SegmentList )
 {
     totalLength = 0;
+    windowStartNumber = std::numeric_limits<uint64_t>::max();
 }
 SegmentList::~SegmentList()
 {
@@ -92,13 +93,23 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     AbstractMultipleSegmentBaseType::updateWith(updated_);
 
     SegmentList *updated = dynamic_cast<SegmentList *>(updated_);
-    if(!updated || updated->segments.empty())
+    if(!updated)
         return;
 
+    /* Incremental updates only carry the new segments */
+    const bool b_window = updated->windowStartNumber != std::numeric_limits<uint64_t>::max();
+    if(updated->segments.empty())
+    {
+        if(b_window)
+            pruneBySegmentNumber(updated->windowStartNumber);
+        return;
+    }
+
     const Segment * lastSegment = (segments.empty()) ? nullptr : segments.back();
     const Segment * prevSegment = lastSegment;
 
-    uint64_t firstnumber = updated->segments.front()->getSequenceNumber();
+    uint64_t firstnumber = b_window ? updated->windowStartNumber
+                                    : updated->segments.front()->getSequenceNumber();
 
     std::vector<Segment *>::iterator it;
     for(it = updated->segments.begin(); it != updated->segments.end(); ++it)
@@ -126,6 +137,11 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     pruneBySegmentNumber(firstnumber);
 }
 
+void SegmentList::setWindowStartNumber(uint64_t number)
+{
+    windowStartNumber = number;
+}
+
 void SegmentList::pruneByPlaybackTime(vlc_tick_t time)
 {
     const Timescale timescale = inheritTimescale();
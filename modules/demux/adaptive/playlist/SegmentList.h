@@ -46,6 +46,7 @@ namespace adaptive
                 virtual void            updateWith(AbstractMultipleSegmentBaseType *,
                                                    bool = false) override;
                 void                    pruneBySegmentNumber(uint64_t);
+                void                    setWindowStartNumber(uint64_t);
                 void                    pruneByPlaybackTime(vlc_tick_t);
                 stime_t                 getTotalLength() const;
 
@@ -62,6 +63,7 @@ namespace adaptive
             private:
                 std::vector<Segment *>  segments;
                 stime_t totalLength;
+                uint64_t windowStartNumber;
         };
     }
 }
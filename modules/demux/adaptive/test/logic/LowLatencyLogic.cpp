@@ -0,0 +1,170 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/LowLatencyAdaptationLogic.hpp"
+#include "../../SegmentTracker.hpp"
+
+#include "../test.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace logic;
+
+/* Bandwidth traces in kbps, sampled every chunk */
+static const unsigned trace_fiber[] = {
+    6000, 6100, 5900, 6000, 6200, 6000, 5800, 6000, 6100, 6000,
+};
+
+static const unsigned trace_drop[] = {
+    5000, 5000, 5000, 5000, 5000, 5000, 5000, 5000, 5000, 5000,
+    1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
+    5000, 5000, 5000, 5000, 5000, 5000, 5000, 5000, 5000, 5000,
+};
+
+static const unsigned trace_cellular[] = {
+    2400, 3100, 1800, 2600,  900, 1500, 2200, 3400, 2800, 1200,
+};
+
+struct SimulationResult
+{
+    std::vector<uint64_t> bandwidths;
+    std::vector<vlc_tick_t> latencies;
+    std::vector<float> rates;
+    vlc_tick_t stalled;
+};
+
+/* Plays chunks fetched at the live edge: downloads can't complete before
+ * the encoder produced the chunk, and playback consumes the buffer at the
+ * rate suggested by the logic during the download. */
+static SimulationResult Simulate(BaseAdaptationSet *set, vlc_tick_t target,
+                                 const unsigned *trace, size_t tracesize,
+                                 unsigned repeat)
+{
+    const vlc_tick_t chunkduration = VLC_TICK_FROM_MS(500);
+    LowLatencyAdaptationLogic logic(nullptr, target);
+    const ID &id = set->getID();
+    SimulationResult result;
+    result.stalled = 0;
+
+    logic.trackerEvent(BufferingStateUpdatedEvent(id, true));
+    vlc_tick_t buffering = target;
+    logic.trackerEvent(BufferingLevelChangedEvent(id, 0, 0, buffering, target));
+
+    BaseRepresentation *rep = nullptr;
+    for(unsigned i = 0; i < tracesize * repeat; i++)
+    {
+        const uint64_t linkbps = trace[(i / repeat) % tracesize] * UINT64_C(1000);
+
+        rep = logic.getNextRepresentation(set, rep);
+        logic.trackerEvent(SegmentChangedEvent(id, 0, chunkduration));
+
+        const size_t size = rep->getBandwidth() * chunkduration / CLOCK_FREQ / 8;
+        const vlc_tick_t dltime = std::max(chunkduration,
+                                           (vlc_tick_t) (size * 8 * CLOCK_FREQ / linkbps));
+        const float rate = logic.getPlaybackRate();
+        const vlc_tick_t consumed = dltime * rate;
+        if(consumed > buffering)
+        {
+            result.stalled += consumed - buffering;
+            buffering = 0;
+        }
+        else buffering -= consumed;
+        buffering += chunkduration;
+
+        logic.updateDownloadRate(id, size, dltime, 0);
+        logic.trackerEvent(BufferingLevelChangedEvent(id, 0, 0, buffering, target));
+
+        result.bandwidths.push_back(rep->getBandwidth());
+        result.latencies.push_back(buffering);
+        result.rates.push_back(rate);
+    }
+    return result;
+}
+
+int LowLatencyLogic_test()
+{
+    BasePlaylist *playlist = nullptr;
+    try
+    {
+        playlist = new BasePlaylist(nullptr);
+        BasePeriod *period = new BasePeriod(playlist);
+        playlist->addPeriod(period);
+        BaseAdaptationSet *set = new BaseAdaptationSet(period);
+        period->addAdaptationSet(set);
+        set->setID(ID("video"));
+        for(uint64_t bw = 400000; bw <= 3200000; bw *= 2)
+        {
+            BaseRepresentation *rep = new BaseRepresentation(set);
+            rep->setBandwidth(bw);
+            set->addRepresentation(rep);
+        }
+
+        const vlc_tick_t target = VLC_TICK_FROM_SEC(2);
+
+        /* Steady fast link: climbs to the highest quality, stays on target */
+        SimulationResult res = Simulate(set, target, trace_fiber,
+                                        ARRAY_SIZE(trace_fiber), 12);
+        Expect(res.stalled == 0);
+        Expect(res.bandwidths.front() == 400000);
+        Expect(res.bandwidths.back() == 3200000);
+        Expect(res.latencies.back() == target);
+        Expect(res.rates.back() == 1.0f);
+
+        /* Link drop: quality follows down then up again, without stalling */
+        res = Simulate(set, target, trace_drop, ARRAY_SIZE(trace_drop), 4);
+        Expect(res.stalled == 0);
+        Expect(res.bandwidths[39] == 3200000);
+        Expect(res.bandwidths[41] <= 800000);
+        Expect(res.bandwidths.back() == 3200000);
+        /* latency got under target, and the playback slowed down to recover it */
+        Expect(*std::min_element(res.latencies.begin(), res.latencies.end()) < target);
+        Expect(*std::min_element(res.rates.begin(), res.rates.end()) < 1.0f);
+        Expect(*std::min_element(res.rates.begin(), res.rates.end()) >=
+               1.0f - LowLatencyAdaptationLogic::MAX_RATE_DEVIATION);
+
+        /* Fluctuating link: latency kept around target */
+        res = Simulate(set, target, trace_cellular, ARRAY_SIZE(trace_cellular), 12);
+        Expect(res.stalled == 0);
+        vlc_tick_t total = 0;
+        for(vlc_tick_t latency : res.latencies)
+            total += latency;
+        Expect(total / (vlc_tick_t) res.latencies.size() > target / 2);
+        Expect(total / (vlc_tick_t) res.latencies.size() < target * 3 / 2);
+
+        delete playlist;
+    }
+    catch(...)
+    {
+        delete playlist;
+        return 1;
+    }
+
+    return 0;
+}
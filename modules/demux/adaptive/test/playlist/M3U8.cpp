@@ -39,6 +39,8 @@
 
 #include <limits>
 #include <algorithm>
+#include <sstream>
+#include <cstdio>
 
 using namespace adaptive;
 using namespace adaptive::playlist;
@@ -383,5 +385,135 @@ int M3U8Playlist_test()
     }
 
 
+    return 0;
+}
+
+static void UpdateM3U8(vlc_object_t *obj, BaseRepresentation *rep,
+                       const char *psz, size_t isz)
+{
+    M3U8Parser parser(nullptr);
+    stream_t *substream = vlc_stream_MemoryNew(obj, ((uint8_t *)psz), isz, true);
+    if(!substream)
+        throw 1;
+    parser.appendSegmentsFromStream(obj, substream, static_cast<HLSRepresentation *>(rep));
+    vlc_stream_Delete(substream);
+}
+
+/* Live window of count 2s segments, starting at sequence number first >= 1000 */
+static std::string LiveM3U8(uint64_t first, uint64_t count)
+{
+    const unsigned offset = 2 * (first - 1000);
+    char datetime[32];
+    snprintf(datetime, sizeof(datetime), "2026-01-01T%02u:%02u:%02u.000Z",
+             offset / 3600, (offset / 60) % 60, offset % 60);
+
+    std::ostringstream ss;
+    ss << "#EXTM3U\n"
+          "#EXT-X-TARGETDURATION:2\n"
+          "#EXT-X-MEDIA-SEQUENCE:" << first << "\n"
+          "#EXT-X-PROGRAM-DATE-TIME:" << datetime << "\n";
+    for(uint64_t i = first; i < first + count; i++)
+        ss << "#EXTINF:2.000,\n" << "segment" << i << ".ts\n";
+    return ss.str();
+}
+
+int M3U8Update_test()
+{
+    vlc_object_t *obj = static_cast<vlc_object_t*>(nullptr);
+
+    const char manifest0[] =
+    "#EXTM3U\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:8,\n"
+    "foobar10.ts\n"
+    "#EXTINF:8,\n"
+    "foobar11.ts\n"
+    "#EXTINF:8,\n"
+    "foobar12.ts\n";
+
+    const char manifest1[] =
+    "#EXTM3U\n"
+    "#EXT-X-MEDIA-SEQUENCE:11\n"
+    "#EXTINF:8,\n"
+    "foobar11.ts\n"
+    "#EXTINF:8,\n"
+    "foobar12.ts\n"
+    "#EXTINF:8,\n"
+    "foobar13.ts\n";
+
+    const char manifest2[] =
+    "#EXTM3U\n"
+    "#EXT-X-MEDIA-SEQUENCE:12\n"
+    "#EXTINF:8,\n"
+    "foobar12.ts\n"
+    "#EXTINF:8,\n"
+    "foobar13.ts\n";
+
+    M3U8 *m3u = ParseM3U8(obj, manifest0, sizeof(manifest0));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive());
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Segment *seg11 = rep->getMediaSegment(11);
+        Expect(seg11);
+
+        /* Known segments are kept, only the new one is added */
+        UpdateM3U8(obj, rep, manifest1, sizeof(manifest1));
+        Expect(rep->getMediaSegment(10) == nullptr);
+        Expect(rep->getMediaSegment(11) == seg11);
+        Segment *seg = rep->getMediaSegment(13);
+        Expect(seg);
+        Expect(seg->startTime.Get() == (stime_t) vlc_tick_from_sec(24));
+        Expect(seg->getSequenceNumber() == 13);
+
+        /* No new segment, window still moves */
+        UpdateM3U8(obj, rep, manifest2, sizeof(manifest2));
+        Expect(rep->getMediaSegment(11) == nullptr);
+        Expect(rep->getMediaSegment(12));
+        Expect(rep->getMediaSegment(13) == seg);
+        Expect(rep->getMediaSegment(14) == nullptr);
+
+        delete m3u;
+    }
+    catch(...)
+    {
+        delete m3u;
+        return 1;
+    }
+
+    /* Refresh of a 6 hours DVR window */
+    const uint64_t windowSize = 6 * 3600 / 2;
+    const std::string manifest3 = LiveM3U8(1000, windowSize);
+    const std::string manifest4 = LiveM3U8(1001, windowSize);
+
+    m3u = ParseM3U8(obj, manifest3.c_str(), manifest3.size());
+    try
+    {
+        Expect(m3u);
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Segment *first = rep->getMediaSegment(1001);
+        Expect(first);
+
+        UpdateM3U8(obj, rep, manifest4.c_str(), manifest4.size());
+
+        Expect(rep->getMediaSegment(1000) == nullptr);
+        Expect(rep->getMediaSegment(1001) == first);
+        Segment *last = rep->getMediaSegment(1000 + windowSize);
+        Expect(last);
+        Expect(last->getDisplayTime() ==
+               first->getDisplayTime() + vlc_tick_from_sec(2 * (windowSize - 1)));
+        Expect(rep->getMediaSegment(1001 + windowSize) == nullptr);
+
+        delete m3u;
+    }
+    catch(...)
+    {
+        delete m3u;
+        return 1;
+    }
+
     return 0;
 }
@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * M3U8Bench.cpp: HLS live playlist refresh benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Times a full parse of a live DVR playlist against its refresh, when one
+ * segment entered and one left the window. Not run by "make check":
+ *   make -C modules adaptive_bench
+ *   ./modules/adaptive_bench [window hours]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../../hls/playlist/Parser.hpp"
+#include "../../../hls/playlist/M3U8.hpp"
+#include "../../../hls/playlist/HLSRepresentation.hpp"
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace hls::playlist;
+
+extern const char vlc_module_name[] = "foobar";
+
+#define RUNS 10
+
+/* Live window of count 2s segments, starting at sequence number first >= 1000 */
+static std::string LiveM3U8(uint64_t first, uint64_t count)
+{
+    const unsigned offset = 2 * (first - 1000);
+    char datetime[32];
+    snprintf(datetime, sizeof(datetime), "2026-01-01T%02u:%02u:%02u.000Z",
+             offset / 3600, (offset / 60) % 60, offset % 60);
+
+    std::ostringstream ss;
+    ss << "#EXTM3U\n"
+          "#EXT-X-TARGETDURATION:2\n"
+          "#EXT-X-MEDIA-SEQUENCE:" << first << "\n"
+          "#EXT-X-PROGRAM-DATE-TIME:" << datetime << "\n";
+    for(uint64_t i = first; i < first + count; i++)
+        ss << "#EXTINF:2.000,\n" << "segment" << i << ".ts\n";
+    return ss.str();
+}
+
+static M3U8 * ParseM3U8(vlc_object_t *obj, const std::string &manifest)
+{
+    M3U8Parser parser(nullptr);
+    stream_t *substream = vlc_stream_MemoryNew(obj, (uint8_t *) manifest.c_str(),
+                                               manifest.size(), true);
+    if(!substream)
+        return nullptr;
+    M3U8 *m3u = parser.parse(obj, substream, std::string("stdin://"));
+    vlc_stream_Delete(substream);
+    return m3u;
+}
+
+static bool UpdateM3U8(vlc_object_t *obj, BaseRepresentation *rep,
+                       const std::string &manifest)
+{
+    M3U8Parser parser(nullptr);
+    stream_t *substream = vlc_stream_MemoryNew(obj, (uint8_t *) manifest.c_str(),
+                                               manifest.size(), true);
+    if(!substream)
+        return false;
+    parser.appendSegmentsFromStream(obj, substream, static_cast<HLSRepresentation *>(rep));
+    vlc_stream_Delete(substream);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    vlc_object_t *obj = static_cast<vlc_object_t*>(nullptr);
+    const unsigned hours = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 6;
+    const uint64_t windowSize = hours * 3600 / 2;
+    if(windowSize == 0)
+        return 1;
+
+    vlc_tick_t fullParseTime = 0, updateTime = 0;
+    size_t manifestSize = 0;
+    for(unsigned i = 0; i < RUNS; i++)
+    {
+        const std::string manifest = LiveM3U8(1000 + i, windowSize);
+        const std::string next = LiveM3U8(1001 + i, windowSize);
+        manifestSize = manifest.size();
+
+        vlc_tick_t start = vlc_tick_now();
+        M3U8 *m3u = ParseM3U8(obj, manifest);
+        fullParseTime += vlc_tick_now() - start;
+        if(!m3u)
+            return 1;
+
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        start = vlc_tick_now();
+        bool b_updated = UpdateM3U8(obj, rep, next);
+        updateTime += vlc_tick_now() - start;
+        delete m3u;
+        if(!b_updated)
+            return 1;
+    }
+
+    std::cout << windowSize << " segments, " << manifestSize / 1024
+              << " KiB playlist: parsed in "
+              << (double) fullParseTime / VLC_TICK_FROM_MS(RUNS)
+              << " ms, refreshed in "
+              << (double) updateTime / VLC_TICK_FROM_MS(RUNS) << " ms" << std::endl;
+    return 0;
+}
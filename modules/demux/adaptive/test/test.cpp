@@ -45,7 +45,9 @@ int main()
     TEST(Conversions) ||
     TEST(TemplatedUri) ||
     TEST(BufferingLogic) ||
+    TEST(LowLatencyLogic) ||
     TEST(CommandsQueue) ||
     TEST(M3U8MasterPlaylist) ||
-    TEST(M3U8Playlist);
+    TEST(M3U8Playlist) ||
+    TEST(M3U8Update);
 }
@@ -45,7 +45,9 @@ int Timeline_test();
 int Conversions_test();
 int M3U8MasterPlaylist_test();
 int M3U8Playlist_test();
+int M3U8Update_test();
 int CommandsQueue_test();
 int BufferingLogic_test();
+int LowLatencyLogic_test();
 
 #endif
@@ -26,6 +26,8 @@
 #endif
 
 #include "Helper.h"
+#include <vlc_common.h>
+#include <vlc_hash.h>
 #include <algorithm>
 using namespace adaptive;
 
@@ -100,3 +102,13 @@ std::list<std::string> Helper::tokenize(const std::string &str, char c)
     ret.push_back(str.substr(prev));
     return ret;
 }
+
+std::string Helper::digest(const void *data, size_t size)
+{
+    char out[VLC_HASH_MD5_DIGEST_SIZE];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, data, size);
+    vlc_hash_md5_Finish(&md5, out, sizeof(out));
+    return std::string(out, sizeof(out));
+}
@@ -39,6 +39,7 @@ namespace adaptive
             static bool        icaseEquals     (std::string str1, std::string str2);
             static bool        ifind            (std::string haystack, std::string needle);
             static std::list<std::string> tokenize(const std::string &, char);
+            static std::string digest          (const void *, size_t);
     };
 }
 
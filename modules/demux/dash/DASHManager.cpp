@@ -98,6 +98,14 @@ bool DASHManager::updatePlaylist()
         if(!p_block)
             return false;
 
+        /* Unchanged MPD, nothing to merge */
+        std::string digest = Helper::digest(p_block->p_buffer, p_block->i_buffer);
+        if(digest == playlistDigest)
+        {
+            block_Release(p_block);
+            return true;
+        }
+
         stream_t *mpdstream = vlc_stream_MemoryNew(p_demux, p_block->p_buffer, p_block->i_buffer, true);
         if(!mpdstream)
         {
@@ -120,6 +128,7 @@ bool DASHManager::updatePlaylist()
         {
             playlist->updateWith(newmpd);
             delete newmpd;
+            playlistDigest = digest;
         }
         vlc_stream_Delete(mpdstream);
         block_Release(p_block);
@@ -59,6 +59,9 @@ namespace dash
 
         protected:
             virtual int doControl(int, va_list) override;
+
+        private:
+            std::string playlistDigest; /* of the last merged MPD */
     };
 
 }
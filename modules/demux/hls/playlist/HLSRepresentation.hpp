@@ -62,6 +62,7 @@ namespace hls
                 vlc_tick_t lastUpdateTime;
                 time_t targetDuration;
                 Url playlistUrl;
+                std::string playlistDigest; /* of the last loaded media playlist */
         };
     }
 }
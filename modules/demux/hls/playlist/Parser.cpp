@@ -165,15 +165,17 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresent
     block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
     if(p_block)
     {
-        stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
-        if(substream)
+        /* Live playlists are often refreshed before any segment got added */
+        std::string digest = Helper::digest(p_block->p_buffer, p_block->i_buffer);
+        if(!rep->b_loaded || digest != rep->playlistDigest)
         {
-            std::list<Tag *> tagslist = parseEntries(substream);
-            vlc_stream_Delete(substream);
-
-            parseSegments(p_obj, rep, tagslist);
-
-            releaseTagsList(tagslist);
+            stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
+            if(substream)
+            {
+                appendSegmentsFromStream(p_obj, substream, rep);
+                vlc_stream_Delete(substream);
+                rep->playlistDigest = digest;
+            }
         }
         block_Release(p_block);
         return true;
@@ -181,6 +183,14 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresent
     return false;
 }
 
+void M3U8Parser::appendSegmentsFromStream(vlc_object_t *p_obj, stream_t *p_stream,
+                                          HLSRepresentation *rep)
+{
+    std::list<Tag *> tagslist = parseEntries(p_stream);
+    parseSegments(p_obj, rep, tagslist);
+    releaseTagsList(tagslist);
+}
+
 static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
                             CommonEncryption &encryption)
 {
@@ -220,6 +230,13 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
 {
     SegmentList *segmentList = new (std::nothrow) SegmentList(rep);
 
+    /* On refresh, segments up to the last known one would be discarded
+     * by the merge: skip their creation and only add the new ones */
+    uint64_t lastKnownNumber = std::numeric_limits<uint64_t>::max();
+    const SegmentList *currentList = rep->inheritSegmentList();
+    if(rep->b_loaded && currentList && !currentList->getSegments().empty())
+        lastKnownNumber = currentList->getSegments().back()->getSequenceNumber();
+
     Timescale timescale(1000000);
     rep->addAttribute(new TimescaleAttr(timescale));
     rep->b_loaded = true;
@@ -246,6 +263,7 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             case SingleValueTag::EXTXMEDIASEQUENCE:
             {
                 sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
+                segmentList->setWindowStartNumber(sequenceNumber);
             }
             break;
 
@@ -265,12 +283,6 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
-
-                segment->setSourceUrl(uritag->getValue().value);
-
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
                 vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
                 if(ctx_extinf)
@@ -280,6 +292,33 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                         nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
                     ctx_extinf = nullptr;
                 }
+
+                if(lastKnownNumber != std::numeric_limits<uint64_t>::max() &&
+                   sequenceNumber <= lastKnownNumber)
+                {
+                    /* already known, only keep track of time and offsets */
+                    sequenceNumber++;
+                    nzStartTime += nzDuration;
+                    totalduration += nzDuration;
+                    if(absReferenceTime != VLC_TICK_INVALID)
+                        absReferenceTime += nzDuration;
+                    if(ctx_byterange)
+                    {
+                        std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
+                        if(range.first == 0)
+                            range.first = prevbyterangeoffset;
+                        prevbyterangeoffset = range.first + range.second;
+                        ctx_byterange = nullptr;
+                    }
+                    discontinuity = false;
+                    break;
+                }
+
+                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+                if(!segment)
+                    break;
+
+                segment->setSourceUrl(uritag->getValue().value);
                 segment->duration.Set(timescale.ToScaled(nzDuration));
                 segment->startTime.Set(timescale.ToScaled(nzStartTime));
                 nzStartTime += nzDuration;
@@ -0,0 +1,274 @@
+/*****************************************************************************
+ * cluster_index.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "cluster_index.hpp"
+
+#include <vlc_fs.h>
+#include <vlc_stream.h>
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#define MKV_ID_CLUSTER   0x1F43B675
+#define MKV_ID_TIMECODE  0xE7
+#define MKV_ID_CRC32     0xBF
+#define MKV_ID_VOID      0xEC
+
+namespace mkv {
+
+ClusterIndexer::ClusterIndexer( demux_t & demuxer, uint64_t i_timescale,
+                                fptr_t i_first_cluster, fptr_t i_segment_end,
+                                const EbmlBinary *p_segment_uid )
+    :demuxer( demuxer )
+    ,i_timescale( i_timescale )
+    ,i_first_cluster( i_first_cluster )
+    ,i_segment_end( i_segment_end )
+    ,p_stream( NULL )
+    ,b_running( false )
+    ,b_abort( false )
+    ,b_modified( false )
+    ,i_flushed( 0 )
+    ,i_resume_pos( i_first_cluster )
+{
+    memset( segment_uid, 0, sizeof(segment_uid) );
+    if( p_segment_uid )
+        memcpy( segment_uid, p_segment_uid->GetBuffer(),
+                std::min<size_t>( p_segment_uid->GetSize(), sizeof(segment_uid) ) );
+    vlc_mutex_init( &lock );
+}
+
+ClusterIndexer::~ClusterIndexer()
+{
+    if( b_running )
+    {
+        vlc_mutex_lock( &lock );
+        b_abort = true;
+        vlc_mutex_unlock( &lock );
+
+        vlc_join( thread, NULL );
+    }
+    if( p_stream )
+        vlc_stream_Delete( p_stream );
+
+    if( b_modified && !path.empty() )
+        Save();
+}
+
+void ClusterIndexer::Load( const char *psz_path )
+{
+    path = psz_path;
+
+    FILE *p_file = vlc_fopen( psz_path, "rb" );
+    if( !p_file )
+        return;
+
+    int64_t i_size = stream_Size( demuxer.s );
+    ClusterIndexFile index;
+    bool b_valid = i_size > 0 && index.Read( p_file, i_size ) &&
+        !memcmp( index.segment_uid, segment_uid, sizeof(segment_uid) ) &&
+        index.i_first_cluster == i_first_cluster &&
+        index.i_timescale == i_timescale;
+    fclose( p_file );
+
+    if( !b_valid )
+    {
+        msg_Warn( &demuxer, "ignoring invalid cluster index %s", psz_path );
+        return;
+    }
+
+    entries.swap( index.entries );
+    i_resume_pos = index.i_resume_pos;
+    /* the file grew since, carry on after the last cluster */
+    if( index.i_file_size != (uint64_t) i_size && !entries.empty() )
+        i_resume_pos = entries.back().fpos + entries.back().size;
+    msg_Dbg( &demuxer, "using cluster index %s (%zu clusters)",
+             psz_path, entries.size() );
+}
+
+void ClusterIndexer::Save()
+{
+    int64_t i_size = stream_Size( demuxer.s );
+    if( i_size <= 0 )
+        return;
+
+    FILE *p_file = vlc_fopen( path.c_str(), "wb" );
+    if( !p_file )
+    {
+        msg_Dbg( &demuxer, "cannot write cluster index %s: %s",
+                 path.c_str(), vlc_strerror_c(errno) );
+        return;
+    }
+
+    ClusterIndexFile index;
+    index.i_file_size = i_size;
+    memcpy( index.segment_uid, segment_uid, sizeof(segment_uid) );
+    index.i_first_cluster = i_first_cluster;
+    index.i_timescale = i_timescale;
+    index.i_resume_pos = i_resume_pos;
+    index.entries = entries;
+    bool b_error = !index.Write( p_file );
+
+    if( fclose( p_file ) || b_error )
+    {
+        msg_Warn( &demuxer, "cannot write cluster index %s", path.c_str() );
+        vlc_unlink( path.c_str() );
+    }
+}
+
+bool ClusterIndexer::Start( const char *psz_url )
+{
+    if( i_resume_pos >= i_segment_end )
+        return false;
+
+    p_stream = vlc_stream_NewURL( &demuxer, psz_url );
+    if( !p_stream )
+        return false;
+
+    if( vlc_clone( &thread, Run, this, VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_stream_Delete( p_stream );
+        p_stream = NULL;
+        return false;
+    }
+    b_running = true;
+    return true;
+}
+
+void ClusterIndexer::Flush( SegmentSeeker & seeker )
+{
+    std::vector<Entry> found;
+    {
+        vlc_mutex_locker guard( &lock );
+        found.assign( entries.begin() + i_flushed, entries.end() );
+        i_flushed = entries.size();
+    }
+
+    for( std::vector<Entry>::const_iterator it = found.begin(); it != found.end(); ++it )
+    {
+        SegmentSeeker::Cluster cinfo = {
+            /* fpos     */ it->fpos,
+            /* pts      */ it->pts,
+            /* duration */ vlc_tick_t( -1 ),
+            /* size     */ it->size
+        };
+        seeker.add_cluster( cinfo );
+    }
+}
+
+/* Reads the level 1 element at i_pos, and the timecode of clusters */
+ClusterIndexer::ReadStatus
+ClusterIndexer::ReadElement( fptr_t i_pos, Entry & entry, fptr_t & i_next )
+{
+    /* ID, size, optional CRC-32 and timecode of a cluster */
+    uint8_t buf[32];
+
+    if( vlc_stream_Seek( p_stream, i_pos ) )
+        return END;
+    ssize_t i_read = vlc_stream_Read( p_stream, buf, sizeof(buf) );
+    if( i_read <= 0 )
+        return END;
+
+    uint64_t i_id, i_size;
+    bool b_unknown;
+    size_t i_id_len = ReadVint( buf, i_read, i_id, true );
+    size_t i_size_len = i_id_len ? ReadVint( &buf[i_id_len], i_read - i_id_len,
+                                             i_size, false, &b_unknown ) : 0;
+    /* the end of an unknown sized element can't be found from its header */
+    if( i_size_len == 0 || b_unknown )
+        return END;
+
+    size_t i_header = i_id_len + i_size_len;
+    i_next = i_pos + i_header + i_size;
+    if( i_id != MKV_ID_CLUSTER )
+        return SKIPPED;
+
+    for( size_t i_off = i_header; i_off < (size_t) i_read; )
+    {
+        uint64_t i_child_id, i_child_size;
+        size_t i_len = ReadVint( &buf[i_off], i_read - i_off, i_child_id, true );
+        size_t i_len2 = i_len ? ReadVint( &buf[i_off + i_len], i_read - i_off - i_len,
+                                          i_child_size, false, &b_unknown ) : 0;
+        if( i_len2 == 0 || b_unknown )
+            break;
+        i_off += i_len + i_len2;
+
+        if( i_child_id == MKV_ID_TIMECODE )
+        {
+            if( i_child_size > 8 || i_off + i_child_size > (size_t) i_read )
+                break;
+
+            uint64_t i_timecode = 0;
+            for( size_t i = 0; i < i_child_size; i++ )
+                i_timecode = ( i_timecode << 8 ) | buf[i_off + i];
+
+            entry.fpos = i_pos;
+            entry.size = i_header + i_size;
+            entry.pts  = VLC_TICK_FROM_NS( i_timecode * i_timescale );
+            return CLUSTER;
+        }
+        if( i_child_id != MKV_ID_CRC32 && i_child_id != MKV_ID_VOID )
+            break;
+        i_off += i_child_size;
+    }
+
+    msg_Dbg( &demuxer, "no timecode at the start of the cluster at %" PRIu64, i_pos );
+    return SKIPPED;
+}
+
+void ClusterIndexer::Run()
+{
+    fptr_t i_pos;
+    {
+        vlc_mutex_locker guard( &lock );
+        i_pos = i_resume_pos;
+    }
+
+    while( i_pos < i_segment_end )
+    {
+        Entry  entry;
+        fptr_t i_next = std::numeric_limits<fptr_t>::max();
+
+        ReadStatus status = ReadElement( i_pos, entry, i_next );
+
+        vlc_mutex_locker guard( &lock );
+        if( b_abort )
+            break;
+        if( status == CLUSTER &&
+            ( entries.empty() || entries.back().fpos < entry.fpos ) )
+            entries.push_back( entry );
+
+        /* done with the segment, or nothing more can be found */
+        i_resume_pos = status == END ? std::numeric_limits<fptr_t>::max() : i_next;
+        b_modified = true;
+        i_pos = i_resume_pos;
+    }
+
+    msg_Dbg( &demuxer, "cluster index stopped at %" PRIu64 " with %zu clusters",
+             i_pos, entries.size() );
+}
+
+void *ClusterIndexer::Run( void *data )
+{
+    static_cast<ClusterIndexer*>( data )->Run();
+    return NULL;
+}
+
+} // namespace
@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * cluster_index.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_CLUSTER_INDEX_HPP_
+#define MKV_CLUSTER_INDEX_HPP_
+
+#include "mkv.hpp"
+#include "matroska_segment_seeker.hpp"
+#include "cluster_index_file.hpp"
+
+#include <vlc_threads.h>
+
+#include <string>
+#include <vector>
+
+namespace mkv {
+
+/* Finds the position and timecode of the clusters of a segment by reading
+ * only their headers, on a stream of its own so that it can run while the
+ * segment plays. Meant for segments without Cues. */
+class ClusterIndexer
+{
+    public:
+        typedef SegmentSeeker::fptr_t fptr_t;
+
+        ClusterIndexer( demux_t &, uint64_t i_timescale, fptr_t i_first_cluster,
+                        fptr_t i_segment_end, const EbmlBinary *p_segment_uid );
+        ~ClusterIndexer();
+
+        /* Reuses the clusters stored in psz_path if it was made for this
+         * segment, and saves them there on destruction if they changed */
+        void Load( const char *psz_path );
+
+        /* Reads the cluster headers from where the index stops, unless it
+         * is already complete. Returns false if nothing remains to be done */
+        bool Start( const char *psz_url );
+
+        /* Hands over the clusters found since the previous call */
+        void Flush( SegmentSeeker & );
+
+    private:
+        typedef ClusterIndexFile::Entry Entry;
+
+        enum ReadStatus { CLUSTER, SKIPPED, END };
+
+        ReadStatus ReadElement( fptr_t i_pos, Entry &, fptr_t &i_next );
+        void Run();
+        static void *Run( void * );
+        void Save();
+
+        demux_t          & demuxer;
+        const uint64_t   i_timescale;
+        const fptr_t     i_first_cluster;
+        const fptr_t     i_segment_end;
+        uint8_t          segment_uid[16];
+
+        std::string      path;
+        stream_t         *p_stream;
+
+        vlc_thread_t     thread;
+        vlc_mutex_t      lock;
+        bool             b_running;
+        bool             b_abort;
+        bool             b_modified;
+
+        std::vector<Entry> entries; /* sorted by position */
+        size_t           i_flushed;
+        fptr_t           i_resume_pos; /* max once complete */
+};
+
+} // namespace
+
+#endif /* include-guard */
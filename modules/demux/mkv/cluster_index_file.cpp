@@ -0,0 +1,118 @@
+/*****************************************************************************
+ * cluster_index_file.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "cluster_index_file.hpp"
+
+#include <cstring>
+
+#define MKV_INDEX_MAGIC "VLCMKIX1"
+
+namespace mkv {
+
+size_t ReadVint( const uint8_t *p, size_t i_size, uint64_t &i_value,
+                 bool b_id, bool *pb_unknown )
+{
+    if( i_size == 0 || p[0] == 0 )
+        return 0;
+
+    size_t i_len = 1;
+    while( !( p[0] & ( 0x80 >> ( i_len - 1 ) ) ) )
+        i_len++;
+    if( i_len > i_size || ( b_id && i_len > 4 ) )
+        return 0;
+
+    uint64_t i_mask = ( UINT64_C(1) << ( 7 * i_len ) ) - 1;
+    i_value = b_id ? p[0] : p[0] & ( 0xFF >> i_len );
+    for( size_t i = 1; i < i_len; i++ )
+        i_value = ( i_value << 8 ) | p[i];
+
+    if( pb_unknown )
+        *pb_unknown = !b_id && i_value == i_mask;
+    return i_len;
+}
+
+/* Layout, big endian:
+ * magic[8] file_size[8] segment_uid[16] first_cluster[8] timescale[8]
+ * resume_pos[8] entry_count[4]
+ * then for each cluster: pos[8] size[8] pts[8] */
+bool ClusterIndexFile::Read( FILE *p_file, uint64_t i_max_size )
+{
+    uint8_t header[60];
+    if( fread( header, 1, sizeof(header), p_file ) != sizeof(header) ||
+        memcmp( header, MKV_INDEX_MAGIC, 8 ) ||
+        GetQWBE( &header[8] ) > i_max_size )
+        return false;
+
+    i_file_size = GetQWBE( &header[8] );
+    memcpy( segment_uid, &header[16], sizeof(segment_uid) );
+    i_first_cluster = GetQWBE( &header[32] );
+    i_timescale = GetQWBE( &header[40] );
+    i_resume_pos = GetQWBE( &header[48] );
+
+    std::vector<Entry> loaded;
+    uint32_t i_count = GetDWBE( &header[56] );
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        uint8_t data[24];
+        if( fread( data, 1, sizeof(data), p_file ) != sizeof(data) )
+            return false;
+
+        Entry entry = { GetQWBE( data ), GetQWBE( &data[8] ),
+                        (vlc_tick_t) GetQWBE( &data[16] ) };
+        if( entry.fpos < i_first_cluster || entry.fpos >= i_file_size ||
+            ( !loaded.empty() && entry.fpos <= loaded.back().fpos ) )
+            return false;
+        loaded.push_back( entry );
+    }
+
+    entries.swap( loaded );
+    return true;
+}
+
+bool ClusterIndexFile::Write( FILE *p_file ) const
+{
+    uint8_t header[60];
+    memcpy( header, MKV_INDEX_MAGIC, 8 );
+    SetQWBE( &header[8], i_file_size );
+    memcpy( &header[16], segment_uid, sizeof(segment_uid) );
+    SetQWBE( &header[32], i_first_cluster );
+    SetQWBE( &header[40], i_timescale );
+    SetQWBE( &header[48], i_resume_pos );
+    SetDWBE( &header[56], entries.size() );
+    if( fwrite( header, 1, sizeof(header), p_file ) != sizeof(header) )
+        return false;
+
+    for( size_t i = 0; i < entries.size(); i++ )
+    {
+        uint8_t data[24];
+        SetQWBE( data, entries[i].fpos );
+        SetQWBE( &data[8], entries[i].size );
+        SetQWBE( &data[16], entries[i].pts );
+        if( fwrite( data, 1, sizeof(data), p_file ) != sizeof(data) )
+            return false;
+    }
+    return true;
+}
+
+} // namespace
@@ -0,0 +1,61 @@
+/*****************************************************************************
+ * cluster_index_file.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_CLUSTER_INDEX_FILE_HPP_
+#define MKV_CLUSTER_INDEX_FILE_HPP_
+
+#include <vlc_common.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace mkv {
+
+/* EBML variable size integer, the length marker is kept for IDs.
+ * Returns the number of bytes used, 0 if invalid or truncated */
+size_t ReadVint( const uint8_t *p, size_t i_size, uint64_t &i_value,
+                 bool b_id, bool *pb_unknown = NULL );
+
+/* Cluster positions of a segment, as saved next to the file */
+struct ClusterIndexFile
+{
+    struct Entry
+    {
+        uint64_t   fpos;
+        uint64_t   size;
+        vlc_tick_t pts;
+    };
+
+    uint64_t i_file_size;
+    uint8_t  segment_uid[16];
+    uint64_t i_first_cluster;
+    uint64_t i_timescale;
+    uint64_t i_resume_pos;
+    std::vector<Entry> entries; /* sorted by position */
+
+    /* Fails if the index is malformed, or made for a file larger than
+     * i_file_size. Matching the segment is left to the caller */
+    bool Read( FILE *, uint64_t i_file_size );
+    bool Write( FILE * ) const;
+};
+
+} // namespace
+
+#endif /* include-guard */
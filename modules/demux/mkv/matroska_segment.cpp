@@ -27,6 +27,9 @@
 #include "util.hpp"
 #include "Ebml_parser.hpp"
 #include "Ebml_dispatcher.hpp"
+#include "cluster_index.hpp"
+
+#include <vlc_url.h>
 
 #include <new>
 #include <iterator>
@@ -53,6 +56,7 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,p_prev_segment_uid(NULL)
     ,p_next_segment_uid(NULL)
     ,b_cues(false)
+    ,p_indexer(NULL)
     ,psz_muxing_application(NULL)
     ,psz_writing_application(NULL)
     ,psz_segment_filename(NULL)
@@ -68,6 +72,8 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
 
 matroska_segment_c::~matroska_segment_c()
 {
+    delete p_indexer;
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -518,6 +524,39 @@ bool matroska_segment_c::PreloadClusters(uint64 i_cluster_pos)
     return true;
 }
 
+void matroska_segment_c::IndexClusters( bool b_index_file )
+{
+    if( b_cues || cluster == NULL || p_indexer != NULL )
+        return;
+
+    SegmentSeeker::fptr_t i_end = segment->IsFiniteSize()
+        ? segment->GetEndPosition()
+        : std::numeric_limits<SegmentSeeker::fptr_t>::max();
+
+    p_indexer = new (std::nothrow) ClusterIndexer( sys.demuxer, i_timescale,
+                                                   cluster->GetElementPosition(),
+                                                   i_end, p_segment_uid );
+    if( p_indexer == NULL )
+        return;
+
+    if( b_index_file )
+    {
+        char *psz_path = vlc_uri2path( sys.demuxer.psz_url );
+        if( psz_path )
+        {
+            std::string index_path = std::string( psz_path ) + ".mkvidx";
+            p_indexer->Load( index_path.c_str() );
+            free( psz_path );
+        }
+    }
+
+    /* clusters from the index file are usable right away */
+    p_indexer->Flush( _seeker );
+
+    if( sys.b_fastseekable && p_indexer->Start( sys.demuxer.psz_url ) )
+        msg_Dbg( &sys.demuxer, "indexing clusters in the background" );
+}
+
 bool matroska_segment_c::PreloadFamily( const matroska_segment_c & of_segment )
 {
     if ( b_preloaded )
@@ -838,6 +877,9 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    if( p_indexer )
+        p_indexer->Flush( _seeker );
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
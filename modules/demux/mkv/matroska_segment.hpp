@@ -45,6 +45,7 @@ class chapter_translation_c;
 class chapter_item_c;
 
 class mkv_track_t;
+class ClusterIndexer;
 
 typedef enum
 {
@@ -116,6 +117,7 @@ public:
     KaxNextUID              *p_next_segment_uid;
 
     bool                    b_cues;
+    ClusterIndexer          *p_indexer;
 
     /* info */
     char                    *psz_muxing_application;
@@ -142,6 +144,7 @@ public:
     bool Preload();
     bool PreloadFamily( const matroska_segment_c & segment );
     bool PreloadClusters( uint64 i_cluster_position );
+    void IndexClusters( bool b_index_file );
     void InformationCreate();
 
     bool Seek( demux_t &, vlc_tick_t i_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate );
@@ -81,6 +81,14 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") );
 
+    add_bool( "mkv-index-clusters", false,
+            N_("Index clusters in the background"),
+            N_("Find the cluster positions of files without cues in the background during playback, so that seeking does not have to read the file up to the requested time.") );
+
+    add_bool( "mkv-index-file", false,
+            N_("Store the cluster index"),
+            N_("Save the cluster index of local files without cues next to them (.mkvidx), and reuse it when the file is opened again.") );
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -164,6 +172,16 @@ static int OpenInternal( demux_t *p_demux, bool trust_cues )
         goto error;
     }
 
+    if( p_sys->b_seekable && !p_demux->b_preparsing &&
+        var_InheritBool( p_demux, "mkv-index-clusters" ) )
+    {
+        /* the index file only describes files holding a single segment */
+        bool b_index_file = p_stream->segments.size() == 1 &&
+                            var_InheritBool( p_demux, "mkv-index-file" );
+        for (size_t i=0; i<p_stream->segments.size(); i++)
+            p_stream->segments[i]->IndexClusters( b_index_file );
+    }
+
     if (b_need_preload && var_InheritBool( p_demux, "mkv-preload-local-dir" ))
     {
         msg_Dbg( p_demux, "Preloading local dir" );
@@ -272,6 +272,23 @@ static void MP4_BoxAddChild( MP4_Box_t *p_parent, MP4_Box_t *p_childbox )
     p_childbox->p_father = p_parent;
 }
 
+static void MP4_BoxRemoveChild( MP4_Box_t *p_parent, MP4_Box_t *p_childbox )
+{
+    MP4_Box_t *p_prev = NULL;
+    for( MP4_Box_t **pp = &p_parent->p_first; *pp; pp = &(*pp)->p_next )
+    {
+        if( *pp == p_childbox )
+        {
+            *pp = p_childbox->p_next;
+            if( p_parent->p_last == p_childbox )
+                p_parent->p_last = p_prev;
+            p_childbox->p_next = NULL;
+            return;
+        }
+        p_prev = *pp;
+    }
+}
+
 MP4_Box_t * MP4_BoxExtract( MP4_Box_t **pp_chain, uint32_t i_type )
 {
     MP4_Box_t *p_box = *pp_chain;
@@ -362,6 +379,34 @@ static int MP4_PeekBoxHeader( stream_t *p_stream, MP4_Box_t *p_box )
     return 1;
 }
 
+/* Sample tables can be read once their track is used */
+static bool MP4_BoxIsDeferred( const MP4_Box_t *p_box, const MP4_Box_t *p_father )
+{
+    if( !p_father || p_father->i_type != ATOM_stbl )
+        return false;
+
+    switch( p_box->i_type )
+    {
+        case ATOM_stts:
+        case ATOM_ctts:
+        case ATOM_stsz:
+        case ATOM_stz2:
+        case ATOM_stsc:
+        case ATOM_stco:
+        case ATOM_co64:
+        case ATOM_stss:
+        case ATOM_sbgp:
+        case ATOM_sdtp:
+            break;
+        default:
+            return false;
+    }
+
+    while( p_father->p_father )
+        p_father = p_father->p_father;
+    return p_father->e_flags & BOX_FLAG_DEFER_TABLES;
+}
+
 /*****************************************************************************
  * MP4_ReadBoxRestricted : Reads box from current position
  *****************************************************************************
@@ -413,7 +458,12 @@ static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father
 
     const uint64_t i_next = p_box->i_pos + p_box->i_size;
     p_box->p_father = p_father;
-    if( MP4_Box_Read_Specific( p_stream, p_box, p_father ) != VLC_SUCCESS )
+    if( MP4_BoxIsDeferred( p_box, p_father ) )
+    {
+        /* Only skip it, see MP4_ReadBoxDeferred */
+        p_box->e_flags |= BOX_FLAG_DEFERRED;
+    }
+    else if( MP4_Box_Read_Specific( p_stream, p_box, p_father ) != VLC_SUCCESS )
     {
         msg_Warn( p_stream, "Failed reading box %4.4s", (char*) &peekbox.i_type );
         MP4_BoxFree( p_box );
@@ -5317,6 +5367,49 @@ static MP4_Box_t *MP4_ReadBox( stream_t *p_stream, MP4_Box_t *p_father )
     return p_box;
 }
 
+bool MP4_BoxGetDeferredRange( const MP4_Box_t *p_container,
+                              uint64_t *pi_start, uint64_t *pi_end )
+{
+    bool b_found = false;
+
+    for( const MP4_Box_t *p_box = p_container->p_first; p_box; p_box = p_box->p_next )
+    {
+        if( !(p_box->e_flags & BOX_FLAG_DEFERRED) )
+            continue;
+        if( !b_found || p_box->i_pos < *pi_start )
+            *pi_start = p_box->i_pos;
+        if( !b_found || p_box->i_pos + p_box->i_size > *pi_end )
+            *pi_end = p_box->i_pos + p_box->i_size;
+        b_found = true;
+    }
+    return b_found;
+}
+
+int MP4_ReadBoxDeferred( stream_t *p_stream, MP4_Box_t *p_container,
+                         uint64_t i_base )
+{
+    int i_ret = VLC_SUCCESS;
+
+    for( MP4_Box_t *p_box = p_container->p_first, *p_next; p_box; p_box = p_next )
+    {
+        p_next = p_box->p_next;
+        if( !(p_box->e_flags & BOX_FLAG_DEFERRED) )
+            continue;
+
+        p_box->e_flags &= ~BOX_FLAG_DEFERRED;
+        if( p_box->i_pos < i_base ||
+            MP4_Seek( p_stream, p_box->i_pos - i_base ) ||
+            MP4_Box_Read_Specific( p_stream, p_box, p_container ) != VLC_SUCCESS )
+        {
+            msg_Warn( p_stream, "Failed reading box %4.4s", (char*) &p_box->i_type );
+            MP4_BoxRemoveChild( p_container, p_box );
+            MP4_BoxFree( p_box );
+            i_ret = VLC_EGENERIC;
+        }
+    }
+    return i_ret;
+}
+
 /*****************************************************************************
  * MP4_BoxNew : creates and initializes an arbitrary box
  *****************************************************************************/
@@ -5392,7 +5485,7 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t *s )
  *  The first box is a virtual box "root" and is the father for all first
  *  level boxes for the file, a sort of virtual container
  *****************************************************************************/
-MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
+MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream, bool b_defer_tables )
 {
     int i_result;
 
@@ -5401,6 +5494,8 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
         return NULL;
 
     p_vroot->i_shortsize = 1;
+    if( b_defer_tables )
+        p_vroot->e_flags |= BOX_FLAG_DEFER_TABLES;
     uint64_t i_size;
     if( vlc_stream_GetSize( p_stream, &i_size ) == 0 )
         p_vroot->i_size = i_size;
@@ -1843,7 +1843,9 @@ struct MP4_Box_s
     enum
     {
         BOX_FLAG_NONE = 0,
-        BOX_FLAG_INCOMPLETE,
+        BOX_FLAG_INCOMPLETE = 1 << 0,
+        BOX_FLAG_DEFERRED = 1 << 1,     /* payload not read yet */
+        BOX_FLAG_DEFER_TABLES = 1 << 2, /* root: defer the sample tables */
     }            e_flags;
 
     UUID_t       i_uuid;  /* Set if i_type == "uuid" */
@@ -1907,9 +1909,28 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t * );
  * MP4_BoxGetRoot : Parse the entire file, and create all boxes in memory
  *****************************************************************************
  *  The first box is a virtual box "root" and is the father for all first
- *  level boxes
+ *  level boxes.
+ *  If b_defer_tables is set, the sample tables boxes of the tracks are only
+ *  located, and flagged BOX_FLAG_DEFERRED until read with MP4_ReadBoxDeferred
  *****************************************************************************/
-MP4_Box_t *MP4_BoxGetRoot( stream_t * );
+MP4_Box_t *MP4_BoxGetRoot( stream_t *, bool b_defer_tables );
+
+/*****************************************************************************
+ * MP4_BoxGetDeferredRange : file range covering the deferred children
+ *****************************************************************************
+ *  returns false if p_container has no deferred children
+ *****************************************************************************/
+bool MP4_BoxGetDeferredRange( const MP4_Box_t *p_container,
+                              uint64_t *pi_start, uint64_t *pi_end );
+
+/*****************************************************************************
+ * MP4_ReadBoxDeferred : read the deferred children of p_container
+ *****************************************************************************
+ *  p_stream data starts at file position i_base. Children failing to load
+ *  are discarded. Boxes of different containers can be read concurrently.
+ *****************************************************************************/
+int MP4_ReadBoxDeferred( stream_t *p_stream, MP4_Box_t *p_container,
+                         uint64_t i_base );
 
 /*****************************************************************************
  * MP4_BoxNew : Allocates a new MP4 Box with its atom type
@@ -55,6 +55,19 @@ static void Close( vlc_object_t * );
 
 #define MP4_ELST_TEXT       N_("Handle edit list")
 
+#define MP4_DEFER_TABLES_TEXT     N_("Defer sample tables loading")
+#define MP4_DEFER_TABLES_LONGTEXT N_("Skip the sample tables while " \
+    "opening the file, and only load those of a track once it is " \
+    "selected. Speeds up opening files with a large moov over slow storage.")
+
+#define MP4_SAMPLETABLE_TEXT     N_("Cache sample tables")
+#define MP4_SAMPLETABLE_LONGTEXT N_("Flatten the timestamps and positions " \
+    "of the samples of a track on its first seek, speeding up seeking and " \
+    "sample lookups in long files.")
+#define MP4_SAMPLETABLE_MAX_TEXT     N_("Sample tables cache size")
+#define MP4_SAMPLETABLE_MAX_LONGTEXT N_("Maximum memory used by the " \
+    "cached sample tables, in MiB.")
+
 #define HEIF_DURATION_TEXT N_("Duration in seconds")
 #define HEIF_DURATION_LONGTEXT N_( \
     "Duration in seconds before simulating an end of file. " \
@@ -72,6 +85,14 @@ vlc_module_begin ()
     add_file_extension("mov")
     add_file_extension("mp4")
 
+    add_bool( CFG_PREFIX"defer-tables", false, MP4_DEFER_TABLES_TEXT,
+              MP4_DEFER_TABLES_LONGTEXT )
+    add_bool( CFG_PREFIX"sample-table", false, MP4_SAMPLETABLE_TEXT,
+              MP4_SAMPLETABLE_LONGTEXT )
+    add_integer( CFG_PREFIX"sample-table-max", 64, MP4_SAMPLETABLE_MAX_TEXT,
+                 MP4_SAMPLETABLE_MAX_LONGTEXT )
+        change_integer_range( 1, 4096 )
+
     set_section("Hacks", NULL)
     add_bool( CFG_PREFIX"m4a-audioonly", false, MP4_M4A_TEXT, MP4_M4A_LONGTEXT )
     add_bool( CFG_PREFIX"editlist", true, MP4_ELST_TEXT, MP4_ELST_TEXT )
@@ -145,6 +166,12 @@ typedef struct
         int es_cat_filters;
     } hacks;
 
+    struct
+    {
+        bool     b_enabled;
+        uint64_t i_budget; /* bytes left for the flattened tables */
+    } sampletables;
+
     mp4_fragments_index_t *p_fragsindex;
 
     ssize_t i_attachments;
@@ -399,12 +426,25 @@ static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
 {
     if( i_sample >= p_track->i_sample_count )
         return NULL;
-    for( uint32_t i=0; i<p_track->i_chunk_count; i++ )
+
+    /* Last chunk starting at or before the sample, as chunks are in
+     * samples order. Empty chunks come before the one sharing their
+     * first sample. */
+    uint32_t i_low = 0, i_high = p_track->i_chunk_count;
+    while( i_low < i_high )
     {
-        if( i_sample >= p_track->chunk[i].i_sample_first &&
-            i_sample - p_track->chunk[i].i_sample_first < p_track->chunk[i].i_sample_count )
-            return &p_track->chunk[i];
+        uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_track->chunk[i_mid].i_sample_first <= i_sample )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
+
+    if( i_low == 0 )
+        return NULL;
+    const mp4_chunk_t *ck = &p_track->chunk[i_low - 1];
+    if( i_sample - ck->i_sample_first < ck->i_sample_count )
+        return ck;
     return NULL;
 }
 
@@ -448,6 +488,107 @@ static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
     return false;
 }
 
+/* Flattens the per chunk run length tables of the track into one entry
+ * per sample, so that lookups do not have to walk them */
+static void MP4_TrackCreateSampleTable( demux_t *p_demux, mp4_track_t *p_track )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_track->b_samples_probed )
+        return;
+    p_track->b_samples_probed = true;
+
+    /* Constant size samples are mostly raw audio: too many of them, and
+     * their position does not need walking the sample sizes */
+    if( !p_sys->sampletables.b_enabled || p_sys->b_fragmented ||
+        p_track->i_sample_size != 0 || p_track->i_sample_count == 0 )
+        return;
+
+    const uint64_t i_size = (uint64_t) p_track->i_sample_count * sizeof(mp4_sample_t);
+    if( i_size > p_sys->sampletables.i_budget )
+    {
+        msg_Dbg( p_demux, "track[Id 0x%x] sample table exceeds the cache size",
+                 p_track->i_track_ID );
+        return;
+    }
+
+    mp4_sample_t *p_samples = vlc_alloc( p_track->i_sample_count,
+                                         sizeof(*p_samples) );
+    if( unlikely(!p_samples) )
+        return;
+
+    uint32_t i_sample = 0;
+    for( uint32_t i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
+    {
+        const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+        if( ck->i_sample_first != i_sample ||
+            ck->i_sample_count > p_track->i_sample_count - i_sample )
+            goto error;
+
+        uint64_t i_offset = ck->i_offset;
+        stime_t i_dts = ck->i_first_dts;
+        uint32_t i_dts_index = 0, i_dts_used = 0;
+        uint32_t i_pts_index = 0, i_pts_used = 0;
+        const uint32_t i_pts_entries = ck->p_sample_offset_pts ? ck->i_entries_pts : 0;
+
+        for( uint32_t i = 0; i < ck->i_sample_count; i++, i_sample++ )
+        {
+            mp4_sample_t *p_entry = &p_samples[i_sample];
+
+            while( i_dts_index < ck->i_entries_dts &&
+                   i_dts_used == ck->p_sample_count_dts[i_dts_index] )
+            {
+                i_dts_index++;
+                i_dts_used = 0;
+            }
+            while( i_pts_index < i_pts_entries &&
+                   i_pts_used == ck->p_sample_count_pts[i_pts_index] )
+            {
+                i_pts_index++;
+                i_pts_used = 0;
+            }
+
+            p_entry->i_offset = i_offset;
+            p_entry->i_dts = i_dts;
+            p_entry->i_delta = ( i_pts_index < i_pts_entries )
+                             ? ck->p_sample_offset_pts[i_pts_index]
+                             : UNKNOWN_DELTA;
+            p_entry->b_sync = false;
+
+            i_offset += p_track->p_sample_size[i_sample];
+            if( i_dts_index < ck->i_entries_dts )
+            {
+                i_dts += ck->p_sample_delta_dts[i_dts_index];
+                i_dts_used++;
+            }
+            i_pts_used++;
+        }
+    }
+
+    if( i_sample != p_track->i_sample_count )
+        goto error;
+
+    const MP4_Box_t *p_stss = MP4_BoxGet( p_track->p_stbl, "stss" );
+    if( p_stss && BOXDATA(p_stss) )
+    {
+        const MP4_Box_data_stss_t *p_stss_data = BOXDATA(p_stss);
+        for( uint32_t i = 0; i < p_stss_data->i_entry_count; i++ )
+            if( p_stss_data->i_sample_number[i] < p_track->i_sample_count )
+                p_samples[p_stss_data->i_sample_number[i]].b_sync = true;
+    }
+
+    p_sys->sampletables.i_budget -= i_size;
+    p_track->p_samples = p_samples;
+    msg_Dbg( p_demux, "track[Id 0x%x] using a %"PRIu64" bytes sample table",
+             p_track->i_track_ID, i_size );
+    return;
+
+error:
+    msg_Warn( p_demux, "track[Id 0x%x] chunks do not match samples, "
+              "no sample table", p_track->i_track_ID );
+    free( p_samples );
+}
+
 static vlc_tick_t MP4_TrackGetDTSPTS( demux_t *p_demux, const mp4_track_t *p_track,
                                       vlc_tick_t *pi_nzpts )
 {
@@ -551,8 +692,12 @@ static int LoadInitFrag( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    /* Tables have to be read back later */
+    const bool b_defer = p_sys->b_seekable &&
+                         var_InheritBool( p_demux, CFG_PREFIX"defer-tables" );
+
     /* Load all boxes ( except raw data ) */
-    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s );
+    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s, b_defer );
     if( p_root == NULL || !MP4_BoxGet( p_root, "/moov" ) )
     {
         MP4_BoxFree( p_root );
@@ -568,6 +713,163 @@ LoadInitFragError:
     return VLC_EGENERIC;
 }
 
+typedef struct
+{
+    vlc_object_t *p_obj;
+    MP4_Box_t    *p_stbl;
+    uint8_t      *p_data;  /* deferred tables, from file position i_base */
+    uint64_t      i_base;
+    size_t        i_size;
+    vlc_thread_t  thread;
+    bool          b_thread;
+} mp4_tables_load_t;
+
+static void *LoadTablesThread( void *data )
+{
+    mp4_tables_load_t *p_load = data;
+
+    stream_t *s = vlc_stream_MemoryNew( p_load->p_obj, p_load->p_data,
+                                        p_load->i_size, true );
+    if( s )
+    {
+        MP4_ReadBoxDeferred( s, p_load->p_stbl, p_load->i_base );
+        vlc_stream_Delete( s );
+    }
+    free( p_load->p_data );
+    p_load->p_data = NULL;
+    return NULL;
+}
+
+/* Reads the range covering the deferred tables of p_load->p_stbl */
+static bool ReadDeferredTables( demux_t *p_demux, mp4_tables_load_t *p_load )
+{
+    uint64_t i_start, i_end;
+
+    if( !MP4_BoxGetDeferredRange( p_load->p_stbl, &i_start, &i_end ) ||
+        i_end - i_start > SIZE_MAX )
+        return false;
+
+    p_load->i_base = i_start;
+    p_load->i_size = i_end - i_start;
+    p_load->p_data = malloc( p_load->i_size );
+    if( !p_load->p_data )
+        return false;
+
+    if( vlc_stream_Seek( p_demux->s, p_load->i_base ) ||
+        vlc_stream_Read( p_demux->s, p_load->p_data, p_load->i_size )
+                         != (ssize_t) p_load->i_size )
+    {
+        free( p_load->p_data );
+        p_load->p_data = NULL;
+        return false;
+    }
+    return true;
+}
+
+/* Tables needed before any track selection: chapters and timecodes are read
+ * by the demuxer itself, and fragmented files are demuxed from the moov */
+static bool TrackNeedsTablesAtOpen( demux_t *p_demux, const mp4_track_t *p_track )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    return MP4_isMetadata( p_track ) ||
+           MP4_BoxGet( p_sys->p_moov, "mvex" ) != NULL;
+}
+
+/* Sample count of a track whose tables are not loaded yet, read from the
+ * stsz/stz2 header: the ES frame rate needs it before the selection */
+static uint32_t TrackPeekSampleCount( demux_t *p_demux, const mp4_track_t *p_track )
+{
+    MP4_Box_t *p_stsz = MP4_BoxGet( p_track->p_stbl, "stsz" );
+    if( !p_stsz )
+        p_stsz = MP4_BoxGet( p_track->p_stbl, "stz2" );
+    if( !p_stsz || !( p_stsz->e_flags & BOX_FLAG_DEFERRED ) )
+        return 0;
+
+    /* version/flags, then sample size or field size, then the count */
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+    uint8_t count[4];
+    if( p_stsz->i_size < mp4_box_headersize( p_stsz ) + 12 ||
+        vlc_stream_Seek( p_demux->s, p_stsz->i_pos +
+                                     mp4_box_headersize( p_stsz ) + 8 ) ||
+        vlc_stream_Read( p_demux->s, count, 4 ) != 4 )
+    {
+        vlc_stream_Seek( p_demux->s, i_pos );
+        return 0;
+    }
+    vlc_stream_Seek( p_demux->s, i_pos );
+    return GetDWBE( count );
+}
+
+/* Reads the deferred sample tables of the tracks needed at open, track by
+ * track. A track tables are parsed on a thread while the next ones are
+ * read. The other tracks load theirs when selected. */
+static void LoadDeferredTables( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+
+    mp4_tables_load_t *p_loads = calloc( p_sys->i_tracks, sizeof(*p_loads) );
+    if( p_loads )
+    {
+        const unsigned i_max_running = vlc_GetCPUCount();
+        unsigned i_running = 0, i_oldest = 0;
+
+        for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+        {
+            mp4_tables_load_t *p_load = &p_loads[i];
+
+            if( !TrackNeedsTablesAtOpen( p_demux, &p_sys->track[i] ) )
+                continue;
+
+            p_load->p_obj = VLC_OBJECT(p_demux);
+            p_load->p_stbl = MP4_BoxGet( p_sys->p_root,
+                                         "/moov/trak[%u]/mdia/minf/stbl", i );
+            if( !p_load->p_stbl || !ReadDeferredTables( p_demux, p_load ) )
+                continue;
+
+            while( i_running >= i_max_running )
+            {
+                if( p_loads[i_oldest].b_thread )
+                {
+                    vlc_join( p_loads[i_oldest].thread, NULL );
+                    p_loads[i_oldest].b_thread = false;
+                    i_running--;
+                }
+                i_oldest++;
+            }
+
+            if( vlc_clone( &p_load->thread, LoadTablesThread, p_load,
+                           VLC_THREAD_PRIORITY_INPUT ) == 0 )
+            {
+                p_load->b_thread = true;
+                i_running++;
+            }
+            else
+                LoadTablesThread( p_load );
+        }
+
+        for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+            if( p_loads[i].b_thread )
+                vlc_join( p_loads[i].thread, NULL );
+        free( p_loads );
+    }
+
+    /* Whatever could not be loaded from memory */
+    for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+    {
+        if( !TrackNeedsTablesAtOpen( p_demux, &p_sys->track[i] ) )
+            continue;
+
+        MP4_Box_t *p_stbl = MP4_BoxGet( p_sys->p_root,
+                                        "/moov/trak[%u]/mdia/minf/stbl", i );
+        if( p_stbl )
+            MP4_ReadBoxDeferred( p_demux->s, p_stbl, 0 );
+    }
+
+    vlc_stream_Seek( p_demux->s, i_pos );
+}
+
 static int CreateTracks( demux_t *p_demux, unsigned i_tracks )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -668,6 +970,16 @@ static void MP4_GetInterleaving( demux_t *p_demux, vlc_tick_t *pi_max_contiguous
     *pi_max_contiguous = 0;
     *pb_flat = true;
 
+    /* Tracks loaded later can be demuxing already */
+    uint32_t *pi_chunk = vlc_alloc( p_sys->i_tracks, sizeof(*pi_chunk) );
+    if( !pi_chunk )
+        return;
+    for( unsigned i=0; i < p_sys->i_tracks; i++ )
+    {
+        pi_chunk[i] = p_sys->track[i].i_chunk;
+        p_sys->track[i].i_chunk = 0;
+    }
+
     /* Find first recorded chunk */
     mp4_track_t *tk = NULL;
     uint64_t i_duration = 0;
@@ -721,9 +1033,35 @@ static void MP4_GetInterleaving( demux_t *p_demux, vlc_tick_t *pi_max_contiguous
         tk = nexttk;
     }
 
-    /* reset */
+    /* restore */
     for( unsigned i=0; i < p_sys->i_tracks; i++ )
-        p_sys->track[i].i_chunk = 0;
+        p_sys->track[i].i_chunk = pi_chunk[i];
+    free( pi_chunk );
+}
+
+/* Numbers the chunk runs of the tracks having their tables loaded, and
+ * warns when demuxing them will need seeks */
+static void MP4_UpdateInterleaving( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->b_fastseekable )
+        return;
+
+    unsigned i_loaded = 0;
+    for( unsigned i=0; i < p_sys->i_tracks; i++ )
+        if( p_sys->track[i].i_chunk_count )
+            i_loaded++;
+    if( i_loaded < 2 )
+        return;
+
+    vlc_tick_t i_max_continuity;
+    bool b_flat;
+    MP4_GetInterleaving( p_demux, &i_max_continuity, &b_flat );
+    if( b_flat )
+        msg_Warn( p_demux, "that media doesn't look interleaved, will need to seek");
+    else if( i_max_continuity > DEMUX_TRACK_MAX_PRELOAD )
+        msg_Warn( p_demux, "that media doesn't look properly interleaved, will need to seek");
 }
 
 static block_t * MP4_Block_Convert( demux_t *p_demux, const mp4_track_t *p_track, block_t *p_block )
@@ -888,6 +1226,11 @@ static int Open( vlc_object_t * p_this )
     p_sys->context.i_lastseqnumber = UINT32_MAX;
     p_sys->i_attachments = -1;
 
+    p_sys->sampletables.b_enabled =
+        var_InheritBool( p_demux, CFG_PREFIX"sample-table" );
+    p_sys->sampletables.i_budget =
+        (uint64_t) var_InheritInteger( p_demux, CFG_PREFIX"sample-table-max" ) << 20;
+
     p_demux->p_sys = p_sys;
 
     if( LoadInitFrag( p_demux ) != VLC_SUCCESS )
@@ -1141,6 +1484,9 @@ static int Open( vlc_object_t * p_this )
     if( (p_sys->p_meta = vlc_meta_New()) )
         MP4_LoadMeta( p_sys, p_sys->p_meta );
 
+    if( p_sys->p_root->e_flags & BOX_FLAG_DEFER_TABLES )
+        LoadDeferredTables( p_demux );
+
     /* now process each track and extract all useful information */
     for( unsigned i = 0; i < p_sys->i_tracks; i++ )
     {
@@ -1236,16 +1582,8 @@ static int Open( vlc_object_t * p_this )
         goto error;
     }
 
-    if( p_sys->i_tracks > 1 && !p_sys->b_fastseekable )
-    {
-        vlc_tick_t i_max_continuity;
-        bool b_flat;
-        MP4_GetInterleaving( p_demux, &i_max_continuity, &b_flat );
-        if( b_flat )
-            msg_Warn( p_demux, "that media doesn't look interleaved, will need to seek");
-        else if( i_max_continuity > DEMUX_TRACK_MAX_PRELOAD )
-            msg_Warn( p_demux, "that media doesn't look properly interleaved, will need to seek");
-    }
+    /* Deferred tracks get theirs when loaded */
+    MP4_UpdateInterleaving( p_demux );
 
     /* */
     LoadChapter( p_demux );
@@ -1703,7 +2041,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, bool b_accurate )
         mp4_track_t *tk = &p_sys->track[i_track];
         /* FIXME: we should find the lowest time from tracks with indexes.
            considering only video for now */
-        if( tk->fmt.i_cat != VIDEO_ES || MP4_isMetadata( tk ) || !tk->b_ok )
+        if( tk->fmt.i_cat != VIDEO_ES || MP4_isMetadata( tk ) || !tk->b_ok ||
+            tk->b_tables_deferred )
             continue;
         if( MP4_TrackSeek( p_demux, tk, i_date ) == VLC_SUCCESS )
         {
@@ -1720,7 +2059,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, bool b_accurate )
     {
         mp4_track_t *tk = &p_sys->track[i_track];
         tk->i_next_block_flags |= BLOCK_FLAG_DISCONTINUITY;
-        if( tk->fmt.i_cat == VIDEO_ES || !tk->b_ok )
+        /* never selected tracks are positioned once they are */
+        if( tk->fmt.i_cat == VIDEO_ES || !tk->b_ok || tk->b_tables_deferred )
             continue;
         MP4_TrackSeek( p_demux, tk, i_start );
     }
@@ -3072,23 +3412,44 @@ static int TrackGetNearestSeekPoint( demux_t *p_demux, mp4_track_t *p_track,
     int i_ret = VLC_EGENERIC;
     *pi_sync_sample = 0;
 
-    const MP4_Box_t *p_stss;
-    if( ( p_stss = MP4_BoxGet( p_track->p_stbl, "stss" ) ) )
+    const MP4_Box_t *p_stss = MP4_BoxGet( p_track->p_stbl, "stss" );
+    if( p_stss && p_track->p_samples )
+    {
+        /* Last sync sample at or before i_sample, or the first one */
+        uint32_t i = i_sample;
+        while( i > 0 && !p_track->p_samples[i].b_sync )
+            i--;
+        while( i < p_track->i_sample_count && !p_track->p_samples[i].b_sync )
+            i++;
+        if( i < p_track->i_sample_count )
+        {
+            *pi_sync_sample = i;
+            msg_Dbg( p_demux, "sample table gives %d --> %" PRIu32 " (sample number)",
+                     i_sample, *pi_sync_sample );
+            i_ret = VLC_SUCCESS;
+        }
+    }
+    else if( p_stss )
     {
         const MP4_Box_data_stss_t *p_stss_data = BOXDATA(p_stss);
         msg_Dbg( p_demux, "track[Id 0x%x] using Sync Sample Box (stss)",
                  p_track->i_track_ID );
-        for( unsigned i_index = 0; i_index < p_stss_data->i_entry_count; i_index++ )
+        /* Last sync sample at or before i_sample, or the first one */
+        unsigned i_low = 1, i_high = p_stss_data->i_entry_count;
+        while( i_low < i_high )
         {
-            if( i_index >= p_stss_data->i_entry_count - 1 ||
-                i_sample < p_stss_data->i_sample_number[i_index+1] )
-            {
-                *pi_sync_sample = p_stss_data->i_sample_number[i_index];
-                msg_Dbg( p_demux, "stss gives %d --> %" PRIu32 " (sample number)",
-                         i_sample, *pi_sync_sample );
-                i_ret = VLC_SUCCESS;
-                break;
-            }
+            unsigned i_mid = i_low + (i_high - i_low) / 2;
+            if( p_stss_data->i_sample_number[i_mid] <= i_sample )
+                i_low = i_mid + 1;
+            else
+                i_high = i_mid;
+        }
+        if( p_stss_data->i_entry_count > 0 )
+        {
+            *pi_sync_sample = p_stss_data->i_sample_number[i_low - 1];
+            msg_Dbg( p_demux, "stss gives %d --> %" PRIu32 " (sample number)",
+                     i_sample, *pi_sync_sample );
+            i_ret = VLC_SUCCESS;
         }
     }
 
@@ -3189,53 +3550,77 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale_qtime( start, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
-    /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
+    if( p_track->p_samples )
     {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
+        /* Last sample starting at or before i_start */
+        uint32_t i_low = 0, i_high = p_track->i_sample_count;
+        while( i_low < i_high )
         {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
+            uint32_t i_mid = i_low + (i_high - i_low) / 2;
+            if( p_track->p_samples[i_mid].i_dts <= i_start )
+                i_low = i_mid + 1;
+            else
+                i_high = i_mid;
         }
+        i_sample = i_low ? i_low - 1 : 0;
 
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
+        const mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk_count - 1];
+        if( i_start >= MP4_ChunkGetSampleDTS( ck, ck->i_sample_count ) )
+            i_sample = p_track->i_sample_count; /* past the last sample */
+        else
+            ck = MP4_TrackChunkForSample( p_track, i_sample );
+        i_chunk = ck - p_track->chunk;
+    }
+    else
+    {
+        /* we start from sample 0/chunk 0, hope it won't take too much time */
+        /* *** find good chunk *** */
+        for( i_chunk = 0; ; i_chunk++ )
         {
-            break;
+            if( i_chunk + 1 >= p_track->i_chunk_count )
+            {
+                /* at the end and can't check if i_start in this chunk,
+                   it will be check while searching i_sample */
+                i_chunk = p_track->i_chunk_count - 1;
+                break;
+            }
+
+            if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
+                (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
+            {
+                break;
+            }
         }
-    }
 
-    /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
+        /* *** find sample in the chunk *** */
+        i_sample = p_track->chunk[i_chunk].i_sample_first;
+        i_dts    = p_track->chunk[i_chunk].i_first_dts;
 
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
-         i_index++ )
-    {
-        if( i_dts +
-            (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+        for( uint_fast32_t i_index = 0;
+             i_index < p_track->chunk[i_chunk].i_entries_dts &&
+             i_sample < p_track->chunk[i_chunk].i_sample_count;
+             i_index++ )
         {
-            i_dts    +=
+            if( i_dts +
                 (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+                p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+            {
+                i_dts    +=
+                    (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
+                    p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
-        }
-        else
-        {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
+                i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+            }
+            else
             {
+                if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
+                {
+                    break;
+                }
+                i_sample += ( i_start - i_dts ) /
+                    p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
                 break;
             }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
-            break;
         }
     }
 
@@ -3390,14 +3775,26 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
         for( uint32_t i=1; i<16; i++ )
         {
             uint32_t i_nextsample = p_track->i_sample + i;
-            const mp4_chunk_t *ck = MP4_TrackChunkForSample( p_track, i_nextsample );
-            if(!ck)
-                break;
-            stime_t pts;
-            stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+            stime_t pts, dts;
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
-                pts += delta;
+            if( p_track->p_samples )
+            {
+                if( i_nextsample >= p_track->i_sample_count )
+                    break;
+                dts = pts = p_track->p_samples[i_nextsample].i_dts;
+                delta = p_track->p_samples[i_nextsample].i_delta;
+                if( delta != UNKNOWN_DELTA )
+                    pts += delta;
+            }
+            else
+            {
+                const mp4_chunk_t *ck = MP4_TrackChunkForSample( p_track, i_nextsample );
+                if(!ck)
+                    break;
+                dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+                if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+                    pts += delta;
+            }
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
                 lowest += p_track->i_start_delta;
@@ -3412,6 +3809,13 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
 
 static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
 {
+    if( p_track->p_samples && p_track->i_sample < p_track->i_sample_count )
+    {
+        p_track->i_next_dts = p_track->p_samples[p_track->i_sample].i_dts;
+        p_track->i_next_delta = p_track->p_samples[p_track->i_sample].i_delta;
+        return;
+    }
+
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
     p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
@@ -3609,9 +4013,13 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
         }
     }
 
-    /* Create chunk index table and sample index table */
-    if( TrackCreateChunksIndex( p_demux,p_track  ) ||
-        TrackCreateSamplesIndex( p_demux, p_track ) )
+    /* Create chunk index table and sample index table, unless the sample
+     * tables were deferred: then that waits for the track selection */
+    uint64_t i_start, i_end;
+    if( MP4_BoxGetDeferredRange( p_track->p_stbl, &i_start, &i_end ) )
+        p_track->b_tables_deferred = true;
+    else if( TrackCreateChunksIndex( p_demux,p_track  ) ||
+             TrackCreateSamplesIndex( p_demux, p_track ) )
     {
         msg_Err( p_demux, "cannot create chunks index" );
         return; /* cannot create chunks index */
@@ -3685,9 +4093,15 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     if( !p_track->b_enable )
         p_track->fmt.i_priority = ES_PRIORITY_NOT_DEFAULTABLE;
 
-    if( TrackCreateES( p_demux,
-                       p_track, p_track->i_chunk,
-                      (MP4_isMetadata( p_track ) || !b_create_es) ? NULL : &p_track->p_es ) )
+    /* The sample count is accumulated again when the tables get loaded */
+    if( p_track->b_tables_deferred )
+        p_track->i_sample_count = TrackPeekSampleCount( p_demux, p_track );
+    int i_ret = TrackCreateES( p_demux,
+                               p_track, p_track->i_chunk,
+                               (MP4_isMetadata( p_track ) || !b_create_es) ? NULL : &p_track->p_es );
+    if( p_track->b_tables_deferred )
+        p_track->i_sample_count = 0;
+    if( i_ret )
     {
         msg_Err( p_demux, "cannot create es for track[Id 0x%x]",
                  p_track->i_track_ID );
@@ -3718,6 +4132,7 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
 
     if( !p_track->i_sample_size )
         free( p_track->p_sample_size );
+    free( p_track->p_samples );
 
     ASFPacketTrackReset( &p_track->asfinfo );
 
@@ -3753,15 +4168,60 @@ static void MP4_TrackSelect( demux_t *p_demux, mp4_track_t *p_track, bool b_sele
     p_track->b_selected = b_select;
 }
 
+/* Reads the deferred sample tables of a track on its first selection, and
+ * creates its chunks and samples indexes */
+static int TrackLoadDeferredTables( demux_t *p_demux, mp4_track_t *p_track )
+{
+    if( !p_track->b_tables_deferred )
+        return VLC_SUCCESS;
+    p_track->b_tables_deferred = false;
+
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+    mp4_tables_load_t load = {
+        .p_obj = VLC_OBJECT(p_demux),
+        .p_stbl = MP4_BoxGet( p_track->p_track, "mdia/minf/stbl" ),
+    };
+
+    if( ReadDeferredTables( p_demux, &load ) )
+        LoadTablesThread( &load );
+    /* Whatever could not be loaded from memory */
+    MP4_ReadBoxDeferred( p_demux->s, load.p_stbl, 0 );
+
+    vlc_stream_Seek( p_demux->s, i_pos );
+
+    if( TrackCreateChunksIndex( p_demux, p_track ) ||
+        TrackCreateSamplesIndex( p_demux, p_track ) )
+    {
+        msg_Err( p_demux, "cannot create chunks index" );
+        p_track->b_ok = false;
+        return VLC_EGENERIC;
+    }
+
+    /* The runs depend on the chunks of all the loaded tracks */
+    MP4_UpdateInterleaving( p_demux );
+
+    /* Its ES was made from the first sample description, have
+     * TrackGotoChunkSample() check the one actually used */
+    if( p_track->chunk[0].i_sample_description_index != 1 )
+        p_track->i_chunk = p_track->i_chunk_count;
+
+    msg_Dbg( p_demux, "loaded the sample tables of track[Id 0x%x]",
+             p_track->i_track_ID );
+    return VLC_SUCCESS;
+}
+
 static int MP4_TrackSeek( demux_t *p_demux, mp4_track_t *p_track,
                           vlc_tick_t i_start )
 {
     uint32_t i_chunk;
     uint32_t i_sample;
 
-    if( !p_track->b_ok || MP4_isMetadata( p_track ) )
+    if( !p_track->b_ok || MP4_isMetadata( p_track ) ||
+        TrackLoadDeferredTables( p_demux, p_track ) )
         return VLC_EGENERIC;
 
+    MP4_TrackCreateSampleTable( p_demux, p_track );
+
     p_track->b_selected = false;
 
     if( TrackTimeToSampleChunk( p_demux, p_track, i_start,
@@ -4070,6 +4530,10 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
 
         i_pos += i_samples * (uint64_t) p_track->i_sample_size;
     }
+    else if( p_track->p_samples && p_track->i_sample < p_track->i_sample_count )
+    {
+        i_pos = p_track->p_samples[p_track->i_sample].i_offset;
+    }
     else
     {
         for( i_sample = p_track->chunk[p_track->i_chunk].i_sample_first;
@@ -61,6 +61,15 @@ typedef struct
 
 } mp4_chunk_t;
 
+/* Flattened sample table entry */
+typedef struct
+{
+    uint64_t     i_offset; /* absolute position of the sample in the file */
+    stime_t      i_dts;
+    uint32_t     i_delta;  /* pts - dts, UINT32_MAX if unknown */
+    bool         b_sync;   /* listed in stss */
+} mp4_sample_t;
+
 typedef struct
 {
     uint64_t i_offset;
@@ -101,6 +110,7 @@ typedef struct
     int b_ok;               /* The track is usable */
     int b_enable;           /* is the trak enable by default */
     bool b_selected;  /* is the trak being played */
+    bool b_tables_deferred; /* no chunks/samples index until selected */
     int i_use_flags;  /* !=0 Set when track is referenced by specific reference types.
                          You'll need to lookup other tracks tref to know the ref source */
     bool b_forced_spu; /* forced track selection (never done by default/priority) */
@@ -149,6 +159,11 @@ typedef struct
     uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
 //                                    too much time to do sumations each time*/
 
+    /* flattened timestamps and offsets, only for variable sample sizes,
+       NULL until the first seek or if not enabled, see mp4-sample-table */
+    mp4_sample_t     *p_samples;
+    bool             b_samples_probed;
+
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
     uint64_t     i_first_dts;    /* i_first_dts value
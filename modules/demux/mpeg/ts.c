@@ -34,11 +34,15 @@
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
 
 #include "ts_pid.h"
 #include "ts_streams.h"
 #include "ts_streams_private.h"
 #include "ts_pes.h"
+#include "ts_worker.h"
+#include "ts_index.h"
 #include "ts_psi.h"
 #include "ts_si.h"
 #include "ts_psip.h"
@@ -123,6 +127,30 @@ static void Close ( vlc_object_t * );
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 #define TS_GENERATED_PCR_OFFSET_TEXT "Offset in ms for generated PCR"
 
+#define READ_BATCH_TEXT N_("Packets per batched read")
+#define READ_BATCH_LONGTEXT N_( \
+    "Read this many TS packets at once into a single buffer and process " \
+    "them in place, instead of allocating a block per packet. " \
+    "0 reads packets one by one." )
+
+#define PROGRAM_THREADS_TEXT N_("Program output threads")
+#define PROGRAM_THREADS_LONGTEXT N_( \
+    "Reassemble and output the PES of each program on one of this many " \
+    "threads, keeping PCR updates in order with the program data. Useful " \
+    "when several programs of a multiplex are demuxed at once. " \
+    "0 does everything on the input thread." )
+
+#define SEEK_INDEX_TEXT N_("Build a seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Remember the position of the PCR read during playback, so that " \
+    "seeking back to a time goes straight to its position instead of " \
+    "searching the file." )
+
+#define SEEK_INDEX_FILE_TEXT N_("Store the seek index")
+#define SEEK_INDEX_FILE_LONGTEXT N_( \
+    "Save the seek index of local files next to them (.tsidx), and reuse " \
+    "it when the file is opened again." )
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -163,6 +191,13 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_integer_with_range( "ts-read-batch", 0, 0, 7 * 1024,
+                            READ_BATCH_TEXT, READ_BATCH_LONGTEXT )
+    add_integer_with_range( "ts-program-threads", 0, 0, 16,
+                            PROGRAM_THREADS_TEXT, PROGRAM_THREADS_LONGTEXT )
+    add_bool( "ts-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
+    add_bool( "ts-seek-index-file", false, SEEK_INDEX_FILE_TEXT,
+              SEEK_INDEX_FILE_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -194,6 +229,9 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static uint8_t* ReadTSPacketBatched( demux_t *p_demux );
+static void ReadTSPacketBatchedReset( demux_sys_t *p_sys );
+static uint64_t TSStreamTell( demux_sys_t *p_sys );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -353,6 +391,79 @@ static int DetectPVRHeadersAndHeaderSize( demux_t *p_demux, unsigned *pi_header_
     return DetectPacketSize( p_demux, pi_header_size, 0 );
 }
 
+/*****************************************************************************
+ * Seek index sidecar
+ *****************************************************************************/
+/* Size and modification time of the indexed file */
+static int SeekIndexStat( demux_t *p_demux, uint64_t *pi_size, int64_t *pi_mtime )
+{
+    char *psz_path = vlc_uri2path( p_demux->psz_url );
+    if( !psz_path )
+        return VLC_EGENERIC;
+
+    struct stat st;
+    int i_ret = vlc_stat( psz_path, &st );
+    free( psz_path );
+    if( i_ret || st.st_size <= 0 )
+        return VLC_EGENERIC;
+
+    *pi_size = st.st_size;
+    *pi_mtime = st.st_mtime;
+    return VLC_SUCCESS;
+}
+
+static void SeekIndexLoad( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    char *psz_path = vlc_uri2path( p_demux->psz_url );
+    if( !psz_path )
+        return;
+    if( asprintf( &p_sys->psz_index_path, "%s.tsidx", psz_path ) == -1 )
+        p_sys->psz_index_path = NULL;
+    free( psz_path );
+    if( !p_sys->psz_index_path )
+        return;
+
+    FILE *p_file = vlc_fopen( p_sys->psz_index_path, "rb" );
+    if( !p_file )
+        return;
+
+    uint64_t i_size;
+    int64_t i_mtime;
+    if( SeekIndexStat( p_demux, &i_size, &i_mtime ) == VLC_SUCCESS &&
+        ts_index_Load( p_sys->p_index, p_file, i_size, i_mtime ) == VLC_SUCCESS )
+        msg_Dbg( p_demux, "using seek index %s", p_sys->psz_index_path );
+    else
+        msg_Warn( p_demux, "ignoring invalid seek index %s", p_sys->psz_index_path );
+    fclose( p_file );
+}
+
+static void SeekIndexSave( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    uint64_t i_size;
+    int64_t i_mtime;
+    if( SeekIndexStat( p_demux, &i_size, &i_mtime ) != VLC_SUCCESS )
+        return;
+
+    FILE *p_file = vlc_fopen( p_sys->psz_index_path, "wb" );
+    if( !p_file )
+    {
+        msg_Dbg( p_demux, "cannot write seek index %s: %s",
+                 p_sys->psz_index_path, vlc_strerror_c(errno) );
+        return;
+    }
+
+    int i_ret = ts_index_Save( p_sys->p_index, p_file, i_size, i_mtime );
+    if( fclose( p_file ) || i_ret != VLC_SUCCESS )
+    {
+        msg_Warn( p_demux, "cannot write seek index %s", p_sys->psz_index_path );
+        vlc_unlink( p_sys->psz_index_path );
+    }
+}
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -399,6 +510,11 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->batch.p_buffer = NULL;
+    ARRAY_INIT( p_sys->workers );
+    p_sys->p_index = NULL;
+    p_sys->psz_index_path = NULL;
+    p_sys->i_next_worker = 0;
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -504,6 +620,28 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_ignore_time_for_positions = var_InheritBool( p_demux, "ts-seek-percent" );
     p_sys->b_cc_check = var_InheritBool( p_demux, "ts-cc-check" );
 
+    unsigned i_batch = var_InheritInteger( p_demux, "ts-read-batch" );
+    if( i_batch > 0 )
+    {
+        /* Need room for at least two packets to check sync when resyncing */
+        p_sys->batch.i_size = (size_t) __MAX(i_batch, 2) * p_sys->i_packet_size;
+        p_sys->batch.p_buffer = aligned_alloc( 32, (p_sys->batch.i_size + 31) & ~31 );
+        if( p_sys->batch.p_buffer )
+            msg_Dbg( p_demux, "reading %u packets per batch", __MAX(i_batch, 2) );
+        ReadTSPacketBatchedReset( p_sys );
+    }
+
+    unsigned i_threads = var_InheritInteger( p_demux, "ts-program-threads" );
+    for( unsigned i = 0; i < i_threads && !p_demux->b_preparsing; i++ )
+    {
+        ts_worker_t *p_worker = ts_worker_New( VLC_OBJECT(p_demux) );
+        if( !p_worker )
+            break;
+        ARRAY_APPEND( p_sys->workers, p_worker );
+    }
+    if( p_sys->workers.i_size )
+        msg_Dbg( p_demux, "using %d program output threads", p_sys->workers.i_size );
+
     p_sys->standard = TS_STANDARD_AUTO;
     char *psz_standard = var_InheritString( p_demux, "ts-standard" );
     if( psz_standard )
@@ -531,6 +669,14 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    if( p_sys->b_canseek && !p_demux->b_preparsing &&
+        var_InheritBool( p_demux, "ts-seek-index" ) )
+    {
+        p_sys->p_index = ts_index_New();
+        if( p_sys->p_index && var_InheritBool( p_demux, "ts-seek-index-file" ) )
+            SeekIndexLoad( p_demux );
+    }
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
@@ -561,6 +707,11 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    /* Let workers output what is pending before releasing the ES */
+    for( int i = 0; i < p_sys->workers.i_size; i++ )
+        ts_worker_Delete( p_sys->workers.p_elems[i] );
+    ARRAY_RESET( p_sys->workers );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -591,6 +742,15 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    if( p_sys->p_index )
+    {
+        if( p_sys->psz_index_path && ts_index_IsModified( p_sys->p_index ) )
+            SeekIndexSave( p_demux );
+        ts_index_Delete( p_sys->p_index );
+    }
+    free( p_sys->psz_index_path );
+
+    aligned_free( p_sys->batch.p_buffer );
     free( p_sys );
 }
 
@@ -619,6 +779,17 @@ static int ChangeKeyCallback( vlc_object_t *p_this, char const *psz_cmd,
 /*****************************************************************************
  * Demux:
  *****************************************************************************/
+static void BatchedPacketRelease( block_t *p_pkt )
+{
+    /* storage belongs to p_sys->batch */
+    VLC_UNUSED(p_pkt);
+}
+
+static const struct vlc_block_callbacks batched_packet_cbs =
+{
+    BatchedPacketRelease,
+};
+
 static int Demux( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -638,8 +809,18 @@ static int Demux( demux_t *p_demux )
     {
         bool         b_frame = false;
         int          i_header = 0;
+        block_t      batchedpkt;
         block_t     *p_pkt;
-        if( !(p_pkt = ReadTSPacket( p_demux )) )
+        if( p_sys->batch.p_buffer )
+        {
+            /* Packet stays in the batch buffer, only wrapped on the stack */
+            uint8_t *p_data = ReadTSPacketBatched( p_demux );
+            if( !p_data )
+                return VLC_DEMUXER_EOF;
+            p_pkt = block_Init( &batchedpkt, &batched_packet_cbs, p_data,
+                                p_sys->i_packet_size - p_sys->i_packet_header_size );
+        }
+        else if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -732,6 +913,15 @@ static int Demux( demux_t *p_demux )
 
             if( p_pid->u.p_stream->transport == TS_TRANSPORT_PES )
             {
+                /* PES gathering keeps the packet: take it out of the batch */
+                if( p_pkt == &batchedpkt )
+                {
+                    block_t *p_dup = block_Duplicate( p_pkt );
+                    block_Release( p_pkt );
+                    if( !p_dup )
+                        continue;
+                    p_pkt = p_dup;
+                }
                 b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
             }
             else if( p_pid->u.p_stream->transport == TS_TRANSPORT_SECTIONS )
@@ -814,6 +1004,9 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
     demux_sys_t *p_sys = p_demux->p_sys;
     ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
 
+    /* Selection and buffers are shared with the workers */
+    ProgramWorkersDrain( p_demux );
+
     /* We need 3 pass to avoid loss on deselect/relesect with hw filters and
        because pid could be shared and its state altered by another unselected pmt
        First clear flag on every referenced pid
@@ -953,7 +1146,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TSStreamTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1151,9 +1344,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        ReadTSPacketBatchedReset( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        ReadTSPacketBatchedReset( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1460,7 +1655,8 @@ static block_t * ConvertPESBlock( demux_t *p_demux, ts_es_t *p_es,
 /****************************************************************************
  * fanouts current block to all subdecoders / shared pid es
  ****************************************************************************/
-static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
+static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain,
+                           int *pi_next_block_flags )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
@@ -1477,10 +1673,10 @@ static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
             p_block->i_flags |= BLOCK_FLAG_AU_END;
 
         ts_es_t *p_es_send = p_es;
-        if( p_es_send->i_next_block_flags )
+        if( *pi_next_block_flags )
         {
-            p_block->i_flags |= p_es_send->i_next_block_flags;
-            p_es_send->i_next_block_flags = 0;
+            p_block->i_flags |= *pi_next_block_flags;
+            *pi_next_block_flags = 0;
         }
 
         while( p_es_send )
@@ -1526,9 +1722,204 @@ static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
     }
 }
 
+/****************************************************************************
+ * program output workers
+ ****************************************************************************/
+typedef struct
+{
+    ts_worker_job_t job;
+    demux_t    *p_demux;
+    ts_pid_t   *p_pid;
+    ts_es_t    *p_es;
+    block_t    *p_chain;       /* PES data, reassembled or not */
+    bool        b_converted;
+    int         i_next_block_flags;
+    unsigned    i_pes_size;
+    uint8_t     i_stream_id;
+} ts_pes_job_t;
+
+typedef struct
+{
+    ts_worker_job_t job;
+    demux_t    *p_demux;
+    int         i_group;
+    vlc_tick_t  i_pcr;
+} ts_pcr_job_t;
+
+static ts_worker_t * ProgramWorker( demux_sys_t *p_sys, ts_pmt_t *p_pmt )
+{
+    /* MPEG-4 systems recreate ES from the input thread */
+    if( p_sys->workers.i_size == 0 || p_pmt->iod )
+        return NULL;
+
+    /* Stick to the same worker to keep the program ordered */
+    if( !p_pmt->p_worker )
+        p_pmt->p_worker = p_sys->workers.p_elems[p_sys->i_next_worker++ %
+                                                 p_sys->workers.i_size];
+    return p_pmt->p_worker;
+}
+
+void ProgramWorkersDrain( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( int i = 0; i < p_sys->workers.i_size; i++ )
+        ts_worker_Drain( p_sys->workers.p_elems[i] );
+}
+
+static block_t * ConvertPESChain( demux_t *p_demux, ts_pid_t *pid, ts_es_t *p_es,
+                                  unsigned i_pes_size, uint8_t i_stream_id,
+                                  block_t *p_block )
+{
+    p_block = block_ChainGather( p_block );
+    if( !p_block )
+        return NULL;
+
+    /*** From here, block can become a chain again though conversion below ***/
+
+    if( pid->u.p_stream->p_proc )
+    {
+        if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
+            ts_stream_processor_Reset( pid->u.p_stream->p_proc );
+        p_block = ts_stream_processor_Push( pid->u.p_stream->p_proc, i_stream_id, p_block );
+    }
+    else
+    /* Some codecs might need xform or AU splitting */
+    {
+        p_block = ConvertPESBlock( p_demux, p_es, i_pes_size, i_stream_id, p_block );
+    }
+
+    return p_block;
+}
+
+static void PESJobRun( ts_worker_job_t *p_job )
+{
+    ts_pes_job_t *job = container_of( p_job, ts_pes_job_t, job );
+
+    block_t *p_block = job->p_chain;
+    if( !job->b_converted )
+        p_block = ConvertPESChain( job->p_demux, job->p_pid, job->p_es,
+                                   job->i_pes_size, job->i_stream_id, p_block );
+    SendDataChain( job->p_demux, job->p_es, p_block, &job->i_next_block_flags );
+    free( job );
+}
+
+static void PCRJobRun( ts_worker_job_t *p_job )
+{
+    ts_pcr_job_t *job = container_of( p_job, ts_pcr_job_t, job );
+
+    es_out_Control( job->p_demux->out, ES_OUT_SET_GROUP_PCR, job->i_group, job->i_pcr );
+    free( job );
+}
+
+/* Reassembles, converts and sends the PES, on the program worker if any */
+static void OutputPES( demux_t *p_demux, ts_pid_t *pid, unsigned i_pes_size,
+                       uint8_t i_stream_id, block_t *p_pes )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_es_t *p_es = pid->u.p_stream->p_es;
+    ts_worker_t *p_worker = ProgramWorker( p_sys, p_es->p_program );
+
+    if( p_worker )
+    {
+        ts_pes_job_t *job = malloc( sizeof(*job) );
+        if( unlikely(!job) )
+        {
+            block_ChainRelease( p_pes );
+            return;
+        }
+        job->job.pf_run = PESJobRun;
+        job->p_demux = p_demux;
+        job->p_pid = pid;
+        job->p_es = p_es;
+        job->i_pes_size = i_pes_size;
+        job->i_stream_id = i_stream_id;
+        /* Flags are raised by the input thread, take them now */
+        job->i_next_block_flags = p_es->i_next_block_flags;
+        p_es->i_next_block_flags = 0;
+        /* Teletext conversion reads the program clock, which only the
+         * input thread may access */
+        job->b_converted = p_es->fmt.i_codec == VLC_CODEC_TELETEXT;
+        job->p_chain = job->b_converted
+                     ? ConvertPESChain( p_demux, pid, p_es, i_pes_size, i_stream_id, p_pes )
+                     : p_pes;
+        ts_worker_Push( p_worker, &job->job );
+        return;
+    }
+
+    p_pes = ConvertPESChain( p_demux, pid, p_es, i_pes_size, i_stream_id, p_pes );
+    SendDataChain( p_demux, p_es, p_pes, &p_es->i_next_block_flags );
+}
+
+/* Sends the PCR in order with the program data */
+static void OutputPCR( demux_t *p_demux, ts_pmt_t *p_pmt, vlc_tick_t i_pcr )
+{
+    ts_worker_t *p_worker = ProgramWorker( p_demux->p_sys, p_pmt );
+
+    if( p_worker )
+    {
+        ts_pcr_job_t *job = malloc( sizeof(*job) );
+        if( likely(job) )
+        {
+            job->job.pf_run = PCRJobRun;
+            job->p_demux = p_demux;
+            job->i_group = p_pmt->i_number;
+            job->i_pcr = i_pcr;
+            ts_worker_Push( p_worker, &job->job );
+            return;
+        }
+        ts_worker_Drain( p_worker );
+    }
+
+    es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, i_pcr );
+}
+
 /****************************************************************************
  * gathering stuff
  ****************************************************************************/
+static void PESSetTiming( demux_t *p_demux, ts_pid_t *pid, ts_pmt_t *p_pmt,
+                          block_t *p_block, stime_t i_append_pcr )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_es_t *p_es = pid->u.p_stream->p_es;
+
+    if ( p_pmt->pcr.b_disable && p_block->i_dts != VLC_TICK_INVALID &&
+         ( p_pmt->i_pid_pcr == pid->i_pid || p_pmt->i_pid_pcr == 0x1FFF ) )
+    {
+        stime_t i_pcr = ( p_block->i_dts > p_sys->i_generated_pcr_dpb_offset )
+                      ? TO_SCALE(p_block->i_dts - p_sys->i_generated_pcr_dpb_offset)
+                      : TO_SCALE(p_block->i_dts);
+        ProgramSetPCR( p_demux, p_pmt, i_pcr );
+    }
+
+    /* Compute PCR/DTS offset if any */
+    stime_t i_pcrref = SETANDVALID(i_append_pcr) ? i_append_pcr : p_pmt->pcr.i_first;
+    if( p_pmt->pcr.i_pcroffset == -1 && p_block->i_dts != VLC_TICK_INVALID &&
+        SETANDVALID(i_pcrref) &&
+       (p_es->fmt.i_cat == VIDEO_ES || p_es->fmt.i_cat == AUDIO_ES) )
+    {
+        stime_t i_dts27 = TO_SCALE(p_block->i_dts);
+        i_dts27 = TimeStampWrapAround( i_pcrref, i_dts27 );
+        i_pcrref = TimeStampWrapAround( p_pmt->pcr.i_first, i_pcrref );
+        if( i_dts27 + (CLOCK_FREQ/90000) < i_pcrref )
+        {
+            p_pmt->pcr.i_pcroffset = i_pcrref - i_dts27 + TO_SCALE_NZ(VLC_TICK_FROM_MS(80));
+            msg_Warn( p_demux, "Broken stream: pid %d sends packets with dts %"PRId64
+                               "us later than pcr, applying delay",
+                      pid->i_pid, FROM_SCALE_NZ(i_pcrref - i_dts27) );
+        }
+        else p_pmt->pcr.i_pcroffset = 0;
+    }
+
+    if( p_pmt->pcr.i_pcroffset != -1 )
+    {
+        if( p_block->i_dts != VLC_TICK_INVALID )
+            p_block->i_dts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
+        if( p_block->i_pts != VLC_TICK_INVALID )
+            p_block->i_pts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
+    }
+}
+
 static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
                                stime_t i_append_pcr )
 {
@@ -1661,6 +2052,17 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
 
         p_pes->i_length = FROM_SCALE_NZ(i_length);
 
+        if( p_es->id && ProgramWorker( p_sys, p_pmt ) && p_pmt->pcr.b_fix_done &&
+            !pid->u.p_stream->prepcr.p_head &&
+            (p_pmt->pcr.i_current > -1 || p_pmt->pcr.b_disable) )
+        {
+            /* Timestamps are read from the first block: leave the
+             * reassembly copy to the program worker */
+            PESSetTiming( p_demux, pid, p_pmt, p_pes, i_append_pcr );
+            OutputPES( p_demux, pid, i_pes_size, i_stream_id, p_pes );
+            return;
+        }
+
         /* Can become a chain on next call due to prepcr */
         block_t *p_chain = block_ChainGather( p_pes );
         while ( p_chain ) {
@@ -1686,57 +2088,8 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
                     continue;
                 }
 
-                if ( p_pmt->pcr.b_disable && p_block->i_dts != VLC_TICK_INVALID &&
-                     ( p_pmt->i_pid_pcr == pid->i_pid || p_pmt->i_pid_pcr == 0x1FFF ) )
-                {
-                    stime_t i_pcr = ( p_block->i_dts > p_sys->i_generated_pcr_dpb_offset )
-                                  ? TO_SCALE(p_block->i_dts - p_sys->i_generated_pcr_dpb_offset)
-                                  : TO_SCALE(p_block->i_dts);
-                    ProgramSetPCR( p_demux, p_pmt, i_pcr );
-                }
-
-                /* Compute PCR/DTS offset if any */
-                stime_t i_pcrref = SETANDVALID(i_append_pcr) ? i_append_pcr : p_pmt->pcr.i_first;
-                if( p_pmt->pcr.i_pcroffset == -1 && p_block->i_dts != VLC_TICK_INVALID &&
-                    SETANDVALID(i_pcrref) &&
-                   (p_es->fmt.i_cat == VIDEO_ES || p_es->fmt.i_cat == AUDIO_ES) )
-                {
-                    stime_t i_dts27 = TO_SCALE(p_block->i_dts);
-                    i_dts27 = TimeStampWrapAround( i_pcrref, i_dts27 );
-                    i_pcrref = TimeStampWrapAround( p_pmt->pcr.i_first, i_pcrref );
-                    if( i_dts27 + (CLOCK_FREQ/90000) < i_pcrref )
-                    {
-                        p_pmt->pcr.i_pcroffset = i_pcrref - i_dts27 + TO_SCALE_NZ(VLC_TICK_FROM_MS(80));
-                        msg_Warn( p_demux, "Broken stream: pid %d sends packets with dts %"PRId64
-                                           "us later than pcr, applying delay",
-                                  pid->i_pid, FROM_SCALE_NZ(i_pcrref - i_dts27) );
-                    }
-                    else p_pmt->pcr.i_pcroffset = 0;
-                }
-
-                if( p_pmt->pcr.i_pcroffset != -1 )
-                {
-                    if( p_block->i_dts != VLC_TICK_INVALID )
-                        p_block->i_dts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
-                    if( p_block->i_pts != VLC_TICK_INVALID )
-                        p_block->i_pts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
-                }
-
-                /*** From here, block can become a chain again though conversion below ***/
-
-                if( pid->u.p_stream->p_proc )
-                {
-                    if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
-                        ts_stream_processor_Reset( pid->u.p_stream->p_proc );
-                    p_block = ts_stream_processor_Push( pid->u.p_stream->p_proc, i_stream_id, p_block );
-                }
-                else
-                /* Some codecs might need xform or AU splitting */
-                {
-                    p_block = ConvertPESBlock( p_demux, p_es, i_pes_size, i_stream_id, p_block );
-                }
-
-                SendDataChain( p_demux, p_es, p_block );
+                PESSetTiming( p_demux, pid, p_pmt, p_block, i_append_pcr );
+                OutputPES( p_demux, pid, i_pes_size, i_stream_id, p_block );
             }
             else
             {
@@ -1844,6 +2197,162 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     return p_pkt;
 }
 
+static void ReadTSPacketBatchedReset( demux_sys_t *p_sys )
+{
+    p_sys->batch.i_offset = 0;
+    p_sys->batch.i_filled = 0;
+    p_sys->batch.i_descrambled = 0;
+}
+
+/* Logical stream position, excluding what is still pending in the batch */
+static uint64_t TSStreamTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream ) -
+           (p_sys->batch.i_filled - p_sys->batch.i_offset);
+}
+
+static bool ReadTSPacketBatchedFill( demux_t *p_demux, size_t i_needed )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    size_t i_left = p_sys->batch.i_filled - p_sys->batch.i_offset;
+
+    if( i_left >= i_needed )
+        return true;
+
+    /* Move the trailing partial packet to the front and refill behind it */
+    if( p_sys->batch.i_offset > 0 )
+    {
+        memmove( p_sys->batch.p_buffer,
+                 &p_sys->batch.p_buffer[p_sys->batch.i_offset], i_left );
+        if( p_sys->batch.i_descrambled > p_sys->batch.i_offset )
+            p_sys->batch.i_descrambled -= p_sys->batch.i_offset;
+        else
+            p_sys->batch.i_descrambled = 0;
+        p_sys->batch.i_offset = 0;
+        p_sys->batch.i_filled = i_left;
+    }
+
+    while( p_sys->batch.i_filled < i_needed )
+    {
+        ssize_t i_read = vlc_stream_ReadPartial( p_sys->stream,
+                                &p_sys->batch.p_buffer[p_sys->batch.i_filled],
+                                p_sys->batch.i_size - p_sys->batch.i_filled );
+        if( i_read <= 0 )
+            return false;
+        p_sys->batch.i_filled += i_read;
+    }
+
+    return true;
+}
+
+/* Descrambles all the complete packets pending in the batch buffer at once,
+ * so that csa_DecryptBatch() gets enough of them to fill its lanes. */
+static void ReadTSPacketBatchedDescramble( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint8_t *pp_pkts[256];
+    size_t i_pkts = 0;
+    size_t i_pos = p_sys->batch.i_offset;
+
+    vlc_mutex_lock( &p_sys->csa_lock );
+    if( p_sys->csa )
+    {
+        while( i_pos + p_sys->i_packet_size <= p_sys->batch.i_filled )
+        {
+            uint8_t *p = &p_sys->batch.p_buffer[i_pos + p_sys->i_packet_header_size];
+
+            /* stop on sync loss, resync will bring us back here */
+            if( p[0] != 0x47 )
+                break;
+            if( p[3]&0x80 )
+            {
+                pp_pkts[i_pkts++] = p;
+                if( i_pkts == ARRAY_SIZE(pp_pkts) )
+                {
+                    csa_DecryptBatch( p_sys->csa, pp_pkts, i_pkts,
+                                      p_sys->i_csa_pkt_size );
+                    i_pkts = 0;
+                }
+            }
+            i_pos += p_sys->i_packet_size;
+        }
+        if( i_pkts > 0 )
+            csa_DecryptBatch( p_sys->csa, pp_pkts, i_pkts, p_sys->i_csa_pkt_size );
+    }
+    vlc_mutex_unlock( &p_sys->csa_lock );
+
+    p_sys->batch.i_descrambled = i_pos;
+}
+
+/* Same as ReadTSPacket(), but returns the packet in place within the batch
+ * buffer. The data is only valid until the next call. */
+static uint8_t* ReadTSPacketBatched( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint8_t *p_pkt;
+
+    if( !ReadTSPacketBatchedFill( p_demux, p_sys->i_packet_size ) )
+    {
+        msg_Dbg( p_demux, "EOF at %"PRIu64, TSStreamTell( p_sys ) );
+        return NULL;
+    }
+
+    p_pkt = &p_sys->batch.p_buffer[p_sys->batch.i_offset];
+
+    /* Check sync byte and re-sync if needed */
+    if( p_pkt[p_sys->i_packet_header_size] != 0x47 )
+    {
+        msg_Warn( p_demux, "lost synchro" );
+        for( ;; )
+        {
+            if( !ReadTSPacketBatchedFill( p_demux, p_sys->i_packet_size * 2 ) )
+            {
+                msg_Dbg( p_demux, "eof ?" );
+                return NULL;
+            }
+
+            const size_t i_left = p_sys->batch.i_filled - p_sys->batch.i_offset;
+            const uint8_t *p_peek = &p_sys->batch.p_buffer[p_sys->batch.i_offset];
+            size_t i_skip = 0;
+            bool b_synced = false;
+
+            while( i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size < i_left )
+            {
+                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
+                    p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
+                {
+                    b_synced = true;
+                    break;
+                }
+                i_skip++;
+            }
+            msg_Dbg( p_demux, "skipping %zu bytes of garbage at %"PRIu64,
+                     i_skip, TSStreamTell( p_sys ) );
+            p_sys->batch.i_offset += i_skip;
+
+            if( b_synced )
+                break;
+        }
+        msg_Dbg( p_demux, "resynced at %" PRIu64, TSStreamTell( p_sys ) );
+
+        if( !ReadTSPacketBatchedFill( p_demux, p_sys->i_packet_size ) )
+        {
+            msg_Dbg( p_demux, "eof ?" );
+            return NULL;
+        }
+        p_pkt = &p_sys->batch.p_buffer[p_sys->batch.i_offset];
+    }
+
+    /* Scrambled packets are descrambled ahead, by batches */
+    if( p_sys->csa && p_sys->batch.i_offset >= p_sys->batch.i_descrambled )
+        ReadTSPacketBatchedDescramble( p_demux );
+
+    p_sys->batch.i_offset += p_sys->i_packet_size;
+
+    /* Skip header (BluRay streams), see ReadTSPacket() */
+    return &p_pkt[p_sys->i_packet_header_size];
+}
+
 static stime_t GetPCR( const block_t *p_pkt )
 {
     const uint8_t *p = p_pkt->p_buffer;
@@ -1916,6 +2425,11 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    ProgramWorkersDrain( p_demux );
+    ReadTSPacketBatchedReset( p_sys );
+    if( p_sys->p_index )
+        ts_index_Break( p_sys->p_index );
+
     ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
     for( int i=0; i< p_pat->programs.i_size; i++ )
     {
@@ -1951,6 +2465,31 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
     }
 }
 
+static int SeekToIndexEntry( demux_t *p_demux, const ts_pmt_t *p_pmt,
+                             const ts_index_entry_t *p_entry )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( vlc_stream_Seek( p_sys->stream, p_entry->i_pos ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    /* One read to check the index still matches the file */
+    block_t *p_pkt = ReadTSPacket( p_demux );
+    bool b_match = p_pkt && PIDGet( p_pkt ) == p_pmt->i_pid_pcr &&
+                   GetPCR( p_pkt ) == p_entry->i_pcr;
+    if( p_pkt )
+        block_Release( p_pkt );
+
+    if( !b_match )
+    {
+        msg_Warn( p_demux, "seek index does not match the stream, dropping it" );
+        ts_index_Clear( p_sys->p_index );
+        return VLC_EGENERIC;
+    }
+
+    return vlc_stream_Seek( p_sys->stream, p_entry->i_pos );
+}
+
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaledtime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -1959,15 +2498,39 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
         return vlc_stream_Seek( p_sys->stream, 0 );
 
+    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+
+    /* Known position from the index: PCR just before or spot on */
+    uint64_t i_head_pos = 0;
+    uint64_t i_tail_pos = UINT64_MAX;
+    ts_index_entry_t before, after;
+    if( p_sys->p_index &&
+        ts_index_Lookup( p_sys->p_index, p_pmt->i_number, p_pmt->pcr.i_first,
+                         i_scaledtime, &before, &after ) )
+    {
+        stime_t i_diff = i_scaledtime - TimeStampWrapAround( p_pmt->pcr.i_first, before.i_pcr );
+        if( ( after.i_pos != UINT64_MAX && after.b_linked ) ||
+            i_diff < TO_SCALE(VLC_TICK_0 + VLC_TICK_FROM_MS(500)) )
+        {
+            if( SeekToIndexEntry( p_demux, p_pmt, &before ) == VLC_SUCCESS )
+                return VLC_SUCCESS;
+            if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) != VLC_SUCCESS )
+                return VLC_EGENERIC;
+        }
+        else
+        {
+            /* Only search in the gap the index doesn't cover */
+            i_head_pos = before.i_pos;
+            i_tail_pos = after.i_pos;
+        }
+    }
+
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
-
     /* Find the time position by using binary search algorithm. */
-    uint64_t i_head_pos = 0;
-    uint64_t i_tail_pos = (uint64_t) i_stream_size - p_sys->i_packet_size;
+    i_tail_pos = __MIN( i_tail_pos, (uint64_t) i_stream_size - p_sys->i_packet_size );
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
@@ -2273,17 +2836,17 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
 
     if ( p_sys->i_pmt_es )
     {
-        es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
+        OutputPCR( p_demux, p_pmt, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TSStreamTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TSStreamTell( p_sys );
             }
         }
     }
@@ -2411,6 +2974,10 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
             /* Can be dedicated PCR pid (no owned then) or another pid (owner == pmt) */
             if( p_pmt->i_pid_pcr == pid->i_pid ) /* If that program references current pid as PCR */
             {
+                if( p_sys->p_index )
+                    ts_index_Add( p_sys->p_index, p_pmt->i_number,
+                                  TSStreamTell( p_sys ) - p_sys->i_packet_size, i_pcr );
+
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
@@ -2739,6 +3306,7 @@ void AddAndCreateES( demux_t *p_demux, ts_pid_t *pid, bool b_create_delayed )
 
     if( pid && p_sys->es_creation == CREATE_ES )
     {
+        ProgramWorkersDrain( p_demux );
         DoCreateES( p_demux, pid->u.p_stream->p_es, NULL );
 
         /* Update the default program == first created ES group */
@@ -24,6 +24,8 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_worker_t ts_worker_t;
+typedef struct ts_index_t ts_index_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -71,6 +73,17 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* batched reads: packets are served in place from a single buffer,
+     * see ReadTSPacketBatched() */
+    struct
+    {
+        uint8_t *p_buffer;
+        size_t   i_size;     /* allocated size, multiple of i_packet_size */
+        size_t   i_offset;   /* start of next unread packet */
+        size_t   i_filled;   /* valid bytes in p_buffer */
+        size_t   i_descrambled; /* end of the packets already descrambled */
+    } batch;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -104,6 +117,14 @@ struct demux_sys_t
     bool        b_split_es;
     bool        b_valid_scrambling;
 
+    /* PCR positions, see SeekToTime() */
+    ts_index_t  *p_index;
+    char        *psz_index_path; /* sidecar file */
+
+    /* program output workers, see ProgramWorker() */
+    DECL_ARRAY( ts_worker_t * ) workers;
+    unsigned    i_next_worker;
+
     bool        b_trust_pcr;
     bool        b_check_pcr_offset;
     unsigned    i_generated_pcr_dpb_offset;
@@ -149,6 +170,7 @@ void TsChangeStandard( demux_sys_t *, ts_standards_e );
 bool ProgramIsSelected( demux_sys_t *, uint16_t i_pgrm );
 
 void UpdatePESFilters( demux_t *p_demux, bool b_all );
+void ProgramWorkersDrain( demux_t *p_demux );
 
 int ProbeStart( demux_t *p_demux, int i_program );
 int ProbeEnd( demux_t *p_demux, int i_program );
@@ -0,0 +1,365 @@
+/*****************************************************************************
+ * ts_index.c: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+
+#include "timestamps.h"
+#include "ts_index.h"
+
+#include <stdio.h>
+
+#define TS_INDEX_MAGIC "VLCTSIX2"
+#define TS_INDEX_LINKED (UINT64_C(1) << 63)
+
+typedef struct
+{
+    int      i_program;
+    DECL_ARRAY(ts_index_entry_t) entries; /* sorted by position */
+    /* last record, while reading continuously */
+    bool     b_continuous;
+    uint64_t i_last_pos;
+    stime_t  i_last_pcr;
+} ts_index_program_t;
+
+struct ts_index_t
+{
+    DECL_ARRAY(ts_index_program_t *) programs;
+    bool b_modified;
+};
+
+ts_index_t * ts_index_New( void )
+{
+    ts_index_t *p_index = malloc( sizeof(*p_index) );
+    if( p_index )
+    {
+        ARRAY_INIT( p_index->programs );
+        p_index->b_modified = false;
+    }
+    return p_index;
+}
+
+void ts_index_Clear( ts_index_t *p_index )
+{
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+    {
+        ARRAY_RESET( p_index->programs.p_elems[i]->entries );
+        free( p_index->programs.p_elems[i] );
+    }
+    ARRAY_RESET( p_index->programs );
+    p_index->b_modified = true;
+}
+
+void ts_index_Delete( ts_index_t *p_index )
+{
+    ts_index_Clear( p_index );
+    free( p_index );
+}
+
+static ts_index_program_t * GetProgram( const ts_index_t *p_index, int i_program )
+{
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+        if( p_index->programs.p_elems[i]->i_program == i_program )
+            return p_index->programs.p_elems[i];
+    return NULL;
+}
+
+static ts_index_program_t * AddProgram( ts_index_t *p_index, int i_program )
+{
+    ts_index_program_t *p_prog = GetProgram( p_index, i_program );
+    if( p_prog )
+        return p_prog;
+
+    p_prog = malloc( sizeof(*p_prog) );
+    if( !p_prog )
+        return NULL;
+    p_prog->i_program = i_program;
+    ARRAY_INIT( p_prog->entries );
+    p_prog->b_continuous = false;
+    ARRAY_APPEND( p_index->programs, p_prog );
+    return p_prog;
+}
+
+/* Index of the first entry at or after i_pos */
+static int FindPos( const ts_index_program_t *p_prog, uint64_t i_pos )
+{
+    int i_low = 0, i_high = p_prog->entries.i_size;
+    while( i_low < i_high )
+    {
+        int i_mid = (i_low + i_high) / 2;
+        if( p_prog->entries.p_elems[i_mid].i_pos < i_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+void ts_index_Add( ts_index_t *p_index, int i_program, uint64_t i_pos, stime_t i_pcr )
+{
+    ts_index_program_t *p_prog = AddProgram( p_index, i_program );
+    if( !p_prog )
+        return;
+
+    int i_entry = FindPos( p_prog, i_pos );
+
+    bool b_linked = false;
+    if( p_prog->b_continuous && i_pos > p_prog->i_last_pos )
+    {
+        /* Follow the entries already known and read through */
+        ts_index_entry_t *p_prev = i_entry > 0 ? &p_prog->entries.p_elems[i_entry - 1]
+                                               : NULL;
+        if( p_prev && p_prev->i_pos > p_prog->i_last_pos )
+        {
+            stime_t i_prev = TimeStampWrapAround( p_prog->i_last_pcr, p_prev->i_pcr );
+            if( !p_prev->b_linked && i_prev >= p_prog->i_last_pcr )
+            {
+                p_prev->b_linked = true;
+                p_index->b_modified = true;
+            }
+            p_prog->i_last_pos = p_prev->i_pos;
+            p_prog->i_last_pcr = p_prev->i_pcr;
+        }
+
+        stime_t i_diff = TimeStampWrapAround( p_prog->i_last_pcr, i_pcr ) - p_prog->i_last_pcr;
+        if( i_diff >= 0 && i_diff < TS_INDEX_INTERVAL )
+            return;
+        /* PCR discontinuities break the time/position monotonicity */
+        b_linked = i_diff >= 0;
+    }
+
+    p_prog->b_continuous = true;
+    p_prog->i_last_pos = i_pos;
+    p_prog->i_last_pcr = i_pcr;
+
+    ts_index_entry_t entry = {
+        .i_pos = i_pos,
+        .i_pcr = i_pcr,
+        .b_linked = b_linked,
+    };
+
+    if( i_entry < p_prog->entries.i_size &&
+        p_prog->entries.p_elems[i_entry].i_pos == i_pos )
+    {
+        /* Already known, from another pass or the sidecar */
+        ts_index_entry_t *p_entry = &p_prog->entries.p_elems[i_entry];
+        if( p_entry->i_pcr != i_pcr || (b_linked && !p_entry->b_linked) )
+        {
+            p_entry->i_pcr = i_pcr;
+            p_entry->b_linked |= b_linked;
+            p_index->b_modified = true;
+        }
+        return;
+    }
+
+    ARRAY_INSERT( p_prog->entries, entry, i_entry );
+    p_index->b_modified = true;
+}
+
+void ts_index_Break( ts_index_t *p_index )
+{
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+        p_index->programs.p_elems[i]->b_continuous = false;
+}
+
+/* Time of an entry in the linked run starting with p_first. PCR only go
+ * forward inside a run, so they wrap relative to its start */
+static stime_t RunTime( stime_t i_first_pcr, const ts_index_entry_t *p_first,
+                        const ts_index_entry_t *p_entry )
+{
+    return TimeStampWrapAround( i_first_pcr, p_first->i_pcr ) +
+           TimeStampWrapAround( p_first->i_pcr, p_entry->i_pcr ) - p_first->i_pcr;
+}
+
+bool ts_index_Lookup( const ts_index_t *p_index, int i_program,
+                      stime_t i_first_pcr, stime_t i_time,
+                      ts_index_entry_t *p_before, ts_index_entry_t *p_after )
+{
+    const ts_index_program_t *p_prog = GetProgram( p_index, i_program );
+    if( !p_prog || p_prog->entries.i_size == 0 )
+        return false;
+
+    const ts_index_entry_t *p_entries = p_prog->entries.p_elems;
+    const int i_entries = p_prog->entries.i_size;
+
+    /* Positions and times only match inside linked runs, and discontinuities
+     * can make several runs cover the same time: use the first run that
+     * contains i_time, or else the one ending the closest before it */
+    int i_run = -1, i_run_end = -1;
+    int i_prev_run = -1, i_prev_end = -1;
+    stime_t i_prev_time = 0;
+    for( int i_start = 0; i_start < i_entries && i_run < 0; )
+    {
+        int i_end = i_start + 1;
+        while( i_end < i_entries && p_entries[i_end].b_linked )
+            i_end++;
+
+        const ts_index_entry_t *p_first = &p_entries[i_start];
+        stime_t i_start_time = RunTime( i_first_pcr, p_first, p_first );
+        stime_t i_end_time = RunTime( i_first_pcr, p_first, &p_entries[i_end - 1] );
+        if( i_start_time <= i_time && i_time < i_end_time )
+        {
+            i_run = i_start;
+            i_run_end = i_end;
+        }
+        else if( i_end_time <= i_time &&
+                 ( i_prev_run < 0 || i_end_time > i_prev_time ) )
+        {
+            i_prev_run = i_start;
+            i_prev_end = i_end;
+            i_prev_time = i_end_time;
+        }
+        i_start = i_end;
+    }
+
+    if( i_run < 0 )
+    {
+        if( i_prev_run < 0 )
+            return false;
+
+        /* Past the end of a run: the next one bounds the unread gap if it
+         * starts later, as nothing is known about the time in between */
+        *p_before = p_entries[i_prev_end - 1];
+        p_after->i_pos = UINT64_MAX;
+        if( i_prev_end < i_entries )
+        {
+            const ts_index_entry_t *p_next = &p_entries[i_prev_end];
+            if( RunTime( i_first_pcr, p_next, p_next ) > i_time )
+                *p_after = *p_next;
+        }
+        return true;
+    }
+
+    /* First entry of the run after i_time */
+    const ts_index_entry_t *p_first = &p_entries[i_run];
+    int i_low = i_run + 1, i_high = i_run_end - 1;
+    while( i_low < i_high )
+    {
+        int i_mid = (i_low + i_high) / 2;
+        if( RunTime( i_first_pcr, p_first, &p_entries[i_mid] ) <= i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+
+    *p_before = p_entries[i_low - 1];
+    *p_after = p_entries[i_low];
+    return true;
+}
+
+bool ts_index_IsModified( const ts_index_t *p_index )
+{
+    return p_index->b_modified;
+}
+
+/* Sidecar layout, big endian:
+ * magic[8] stream_size[8] stream_mtime[8] program_count[4]
+ * then for each program: number[4] entry_count[4]
+ *   then for each entry: pos[8] linked<<63|pcr[8] */
+int ts_index_Load( ts_index_t *p_index, FILE *p_file,
+                   uint64_t i_size, int64_t i_mtime )
+{
+    uint8_t header[28];
+    if( fread( header, 1, sizeof(header), p_file ) != sizeof(header) ||
+        memcmp( header, TS_INDEX_MAGIC, 8 ) ||
+        GetQWBE( &header[8] ) != i_size ||
+        (int64_t) GetQWBE( &header[16] ) != i_mtime )
+        return VLC_EGENERIC;
+
+    ts_index_Clear( p_index );
+
+    uint32_t i_programs = GetDWBE( &header[24] );
+    for( uint32_t i = 0; i < i_programs; i++ )
+    {
+        uint8_t prog[8];
+        if( fread( prog, 1, sizeof(prog), p_file ) != sizeof(prog) )
+            goto error;
+
+        ts_index_program_t *p_prog = AddProgram( p_index, GetDWBE( prog ) );
+        if( !p_prog )
+            goto error;
+
+        uint32_t i_entries = GetDWBE( &prog[4] );
+        for( uint32_t j = 0; j < i_entries; j++ )
+        {
+            uint8_t data[16];
+            if( fread( data, 1, sizeof(data), p_file ) != sizeof(data) )
+                goto error;
+
+            uint64_t i_pcr = GetQWBE( &data[8] );
+            ts_index_entry_t entry = {
+                .i_pos = GetQWBE( data ),
+                .i_pcr = i_pcr & ~TS_INDEX_LINKED,
+                .b_linked = i_pcr & TS_INDEX_LINKED,
+            };
+            if( entry.i_pos >= i_size || (p_prog->entries.i_size &&
+                entry.i_pos <= ARRAY_VAL(p_prog->entries, p_prog->entries.i_size - 1).i_pos) )
+                goto error;
+            ARRAY_APPEND( p_prog->entries, entry );
+        }
+    }
+
+    p_index->b_modified = false;
+    return VLC_SUCCESS;
+
+error:
+    ts_index_Clear( p_index );
+    p_index->b_modified = false;
+    return VLC_EGENERIC;
+}
+
+int ts_index_Save( ts_index_t *p_index, FILE *p_file,
+                   uint64_t i_size, int64_t i_mtime )
+{
+    uint8_t header[28];
+    memcpy( header, TS_INDEX_MAGIC, 8 );
+    SetQWBE( &header[8], i_size );
+    SetQWBE( &header[16], i_mtime );
+    SetDWBE( &header[24], p_index->programs.i_size );
+    if( fwrite( header, 1, sizeof(header), p_file ) != sizeof(header) )
+        return VLC_EGENERIC;
+
+    for( int i = 0; i < p_index->programs.i_size; i++ )
+    {
+        const ts_index_program_t *p_prog = p_index->programs.p_elems[i];
+        uint8_t prog[8];
+        SetDWBE( prog, p_prog->i_program );
+        SetDWBE( &prog[4], p_prog->entries.i_size );
+        if( fwrite( prog, 1, sizeof(prog), p_file ) != sizeof(prog) )
+            return VLC_EGENERIC;
+
+        for( int j = 0; j < p_prog->entries.i_size; j++ )
+        {
+            const ts_index_entry_t *p_entry = &p_prog->entries.p_elems[j];
+            uint8_t data[16];
+            SetQWBE( data, p_entry->i_pos );
+            SetQWBE( &data[8], p_entry->i_pcr |
+                               (p_entry->b_linked ? TS_INDEX_LINKED : 0) );
+            if( fwrite( data, 1, sizeof(data), p_file ) != sizeof(data) )
+                return VLC_EGENERIC;
+        }
+    }
+
+    p_index->b_modified = false;
+    return VLC_SUCCESS;
+}
@@ -0,0 +1,63 @@
+/*****************************************************************************
+ * ts_index.h: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_INDEX_H
+#define VLC_TS_INDEX_H
+
+/* Seek index: byte position of PCR packets, per program, recorded while
+ * reading so that seeks do not need to bisect the whole file */
+
+/* Distance between two recorded PCR of a program, 90kHz */
+#define TS_INDEX_INTERVAL (90000 / 4)
+
+typedef struct ts_index_t ts_index_t;
+
+typedef struct
+{
+    uint64_t i_pos;   /* start of the packet carrying the PCR */
+    stime_t  i_pcr;   /* as read, 90kHz, not wrapped around */
+    bool     b_linked; /* read continuously from the previous entry */
+} ts_index_entry_t;
+
+ts_index_t * ts_index_New( void );
+void ts_index_Delete( ts_index_t * );
+void ts_index_Clear( ts_index_t * );
+
+/* Records a PCR read at i_pos. Reading must have been continuous since
+ * the previous record for the entry to get linked */
+void ts_index_Add( ts_index_t *, int i_program, uint64_t i_pos, stime_t i_pcr );
+/* Signals that reading jumped (seek) */
+void ts_index_Break( ts_index_t * );
+
+/* Finds the last entry before i_time, and the next one if any. Only
+ * entries of a same linked run are compared, a run being wrapped around
+ * i_first_pcr from its start. The next entry is not linked when i_time
+ * falls in an unread gap, and missing (i_pos UINT64_MAX) when nothing
+ * bounds it. Returns false if there's no entry before i_time */
+bool ts_index_Lookup( const ts_index_t *, int i_program,
+                      stime_t i_first_pcr, stime_t i_time,
+                      ts_index_entry_t *p_before, ts_index_entry_t *p_after );
+
+/* Sidecar file storage. i_size and i_mtime identify the indexed file,
+ * loading rejects an index made for another size or modification time */
+int ts_index_Load( ts_index_t *, FILE *, uint64_t i_size, int64_t i_mtime );
+int ts_index_Save( ts_index_t *, FILE *, uint64_t i_size, int64_t i_mtime );
+bool ts_index_IsModified( const ts_index_t * );
+
+#endif
@@ -42,8 +42,10 @@ void ts_pid_list_Init( ts_pid_list_t *p_list )
     p_list->pp_all = NULL;
     p_list->i_all = 0;
     p_list->i_all_alloc = 0;
-    p_list->i_last_pid = 0;
-    p_list->p_last = NULL;
+    memset( p_list->pp_index, 0, sizeof(p_list->pp_index) );
+    p_list->pp_index[0] = &p_list->pat;
+    p_list->pp_index[0x1FFB] = &p_list->base_si;
+    p_list->pp_index[0x1FFF] = &p_list->dummy;
 }
 
 void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
@@ -62,100 +64,62 @@ void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
     free( p_list->pp_all );
 }
 
-struct searchkey
+static ts_pid_t * ts_pid_Create( ts_pid_list_t *p_list, uint16_t i_pid )
 {
-    int16_t i_pid;
-    ts_pid_t *const *pp_last;
-};
-
-static int ts_bsearch_searchkey_Compare( const void *key, const void *other )
-{
-    struct searchkey *p_key = (void *)key;
-    ts_pid_t *const *pp_pid = other;
-
-    ts_pid_t *p_pid = *pp_pid;
-    p_key->pp_last = other;
-    return ( p_key->i_pid >= p_pid->i_pid ) ? p_key->i_pid - p_pid->i_pid : -1;
-}
+    if( p_list->i_all >= p_list->i_all_alloc )
+    {
+        ts_pid_t **p_realloc = realloc( p_list->pp_all,
+                                        (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
+        if( !p_realloc )
+        {
+            abort();
+            //return NULL;
+        }
+        p_list->pp_all = p_realloc;
+        p_list->i_all_alloc += PID_ALLOC_CHUNK;
+    }
 
-ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
-{
-    switch( i_pid )
+    ts_pid_t *p_pid = calloc( 1, sizeof(*p_pid) );
+    if( !p_pid )
     {
-        case 0:
-            return &p_list->pat;
-        case 0x1FFB:
-            return &p_list->base_si;
-        case 0x1FFF:
-            return &p_list->dummy;
-        default:
-            if( p_list->i_last_pid == i_pid )
-                return p_list->p_last;
-        break;
+        abort();
+        //return NULL;
     }
 
-    size_t i_index = 0;
-    ts_pid_t *p_pid = NULL;
+    p_pid->i_cc  = 0xff;
+    p_pid->i_pid = i_pid;
 
-    if( p_list->pp_all )
+    /* Keep pp_all sorted so iteration order does not depend on arrival */
+    size_t i_low = 0, i_high = p_list->i_all;
+    while( i_low < i_high )
     {
-        struct searchkey pidkey;
-        pidkey.i_pid = i_pid;
-        pidkey.pp_last = NULL;
-
-        ts_pid_t **pp_pidk = bsearch( &pidkey, p_list->pp_all, p_list->i_all,
-                                      sizeof(ts_pid_t *), ts_bsearch_searchkey_Compare );
-        if ( pp_pidk )
-            p_pid = *pp_pidk;
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_list->pp_all[i_mid]->i_pid < i_pid )
+            i_low = i_mid + 1;
         else
-            i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
+            i_high = i_mid;
     }
 
-    if( p_pid == NULL )
-    {
-        if( p_list->i_all >= p_list->i_all_alloc )
-        {
-            ts_pid_t **p_realloc = realloc( p_list->pp_all,
-                                            (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
-            if( !p_realloc )
-            {
-                abort();
-                //return NULL;
-            }
-            p_list->pp_all = p_realloc;
-            p_list->i_all_alloc += PID_ALLOC_CHUNK;
-        }
+    memmove( &p_list->pp_all[i_low + 1],
+             &p_list->pp_all[i_low],
+             (p_list->i_all - i_low) * sizeof(ts_pid_t *) );
+    p_list->pp_all[i_low] = p_pid;
+    p_list->i_all++;
 
-        p_pid = calloc( 1, sizeof(*p_pid) );
-        if( !p_pid )
-        {
-            abort();
-            //return NULL;
-        }
+    p_list->pp_index[i_pid] = p_pid;
 
-        p_pid->i_cc  = 0xff;
-        p_pid->i_pid = i_pid;
-
-        /* Do insertion based on last bsearch mid point */
-        if( p_list->i_all )
-        {
-            if( p_list->pp_all[i_index]->i_pid < i_pid )
-                i_index++;
-
-            memmove( &p_list->pp_all[i_index + 1],
-                    &p_list->pp_all[i_index],
-                    (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
-        }
-
-        p_list->pp_all[i_index] = p_pid;
-        p_list->i_all++;
+    return p_pid;
+}
 
-    }
+ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
+{
+    i_pid &= TS_PID_COUNT - 1;
 
-    p_list->p_last = p_pid;
-    p_list->i_last_pid = i_pid;
+    ts_pid_t *p_pid = p_list->pp_index[i_pid];
+    if( likely(p_pid) )
+        return p_pid;
 
-    return p_pid;
+    return ts_pid_Create( p_list, i_pid );
 }
 
 ts_pid_t * ts_pid_Next( ts_pid_list_t *p_list, ts_pid_next_context_t *p_ctx )
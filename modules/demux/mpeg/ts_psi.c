@@ -95,6 +95,9 @@ static void PATCallBack( void *data, dvbpsi_pat_t *p_dvbpsipat )
 
     msg_Dbg( p_demux, "PATCallBack called" );
 
+    /* Programs and ES can go away below */
+    ProgramWorkersDrain( p_demux );
+
     if(unlikely( GetPID(p_sys, 0)->type != TYPE_PAT ))
     {
         msg_Warn( p_demux, "PATCallBack called on invalid pid" );
@@ -1823,6 +1826,9 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
 
     msg_Dbg( p_demux, "PMTCallBack called for program %d", p_dvbpsipmt->i_program_number );
 
+    /* ES can be updated or go away below */
+    ProgramWorkersDrain( p_demux );
+
     if (unlikely(GetPID(p_sys, 0)->type != TYPE_PAT))
     {
         assert(GetPID(p_sys, 0)->type == TYPE_PAT);
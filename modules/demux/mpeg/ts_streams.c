@@ -117,6 +117,7 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
     pmt->i_number   = -1;
     pmt->i_pid_pcr  = 0x1FFF;
     pmt->b_selected = false;
+    pmt->p_worker   = NULL;
     pmt->iod        = NULL;
     pmt->od.i_version = -1;
     ARRAY_INIT( pmt->od.objects );
@@ -21,6 +21,7 @@
 
 typedef struct dvbpsi_s dvbpsi_t;
 typedef struct ts_sections_processor_t ts_sections_processor_t;
+typedef struct ts_worker_t ts_worker_t;
 
 #include "mpeg4_iod.h"
 #include "timestamps.h"
@@ -45,6 +46,8 @@ struct ts_pmt_t
     int             i_number;
     int             i_pid_pcr;
     bool            b_selected;
+    /* output worker, if any, see ProgramWorker() */
+    ts_worker_t     *p_worker;
     /* IOD stuff (mpeg4) */
     od_descriptor_t *iod;
     od_descriptors_t od;
@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * ts_worker.c: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+
+#include "ts_worker.h"
+
+#include <assert.h>
+
+/* Bounds the memory held by a late worker */
+#define TS_WORKER_MAX_PENDING 1024
+
+struct ts_worker_t
+{
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;   /* jobs queued, or exit requested */
+    vlc_cond_t  idle;   /* queue drained, or room made */
+    ts_worker_job_t *p_first;
+    ts_worker_job_t **pp_last;
+    unsigned    i_pending; /* queued and running jobs */
+    bool        b_exit;
+};
+
+static void *Run( void *data )
+{
+    ts_worker_t *p_worker = data;
+
+    vlc_mutex_lock( &p_worker->lock );
+    for( ;; )
+    {
+        while( !p_worker->p_first && !p_worker->b_exit )
+            vlc_cond_wait( &p_worker->wait, &p_worker->lock );
+
+        ts_worker_job_t *p_job = p_worker->p_first;
+        if( !p_job ) /* exit once everything is out */
+            break;
+
+        p_worker->p_first = p_job->p_next;
+        if( !p_worker->p_first )
+            p_worker->pp_last = &p_worker->p_first;
+        vlc_mutex_unlock( &p_worker->lock );
+
+        p_job->pf_run( p_job );
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->i_pending--;
+        if( p_worker->i_pending == 0 ||
+            p_worker->i_pending == TS_WORKER_MAX_PENDING - 1 )
+            vlc_cond_signal( &p_worker->idle );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return NULL;
+}
+
+ts_worker_t * ts_worker_New( vlc_object_t *p_obj )
+{
+    ts_worker_t *p_worker = malloc( sizeof(*p_worker) );
+    if( !p_worker )
+        return NULL;
+
+    vlc_mutex_init( &p_worker->lock );
+    vlc_cond_init( &p_worker->wait );
+    vlc_cond_init( &p_worker->idle );
+    p_worker->p_first = NULL;
+    p_worker->pp_last = &p_worker->p_first;
+    p_worker->i_pending = 0;
+    p_worker->b_exit = false;
+
+    if( vlc_clone( &p_worker->thread, Run, p_worker, VLC_THREAD_PRIORITY_INPUT ) )
+    {
+        msg_Err( p_obj, "cannot spawn program worker" );
+        free( p_worker );
+        return NULL;
+    }
+
+    return p_worker;
+}
+
+void ts_worker_Delete( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    p_worker->b_exit = true;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+
+    vlc_join( p_worker->thread, NULL );
+    assert( p_worker->p_first == NULL );
+    free( p_worker );
+}
+
+void ts_worker_Push( ts_worker_t *p_worker, ts_worker_job_t *p_job )
+{
+    p_job->p_next = NULL;
+
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_pending >= TS_WORKER_MAX_PENDING )
+        vlc_cond_wait( &p_worker->idle, &p_worker->lock );
+
+    *p_worker->pp_last = p_job;
+    p_worker->pp_last = &p_job->p_next;
+    if( p_worker->i_pending++ == 0 )
+        vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+void ts_worker_Drain( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_pending > 0 )
+        vlc_cond_wait( &p_worker->idle, &p_worker->lock );
+    vlc_mutex_unlock( &p_worker->lock );
+}
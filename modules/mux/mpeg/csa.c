@@ -28,6 +28,7 @@
 
 #include <assert.h>
 #include <vlc_common.h>
+#include <vlc_cpu.h>
 
 #include "csa.h"
 
@@ -56,6 +57,78 @@ static void csa_StreamCypher( csa_t *c, int b_init, uint8_t *ck, uint8_t *sb, ui
 
 static void csa_BlockDecypher( uint8_t kk[57], uint8_t ib[8], uint8_t bd[8] );
 static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] );
+static void csa_BlockDecypherN( const uint8_t kk[57], uint64_t *R, unsigned n );
+
+/* a packet queued for batched decryption */
+struct csa_lane
+{
+    uint8_t *pkt;
+    uint8_t *payload;
+    unsigned n;         /* number of 8 bytes blocks, at least 1 */
+    unsigned residue;
+};
+
+/* s-box inputs of csa_StreamCypher(), as (A register, bit) from MSB to LSB */
+static const uint8_t csa_sbox_in[7][5][2] =
+{
+    { {4,0}, {1,2}, {6,1}, {7,3}, {9,0} },
+    { {2,1}, {3,2}, {6,3}, {7,0}, {9,1} },
+    { {1,3}, {2,0}, {5,1}, {5,3}, {6,2} },
+    { {3,3}, {1,1}, {2,3}, {4,2}, {8,0} },
+    { {5,2}, {4,3}, {6,0}, {8,1}, {9,2} },
+    { {3,1}, {4,1}, {5,0}, {7,2}, {9,3} },
+    { {2,2}, {3,0}, {7,1}, {8,2}, {8,3} },
+};
+
+/* Transposes a 8x8 bits matrix, byte i being row i */
+static inline uint64_t csa_Transpose8x8( uint64_t x )
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & UINT64_C(0x00AA00AA00AA00AA);
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & UINT64_C(0x0000CCCC0000CCCC);
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & UINT64_C(0x00000000F0F0F0F0);
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+#define csa_word uint64_t
+#define CSA_FUNC(name) csa_##name##_64
+#define CSA_TARGET
+#include "csa_bitslice.h"
+#undef CSA_TARGET
+#undef CSA_FUNC
+#undef csa_word
+
+#if defined(__has_attribute)
+# if __has_attribute(__vector_size__)
+#  define CSA_HAS_VECTORSIZE
+# endif
+#endif
+
+#if defined(CAN_COMPILE_SSE2) && defined(CSA_HAS_VECTORSIZE)
+typedef uint8_t csa_v16 __attribute__((__vector_size__(16)));
+# define csa_word csa_v16
+# define CSA_FUNC(name) csa_##name##_sse2
+# define CSA_TARGET __attribute__((__target__("sse2")))
+# include "csa_bitslice.h"
+# undef CSA_TARGET
+# undef CSA_FUNC
+# undef csa_word
+#endif
+
+#if defined(CAN_COMPILE_AVX2) && defined(CSA_HAS_VECTORSIZE)
+typedef uint8_t csa_v32 __attribute__((__vector_size__(32)));
+# define csa_word csa_v32
+# define CSA_FUNC(name) csa_##name##_avx2
+# define CSA_TARGET __attribute__((__target__("avx2")))
+# include "csa_bitslice.h"
+# undef CSA_TARGET
+# undef CSA_FUNC
+# undef csa_word
+#endif
 
 /*****************************************************************************
  * csa_New:
@@ -221,6 +294,125 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     }
 }
 
+/*****************************************************************************
+ * csa_DecryptBatch:
+ *****************************************************************************/
+/* Below that many packets, the bitsliced code is slower than csa_Decrypt() */
+#define CSA_BATCH_MIN 8
+
+static void csa_DecryptLanes( csa_t *c, bool odd, struct csa_lane *lanes,
+                              unsigned count, int i_pkt_size )
+{
+    uint8_t *ck = odd ? c->o_ck : c->e_ck;
+    uint8_t *kk = odd ? c->o_kk : c->e_kk;
+
+    while( count > 0 )
+    {
+        unsigned done;
+
+        /* Pick the widest kernel that is at least half used */
+#if defined(CAN_COMPILE_AVX2) && defined(CSA_HAS_VECTORSIZE)
+        if( count > 128 && vlc_CPU_AVX2() )
+        {
+            done = __MIN(count, 256);
+            csa_StreamLanes_avx2( ck, lanes, done );
+        }
+        else
+#endif
+#if defined(CAN_COMPILE_SSE2) && defined(CSA_HAS_VECTORSIZE)
+        if( count > 64 && vlc_CPU_SSE2() )
+        {
+            done = __MIN(count, 128);
+            csa_StreamLanes_sse2( ck, lanes, done );
+        }
+        else
+#endif
+        if( count >= CSA_BATCH_MIN )
+        {
+            done = __MIN(count, 64);
+            csa_StreamLanes_64( ck, lanes, done );
+        }
+        else
+        {
+            for( unsigned i = 0; i < count; i++ )
+                csa_Decrypt( c, lanes[i].pkt, i_pkt_size );
+            return;
+        }
+
+        /* The stream is applied, all the blocks are now independent */
+        for( unsigned i = 0; i < done; i++ )
+        {
+            uint8_t *p = lanes[i].payload;
+            const unsigned n = lanes[i].n;
+
+            lanes[i].pkt[3] &= 0x3f;
+            for( unsigned k = 0; k < n; k += 8 )
+            {
+                const unsigned m = __MIN(n - k, 8);
+                uint64_t R[8];
+
+                for( unsigned b = 0; b < m; b++ )
+                    R[b] = GetQWLE( &p[8*(k+b)] );
+                csa_BlockDecypherN( kk, R, m );
+                for( unsigned b = 0; b < m; b++ )
+                {
+                    if( k + b + 1 < n )
+                        R[b] ^= GetQWLE( &p[8*(k+b+1)] );
+                    SetQWLE( &p[8*(k+b)], R[b] );
+                }
+            }
+        }
+
+        lanes += done;
+        count -= done;
+    }
+}
+
+void csa_DecryptBatch( csa_t *c, uint8_t *const *pp_pkts, size_t i_count,
+                       int i_pkt_size )
+{
+    struct csa_lane lanes[2][256];
+    unsigned count[2] = { 0, 0 };
+
+    for( size_t i = 0; i < i_count; i++ )
+    {
+        uint8_t *pkt = pp_pkts[i];
+
+        /* transport scrambling control */
+        if( (pkt[3]&0x80) == 0 )
+            continue;
+
+        int i_hdr = 4;
+        if( pkt[3]&0x20 )
+            i_hdr += pkt[4] + 1;
+
+        /* Leave the corner cases to the reference code */
+        if( 188 - i_hdr < 8 || i_pkt_size - i_hdr < 8 )
+        {
+            csa_Decrypt( c, pkt, i_pkt_size );
+            continue;
+        }
+
+        const bool odd = pkt[3]&0x40;
+        struct csa_lane *lane = &lanes[odd][count[odd]++];
+
+        lane->pkt = pkt;
+        lane->payload = &pkt[i_hdr];
+        lane->n = (i_pkt_size - i_hdr) / 8;
+        lane->residue = (i_pkt_size - i_hdr) % 8;
+
+        if( count[odd] == ARRAY_SIZE(lanes[odd]) )
+        {
+            csa_DecryptLanes( c, odd, lanes[odd], count[odd], i_pkt_size );
+            count[odd] = 0;
+        }
+    }
+
+    for( int odd = 0; odd < 2; odd++ )
+        if( count[odd] > 0 )
+            csa_DecryptLanes( c, odd, lanes[odd], count[odd], i_pkt_size );
+}
+
 /*****************************************************************************
  * csa_Encrypt:
  *****************************************************************************/
@@ -571,6 +763,32 @@ static void csa_BlockDecypher( uint8_t kk[57], uint8_t ib[8], uint8_t bd[8] )
     }
 }
 
+/* Same as csa_BlockDecypher() on up to 8 independent blocks, interleaved
+ * to hide the latency of the table lookups. R[k] holds R[1..8] of a block,
+ * R[1] in the least significant byte. */
+static void csa_BlockDecypherN( const uint8_t kk[57], uint64_t *R, unsigned n )
+{
+    assert( n <= 8 );
+
+    // loop over kk[56]..kk[1]
+    for( int i = 56; i > 0; i-- )
+    {
+        for( unsigned b = 0; b < n; b++ )
+        {
+            const uint64_t x = R[b];
+            const unsigned R8 = x >> 56;
+            const unsigned sbox_out = block_sbox[ kk[i] ^ ((x >> 48) & 0xff) ];
+            const uint64_t perm_out = block_perm[sbox_out];
+            const uint64_t w = R8 ^ sbox_out;
+
+            /* shift R[1..7] into R[2..8] and R[8] into R[1], then xor:
+             * R[1] ^= sbox_out, R[3..5] ^= R[8]^sbox_out, R[7] ^= perm_out */
+            R[b] = ((x << 8) | R8)
+                 ^ sbox_out ^ (w * 0x10101 << 16) ^ (perm_out << 48);
+        }
+    }
+}
+
 static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
 {
     int i;
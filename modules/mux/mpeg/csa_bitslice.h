@@ -0,0 +1,418 @@
+/*****************************************************************************
+ * csa_bitslice.h: bitsliced CSA stream cypher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* This file is included by csa.c once per machine word size, with
+ *  - csa_word: the word type, each bit of a word belongs to another packet,
+ *  - CSA_FUNC(name): decorates the names for that word size,
+ *  - CSA_TARGET: the function attributes required by that word type.
+ *
+ * The cypher state of csa_StreamCypher() is held one bit per word, so that
+ * a single pass runs the stream cypher of sizeof(csa_word)*8 packets.
+ * The s-boxes are evaluated from their algebraic normal form. */
+
+#define CSA_LANES (sizeof (csa_word) * 8)
+
+struct CSA_FUNC(state)
+{
+    csa_word A[11][4];
+    csa_word B[11][4];
+    csa_word X[4], Y[4], Z[4];
+    csa_word D[4], E[4], F[4];
+    csa_word p, q, r;
+};
+
+static inline CSA_TARGET void CSA_FUNC(sbox1)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x02 = x0 & x2;
+    const csa_word x12 = x1 & x2;
+    const csa_word x03 = x0 & x3;
+    const csa_word x13 = x1 & x3;
+    const csa_word x23 = x2 & x3;
+    const csa_word x04 = x0 & x4;
+    const csa_word x24 = x2 & x4;
+    const csa_word x34 = x3 & x4;
+    const csa_word x013 = x01 & x3;
+    const csa_word x023 = x02 & x3;
+    const csa_word x123 = x12 & x3;
+    const csa_word x014 = x01 & x4;
+    const csa_word x124 = x12 & x4;
+    const csa_word x134 = x13 & x4;
+    const csa_word x234 = x23 & x4;
+    const csa_word x0134 = x013 & x4;
+    const csa_word x0234 = x023 & x4;
+    const csa_word x1234 = x123 & x4;
+    *o0 = x1 ^ x02 ^ x3 ^ x03 ^ x013 ^ x04 ^ x34 ^ x134 ^ x234 ^ x0234;
+    *o1 = ~(x0 ^ x1 ^ x01 ^ x02 ^ x12 ^ x03 ^ x13 ^ x23 ^ x023 ^ x123 ^ x4 ^
+          x014 ^ x24 ^ x124 ^ x34 ^ x134 ^ x0134 ^ x234 ^ x1234);
+}
+
+static inline CSA_TARGET void CSA_FUNC(sbox2)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x02 = x0 & x2;
+    const csa_word x12 = x1 & x2;
+    const csa_word x03 = x0 & x3;
+    const csa_word x13 = x1 & x3;
+    const csa_word x23 = x2 & x3;
+    const csa_word x24 = x2 & x4;
+    const csa_word x34 = x3 & x4;
+    const csa_word x012 = x01 & x2;
+    const csa_word x013 = x01 & x3;
+    const csa_word x023 = x02 & x3;
+    const csa_word x014 = x01 & x4;
+    const csa_word x124 = x12 & x4;
+    const csa_word x034 = x03 & x4;
+    const csa_word x134 = x13 & x4;
+    const csa_word x234 = x23 & x4;
+    const csa_word x0134 = x013 & x4;
+    const csa_word x0234 = x023 & x4;
+    *o0 = ~(x1 ^ x2 ^ x02 ^ x013 ^ x023 ^ x014 ^ x24 ^ x34 ^ x0134 ^ x0234);
+    *o1 = ~(x0 ^ x1 ^ x02 ^ x12 ^ x012 ^ x3 ^ x124 ^ x034 ^ x134 ^ x0134 ^
+          x234);
+}
+
+static inline CSA_TARGET void CSA_FUNC(sbox3)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x02 = x0 & x2;
+    const csa_word x12 = x1 & x2;
+    const csa_word x03 = x0 & x3;
+    const csa_word x13 = x1 & x3;
+    const csa_word x23 = x2 & x3;
+    const csa_word x14 = x1 & x4;
+    const csa_word x24 = x2 & x4;
+    const csa_word x012 = x01 & x2;
+    const csa_word x013 = x01 & x3;
+    const csa_word x123 = x12 & x3;
+    const csa_word x014 = x01 & x4;
+    const csa_word x024 = x02 & x4;
+    const csa_word x124 = x12 & x4;
+    const csa_word x034 = x03 & x4;
+    const csa_word x234 = x23 & x4;
+    const csa_word x0124 = x012 & x4;
+    const csa_word x1234 = x123 & x4;
+    *o0 = x1 ^ x01 ^ x02 ^ x3 ^ x4;
+    *o1 = ~(x0 ^ x1 ^ x02 ^ x12 ^ x012 ^ x3 ^ x03 ^ x13 ^ x013 ^ x23 ^ x123 ^
+          x4 ^ x14 ^ x014 ^ x24 ^ x024 ^ x124 ^ x0124 ^ x034 ^ x234 ^ x1234);
+}
+
+static inline CSA_TARGET void CSA_FUNC(sbox4)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x12 = x1 & x2;
+    const csa_word x03 = x0 & x3;
+    const csa_word x23 = x2 & x3;
+    const csa_word x04 = x0 & x4;
+    const csa_word x14 = x1 & x4;
+    const csa_word x34 = x3 & x4;
+    const csa_word x012 = x01 & x2;
+    const csa_word x013 = x01 & x3;
+    const csa_word x123 = x12 & x3;
+    const csa_word x034 = x03 & x4;
+    const csa_word x234 = x23 & x4;
+    const csa_word x0124 = x012 & x4;
+    const csa_word x0134 = x013 & x4;
+    const csa_word x1234 = x123 & x4;
+    *o0 = ~(x1 ^ x01 ^ x2 ^ x03 ^ x013 ^ x23 ^ x04 ^ x14 ^ x0124 ^ x34 ^ x034 ^
+          x0134 ^ x234 ^ x1234);
+    *o1 = ~(x0 ^ x01 ^ x2 ^ x012 ^ x3 ^ x123 ^ x4 ^ x04 ^ x14 ^ x0124 ^ x34 ^
+          x034 ^ x0134 ^ x234 ^ x1234);
+}
+
+static inline CSA_TARGET void CSA_FUNC(sbox5)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x02 = x0 & x2;
+    const csa_word x12 = x1 & x2;
+    const csa_word x03 = x0 & x3;
+    const csa_word x13 = x1 & x3;
+    const csa_word x04 = x0 & x4;
+    const csa_word x14 = x1 & x4;
+    const csa_word x24 = x2 & x4;
+    const csa_word x34 = x3 & x4;
+    const csa_word x012 = x01 & x2;
+    const csa_word x013 = x01 & x3;
+    const csa_word x023 = x02 & x3;
+    const csa_word x123 = x12 & x3;
+    const csa_word x024 = x02 & x4;
+    const csa_word x124 = x12 & x4;
+    const csa_word x034 = x03 & x4;
+    const csa_word x134 = x13 & x4;
+    const csa_word x0124 = x012 & x4;
+    const csa_word x0134 = x013 & x4;
+    const csa_word x0234 = x023 & x4;
+    const csa_word x1234 = x123 & x4;
+    *o0 = x01 ^ x2 ^ x02 ^ x012 ^ x03 ^ x13 ^ x023 ^ x04 ^ x24 ^ x024 ^ x124 ^
+          x0124 ^ x34 ^ x034 ^ x134 ^ x0134;
+    *o1 = ~(x0 ^ x1 ^ x01 ^ x02 ^ x12 ^ x012 ^ x3 ^ x03 ^ x013 ^ x023 ^ x123 ^
+          x04 ^ x14 ^ x24 ^ x124 ^ x0124 ^ x034 ^ x134 ^ x0234 ^ x1234);
+}
+
+static inline CSA_TARGET void CSA_FUNC(sbox6)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x02 = x0 & x2;
+    const csa_word x12 = x1 & x2;
+    const csa_word x03 = x0 & x3;
+    const csa_word x13 = x1 & x3;
+    const csa_word x23 = x2 & x3;
+    const csa_word x012 = x01 & x2;
+    const csa_word x013 = x01 & x3;
+    const csa_word x023 = x02 & x3;
+    const csa_word x123 = x12 & x3;
+    const csa_word x014 = x01 & x4;
+    const csa_word x124 = x12 & x4;
+    const csa_word x034 = x03 & x4;
+    const csa_word x0124 = x012 & x4;
+    const csa_word x0134 = x013 & x4;
+    const csa_word x1234 = x123 & x4;
+    *o0 = x0 ^ x2 ^ x12 ^ x012 ^ x13 ^ x23 ^ x123 ^ x014 ^ x124 ^ x0124 ^ x0134
+          ^ x1234;
+    *o1 = x1 ^ x02 ^ x013 ^ x23 ^ x023 ^ x4 ^ x014 ^ x034;
+}
+
+static inline CSA_TARGET void CSA_FUNC(sbox7)(const csa_word x[5],
+                                      csa_word *o0, csa_word *o1)
+{
+    const csa_word x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], x4 = x[4];
+    const csa_word x01 = x0 & x1;
+    const csa_word x12 = x1 & x2;
+    const csa_word x13 = x1 & x3;
+    const csa_word x23 = x2 & x3;
+    const csa_word x04 = x0 & x4;
+    const csa_word x24 = x2 & x4;
+    const csa_word x012 = x01 & x2;
+    const csa_word x013 = x01 & x3;
+    const csa_word x123 = x12 & x3;
+    const csa_word x014 = x01 & x4;
+    const csa_word x124 = x12 & x4;
+    const csa_word x134 = x13 & x4;
+    const csa_word x0124 = x012 & x4;
+    const csa_word x0134 = x013 & x4;
+    const csa_word x1234 = x123 & x4;
+    *o0 = x0 ^ x01 ^ x2 ^ x12 ^ x012 ^ x3 ^ x23 ^ x4 ^ x134 ^ x0134;
+    *o1 = x0 ^ x1 ^ x01 ^ x2 ^ x3 ^ x013 ^ x04 ^ x014 ^ x24 ^ x124 ^ x0124 ^
+          x0134 ^ x1234;
+}
+
+static inline CSA_TARGET void CSA_FUNC(select)(csa_word x[5],
+                                               const csa_word A[11][4],
+                                               const uint8_t in[5][2])
+{
+    for( int i = 0; i < 5; i++ )
+        x[4 - i] = A[in[i][0]][in[i][1]];
+}
+
+/* One iteration of csa_StreamCypher(): 2 output bits per packet.
+ * in_a and in_b are the input nibbles during initialisation, NULL after. */
+static inline CSA_TARGET void CSA_FUNC(step)( struct CSA_FUNC(state) *s,
+                                              const csa_word *in_a,
+                                              const csa_word *in_b,
+                                              csa_word *out_hi,
+                                              csa_word *out_lo )
+{
+    csa_word x[5], o[7][2];
+    csa_word extra_B[4], next_A1[4], next_B1[4], next_D[4], next_F[4];
+    csa_word carry;
+
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[0] ); CSA_FUNC(sbox1)( x, &o[0][0], &o[0][1] );
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[1] ); CSA_FUNC(sbox2)( x, &o[1][0], &o[1][1] );
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[2] ); CSA_FUNC(sbox3)( x, &o[2][0], &o[2][1] );
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[3] ); CSA_FUNC(sbox4)( x, &o[3][0], &o[3][1] );
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[4] ); CSA_FUNC(sbox5)( x, &o[4][0], &o[4][1] );
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[5] ); CSA_FUNC(sbox6)( x, &o[5][0], &o[5][1] );
+    CSA_FUNC(select)( x, s->A, csa_sbox_in[6] ); CSA_FUNC(sbox7)( x, &o[6][0], &o[6][1] );
+
+    /* use 4x4 xor to produce extra nibble for T3 */
+    extra_B[3] = s->B[3][0] ^ s->B[6][1] ^ s->B[7][2] ^ s->B[9][3];
+    extra_B[2] = s->B[6][0] ^ s->B[8][1] ^ s->B[3][3] ^ s->B[4][2];
+    extra_B[1] = s->B[5][3] ^ s->B[8][2] ^ s->B[4][0] ^ s->B[5][1];
+    extra_B[0] = s->B[9][2] ^ s->B[6][3] ^ s->B[3][1] ^ s->B[8][0];
+
+    carry = s->r;
+    for( int b = 0; b < 4; b++ )
+    {
+        /* T1 and T2, with the inputs during initialisation */
+        next_A1[b] = s->A[10][b] ^ s->X[b];
+        next_B1[b] = s->B[7][b] ^ s->B[10][b] ^ s->Y[b];
+        if( in_a != NULL )
+        {
+            next_A1[b] ^= s->D[b] ^ in_a[b];
+            next_B1[b] ^= in_b[b];
+        }
+
+        /* T3 */
+        next_D[b] = s->E[b] ^ s->Z[b] ^ extra_B[b];
+
+        /* T4: F = q ? Z + E + r : E */
+        const csa_word zxe = s->Z[b] ^ s->E[b];
+        const csa_word sum = zxe ^ carry;
+        carry = (s->Z[b] & s->E[b]) | (carry & zxe);
+        next_F[b] = s->E[b] ^ (s->q & (sum ^ s->E[b]));
+    }
+
+    /* if p=1, rotate T2 left */
+    csa_word rot[4];
+    for( int b = 0; b < 4; b++ )
+        rot[b] = next_B1[b] ^ (s->p & (next_B1[b] ^ next_B1[(b + 3) & 3]));
+
+    s->r ^= s->q & (carry ^ s->r);
+    for( int b = 0; b < 4; b++ )
+    {
+        s->E[b] = s->F[b];
+        s->F[b] = next_F[b];
+        s->D[b] = next_D[b];
+    }
+
+    for( int k = 10; k > 1; k-- )
+        for( int b = 0; b < 4; b++ )
+        {
+            s->A[k][b] = s->A[k-1][b];
+            s->B[k][b] = s->B[k-1][b];
+        }
+    for( int b = 0; b < 4; b++ )
+    {
+        s->A[1][b] = next_A1[b];
+        s->B[1][b] = rot[b];
+    }
+
+    s->X[0] = o[0][1]; s->X[1] = o[1][1]; s->X[2] = o[2][0]; s->X[3] = o[3][0];
+    s->Y[0] = o[2][1]; s->Y[1] = o[3][1]; s->Y[2] = o[4][0]; s->Y[3] = o[5][0];
+    s->Z[0] = o[4][1]; s->Z[1] = o[5][1]; s->Z[2] = o[0][0]; s->Z[3] = o[1][0];
+    s->p = o[6][1];
+    s->q = o[6][0];
+
+    /* 2 output bits are a function of the 4 bits of D */
+    *out_hi = s->D[2] ^ s->D[3];
+    *out_lo = s->D[0] ^ s->D[1];
+}
+
+/* Runs the stream cypher of up to CSA_LANES packets at once, and xors the
+ * generated stream into their payload (blocks 2 to n and the residue).
+ * The block decypher is left to the caller. */
+static CSA_TARGET void CSA_FUNC(StreamLanes)( const uint8_t ck[8],
+                                              const struct csa_lane *lanes,
+                                              unsigned count )
+{
+    struct CSA_FUNC(state) s;
+    csa_word zero, ones;
+    csa_word in[8][8];
+    uint8_t planes[8][sizeof (csa_word)];
+    unsigned gens = 0;
+
+    assert( count > 0 && count <= CSA_LANES );
+
+    memset( &zero, 0, sizeof (zero) );
+    memset( &ones, 0xff, sizeof (ones) );
+
+    /* transpose the first block of each packet, it initialises the cypher */
+    for( unsigned i = 0; i < 8; i++ )
+    {
+        memset( planes, 0, sizeof (planes) );
+        for( unsigned g = 0; g * 8 < count; g++ )
+        {
+            uint64_t t = 0;
+            for( unsigned l = 0; l < 8 && g * 8 + l < count; l++ )
+                t |= (uint64_t)lanes[g * 8 + l].payload[i] << (8 * l);
+            t = csa_Transpose8x8( t );
+            for( unsigned b = 0; b < 8; b++ )
+                planes[b][g] = t >> (8 * b);
+        }
+        for( unsigned b = 0; b < 8; b++ )
+            memcpy( &in[i][b], planes[b], sizeof (csa_word) );
+    }
+
+    for( unsigned l = 0; l < count; l++ )
+    {
+        unsigned n = lanes[l].n - 1 + (lanes[l].residue > 0);
+        if( n > gens )
+            gens = n;
+    }
+
+    /* load first 32 bits of CK into A[1]..A[8], last into B[1]..B[8],
+     * all other regs = 0 */
+    memset( &s, 0, sizeof (s) );
+    for( int i = 0; i < 4; i++ )
+        for( int b = 0; b < 4; b++ )
+        {
+            s.A[1+2*i+0][b] = ((ck[i] >> (4 + b)) & 1) ? ones : zero;
+            s.A[1+2*i+1][b] = ((ck[i] >> b) & 1) ? ones : zero;
+            s.B[1+2*i+0][b] = ((ck[4+i] >> (4 + b)) & 1) ? ones : zero;
+            s.B[1+2*i+1][b] = ((ck[4+i] >> b) & 1) ? ones : zero;
+        }
+
+    for( unsigned i = 0; i < 8; i++ )
+    {
+        const csa_word *in1 = &in[i][4], *in2 = &in[i][0];
+        csa_word hi, lo;
+
+        for( int j = 0; j < 4; j++ )
+            CSA_FUNC(step)( &s, (j % 2) ? in2 : in1, (j % 2) ? in1 : in2,
+                            &hi, &lo );
+    }
+
+    for( unsigned m = 0; m < gens; m++ )
+    {
+        for( unsigned i = 0; i < 8; i++ )
+        {
+            csa_word ob[8];
+
+            for( int j = 0; j < 4; j++ )
+                CSA_FUNC(step)( &s, NULL, NULL, &ob[7-2*j], &ob[6-2*j] );
+
+            for( unsigned b = 0; b < 8; b++ )
+                memcpy( planes[b], &ob[b], sizeof (csa_word) );
+
+            for( unsigned g = 0; g * 8 < count; g++ )
+            {
+                uint64_t t = 0;
+                for( unsigned b = 0; b < 8; b++ )
+                    t |= (uint64_t)planes[b][g] << (8 * b);
+                t = csa_Transpose8x8( t );
+
+                for( unsigned l = 0; l < 8 && g * 8 + l < count; l++ )
+                {
+                    const struct csa_lane *lane = &lanes[g * 8 + l];
+                    const uint8_t stream = t >> (8 * l);
+
+                    if( m + 1 < lane->n )
+                        lane->payload[8 * (m + 1) + i] ^= stream;
+                    else if( m + 1 == lane->n && i < lane->residue )
+                        lane->payload[8 * lane->n + i] ^= stream;
+                }
+            }
+        }
+    }
+}
+
+#undef CSA_LANES
@@ -231,6 +231,37 @@ static ssize_t AStreamReadBlock(stream_t *s, void *buf, size_t len)
     return i_copy;
 }
 
+/* Hands the cached blocks over as they are, without copying them */
+static block_t *AStreamBlock(stream_t *s, bool *restrict eof)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    if (block_BytestreamRemaining( &sys->cache ) == 0 &&
+        AStreamRefillBlock(s) == VLC_EGENERIC)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    block_BytestreamFlush( &sys->cache );
+
+    block_t *block = sys->cache.p_block;
+    if (block == NULL)
+        return NULL;
+
+    sys->cache.p_chain = sys->cache.p_block = block->p_next;
+    if (sys->cache.p_chain == NULL)
+        sys->cache.pp_last = &sys->cache.p_chain;
+    sys->cache.i_total -= block->i_buffer;
+    block->p_next = NULL;
+
+    /* Partly read through vlc_stream_Read() */
+    block->p_buffer += sys->cache.i_block_offset;
+    block->i_buffer -= sys->cache.i_block_offset;
+    sys->cache.i_block_offset = 0;
+    return block;
+}
+
 /****************************************************************************
  * AStreamControl:
  ****************************************************************************/
@@ -302,6 +333,7 @@ static int Open(vlc_object_t *obj)
     }
 
     s->pf_read = AStreamReadBlock;
+    s->pf_block = AStreamBlock;
     s->pf_seek = AStreamSeekBlock;
     s->pf_control = AStreamControl;
     return VLC_SUCCESS;
@@ -35,6 +35,9 @@
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
 
+/* Initial buffer size in adaptive mode */
+#define PREFETCH_ADAPTIVE_MIN (1 << 19)
+
 struct stream_ctrl
 {
     struct stream_ctrl *next;
@@ -73,8 +76,25 @@ typedef struct
     size_t       buffer_length;
     size_t       buffer_size;
     char        *buffer;
+    size_t       buffer_max; /* adaptive mode growth limit, 0 if fixed */
     size_t       seek_threshold;
 
+    struct
+    {
+        /* Consumer rate */
+        uint64_t     consumed; /* bytes read since rate_start */
+        vlc_tick_t   rate_start;
+        uint64_t     rate; /* bytes per second */
+        /* Upstream */
+        uint64_t     input_bytes;
+        vlc_tick_t   input_time;
+        vlc_tick_t   latency; /* decaying peak of the read latency */
+        /* Consumer reads served without waiting, or after waiting */
+        unsigned long hits;
+        unsigned long misses;
+        vlc_tick_t   stall_time;
+    } stats;
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
@@ -85,9 +105,20 @@ static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
     vlc_mutex_unlock(&sys->lock);
     assert(length > 0);
 
+    vlc_tick_t start = vlc_tick_now();
     ssize_t val = vlc_stream_ReadPartial(stream->s, buf, length);
+    vlc_tick_t latency = vlc_tick_now() - start;
 
     vlc_mutex_lock(&sys->lock);
+    if (val > 0)
+    {
+        sys->stats.input_bytes += val;
+        sys->stats.input_time += latency;
+        if (latency > sys->stats.latency)
+            sys->stats.latency = latency;
+        else
+            sys->stats.latency -= (sys->stats.latency - latency) / 16;
+    }
     return val;
 }
 
@@ -123,6 +154,86 @@ static int ThreadControl(stream_t *stream, int query, ...)
     return ret;
 }
 
+static void ThreadResize(stream_t *stream, size_t size)
+{
+    stream_sys_t *sys = stream->p_sys;
+    char *buffer = malloc(size);
+
+    if (buffer == NULL)
+    {   /* Keep going with the current buffer */
+        sys->buffer_max = sys->buffer_size;
+        return;
+    }
+
+    /* Move the buffered data to its offset in the larger circular buffer */
+    uint64_t end = sys->buffer_offset + sys->buffer_length;
+
+    for (uint64_t pos = sys->buffer_offset; pos < end;)
+    {
+        size_t from = pos % sys->buffer_size;
+        size_t to = pos % size;
+        size_t len = end - pos;
+
+        if (len > sys->buffer_size - from)
+            len = sys->buffer_size - from;
+        if (len > size - to)
+            len = size - to;
+        memcpy(buffer + to, sys->buffer + from, len);
+        pos += len;
+    }
+
+    free(sys->buffer);
+    sys->buffer = buffer;
+    sys->buffer_size = size;
+}
+
+/**
+ * Updates the consumer rate, and in adaptive mode grows the buffer so that it
+ * covers what is consumed while upstream reads are outstanding.
+ */
+static void ThreadAdapt(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t elapsed = now - sys->stats.rate_start;
+
+    if (elapsed < VLC_TICK_FROM_SEC(1))
+        return;
+
+    uint64_t rate = sys->stats.consumed * CLOCK_FREQ / elapsed;
+
+    sys->stats.rate = sys->stats.rate ? (3 * sys->stats.rate + rate) / 4
+                                      : rate;
+    sys->stats.consumed = 0;
+    sys->stats.rate_start = now;
+
+    if (sys->buffer_size >= sys->buffer_max)
+        return;
+
+    /* Cover a few slow reads, less of them if upstream catches up fast */
+    uint64_t throughput = 0;
+    if (sys->stats.input_time > 0)
+        throughput = sys->stats.input_bytes * CLOCK_FREQ
+                     / sys->stats.input_time;
+
+    unsigned margin = (throughput > 2 * sys->stats.rate) ? 2 : 4;
+    uint64_t target = margin * sys->stats.rate * sys->stats.latency
+                      / CLOCK_FREQ;
+    if (target <= sys->buffer_size)
+        return;
+
+    size_t size = sys->buffer_size;
+    while (size < target && size < sys->buffer_max)
+        size *= 2;
+    if (size > sys->buffer_max)
+        size = sys->buffer_max;
+
+    msg_Dbg(stream, "growing buffer to %zu bytes (consumed %"PRIu64" B/s, "
+            "input %"PRIu64" B/s, latency %"PRId64" ms)", size,
+            sys->stats.rate, throughput, MS_FROM_VLC_TICK(sys->stats.latency));
+    ThreadResize(stream, size);
+}
+
 static void *Thread(void *data)
 {
     stream_t *stream = data;
@@ -150,6 +261,9 @@ static void *Thread(void *data)
             msg_Dbg(stream, paused ? "resuming" : "pausing");
             paused = sys->paused;
             ThreadControl(stream, STREAM_SET_PAUSE_STATE, paused);
+            /* Do not account the pause in the consumer rate */
+            sys->stats.consumed = 0;
+            sys->stats.rate_start = vlc_tick_now();
             continue;
         }
 
@@ -186,6 +300,8 @@ static void *Thread(void *data)
 
         assert(stream_offset >= sys->buffer_offset);
 
+        ThreadAdapt(stream);
+
         /* As long as there is space, the buffer will retain already read
          * ("historical") data. The data can be used if/when seeking backward.
          * Unread data is however given precedence if the buffer is full. */
@@ -311,6 +427,8 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_cond_signal(&sys->wait_space);
     }
 
+    vlc_tick_t stall = VLC_TICK_INVALID;
+
     while ((copy = BufferLevel(stream, &eof)) == 0 && !eof)
     {
         void *data[2];
@@ -321,6 +439,9 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
             return 0;
         }
 
+        if (stall == VLC_TICK_INVALID)
+            stall = vlc_tick_now();
+
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
@@ -335,6 +456,15 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 
     memcpy(buf, sys->buffer + offset, copy);
     sys->stream_offset += copy;
+
+    if (stall != VLC_TICK_INVALID)
+    {
+        sys->stats.misses++;
+        sys->stats.stall_time += vlc_tick_now() - stall;
+    }
+    else
+        sys->stats.hits++;
+    sys->stats.consumed += copy;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -474,6 +604,15 @@ static int Open(vlc_object_t *obj)
             sys->buffer_size = size;
     }
 
+    sys->buffer_max = sys->buffer_size;
+    if (var_InheritBool(obj, "prefetch-adaptive")
+     && sys->buffer_size > PREFETCH_ADAPTIVE_MIN)
+        /* Start small, grow from the measured rates */
+        sys->buffer_size = PREFETCH_ADAPTIVE_MIN;
+
+    memset(&sys->stats, 0, sizeof (sys->stats));
+    sys->stats.rate_start = vlc_tick_now();
+
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
@@ -524,6 +663,12 @@ static void Close (vlc_object_t *obj)
     vlc_join(sys->thread, NULL);
     vlc_interrupt_destroy(sys->interrupt);
 
+    msg_Dbg(stream, "%lu hits, %lu misses, stalled %"PRId64" ms, "
+            "%zu bytes buffer, input %"PRIu64" bytes in %"PRId64" ms",
+            sys->stats.hits, sys->stats.misses,
+            MS_FROM_VLC_TICK(sys->stats.stall_time), sys->buffer_size,
+            sys->stats.input_bytes, MS_FROM_VLC_TICK(sys->stats.input_time));
+
     while(sys->controls)
     {
         struct stream_ctrl *ctrl = sys->controls;
@@ -546,6 +691,9 @@ vlc_module_begin()
                 N_("Prefetch buffer size (KiB)"))
         change_integer_range(4, 1 << 20)
     add_obsolete_integer("prefetch-read-size") /* since 4.0.0 */
+    add_bool("prefetch-adaptive", false, N_("Adaptive buffer size"),
+             N_("Start with a small buffer and grow it, up to the buffer "
+                "size, from the measured consumption rate and read latency."))
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"))
         change_integer_range(0, UINT64_C(1) << 60)
@@ -52,8 +52,21 @@ static int Send( sout_stream_t *p_stream, void *id, block_t *p_buffer )
     return VLC_SUCCESS;
 }
 
+static int Control( sout_stream_t *p_stream, int i_query, va_list args )
+{
+    VLC_UNUSED(p_stream);
+
+    switch( i_query )
+    {
+        case SOUT_STREAM_IS_READONLY:
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
 static const struct sout_stream_operations ops = {
-    Add, Del, Send, NULL, NULL,
+    Add, Del, Send, Control, NULL,
 };
 
 /*****************************************************************************
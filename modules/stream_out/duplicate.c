@@ -29,6 +29,7 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_plugin.h>
 #include <vlc_sout.h>
 #include <vlc_block.h>
@@ -66,6 +67,11 @@ typedef struct
 
     int             i_nb_select;
     char            **ppsz_select;
+
+    /* Outputs that never write to the block payload, see
+     * sout_StreamIsReadOnly() */
+    int             i_nb_readonly;
+    bool            *pb_readonly;
 } sout_stream_sys_t;
 
 typedef struct
@@ -77,6 +83,76 @@ typedef struct
 static bool ESSelected( struct vlc_logger *, const es_format_t *fmt,
                         char *psz_select );
 
+/*****************************************************************************
+ * Shared blocks:
+ *****************************************************************************
+ * Read-only outputs are handed lightweight blocks pointing to the payload of
+ * the input block instead of a full copy of it. The input block is released
+ * once the last of those is released.
+ *****************************************************************************/
+typedef struct
+{
+    vlc_atomic_rc_t rc;
+    block_t         *p_block;
+} shared_payload_t;
+
+typedef struct
+{
+    block_t             self;
+    shared_payload_t    *p_payload;
+} shared_block_t;
+
+static shared_payload_t *SharedPayloadNew( block_t *p_block )
+{
+    shared_payload_t *p_payload = malloc( sizeof( *p_payload ) );
+    if( unlikely(p_payload == NULL) )
+        return NULL;
+
+    vlc_atomic_rc_init( &p_payload->rc );
+    p_payload->p_block = p_block;
+    return p_payload;
+}
+
+static void SharedPayloadRelease( shared_payload_t *p_payload )
+{
+    if( vlc_atomic_rc_dec( &p_payload->rc ) )
+    {
+        block_Release( p_payload->p_block );
+        free( p_payload );
+    }
+}
+
+static void SharedBlockRelease( block_t *p_block )
+{
+    shared_block_t *p_shared = container_of( p_block, shared_block_t, self );
+
+    SharedPayloadRelease( p_shared->p_payload );
+    free( p_shared );
+}
+
+static const struct vlc_block_callbacks shared_block_cbs =
+{
+    SharedBlockRelease,
+};
+
+static block_t *SharedBlockNew( shared_payload_t *p_payload )
+{
+    block_t *p_block = p_payload->p_block;
+    shared_block_t *p_shared = malloc( sizeof( *p_shared ) );
+    if( unlikely(p_shared == NULL) )
+        return NULL;
+
+    /* There is no room around the payload, so that block_Realloc() always
+     * copies it rather than writing to the shared buffer. */
+    block_Init( &p_shared->self, &shared_block_cbs,
+                p_block->p_buffer, p_block->i_buffer );
+    block_CopyProperties( &p_shared->self, p_block );
+
+    vlc_atomic_rc_inc( &p_payload->rc );
+    p_shared->p_payload = p_payload;
+    return &p_shared->self;
+}
+
 /*****************************************************************************
  * Control
  *****************************************************************************/
@@ -99,6 +175,16 @@ static int Control( sout_stream_t *p_stream, int i_query, va_list args )
             }
             return VLC_SUCCESS;
         }
+
+        case SOUT_STREAM_IS_READONLY:
+        {
+            bool *pb_readonly = va_arg( args, bool * );
+
+            *pb_readonly = true;
+            for( int i = 0; i < p_sys->i_nb_readonly; i++ )
+                *pb_readonly = *pb_readonly && p_sys->pb_readonly[i];
+            return VLC_SUCCESS;
+        }
     }
 
     return VLC_EGENERIC;
@@ -125,6 +211,7 @@ static int Open( vlc_object_t *p_this )
 
     TAB_INIT( p_sys->i_nb_streams, p_sys->pp_streams );
     TAB_INIT( p_sys->i_nb_select, p_sys->ppsz_select );
+    TAB_INIT( p_sys->i_nb_readonly, p_sys->pb_readonly );
 
     char **ppsz_select = NULL;
 
@@ -140,8 +227,14 @@ static int Open( vlc_object_t *p_this )
 
             if( s )
             {
+                bool b_readonly = sout_StreamIsReadOnly( s );
+
+                if( b_readonly )
+                    msg_Dbg( p_stream, " * output shares its input" );
                 TAB_APPEND( p_sys->i_nb_streams, p_sys->pp_streams, s );
                 TAB_APPEND( p_sys->i_nb_select,  p_sys->ppsz_select, NULL );
+                TAB_APPEND( p_sys->i_nb_readonly, p_sys->pb_readonly,
+                            b_readonly );
                 ppsz_select = &p_sys->ppsz_select[p_sys->i_nb_select - 1];
             }
         }
@@ -198,6 +291,7 @@ static void Close( vlc_object_t * p_this )
     }
     free( p_sys->pp_streams );
     free( p_sys->ppsz_select );
+    free( p_sys->pb_readonly );
 
     free( p_sys );
 }
@@ -289,37 +383,59 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     sout_stream_sys_t *p_sys = p_stream->p_sys;
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
     sout_stream_t     *p_dup_stream;
-    int               i_stream;
+    int               i_stream, i_last = -1, i_nb_readonly = 0;
+
+    for( i_stream = 0; i_stream < p_sys->i_nb_streams; i_stream++ )
+    {
+        if( id->pp_ids[i_stream] )
+        {
+            i_last = i_stream;
+            if( p_sys->pb_readonly[i_stream] )
+                i_nb_readonly++;
+        }
+    }
 
     /* Loop through the linked list of buffers */
     while( p_buffer )
     {
         block_t *p_next = p_buffer->p_next;
+        shared_payload_t *p_payload = NULL;
 
         p_buffer->p_next = NULL;
 
-        for( i_stream = 0; i_stream < p_sys->i_nb_streams - 1; i_stream++ )
+        /* Share the payload between read-only outputs unless a single
+         * output would get it anyway */
+        if( i_nb_readonly > 1 ||
+            ( i_nb_readonly == 1 && !p_sys->pb_readonly[i_last] ) )
+            p_payload = SharedPayloadNew( p_buffer );
+
+        for( i_stream = 0; i_stream < p_sys->i_nb_streams; i_stream++ )
         {
+            block_t *p_dup;
+
+            if( !id->pp_ids[i_stream] )
+                continue;
+
             p_dup_stream = p_sys->pp_streams[i_stream];
 
-            if( id->pp_ids[i_stream] )
+            if( p_payload && p_sys->pb_readonly[i_stream] )
+                p_dup = SharedBlockNew( p_payload );
+            else if( i_stream == i_last && !p_payload )
             {
-                block_t *p_dup = block_Duplicate( p_buffer );
-
-                if( p_dup )
-                    sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
+                p_dup = p_buffer;
+                p_buffer = NULL;
             }
-        }
+            else
+                p_dup = block_Duplicate( p_buffer );
 
-        if( i_stream < p_sys->i_nb_streams && id->pp_ids[i_stream] )
-        {
-            p_dup_stream = p_sys->pp_streams[i_stream];
-            sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_buffer );
+            if( p_dup )
+                sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
         }
-        else
-        {
+
+        if( p_payload )
+            SharedPayloadRelease( p_payload );
+        else if( p_buffer )
             block_Release( p_buffer );
-        }
 
         p_buffer = p_next;
     }
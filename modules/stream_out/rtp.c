@@ -358,7 +358,7 @@ struct sout_stream_id_sys_t
 
 static int Control(sout_stream_t *stream, int query, va_list args)
 {
-    (void) stream;
+    sout_stream_sys_t *sys = stream->p_sys;
 
     switch (query)
     {
@@ -366,6 +366,12 @@ static int Control(sout_stream_t *stream, int query, va_list args)
             *va_arg(args, bool *) = true;
             break;
 
+        case SOUT_STREAM_IS_READONLY:
+            /* The RTP packetizers copy the payload into new packets, but
+             * muxers may rewrite it in place. */
+            *va_arg(args, bool *) = sys->p_mux == NULL;
+            break;
+
         default:
             return VLC_EGENERIC;
     }
@@ -102,6 +102,7 @@ typedef struct
     sout_mux_t           *p_mux;
     session_descriptor_t *p_session;
     bool                  synchronous;
+    bool                  readonly;
 } sout_stream_sys_t;
 
 static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
@@ -234,6 +235,19 @@ static void checkAccessMux( sout_stream_t *p_stream, char *psz_access,
         msg_Err( p_stream, "mov and mp4 mux are only valid with file output" );
 }
 
+static bool isReadOnlyMux( const char *psz_mux )
+{
+    return exactMatch( psz_mux, "raw", 3 ) || exactMatch( psz_mux, "es", 2 ) ||
+           exactMatch( psz_mux, "dummy", 5 );
+}
+
+static bool isReadOnlyAccess( const char *psz_access )
+{
+    return exactMatch( psz_access, "file", 4 ) ||
+           exactMatch( psz_access, "stream", 6 ) ||
+           exactMatch( psz_access, "fd", 2 );
+}
+
 static int Control(sout_stream_t *stream, int query, va_list args)
 {
     sout_stream_sys_t *sys = stream->p_sys;
@@ -244,6 +258,10 @@ static int Control(sout_stream_t *stream, int query, va_list args)
             *va_arg(args, bool *) = sys->synchronous;
             break;
 
+        case SOUT_STREAM_IS_READONLY:
+            *va_arg(args, bool *) = sys->readonly;
+            break;
+
         default:
             return VLC_EGENERIC;
     }
@@ -317,6 +335,7 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->synchronous = !sout_AccessOutCanControlPace(p_access);
     p_sys->p_mux = sout_MuxNew( p_access, psz_mux );
+    const char *psz_mux_used = psz_mux;
     if( !p_sys->p_mux )
     {
         const char *psz_mux_guess = getMuxFromAlias( psz_mux );
@@ -325,6 +344,7 @@ static int Open( vlc_object_t *p_this )
             msg_Dbg( p_stream, "Couldn't open mux `%s', trying `%s' instead",
                 psz_mux, psz_mux_guess );
             p_sys->p_mux = sout_MuxNew( p_access, psz_mux_guess );
+            psz_mux_used = psz_mux_guess;
         }
 
         if( !p_sys->p_mux )
@@ -337,6 +357,12 @@ static int Open( vlc_object_t *p_this )
         }
     }
 
+    /* The raw muxer hands the blocks as is to the access, and the file
+     * access only reads them. Other muxers may rewrite the payload in place,
+     * e.g. the MPEG muxers reuse the room of the data they strip. */
+    p_sys->readonly = isReadOnlyMux( psz_mux_used ) &&
+                      isReadOnlyAccess( psz_access );
+
     p_stream->ops = &ops;
     ret = VLC_SUCCESS;
     msg_Dbg( p_this, "using `%s/%s://%s'", psz_access, psz_mux, psz_url );
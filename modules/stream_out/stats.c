@@ -204,8 +204,25 @@ static int OutputSend(sout_stream_t *stream, void *id, block_t *block)
     return VLC_SUCCESS;
 }
 
+static int OutputControl(sout_stream_t *stream, int query, va_list args)
+{
+    (void) stream;
+
+    switch (query)
+    {
+        case SOUT_STREAM_IS_READONLY:
+            *va_arg(args, bool *) = true;
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+
+    return VLC_SUCCESS;
+}
+
 static const struct sout_stream_operations output_ops = {
-    Add, Del, OutputSend, NULL, NULL,
+    Add, Del, OutputSend, OutputControl, NULL,
 };
 
 static int OutputOpen(vlc_object_t *obj)
@@ -250,8 +267,23 @@ static int FilterSend(sout_stream_t *stream, void *opaque, block_t *block)
     return sout_StreamIdSend(stream->p_next, id->next_id, block);
 }
 
+static int FilterControl(sout_stream_t *stream, int query, va_list args)
+{
+    switch (query)
+    {
+        case SOUT_STREAM_IS_READONLY:
+            *va_arg(args, bool *) = sout_StreamIsReadOnly(stream->p_next);
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+
+    return VLC_SUCCESS;
+}
+
 static const struct sout_stream_operations filter_ops = {
-    FilterAdd, FilterDel, FilterSend, NULL, NULL,
+    FilterAdd, FilterDel, FilterSend, FilterControl, NULL,
 };
 
 static int FilterOpen(vlc_object_t *obj)
@@ -175,6 +175,20 @@ block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
     return p_data;
 }
 
+void transcode_encoder_get_stats( transcode_encoder_t *p_enc,
+                                  transcode_stage_stats_t *p_stats )
+{
+    if( p_enc->p_encoder->fmt_in.i_cat != VIDEO_ES )
+    {
+        memset( p_stats, 0, sizeof(*p_stats) );
+        return;
+    }
+
+    vlc_mutex_lock( &p_enc->lock_out );
+    *p_stats = p_enc->stats;
+    vlc_mutex_unlock( &p_enc->lock_out );
+}
+
 void transcode_encoder_close( transcode_encoder_t *p_enc )
 {
     if( !p_enc->p_encoder->p_module )
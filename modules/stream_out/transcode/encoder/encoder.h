@@ -23,6 +23,33 @@
 
 typedef struct transcode_encoder_t transcode_encoder_t;
 
+/* Statistics of one stage of the transcoding pipeline */
+typedef struct
+{
+    uint64_t        i_count;        /* processed items */
+    vlc_tick_t      i_total;        /* time spent processing them */
+    vlc_tick_t      i_max;          /* longest processing time */
+    uint64_t        i_queued_total; /* input queue depth, summed on each push */
+    unsigned        i_queued_max;   /* deepest input queue */
+} transcode_stage_stats_t;
+
+static inline void transcode_stage_stats_add( transcode_stage_stats_t *p_stats,
+                                              vlc_tick_t i_duration )
+{
+    p_stats->i_count++;
+    p_stats->i_total += i_duration;
+    if( i_duration > p_stats->i_max )
+        p_stats->i_max = i_duration;
+}
+
+static inline void transcode_stage_stats_queued( transcode_stage_stats_t *p_stats,
+                                                 unsigned i_queued )
+{
+    p_stats->i_queued_total += i_queued;
+    if( i_queued > p_stats->i_queued_max )
+        p_stats->i_queued_max = i_queued;
+}
+
 typedef struct
 {
     vlc_fourcc_t i_codec; /* (0 if not transcode) */
@@ -44,6 +71,7 @@ typedef struct
                 unsigned int i_count;
                 int          i_priority;
                 uint32_t     pool_size;
+                bool         b_pipeline; /* filters on their own thread */
             } threads;
         } video;
         struct
@@ -78,6 +106,7 @@ void transcode_encoder_close( transcode_encoder_t * );
 bool transcode_encoder_opened( const transcode_encoder_t * );
 int transcode_encoder_open( transcode_encoder_t *, const transcode_encoder_config_t * );
 int transcode_encoder_drain( transcode_encoder_t *, block_t ** );
+void transcode_encoder_get_stats( transcode_encoder_t *, transcode_stage_stats_t * );
 
 int transcode_encoder_test( encoder_t *p_encoder,
                             const transcode_encoder_config_t *p_cfg,
@@ -25,12 +25,16 @@ struct transcode_encoder_t
     vlc_mutex_t     lock_out;
     bool            b_abort;
     picture_fifo_t *pp_pics;
+    unsigned        i_pics; /* pictures waiting in pp_pics */
     vlc_sem_t       picture_pool_has_room;
     vlc_cond_t      cond;
 
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* video encoding statistics, protected by lock_out */
+    transcode_stage_stats_t stats;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
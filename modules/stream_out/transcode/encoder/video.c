@@ -371,12 +371,17 @@ static void* EncoderThread( void *obj )
 
         if( p_pic )
         {
+            p_enc->i_pics--;
+
             /* release lock while encoding */
             vlc_mutex_unlock( &p_enc->lock_out );
+            vlc_tick_t i_start = vlc_tick_now();
             p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
+            vlc_tick_t i_duration = vlc_tick_now() - i_start;
             picture_Release( p_pic );
             vlc_mutex_lock( &p_enc->lock_out );
 
+            transcode_stage_stats_add( &p_enc->stats, i_duration );
             block_ChainAppend( &p_enc->p_buffers, p_block );
         }
 
@@ -387,6 +392,7 @@ static void* EncoderThread( void *obj )
     /*Encode what we have in the buffer on closing*/
     while( (p_pic = picture_fifo_Pop( p_enc->pp_pics )) != NULL )
     {
+        p_enc->i_pics--;
         vlc_sem_post( &p_enc->picture_pool_has_room );
         p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
         picture_Release( p_pic );
@@ -470,6 +476,7 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     vlc_sem_init( &p_enc->picture_pool_has_room, p_cfg->video.threads.pool_size );
     vlc_cond_init( &p_enc->cond );
     p_enc->p_buffers = NULL;
+    p_enc->i_pics = 0;
     p_enc->b_abort = false;
 
     if( p_cfg->video.threads.i_count > 0 )
@@ -490,13 +497,24 @@ block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t
 {
     if( !p_enc->b_threaded )
     {
-        return vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
+        if( p_pic == NULL ) /* draining */
+            return vlc_encoder_EncodeVideo( p_enc->p_encoder, NULL );
+
+        vlc_tick_t i_start = vlc_tick_now();
+        block_t *p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
+        vlc_tick_t i_duration = vlc_tick_now() - i_start;
+
+        vlc_mutex_lock( &p_enc->lock_out );
+        transcode_stage_stats_add( &p_enc->stats, i_duration );
+        vlc_mutex_unlock( &p_enc->lock_out );
+        return p_block;
     }
 
     vlc_sem_wait( &p_enc->picture_pool_has_room );
     vlc_mutex_lock( &p_enc->lock_out );
     picture_Hold( p_pic );
     picture_fifo_Push( p_enc->pp_pics, p_pic );
+    transcode_stage_stats_queued( &p_enc->stats, ++p_enc->i_pics );
     vlc_cond_signal( &p_enc->cond );
     vlc_mutex_unlock( &p_enc->lock_out );
     return NULL;
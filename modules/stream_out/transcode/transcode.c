@@ -131,8 +131,25 @@
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
+#define PIPELINE_TEXT N_("Pipelined video transcoding")
+#define PIPELINE_LONGTEXT N_( \
+    "Runs deinterlacing, scaling, video filters and subpicture blending on " \
+    "their own thread, between the decoder and the encoder. At most " \
+    "pool-size pictures wait to be filtered." )
 
 
+#define VRENDITIONS_TEXT N_("Extra video renditions")
+#define VRENDITIONS_LONGTEXT N_( \
+    "Colon-separated list of additional encodings of the video, each as " \
+    "[width]x[height][@bitrate in kb/s], for instance \"x720@2500:x480@1000\". " \
+    "The video is decoded and filtered once, then scaled and encoded for " \
+    "every rendition with the video encoder settings. Each rendition is " \
+    "output as a new elementary stream, with an id from 65536 upwards, in " \
+    "the order the renditions are created." )
+
+/* Above the source ES ids, such as the 13 bits TS PIDs */
+#define RENDITION_ES_ID_BASE 0x10000
+
 static const char *const ppsz_deinterlace_type[] =
 {
     "deinterlace", "ffmpeg-deinterlace"
@@ -176,6 +193,8 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "vrenditions", NULL, VRENDITIONS_TEXT,
+                VRENDITIONS_LONGTEXT )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "audio encoder", NULL,
@@ -211,6 +230,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT )
         change_integer_range( 1, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT )
+    add_bool( SOUT_CFG_PREFIX "pipeline", false, PIPELINE_TEXT,
+              PIPELINE_LONGTEXT )
 
 vlc_module_end ()
 
@@ -220,7 +241,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "pipeline", "vrenditions", NULL
 };
 
 /*****************************************************************************
@@ -321,6 +342,7 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
 
     p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    p_cfg->video.threads.b_pipeline = var_GetBool( p_stream, SOUT_CFG_PREFIX "pipeline" );
 
 #if VLC_THREAD_PRIORITY_OUTPUT != VLC_THREAD_PRIORITY_VIDEO
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
@@ -330,6 +352,51 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+static void SetVideoRenditionsConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_string = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "vrenditions" );
+    if( !psz_string )
+        return;
+
+    char *psz_save;
+    for( char *psz = strtok_r( psz_string, ":", &psz_save ); psz != NULL;
+         psz = strtok_r( NULL, ":", &psz_save ) )
+    {
+        unsigned i_width = 0, i_height = 0, i_bitrate = 0;
+        char *psz_end = psz;
+
+        if( *psz_end != 'x' )
+            i_width = strtoul( psz_end, &psz_end, 10 );
+        if( *psz_end == 'x' )
+            i_height = strtoul( psz_end + 1, &psz_end, 10 );
+        if( *psz_end == '@' )
+            i_bitrate = strtoul( psz_end + 1, &psz_end, 10 );
+
+        if( *psz_end != '\0' || ( !i_width && !i_height ) )
+        {
+            msg_Err( p_stream, "ignoring invalid video rendition `%s'", psz );
+            continue;
+        }
+
+        /* Same encoder and settings as the main video, at another size */
+        transcode_encoder_config_t cfg = p_sys->venc_cfg;
+        cfg.psz_name = p_sys->venc_cfg.psz_name ? strdup( p_sys->venc_cfg.psz_name ) : NULL;
+        cfg.psz_lang = p_sys->venc_cfg.psz_lang ? strdup( p_sys->venc_cfg.psz_lang ) : NULL;
+        cfg.p_config_chain = config_ChainDuplicate( p_sys->venc_cfg.p_config_chain );
+        cfg.video.f_scale = 0;
+        cfg.video.i_width = i_width;
+        cfg.video.i_height = i_height;
+        cfg.video.i_maxwidth = cfg.video.i_maxheight = 0;
+        if( i_bitrate )
+            cfg.video.i_bitrate = i_bitrate * 1000;
+
+        msg_Dbg( p_stream, "video rendition %ux%u %ukb/s", i_width, i_height,
+                 cfg.video.i_bitrate / 1000 );
+        TAB_APPEND( p_sys->i_vrenditions, p_sys->p_vrenditions_cfg, cfg );
+    }
+    free( psz_string );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -419,6 +486,10 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
     }
 
+    p_sys->i_rendition_es_id = RENDITION_ES_ID_BASE;
+    if( p_sys->venc_cfg.i_codec )
+        SetVideoRenditionsConfig( p_stream, p_sys );
+
     /* Video Filter Parameters */
     sout_filters_config_init( &p_sys->vfilters_cfg );
 
@@ -476,6 +547,9 @@ static void Close( vlc_object_t * p_this )
     sout_stream_sys_t   *p_sys = p_stream->p_sys;
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
+    for( int i = 0; i < p_sys->i_vrenditions; i++ )
+        transcode_encoder_config_clean( &p_sys->p_vrenditions_cfg[i] );
+    free( p_sys->p_vrenditions_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
@@ -688,7 +762,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             decoder_Destroy( id->p_decoder );
@@ -52,6 +52,9 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    int                   i_vrenditions;
+    transcode_encoder_config_t *p_vrenditions_cfg; /* extra encodings */
+    int                   i_rendition_es_id; /* next rendition ES id */
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -67,6 +70,8 @@ typedef struct
 } sout_stream_sys_t;
 
 struct aout_filters;
+struct transcode_video_pipeline;
+struct transcode_video_rendition;
 
 struct sout_stream_id_sys_t
 {
@@ -125,6 +130,11 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             struct transcode_video_pipeline *p_pipeline; /**< filter thread */
+             int i_renditions;
+             struct transcode_video_rendition **pp_renditions; /**< extra encodings */
+             transcode_stage_stats_t dec_stats;
+             transcode_stage_stats_t filter_stats;
          };
          struct
          {
@@ -201,7 +211,7 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
@@ -168,9 +168,63 @@ static vlc_picture_chain_t transcode_dequeue_all_pics( sout_stream_id_sys_t *id
     return p_pics;
 }
 
+/*
+ * Creates an encoder for the decoded stream.
+ * Because some info about the decoded input will only be available
+ * once the first frame is decoded, we actually only test the availability
+ * of the encoder here.
+ */
+static transcode_encoder_t *transcode_video_encoder_new( sout_stream_t *p_stream,
+                                                         sout_stream_id_sys_t *id,
+                                                         const transcode_encoder_config_t *p_cfg )
+{
+    transcode_encoder_t *p_enc = NULL;
+
+    /* Should be the same format until encoder loads */
+    es_format_t encoder_tested_fmt_in;
+    es_format_Init( &encoder_tested_fmt_in, VIDEO_ES, 0 );
+
+    struct encoder_owner *p_enc_owner = (struct encoder_owner*)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+    if ( unlikely(p_enc_owner == NULL))
+       goto end;
+
+    p_enc_owner->id = id;
+    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+    if( transcode_encoder_test( &p_enc_owner->enc,
+                                p_cfg,
+                                &id->p_decoder->fmt_in,
+                                id->p_decoder->fmt_out.i_codec,
+                                &encoder_tested_fmt_in ) )
+       goto end;
+
+    p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+    if ( unlikely(p_enc_owner == NULL))
+       goto end;
+
+    p_enc = transcode_encoder_new( &p_enc_owner->enc, &encoder_tested_fmt_in );
+    if( !p_enc )
+       goto end;
+
+    p_enc_owner->id = id;
+    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+end:
+    es_format_Clean( &encoder_tested_fmt_in );
+    return p_enc;
+}
+
+static struct transcode_video_rendition *
+transcode_video_rendition_New( sout_stream_t *, sout_stream_id_sys_t *,
+                               const transcode_encoder_config_t *, int );
+static void transcode_video_rendition_Delete( sout_stream_t *,
+                                              struct transcode_video_rendition * );
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
     msg_Dbg( p_stream,
              "creating video transcoding from fcc=`%4.4s' to fcc=`%4.4s'",
              (char*)&p_fmt->i_codec, (char*)&id->p_enccfg->i_codec );
@@ -211,50 +265,33 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
         es_format_Copy( &id->decoder_out, &id->p_decoder->fmt_out );
     }
 
-    /*
-     * Open encoder.
-     * Because some info about the decoded input will only be available
-     * once the first frame is decoded, we actually only test the availability
-     * of the encoder here.
-     */
-
-    /* Should be the same format until encoder loads */
-    es_format_t encoder_tested_fmt_in;
-    es_format_Init( &encoder_tested_fmt_in, id->decoder_out.i_cat, 0 );
-
-    struct encoder_owner *p_enc_owner = (struct encoder_owner*)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
-    if ( unlikely(p_enc_owner == NULL))
-       goto error;
-
-    p_enc_owner->id = id;
-    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
-
-    if( transcode_encoder_test( &p_enc_owner->enc,
-                                id->p_enccfg,
-                                &id->p_decoder->fmt_in,
-                                id->p_decoder->fmt_out.i_codec,
-                                &encoder_tested_fmt_in ) )
-       goto error;
-
-    p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
-    if ( unlikely(p_enc_owner == NULL))
-       goto error;
-
-    id->encoder = transcode_encoder_new( &p_enc_owner->enc, &encoder_tested_fmt_in );
+    /* Open encoder */
+    id->encoder = transcode_video_encoder_new( p_stream, id, id->p_enccfg );
     if( !id->encoder )
        goto error;
 
-    p_enc_owner->id = id;
-    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
-
-    es_format_Clean( &encoder_tested_fmt_in );
+    /* Extra renditions */
+    TAB_INIT( id->i_renditions, id->pp_renditions );
+    for( int i = 0; i < p_sys->i_vrenditions; i++ )
+    {
+        vlc_mutex_lock( &p_sys->lock );
+        const int i_es_id = p_sys->i_rendition_es_id++;
+        vlc_mutex_unlock( &p_sys->lock );
+
+        struct transcode_video_rendition *p_rend =
+            transcode_video_rendition_New( p_stream, id, &p_sys->p_vrenditions_cfg[i],
+                                           i_es_id );
+        if( p_rend )
+            TAB_APPEND( id->i_renditions, id->pp_renditions, p_rend );
+        else
+            msg_Warn( p_stream, "cannot create video rendition %d", i + 1 );
+    }
 
     return VLC_SUCCESS;
 
 error:
     module_unneed( id->p_decoder, id->p_decoder->p_module );
     id->p_decoder->p_module = NULL;
-    es_format_Clean( &encoder_tested_fmt_in );
     es_format_Clean( &id->decoder_out );
     return VLC_EGENERIC;
 }
@@ -338,8 +375,41 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+static void transcode_video_pipeline_Delete( struct transcode_video_pipeline * );
+
+static void debug_stage_stats( sout_stream_t *p_stream, const char *psz_stage,
+                               const transcode_stage_stats_t *p_stats )
+{
+    if( p_stats->i_count == 0 )
+        return;
+
+    msg_Dbg( p_stream, "%s: %"PRIu64" pictures, latency avg %"PRId64"us "
+             "max %"PRId64"us, queue avg %.1f max %u", psz_stage,
+             p_stats->i_count,
+             US_FROM_VLC_TICK( p_stats->i_total / p_stats->i_count ),
+             US_FROM_VLC_TICK( p_stats->i_max ),
+             (double)p_stats->i_queued_total / p_stats->i_count,
+             p_stats->i_queued_max );
+}
+
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
+    if( id->p_pipeline )
+        transcode_video_pipeline_Delete( id->p_pipeline );
+
+    transcode_stage_stats_t enc_stats;
+    transcode_encoder_get_stats( id->encoder, &enc_stats );
+    debug_stage_stats( p_stream, "decoder", &id->dec_stats );
+    debug_stage_stats( p_stream, "filters", &id->filter_stats );
+    debug_stage_stats( p_stream, "encoder", &enc_stats );
+
+    /* Close renditions */
+    for( int i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_video_rendition_Delete( p_stream, id->pp_renditions[i] );
+    }
+    TAB_CLEAN( id->i_renditions, id->pp_renditions );
+
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
@@ -361,7 +431,8 @@ void transcode_video_clean( sout_stream_id_sys_t *id )
 void transcode_video_push_spu( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                subpicture_t *p_subpicture )
 {
-    if( !id->p_spu )
+    /* Not once the filter thread runs, see transcode_video_process() */
+    if( !id->p_spu && !id->p_pipeline )
         id->p_spu = spu_Create( p_stream, NULL );
     if( !id->p_spu )
         subpicture_Delete( p_subpicture );
@@ -440,6 +511,386 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
+/*
+ * Extra renditions: the pictures handed to the main encoder are shared (held)
+ * with one scaler and encoder per rendition, so that the decoder and the
+ * filters only run once for the whole ladder.
+ */
+struct transcode_video_rendition
+{
+    const transcode_encoder_config_t *p_enccfg;
+    transcode_encoder_t *encoder;
+    filter_chain_t      *p_conv; /**< scaler/converter to the encoder input */
+    int                 i_es_id;
+    void                *downstream_id;
+    bool                b_error;
+
+    vlc_mutex_t         lock;
+    block_t             *p_out; /**< blocks output by an unthreaded encoder */
+};
+
+static struct transcode_video_rendition *
+transcode_video_rendition_New( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                               const transcode_encoder_config_t *p_cfg, int i_es_id )
+{
+    struct transcode_video_rendition *p_rend = calloc( 1, sizeof(*p_rend) );
+    if( unlikely(p_rend == NULL) )
+        return NULL;
+
+    p_rend->encoder = transcode_video_encoder_new( p_stream, id, p_cfg );
+    if( !p_rend->encoder )
+    {
+        free( p_rend );
+        return NULL;
+    }
+    p_rend->p_enccfg = p_cfg;
+    p_rend->i_es_id = i_es_id;
+    vlc_mutex_init( &p_rend->lock );
+    return p_rend;
+}
+
+static void transcode_video_rendition_Delete( sout_stream_t *p_stream,
+                                              struct transcode_video_rendition *p_rend )
+{
+    transcode_stage_stats_t enc_stats;
+    transcode_encoder_get_stats( p_rend->encoder, &enc_stats );
+    debug_stage_stats( p_stream, "rendition encoder", &enc_stats );
+
+    transcode_encoder_close( p_rend->encoder );
+    transcode_encoder_delete( p_rend->encoder );
+    transcode_remove_filters( &p_rend->p_conv );
+    block_ChainRelease( p_rend->p_out );
+    if( p_rend->downstream_id )
+        sout_StreamIdDel( p_stream->p_next, p_rend->downstream_id );
+    free( p_rend );
+}
+
+/* Sets the rendition up for the pictures fed to the main encoder */
+static int transcode_video_rendition_configure( sout_stream_t *p_stream,
+                                                sout_stream_id_sys_t *id,
+                                                struct transcode_video_rendition *p_rend,
+                                                vlc_video_context *vctx )
+{
+    const es_format_t *p_src = transcode_encoder_format_in( id->encoder );
+
+    if( !transcode_encoder_opened( p_rend->encoder ) )
+    {
+        transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                           &id->decoder_out.video,
+                                           p_rend->p_enccfg, &p_src->video,
+                                           vctx, p_rend->encoder );
+        if( transcode_encoder_open( p_rend->encoder, p_rend->p_enccfg ) != VLC_SUCCESS )
+        {
+            msg_Err( p_stream, "cannot open the encoder of rendition %d",
+                     p_rend->i_es_id );
+            return VLC_EGENERIC;
+        }
+    }
+
+    /* The fmt_in may have been overriden by the encoder. */
+    const es_format_t *p_enc_in = transcode_encoder_format_in( p_rend->encoder );
+
+    transcode_remove_filters( &p_rend->p_conv );
+    if( p_src->i_codec != p_enc_in->i_codec ||
+        p_src->video.i_width  != p_enc_in->video.i_width ||
+        p_src->video.i_height != p_enc_in->video.i_height ||
+        p_src->video.i_visible_width  != p_enc_in->video.i_visible_width ||
+        p_src->video.i_visible_height != p_enc_in->video.i_visible_height )
+    {
+        p_rend->p_conv = filter_chain_NewVideo( p_stream, false, NULL );
+        if( !p_rend->p_conv )
+            return VLC_EGENERIC;
+        filter_chain_Reset( p_rend->p_conv, p_src, vctx, p_enc_in );
+        if( filter_chain_AppendConverter( p_rend->p_conv, NULL ) )
+        {
+            msg_Err( p_stream, "cannot scale the video for rendition %d",
+                     p_rend->i_es_id );
+            return VLC_EGENERIC;
+        }
+    }
+
+    msg_Dbg( p_stream, "rendition %d: %ux%u", p_rend->i_es_id,
+             p_enc_in->video.i_visible_width, p_enc_in->video.i_visible_height );
+
+    if( !p_rend->downstream_id )
+    {
+        es_format_t fmt_orig;
+        es_format_Copy( &fmt_orig, &id->p_decoder->fmt_in );
+        fmt_orig.i_id = p_rend->i_es_id;
+        p_rend->downstream_id =
+            id->pf_transcode_downstream_add( p_stream, &fmt_orig,
+                                             transcode_encoder_format_out( p_rend->encoder ) );
+        es_format_Clean( &fmt_orig );
+        if( !p_rend->downstream_id )
+        {
+            msg_Err( p_stream, "cannot output rendition %d", p_rend->i_es_id );
+            return VLC_EGENERIC;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+static void transcode_video_rendition_encode( struct transcode_video_rendition *p_rend,
+                                              picture_t *p_pic )
+{
+    if( p_rend->b_error || !transcode_encoder_opened( p_rend->encoder ) )
+        return;
+
+    p_pic = picture_Hold( p_pic );
+    if( p_rend->p_conv )
+        p_pic = filter_chain_VideoFilter( p_rend->p_conv, p_pic );
+    if( !p_pic )
+        return;
+
+    block_t *p_block = transcode_encoder_encode( p_rend->encoder, p_pic );
+    picture_Release( p_pic );
+
+    if( p_block )
+    {
+        vlc_mutex_lock( &p_rend->lock );
+        block_ChainAppend( &p_rend->p_out, p_block );
+        vlc_mutex_unlock( &p_rend->lock );
+    }
+}
+
+static void transcode_video_rendition_drain( struct transcode_video_rendition *p_rend,
+                                             bool b_close )
+{
+    if( !transcode_encoder_opened( p_rend->encoder ) )
+        return;
+
+    block_t *p_drained = NULL;
+    transcode_encoder_drain( p_rend->encoder, &p_drained );
+    if( b_close )
+    {
+        transcode_encoder_close( p_rend->encoder );
+        transcode_remove_filters( &p_rend->p_conv );
+    }
+
+    vlc_mutex_lock( &p_rend->lock );
+    block_ChainAppend( &p_rend->p_out, p_drained );
+    vlc_mutex_unlock( &p_rend->lock );
+}
+
+/* Sends what the rendition encoded to its own elementary stream */
+static void transcode_video_rendition_output( sout_stream_t *p_stream,
+                                              struct transcode_video_rendition *p_rend,
+                                              bool b_eos )
+{
+    vlc_mutex_lock( &p_rend->lock );
+    block_t *p_out = p_rend->p_out;
+    p_rend->p_out = NULL;
+    vlc_mutex_unlock( &p_rend->lock );
+
+    if( p_rend->p_enccfg->video.threads.i_count >= 1 &&
+        transcode_encoder_opened( p_rend->encoder ) )
+        block_ChainAppend( &p_out, transcode_encoder_get_output_async( p_rend->encoder ) );
+
+    if( b_eos )
+        tag_last_block_with_flag( &p_out, BLOCK_FLAG_END_OF_SEQUENCE );
+
+    if( !p_out )
+        return;
+    if( p_rend->downstream_id )
+        sout_StreamIdSend( p_stream->p_next, p_rend->downstream_id, p_out );
+    else
+        block_ChainRelease( p_out );
+}
+
+/* Runs the filter chains on a picture and hands the result to the encoder.
+ * Returns the time spent filtering, encoding excluded. */
+static vlc_tick_t transcode_video_filter_picture( sout_stream_id_sys_t *id,
+                                                  picture_t *p_pic, block_t **out )
+{
+    vlc_tick_t i_start = vlc_tick_now();
+    vlc_tick_t i_encoding = 0;
+
+    /* Run the filter and output chains; first with the picture,
+     * and then with NULL as many times as we need until they
+     * stop outputting frames.
+     */
+    for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
+    {
+        /* Run filter chain */
+        if( id->p_f_chain )
+            p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
+
+        if( !p_in )
+            break;
+
+        for ( ;; p_in = NULL /* drain second time */ )
+        {
+            /* Run user specified filter chain */
+            filter_chain_t * secondary_chains[] = { id->p_uf_chain,
+                                                    id->p_final_conv_static };
+            for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
+            {
+                if( !secondary_chains[i] )
+                    continue;
+                p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
+            }
+
+            if( !p_in )
+                break;
+
+            /* Blend subpictures */
+            p_in = RenderSubpictures( id, p_in );
+
+            if( p_in )
+            {
+                for( int i = 0; i < id->i_renditions; i++ )
+                    transcode_video_rendition_encode( id->pp_renditions[i], p_in );
+
+                vlc_tick_t i_encode_start = vlc_tick_now();
+                block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
+                i_encoding += vlc_tick_now() - i_encode_start;
+                if( p_encoded )
+                    block_ChainAppend( out, p_encoded );
+                picture_Release( p_in );
+            }
+        }
+    }
+
+    return vlc_tick_now() - i_start - i_encoding;
+}
+
+/*
+ * Pipelined mode: the decoded pictures are queued to a thread running the
+ * filters (and the encoder, unless it has its own thread), so that decoding
+ * the next pictures overlaps with filtering the previous ones.
+ */
+struct transcode_video_pipeline
+{
+    sout_stream_id_sys_t *id;
+    vlc_thread_t        thread;
+
+    vlc_mutex_t         lock;
+    vlc_cond_t          wait_input; /* a picture was queued, or abort */
+    vlc_cond_t          wait_room;  /* a picture was dequeued or filtered */
+    vlc_picture_chain_t pics;
+    unsigned            i_pics;
+    unsigned            i_max_pics;
+    bool                b_busy;     /* filtering a picture */
+    bool                b_abort;
+
+    /* blocks output by an unthreaded encoder */
+    block_t             *p_out;
+};
+
+static void* VideoFilterThread( void *data )
+{
+    struct transcode_video_pipeline *p_pl = data;
+    sout_stream_id_sys_t *id = p_pl->id;
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &p_pl->lock );
+
+    for( ;; )
+    {
+        while( !p_pl->b_abort && vlc_picture_chain_IsEmpty( &p_pl->pics ) )
+            vlc_cond_wait( &p_pl->wait_input, &p_pl->lock );
+
+        /* Filter what is left in the queue on abort */
+        if( vlc_picture_chain_IsEmpty( &p_pl->pics ) )
+            break;
+
+        picture_t *p_pic = vlc_picture_chain_PopFront( &p_pl->pics );
+        p_pl->i_pics--;
+        p_pl->b_busy = true;
+        vlc_cond_signal( &p_pl->wait_room );
+        vlc_mutex_unlock( &p_pl->lock );
+
+        block_t *p_out = NULL;
+        vlc_tick_t i_duration = transcode_video_filter_picture( id, p_pic, &p_out );
+
+        vlc_mutex_lock( &p_pl->lock );
+        transcode_stage_stats_add( &id->filter_stats, i_duration );
+        block_ChainAppend( &p_pl->p_out, p_out );
+        p_pl->b_busy = false;
+        vlc_cond_signal( &p_pl->wait_room );
+    }
+
+    vlc_mutex_unlock( &p_pl->lock );
+
+    vlc_restorecancel( canc );
+
+    return NULL;
+}
+
+static struct transcode_video_pipeline *
+transcode_video_pipeline_New( sout_stream_id_sys_t *id,
+                              const transcode_encoder_config_t *p_cfg )
+{
+    struct transcode_video_pipeline *p_pl = malloc( sizeof(*p_pl) );
+    if( unlikely(p_pl == NULL) )
+        return NULL;
+
+    p_pl->id = id;
+    vlc_mutex_init( &p_pl->lock );
+    vlc_cond_init( &p_pl->wait_input );
+    vlc_cond_init( &p_pl->wait_room );
+    vlc_picture_chain_Init( &p_pl->pics );
+    p_pl->i_pics = 0;
+    p_pl->i_max_pics = __MAX( p_cfg->video.threads.pool_size, 1 );
+    p_pl->b_busy = false;
+    p_pl->b_abort = false;
+    p_pl->p_out = NULL;
+
+    if( vlc_clone( &p_pl->thread, VideoFilterThread, p_pl,
+                   p_cfg->video.threads.i_priority ) )
+    {
+        free( p_pl );
+        return NULL;
+    }
+    return p_pl;
+}
+
+static void transcode_video_pipeline_Delete( struct transcode_video_pipeline *p_pl )
+{
+    vlc_mutex_lock( &p_pl->lock );
+    p_pl->b_abort = true;
+    vlc_cond_signal( &p_pl->wait_input );
+    vlc_mutex_unlock( &p_pl->lock );
+    vlc_join( p_pl->thread, NULL );
+
+    block_ChainRelease( p_pl->p_out );
+    free( p_pl );
+}
+
+static void transcode_video_pipeline_Push( struct transcode_video_pipeline *p_pl,
+                                           picture_t *p_pic )
+{
+    vlc_mutex_lock( &p_pl->lock );
+    while( p_pl->i_pics >= p_pl->i_max_pics )
+        vlc_cond_wait( &p_pl->wait_room, &p_pl->lock );
+    vlc_picture_chain_Append( &p_pl->pics, p_pic );
+    transcode_stage_stats_queued( &p_pl->id->filter_stats, ++p_pl->i_pics );
+    vlc_cond_signal( &p_pl->wait_input );
+    vlc_mutex_unlock( &p_pl->lock );
+}
+
+/* Waits for the queued pictures to be filtered, so that the filters and the
+ * encoder can be reconfigured or drained, and returns what was encoded. */
+static block_t *transcode_video_pipeline_Wait( struct transcode_video_pipeline *p_pl )
+{
+    vlc_mutex_lock( &p_pl->lock );
+    while( p_pl->i_pics > 0 || p_pl->b_busy )
+        vlc_cond_wait( &p_pl->wait_room, &p_pl->lock );
+    block_t *p_out = p_pl->p_out;
+    p_pl->p_out = NULL;
+    vlc_mutex_unlock( &p_pl->lock );
+    return p_out;
+}
+
+static block_t *transcode_video_pipeline_GetOutput( struct transcode_video_pipeline *p_pl )
+{
+    vlc_mutex_lock( &p_pl->lock );
+    block_t *p_out = p_pl->p_out;
+    p_pl->p_out = NULL;
+    vlc_mutex_unlock( &p_pl->lock );
+    return p_out;
+}
+
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -447,7 +898,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
     bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
 
+    vlc_tick_t i_start = vlc_tick_now();
     int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+    if( in )
+        transcode_stage_stats_add( &id->dec_stats, vlc_tick_now() - i_start );
     if( ret != VLCDEC_SUCCESS )
         return VLC_EGENERIC;
 
@@ -466,6 +920,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
         if( p_pic && ( unlikely(!transcode_encoder_opened(id->encoder)) ||
               !video_format_IsSimilar( &id->decoder_out.video, &p_pic->format ) ) )
         {
+            /* The filter thread must be done with the current chains */
+            if( id->p_pipeline )
+                block_ChainAppend( out, transcode_video_pipeline_Wait( id->p_pipeline ) );
+
             if( !transcode_encoder_opened(id->encoder) ) /* Configure Encoder input/output */
             {
                 assert( !id->p_f_chain && !id->p_uf_chain );
@@ -574,55 +1032,56 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                    (char *) &id->p_enccfg->i_codec );
                 goto error;
             }
-        }
 
-        /* Run the filter and output chains; first with the picture,
-         * and then with NULL as many times as we need until they
-         * stop outputting frames.
-         */
-        for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
-        {
-            /* Run filter chain */
-            if( id->p_f_chain )
-                p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
+            /* Renditions are fed with the main encoder input */
+            vlc_video_context *enc_vctx = picture_GetVideoContext( p_pic );
+            if( id->p_final_conv_static )
+                enc_vctx = filter_chain_GetVideoCtxOut( id->p_final_conv_static );
+            else if( id->p_uf_chain )
+                enc_vctx = filter_chain_GetVideoCtxOut( id->p_uf_chain );
+            else if( id->p_f_chain )
+                enc_vctx = filter_chain_GetVideoCtxOut( id->p_f_chain );
 
-            if( !p_in )
-                break;
-
-            for ( ;; p_in = NULL /* drain second time */ )
+            for( int i = 0; i < id->i_renditions; i++ )
             {
-                /* Run user specified filter chain */
-                filter_chain_t * secondary_chains[] = { id->p_uf_chain,
-                                                        id->p_final_conv_static };
-                for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
-                {
-                    if( !secondary_chains[i] )
-                        continue;
-                    p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
-                }
-
-                if( !p_in )
-                    break;
-
-                /* Blend subpictures */
-                p_in = RenderSubpictures( id, p_in );
-
-                if( p_in )
-                {
-                    block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
-                    if( p_encoded )
-                        block_ChainAppend( out, p_encoded );
-                    picture_Release( p_in );
-                }
+                struct transcode_video_rendition *p_rend = id->pp_renditions[i];
+                if( !p_rend->b_error &&
+                    transcode_video_rendition_configure( p_stream, id, p_rend,
+                                                         enc_vctx ) != VLC_SUCCESS )
+                    p_rend->b_error = true;
             }
         }
 
+        if( id->p_enccfg->video.threads.b_pipeline && !id->p_pipeline )
+        {
+            /* The filter thread blends the subpictures: their unit must
+             * exist before it starts, and not change afterwards */
+            if( !id->p_spu )
+                id->p_spu = spu_Create( p_stream, NULL );
+            id->p_pipeline = transcode_video_pipeline_New( id, id->p_enccfg );
+            if( !id->p_pipeline )
+                msg_Warn( p_stream, "cannot start the video filter thread" );
+        }
+
+        if( id->p_pipeline && p_pic )
+            transcode_video_pipeline_Push( id->p_pipeline, p_pic );
+        else
+            transcode_stage_stats_add( &id->filter_stats,
+                    transcode_video_filter_picture( id, p_pic, out ) );
+
         if( b_eos )
         {
             msg_Info( p_stream, "Drain/restart on EOS" );
+            if( id->p_pipeline )
+                block_ChainAppend( out, transcode_video_pipeline_Wait( id->p_pipeline ) );
             if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
                 goto error;
             transcode_encoder_close( id->encoder );
+            for( int i = 0; i < id->i_renditions; i++ )
+            {
+                transcode_video_rendition_drain( id->pp_renditions[i], true );
+                transcode_video_rendition_output( p_stream, id->pp_renditions[i], true );
+            }
             /* Close filters */
             transcode_remove_filters( &id->p_f_chain );
             transcode_remove_filters( &id->p_uf_chain );
@@ -638,6 +1097,16 @@ error:
         id->b_error = true;
     }
 
+    if( id->p_pipeline )
+    {
+        /* Pick up what the filter thread encoded, waiting for it when
+         * draining */
+        if( in == NULL )
+            block_ChainAppend( out, transcode_video_pipeline_Wait( id->p_pipeline ) );
+        else
+            block_ChainAppend( out, transcode_video_pipeline_GetOutput( id->p_pipeline ) );
+    }
+
     if( id->p_enccfg->video.threads.i_count >= 1 )
     {
         /* Pick up any return data the encoder thread wants to output. */
@@ -654,6 +1123,14 @@ error:
             msg_Warn( p_stream, "Flushing failed");
     }
 
+    for( int i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_video_rendition *p_rend = id->pp_renditions[i];
+        if( !p_rend->b_error && in == NULL )
+            transcode_video_rendition_drain( p_rend, false );
+        transcode_video_rendition_output( p_stream, p_rend, b_eos );
+    }
+
     if( b_eos )
         tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
 
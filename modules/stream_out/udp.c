@@ -29,6 +29,9 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#ifdef HAVE_SENDMMSG
+#include <netinet/udp.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -39,6 +42,15 @@
 #include <vlc_memstream.h>
 #include "sdp_helper.h"
 
+/* Datagrams per sendmmsg() call */
+#define BATCH_MAX 64
+/* Gathered blocks per datagram */
+#define IOV_MAX_PER_DGRAM 16
+/* Largest UDP payload, so also the largest segmentation offload write */
+#define UDP_PAYLOAD_MAX 65507u
+/* Bytes waiting for their pacing deadline before the muxer gets blocked */
+#define PACE_QUEUE_MAX (32u << 20)
+
 struct sout_stream_udp
 {
     sout_access_out_t *access;
@@ -46,6 +58,19 @@ struct sout_stream_udp
     session_descriptor_t *sap;
     int fd;
     uint_fast16_t mtu;
+    bool gso;
+
+    /* DTS paced sending */
+    vlc_tick_t pace_delay; /* 0 if sending as soon as muxed */
+    vlc_tick_t pace_offset; /* wall clock minus DTS */
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_cond_t space;
+    block_t *queue;
+    block_t **queue_last;
+    size_t queue_size;
+    bool dead;
 };
 
 static void *Add(sout_stream_t *stream, const es_format_t *fmt)
@@ -145,39 +170,163 @@ static int Control(sout_stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
-static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
+/**
+ * Gathers blocks from a chain into one datagram of at most MTU bytes.
+ * @return the first block not included in the datagram
+ */
+static block_t *GatherDatagram(struct sout_stream_udp *sys, block_t *block,
+                               struct iovec *iov, unsigned *restrict iovlen,
+                               size_t *restrict size)
+{
+    size_t tosend = 0;
+    unsigned n = 0;
+
+    do {
+        if (n >= IOV_MAX_PER_DGRAM)
+            break;
+        if (block->i_buffer + tosend > sys->mtu && likely(n > 0))
+            break;
+
+        iov[n].iov_base = block->p_buffer;
+        iov[n].iov_len = block->i_buffer;
+        n++;
+        tosend += block->i_buffer;
+        block = block->p_next;
+    } while (block != NULL);
+
+    *iovlen = n;
+    *size = tosend;
+    return block;
+}
+
+#if defined(HAVE_SENDMMSG) && defined(UDP_SEGMENT)
+/**
+ * Counts the datagrams that can go in one segmentation offload write:
+ * all but the last must have the same size, within the UDP payload limit.
+ */
+static unsigned CountSegments(const struct mmsghdr *msgs, unsigned count)
+{
+    const size_t seg = msgs[0].msg_len;
+    const unsigned max = UDP_PAYLOAD_MAX / seg;
+    unsigned n = 0;
+
+    while (n < count && n < max && msgs[n].msg_len <= seg)
+        if (msgs[n++].msg_len < seg)
+            break; /* shorter last segment */
+    return n;
+}
+
+/**
+ * Sends datagrams as a single segmentation offload write.
+ * The datagrams must have been checked with CountSegments().
+ */
+static int SendSegmented(struct sout_stream_udp *sys,
+                         const struct mmsghdr *msgs, unsigned count)
+{
+    struct iovec *iov = msgs[0].msg_hdr.msg_iov;
+    size_t iovlen = 0;
+
+    for (unsigned i = 0; i < count; i++)
+        iovlen += msgs[i].msg_hdr.msg_iovlen;
+
+    union {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr hdr = {
+        .msg_iov = iov,
+        .msg_iovlen = iovlen,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof (control.buf),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+    uint16_t gso_size = msgs[0].msg_len;
+
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof (gso_size));
+    memcpy(CMSG_DATA(cmsg), &gso_size, sizeof (gso_size));
+
+    /* A datagram write is all or nothing */
+    if (sendmsg(sys->fd, &hdr, 0) >= 0)
+        return 0;
+    if (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)
+        sys->gso = false; /* not supported, do not try again */
+    return -1;
+}
+#endif
+
+/**
+ * Sends a chain of blocks, gathered into MTU-sized datagrams,
+ * with as few system calls as possible.
+ */
+static ssize_t SendChain(vlc_object_t *obj, struct sout_stream_udp *sys,
+                         block_t *block)
 {
-    struct sout_stream_udp *sys = access->p_sys;
     ssize_t total = 0;
 
     while (block != NULL) {
-        struct iovec iov[16];
+        struct iovec iov[BATCH_MAX * IOV_MAX_PER_DGRAM];
+#ifdef HAVE_SENDMMSG
+        struct mmsghdr msgs[BATCH_MAX];
+#endif
         block_t *unsent = block;
-        unsigned iovlen = 0;
-        size_t tosend = 0;
+        unsigned count = 0, iovlen = 0;
 
-        /* Count how many blocks to gather */
+        /* Gather as many datagrams as possible */
         do {
-            if (iovlen >= ARRAY_SIZE(iov))
-                break;
-            if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
-                break;
+            unsigned n;
+            size_t size;
+
+            unsent = GatherDatagram(sys, unsent, iov + iovlen, &n, &size);
+#ifdef HAVE_SENDMMSG
+            msgs[count].msg_hdr = (struct msghdr) {
+                .msg_iov = iov + iovlen,
+                .msg_iovlen = n,
+            };
+            msgs[count].msg_len = size;
+#else
+            /* One datagram at a time without sendmmsg() */
+            struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = n };
+            if (sendmsg(sys->fd, &hdr, 0) < 0)
+                msg_Err(obj, "send error: %s", vlc_strerror_c(errno));
+            else
+                total += size;
+            iovlen = 0;
+            break;
+#endif
+            iovlen += n;
+            count++;
+        } while (unsent != NULL && count < BATCH_MAX);
 
-            iov[iovlen].iov_base = unsent->p_buffer;
-            iov[iovlen].iov_len = unsent->i_buffer;
-            iovlen++;
-            tosend += unsent->i_buffer;
-            unsent = unsent->p_next;
-        } while (unsent != NULL);
+#ifdef HAVE_SENDMMSG
+        unsigned i = 0;
 
-        /* Send */
-        struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = iovlen };
-        int val = sendmsg(sys->fd, &hdr, 0);
+# ifdef UDP_SEGMENT
+        /* The datagrams of a failed write were not sent: they are sent
+         * again below, without segmentation offload */
+        while (sys->gso && i + 1 < count) {
+            unsigned n = CountSegments(msgs + i, count - i);
 
-        if (val < 0)
-            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
-        else
-            total += val;
+            if (n < 2 || SendSegmented(sys, msgs + i, n))
+                break;
+            for (unsigned j = 0; j < n; j++)
+                total += msgs[i + j].msg_len;
+            i += n;
+        }
+# endif
+        while (i < count) {
+            int val = sendmmsg(sys->fd, msgs + i, count - i, 0);
+
+            if (val < 0) {
+                msg_Err(obj, "send error: %s", vlc_strerror_c(errno));
+                break;
+            }
+            for (int j = 0; j < val; j++)
+                total += msgs[i + j].msg_len;
+            i += val;
+        }
+#endif
 
         /* Free */
         do {
@@ -191,6 +340,113 @@ static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
     return total;
 }
 
+static vlc_tick_t PaceDeadline(sout_access_out_t *access, block_t *block,
+                               vlc_tick_t now)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+
+    if (block->i_dts == VLC_TICK_INVALID)
+        return now;
+
+    vlc_tick_t deadline = block->i_dts + sys->pace_offset;
+
+    /* (Re)synchronize on the first block and on DTS discontinuities */
+    if (sys->pace_offset == VLC_TICK_INVALID
+     || deadline > now + sys->pace_delay + VLC_TICK_FROM_SEC(1)
+     || deadline < now - VLC_TICK_FROM_SEC(1)) {
+        if (sys->pace_offset != VLC_TICK_INVALID)
+            msg_Warn(access, "DTS discontinuity, resynchronizing pacing");
+        sys->pace_offset = now + sys->pace_delay - block->i_dts;
+        deadline = now + sys->pace_delay;
+    }
+    return deadline;
+}
+
+static void *PaceThread(void *data)
+{
+    sout_access_out_t *access = data;
+    struct sout_stream_udp *sys = access->p_sys;
+
+    vlc_mutex_lock(&sys->lock);
+    for (;;) {
+        while (sys->queue == NULL && !sys->dead)
+            vlc_cond_wait(&sys->wait, &sys->lock);
+        if (sys->dead)
+            break;
+
+        vlc_tick_t deadline = PaceDeadline(access, sys->queue, vlc_tick_now());
+        if (vlc_cond_timedwait(&sys->wait, &sys->lock, deadline) == 0)
+            continue; /* woken up early */
+
+        /* Take all the blocks that are due */
+        vlc_tick_t now = vlc_tick_now();
+        block_t *due = sys->queue, **lastp = &sys->queue;
+
+        while (*lastp != NULL && PaceDeadline(access, *lastp, now) <= now)
+            lastp = &(*lastp)->p_next;
+
+        sys->queue = *lastp;
+        *lastp = NULL;
+        if (sys->queue == NULL)
+            sys->queue_last = &sys->queue;
+        for (const block_t *b = due; b != NULL; b = b->p_next)
+            sys->queue_size -= b->i_buffer;
+        vlc_cond_broadcast(&sys->space);
+        vlc_mutex_unlock(&sys->lock);
+
+        SendChain(VLC_OBJECT(access), sys, due);
+
+        vlc_mutex_lock(&sys->lock);
+    }
+
+    /* Send the last muxer output right away rather than dropping it */
+    block_t *rest = sys->queue;
+
+    sys->queue = NULL;
+    sys->queue_last = &sys->queue;
+    sys->queue_size = 0;
+    vlc_cond_broadcast(&sys->space);
+    vlc_mutex_unlock(&sys->lock);
+
+    if (rest != NULL)
+        SendChain(VLC_OBJECT(access), sys, rest);
+    return NULL;
+}
+
+static void PaceStop(struct sout_stream_udp *sys)
+{
+    vlc_mutex_lock(&sys->lock);
+    sys->dead = true;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+}
+
+static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+
+    if (sys->pace_delay == 0)
+        return SendChain(VLC_OBJECT(access), sys, block);
+
+    ssize_t total = 0;
+    for (const block_t *b = block; b != NULL; b = b->p_next)
+        total += b->i_buffer;
+
+    vlc_mutex_lock(&sys->lock);
+    /* Hold the muxer back, as a blocking socket would, if the queue does not
+     * drain (stalled socket, or more than the limit within the delay) */
+    while (sys->queue_size > 0 && sys->queue_size + total > PACE_QUEUE_MAX
+        && !sys->dead)
+        vlc_cond_wait(&sys->space, &sys->lock);
+    if (sys->queue == NULL)
+        vlc_cond_signal(&sys->wait);
+    block_ChainLastAppend(&sys->queue_last, block);
+    sys->queue_size += total;
+    vlc_mutex_unlock(&sys->lock);
+    return total;
+}
+
 static void Close(vlc_object_t *obj)
 {
     sout_stream_t *stream = (sout_stream_t *)obj;
@@ -200,6 +456,10 @@ static void Close(vlc_object_t *obj)
         sout_AnnounceUnRegister(stream, sys->sap);
 
     sout_MuxDelete(sys->mux);
+
+    if (sys->pace_delay != 0)
+        PaceStop(sys);
+
     sout_AccessOutDelete(sys->access);
     net_Close(sys->fd);
     free(sys);
@@ -210,7 +470,7 @@ static const struct sout_stream_operations ops = {
 };
 
 static const char *const chain_options[] = {
-    "avformat", "dst", "sap", "name", "description", NULL
+    "avformat", "dst", "sap", "name", "description", "pace", "gso", NULL
 };
 
 #define DEFAULT_PORT 1234
@@ -308,10 +568,31 @@ static int Open(vlc_object_t *obj)
     sys->access = access;
     sys->fd = fd;
     sys->mtu = var_InheritInteger(stream, "mtu");
+    sys->gso = var_GetBool(stream, SOUT_CFG_PREFIX "gso");
+    sys->pace_delay = VLC_TICK_FROM_MS(var_GetInteger(stream,
+                                                      SOUT_CFG_PREFIX "pace"));
+    sys->pace_offset = VLC_TICK_INVALID;
+    sys->queue = NULL;
+    sys->queue_last = &sys->queue;
+    sys->queue_size = 0;
+    sys->dead = false;
+
+    if (sys->pace_delay != 0) {
+        vlc_mutex_init(&sys->lock);
+        vlc_cond_init(&sys->wait);
+        vlc_cond_init(&sys->space);
+        if (vlc_clone(&sys->thread, PaceThread, access,
+                      VLC_THREAD_PRIORITY_HIGHEST)) {
+            ret = VLC_ENOMEM;
+            goto error;
+        }
+    }
 
     sout_mux_t *mux = sout_MuxNew(access, muxmod);
     if (mux == NULL) {
         ret = VLC_ENOTSUP;
+        if (sys->pace_delay != 0)
+            PaceStop(sys);
         goto error;
     }
     sys->mux = mux;
@@ -346,6 +627,14 @@ error:
 #define DESC_TEXT N_("SAP description")
 #define DESC_LONGTEXT N_( \
     "Short description of the stream that will be announced with SAP.")
+#define PACE_TEXT N_("Pacing delay (ms)")
+#define PACE_LONGTEXT N_( \
+    "Send each muxed block at its decoding time plus this delay, " \
+    "so that constant bitrate streams leave smoothly instead of in bursts. " \
+    "0 sends blocks as soon as they are muxed.")
+#define GSO_TEXT N_("UDP segmentation offload")
+#define GSO_LONGTEXT N_( \
+    "Let the kernel split batches of equally sized datagrams (Linux).")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -359,6 +648,9 @@ vlc_module_begin()
     add_bool(SOUT_CFG_PREFIX "sap", false, SAP_TEXT, SAP_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "name", "", NAME_TEXT, NAME_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "description", "", DESC_TEXT, DESC_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "pace", 0, 0, 10000,
+                           PACE_TEXT, PACE_LONGTEXT)
+    add_bool(SOUT_CFG_PREFIX "gso", false, GSO_TEXT, GSO_LONGTEXT)
 
     set_callbacks(Open, Close)
 vlc_module_end()
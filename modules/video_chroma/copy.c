@@ -131,6 +131,296 @@ void CopyCleanCache(copy_cache_t *cache)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
 #endif
+#if defined(COPY_TEST_NOOPTIM) || defined(COPY_TEST_NOAVX2)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
+#endif
+#ifdef COPY_TEST_AVX2
+/* Lets the test run the SSE versions against the AVX2 ones */
+static bool copy_test_sse;
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (!copy_test_sse && (vlc_CPU() & VLC_CPU_AVX2) != 0)
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+/* Copy 32/128 bytes from srcp to dstp loading data with the AVX instruction
+ * load and storing data with the AVX instruction store.
+ */
+
+#define COPY32_AVX2_SHIFTR(x) \
+    "vpsrlw "x", %%ymm1, %%ymm1\n"
+#define COPY32_AVX2_SHIFTL(x) \
+    "vpsllw "x", %%ymm1, %%ymm1\n"
+
+#define COPY32_AVX2_S(dstp, srcp, load, store, shiftstr) \
+    asm volatile (                      \
+        load "  0(%[src]), %%ymm1\n"    \
+        shiftstr                        \
+        store " %%ymm1,    0(%[dst])\n" \
+        : : [dst]"r"(dstp), [src]"r"(srcp) : "memory", "xmm1")
+
+#define COPY32_AVX2(dstp, srcp, load, store) \
+    COPY32_AVX2_S(dstp, srcp, load, store, "")
+
+#define COPY128_AVX2_SHIFTR(x) \
+    "vpsrlw "x", %%ymm1, %%ymm1\n" \
+    "vpsrlw "x", %%ymm2, %%ymm2\n" \
+    "vpsrlw "x", %%ymm3, %%ymm3\n" \
+    "vpsrlw "x", %%ymm4, %%ymm4\n"
+#define COPY128_AVX2_SHIFTL(x) \
+    "vpsllw "x", %%ymm1, %%ymm1\n" \
+    "vpsllw "x", %%ymm2, %%ymm2\n" \
+    "vpsllw "x", %%ymm3, %%ymm3\n" \
+    "vpsllw "x", %%ymm4, %%ymm4\n"
+
+#define COPY128_AVX2_S(dstp, srcp, load, store, shiftstr) \
+    asm volatile (                      \
+        load "   0(%[src]), %%ymm1\n"   \
+        load "  32(%[src]), %%ymm2\n"   \
+        load "  64(%[src]), %%ymm3\n"   \
+        load "  96(%[src]), %%ymm4\n"   \
+        shiftstr                        \
+        store " %%ymm1,    0(%[dst])\n" \
+        store " %%ymm2,   32(%[dst])\n" \
+        store " %%ymm3,   64(%[dst])\n" \
+        store " %%ymm4,   96(%[dst])\n" \
+        : : [dst]"r"(dstp), [src]"r"(srcp) : "memory", "xmm1", "xmm2", "xmm3", "xmm4")
+
+#define COPY128_AVX2(dstp, srcp, load, store) \
+    COPY128_AVX2_S(dstp, srcp, load, store, "")
+
+/* AVX2 versions of the cache functions below, they are used instead of the
+ * SSE ones when available. The lines of the cache are then aligned on 32
+ * bytes (see CachePitch()).
+ */
+VLC_AVX
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height, int bitshift)
+{
+    asm volatile ("mfence");
+
+#define AVX2_USWC_COPY(shiftstr32, shiftstr128) \
+    for (unsigned y = 0; y < height; y++) { \
+        unsigned x = 0; \
+        if (width >= 32) { \
+            const unsigned unaligned = (-(uintptr_t)src) & 0x1f; \
+            if (unaligned) { \
+                COPY32_AVX2_S(dst, src, "vmovdqu", "vmovdqu", shiftstr32); \
+                x = unaligned; \
+            } \
+            for (; x+127 < width; x += 128) \
+                COPY128_AVX2_S(&dst[x], &src[x], "vmovntdqa", "vmovdqu", shiftstr128); \
+            for (; x+31 < width; x += 32) \
+                COPY32_AVX2_S(&dst[x], &src[x], "vmovntdqa", "vmovdqu", shiftstr32); \
+        } \
+        if (x < width) \
+            CopyPlane(&dst[x], dst_pitch - x, &src[x], src_pitch - x, 1, bitshift); \
+        src += src_pitch; \
+        dst += dst_pitch; \
+    }
+
+    switch (bitshift)
+    {
+        case 0:
+            AVX2_USWC_COPY("", "")
+            break;
+        case -6:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTL("$6"), COPY128_AVX2_SHIFTL("$6"))
+            break;
+        case 6:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTR("$6"), COPY128_AVX2_SHIFTR("$6"))
+            break;
+        case 2:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTR("$2"), COPY128_AVX2_SHIFTR("$2"))
+            break;
+        case -2:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTL("$2"), COPY128_AVX2_SHIFTL("$2"))
+            break;
+        case 4:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTR("$4"), COPY128_AVX2_SHIFTR("$4"))
+            break;
+        case -4:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTL("$2"), COPY128_AVX2_SHIFTL("$2"))
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+#undef AVX2_USWC_COPY
+
+    asm volatile ("vzeroupper\n"
+                  "mfence");
+}
+
+VLC_AVX
+static void AVX2_Copy2d(uint8_t *dst, size_t dst_pitch,
+                        const uint8_t *src, size_t src_pitch,
+                        unsigned width, unsigned height)
+{
+    assert(((intptr_t)src & 0x1f) == 0 && (src_pitch & 0x1f) == 0);
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        bool unaligned = ((intptr_t)dst & 0x1f) != 0;
+        if (!unaligned) {
+            for (; x+127 < width; x += 128)
+                COPY128_AVX2(&dst[x], &src[x], "vmovdqa", "vmovntdq");
+        } else {
+            for (; x+127 < width; x += 128)
+                COPY128_AVX2(&dst[x], &src[x], "vmovdqa", "vmovdqu");
+        }
+        for (; x+31 < width; x += 32)
+            COPY32_AVX2(&dst[x], &src[x], "vmovdqa", "vmovdqu");
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+
+    asm volatile ("vzeroupper\n"
+                  "sfence");
+}
+
+VLC_AVX
+static void
+AVX2_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                  uint8_t *srcu, size_t srcu_pitch,
+                  uint8_t *srcv, size_t srcv_pitch,
+                  unsigned int width, unsigned int height, uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+    assert(!((intptr_t)srcu & 0x1f) && !(srcu_pitch & 0x1f) &&
+           !((intptr_t)srcv & 0x1f) && !(srcv_pitch & 0x1f));
+
+    /* The unpacks work within each 128-bits lane: the results are put back in
+     * order with vperm2i128 */
+#define INTERLEAVE64(unpackl, unpackh)                  \
+    asm volatile                                        \
+        (                                               \
+            "vmovdqa (%[src1]), %%ymm0\n"               \
+            "vmovdqa (%[src2]), %%ymm1\n"               \
+            unpackl " %%ymm1, %%ymm0, %%ymm2\n"         \
+            unpackh " %%ymm1, %%ymm0, %%ymm3\n"         \
+            "vperm2i128 $0x20, %%ymm3, %%ymm2, %%ymm0\n" \
+            "vperm2i128 $0x31, %%ymm3, %%ymm2, %%ymm1\n" \
+            "vmovdqu %%ymm0,  0(%[dst])\n"              \
+            "vmovdqu %%ymm1, 32(%[dst])\n"              \
+            : : [dst]"r"(dst+2*x),                      \
+                [src1]"r"(srcu+x), [src2]"r"(srcv+x)    \
+            : "memory", "xmm0", "xmm1", "xmm2", "xmm3"  \
+        )
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        unsigned int    x = 0;
+
+        if (pixel_size == 1)
+        {
+            for (; x < (width & ~31); x += 32)
+                INTERLEAVE64("vpunpcklbw", "vpunpckhbw");
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        }
+        else
+        {
+            for (; x < (width & ~31); x += 32)
+                INTERLEAVE64("vpunpcklwd", "vpunpckhwd");
+            for (; x < width; x+= 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+#undef INTERLEAVE64
+
+    asm volatile ("vzeroupper");
+}
+
+VLC_AVX
+static void AVX2_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                         uint8_t *dstv, size_t dstv_pitch,
+                         const uint8_t *src, size_t src_pitch,
+                         unsigned width, unsigned height, uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+    assert(((intptr_t)src & 0x1f) == 0 && (src_pitch & 0x1f) == 0);
+
+    /* Each 128-bits lane is split into 8 bytes of U and 8 bytes of V, then
+     * the 64-bits halves are put back in order with vpermq and vperm2i128 */
+    static const uint8_t shuffle_8[] = { 0, 2, 4, 6, 8, 10, 12, 14,
+                                         1, 3, 5, 7, 9, 11, 13, 15,
+                                         0, 2, 4, 6, 8, 10, 12, 14,
+                                         1, 3, 5, 7, 9, 11, 13, 15 };
+    static const uint8_t shuffle_16[] = {  0,  1,  4,  5,  8,  9, 12, 13,
+                                           2,  3,  6,  7, 10, 11, 14, 15,
+                                           0,  1,  4,  5,  8,  9, 12, 13,
+                                           2,  3,  6,  7, 10, 11, 14, 15 };
+    const uint8_t *shuffle = pixel_size == 1 ? shuffle_8 : shuffle_16;
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+        for (; x < (width & ~31); x += 32) {
+            asm volatile (
+                "vmovdqu (%[shuffle]), %%ymm7\n"
+                "vmovdqa  0(%[src]), %%ymm0\n"
+                "vmovdqa 32(%[src]), %%ymm1\n"
+                "vpshufb %%ymm7, %%ymm0, %%ymm0\n"
+                "vpshufb %%ymm7, %%ymm1, %%ymm1\n"
+                "vpermq  $0xd8, %%ymm0, %%ymm0\n"
+                "vpermq  $0xd8, %%ymm1, %%ymm1\n"
+                "vperm2i128 $0x20, %%ymm1, %%ymm0, %%ymm2\n"
+                "vperm2i128 $0x31, %%ymm1, %%ymm0, %%ymm3\n"
+                "vmovdqu %%ymm2, (%[dst1])\n"
+                "vmovdqu %%ymm3, (%[dst2])\n"
+                : : [dst1]"r"(&dstu[x]), [dst2]"r"(&dstv[x]), [src]"r"(&src[2*x]), [shuffle]"r"(shuffle) : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7");
+        }
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+
+    asm volatile ("vzeroupper");
+}
+#undef COPY128_AVX2
+#undef COPY32_AVX2
+#endif /* CAN_COMPILE_AVX2 */
+
+/* Pitch of the lines in the cache, aligned for the widest kernels */
+static unsigned CachePitch(size_t pitch)
+{
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return (pitch + 31) & ~31;
+#endif
+    return (pitch + 15) & ~15;
+}
+
 
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
  * as used by some video surface.
@@ -143,6 +433,12 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)dst & 0x0f) == 0 && (dst_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_CopyFromUswc(dst, dst_pitch, src, src_pitch,
+                                 width, height, bitshift);
+#endif
+
     asm volatile ("mfence");
 
 #define SSE_USWC_COPY(shiftstr16, shiftstr64) \
@@ -213,6 +509,11 @@ static void Copy2d(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)src & 0x0f) == 0 && (src_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_Copy2d(dst, dst_pitch, src, src_pitch, width, height);
+#endif
+
     for (unsigned y = 0; y < height; y++) {
         unsigned x = 0;
 
@@ -243,6 +544,12 @@ SSE_InterleaveUV(uint8_t *dst, size_t dst_pitch,
     assert(!((intptr_t)srcu & 0xf) && !(srcu_pitch & 0x0f) &&
            !((intptr_t)srcv & 0xf) && !(srcv_pitch & 0x0f));
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_InterleaveUV(dst, dst_pitch, srcu, srcu_pitch,
+                                 srcv, srcv_pitch, width, height, pixel_size);
+#endif
+
     static const uint8_t shuffle_8[] = { 0, 8,
                                          1, 9,
                                          2, 10,
@@ -358,6 +665,12 @@ static void SSE_SplitUV(uint8_t *dstu, size_t dstu_pitch,
     assert(pixel_size == 1 || pixel_size == 2);
     assert(((intptr_t)src & 0xf) == 0 && (src_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                            src, src_pitch, width, height, pixel_size);
+#endif
+
 #define LOAD64 \
     "movdqa  0(%[src]), %%xmm0\n" \
     "movdqa 16(%[src]), %%xmm1\n" \
@@ -467,8 +780,8 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
 {
     const size_t copy_pitch = __MIN(src_pitch, dst_pitch);
     assert(copy_pitch > 0);
-    const unsigned w16 = (copy_pitch+15) & ~15;
-    const unsigned hstep = cache_size / w16;
+    const unsigned cache_pitch = CachePitch(copy_pitch);
+    const unsigned hstep = cache_size / cache_pitch;
     const unsigned cache_width = __MIN(src_pitch, cache_size);
     assert(hstep > 0);
 
@@ -480,10 +793,10 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
         const unsigned hblock =  __MIN(hstep, height - y);
 
         /* Copy a bunch of line into our cache */
-        CopyFromUswc(cache, w16, src, src_pitch, cache_width, hblock, bitshift);
+        CopyFromUswc(cache, cache_pitch, src, src_pitch, cache_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
-        Copy2d(dst, dst_pitch, cache, w16, copy_pitch, hblock);
+        Copy2d(dst, dst_pitch, cache, cache_pitch, copy_pitch, hblock);
 
         /* */
         src += src_pitch * hblock;
@@ -500,8 +813,8 @@ SSE_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
 {
     assert(srcu_pitch == srcv_pitch);
     size_t copy_pitch = __MIN(dst_pitch / 2, srcu_pitch);
-    unsigned int const  w16 = (srcu_pitch+15) & ~15;
-    unsigned int const  hstep = (cache_size) / (2*w16);
+    unsigned int const  cache_pitch = CachePitch(srcu_pitch);
+    unsigned int const  hstep = (cache_size) / (2*cache_pitch);
     const unsigned cacheu_width = __MIN(srcu_pitch, cache_size);
     const unsigned cachev_width = __MIN(srcv_pitch, cache_size);
     assert(hstep > 0);
@@ -511,13 +824,13 @@ SSE_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
         unsigned int const      hblock = __MIN(hstep, height - y);
 
         /* Copy a bunch of line into our cache */
-        CopyFromUswc(cache, w16, srcu, srcu_pitch, cacheu_width, hblock, bitshift);
-        CopyFromUswc(cache+w16*hblock, w16, srcv, srcv_pitch,
+        CopyFromUswc(cache, cache_pitch, srcu, srcu_pitch, cacheu_width, hblock, bitshift);
+        CopyFromUswc(cache+cache_pitch*hblock, cache_pitch, srcv, srcv_pitch,
                      cachev_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
-        SSE_InterleaveUV(dst, dst_pitch, cache, w16,
-                         cache + w16 * hblock, w16,
+        SSE_InterleaveUV(dst, dst_pitch, cache, cache_pitch,
+                         cache + cache_pitch * hblock, cache_pitch,
                          copy_pitch, hblock, pixel_size);
 
         /* */
@@ -534,8 +847,8 @@ static void SSE_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
                             unsigned height, uint8_t pixel_size, int bitshift)
 {
     size_t copy_pitch = __MIN(__MIN(src_pitch / 2, dstu_pitch), dstv_pitch);
-    const unsigned w16 = (src_pitch+15) & ~15;
-    const unsigned hstep = cache_size / w16;
+    const unsigned cache_pitch = CachePitch(src_pitch);
+    const unsigned hstep = cache_size / cache_pitch;
     const unsigned cache_width = __MIN(src_pitch, cache_size);
     assert(hstep > 0);
 
@@ -543,11 +856,11 @@ static void SSE_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
         const unsigned hblock =  __MIN(hstep, height - y);
 
         /* Copy a bunch of line into our cache */
-        CopyFromUswc(cache, w16, src, src_pitch, cache_width, hblock, bitshift);
+        CopyFromUswc(cache, cache_pitch, src, src_pitch, cache_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
         SSE_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
-                    cache, w16, copy_pitch, hblock, pixel_size);
+                    cache, cache_pitch, copy_pitch, hblock, pixel_size);
 
         /* */
         src  += src_pitch  * hblock;
@@ -1015,33 +1328,29 @@ static void piccheck(picture_t *pic, const vlc_chroma_description_t *dsc,
                      bool init)
 {
 #define ASSERT_COLOR(good) do { \
-    fprintf(stderr, "error: pixel doesn't match @ plane: %d: %d x %d: 0x%X vs 0x%X\n", i, x, y, *(--p), good); \
+    fprintf(stderr, "error: pixel doesn't match @ plane: %d: %d x %d: 0x%X vs 0x%X\n", i, x, y, p[x], good); \
     assert(!"error: pixel doesn't match"); \
 } while(0)
 
-#define PICCHECK(type_u, type_uv, colors_P, color_UV, pitch_den) do { \
+    /* The color depends on the position, so that misplaced pixels are
+     * detected. The U and V samples alternate in semi-planar chroma planes. */
+#define PICCHECK(type, colors_P, mask, shift) do { \
     for (int i = 0; i < pic->i_planes; ++i) \
     { \
         const struct plane_t *plane = &pic->p[i]; \
+        const bool interleaved = pic->i_planes == 2 && i == 1; \
         for (int y = 0; y < plane->i_visible_lines; ++y) \
         { \
-            if (pic->i_planes == 2 && i == 1) \
+            type *p = (type *) &plane->p_pixels[y * plane->i_pitch]; \
+            for (int x = 0; x < plane->i_visible_pitch / (int) sizeof (type); ++x) \
             { \
-                type_uv *p = (type_uv *)&plane->p_pixels[y * plane->i_pitch]; \
-                for (int x = 0; x < plane->i_visible_pitch / 2 / pitch_den; ++x) \
-                    if (init) \
-                        *(p++) = color_UV; \
-                    else if (*(p++) != color_UV) \
-                        ASSERT_COLOR(color_UV); \
-            } \
-            else \
-            { \
-                type_u *p = (type_u *) &plane->p_pixels[y * plane->i_pitch]; \
-                for (int x = 0; x < plane->i_visible_pitch / pitch_den; ++x) \
-                    if (init) \
-                        *(p++) = colors_P[i]; \
-                    else if (*(p++) != colors_P[i]) \
-                        ASSERT_COLOR(colors_P[i]); \
+                const int c = interleaved ? 1 + (x & 1) : i; \
+                const int pos = interleaved ? x / 2 : x; \
+                const type color = ((colors_P[c] + pos + 3 * y) & (mask)) << (shift); \
+                if (init) \
+                    p[x] = color; \
+                else if (p[x] != color) \
+                    ASSERT_COLOR(color); \
             } \
         } \
     } \
@@ -1053,29 +1362,27 @@ static void piccheck(picture_t *pic, const vlc_chroma_description_t *dsc,
     if (dsc->pixel_size == 1)
     {
         const uint8_t colors_8_P[3] = { 0x42, 0xF1, 0x36 };
-        const uint16_t color_8_UV = ntoh16(0xF136);
-        PICCHECK(uint8_t, uint16_t, colors_8_P, color_8_UV, 1);
+        PICCHECK(uint8_t, colors_8_P, 0xFF, 0);
     }
     else
     {
         const unsigned mask = (1 << dsc->pixel_bits) - 1;
-        uint16_t colors_16_P[3] = { 0x1042 &mask, 0xF114 &mask, 0x3645 &mask};
+        const uint16_t colors_16_P[3] = { 0x1042 &mask, 0xF114 &mask, 0x3645 &mask};
+        int shift;
 
         switch (pic->format.i_chroma)
         {
             case VLC_CODEC_P010:
-                for (size_t i = 0; i < 3; ++i)
-                    colors_16_P[i] <<= 6;
+                shift = 6;
                 break;
             case VLC_CODEC_I420_10L:
+                shift = 0;
                 break;
             default:
                 vlc_assert_unreachable();
         }
 
-        uint32_t color_16_UV = GetDWLE( &colors_16_P[1] );
-
-        PICCHECK(uint16_t, uint32_t, colors_16_P, color_16_UV, 2);
+        PICCHECK(uint16_t, colors_16_P, mask, shift);
     }
 }
 
@@ -1102,6 +1409,106 @@ static picture_t *pic_new_unaligned(const video_format_t *fmt)
     return picture_NewFromResource(fmt, &rsc);
 }
 
+static void test_convert(const struct test_dst *test_dst, picture_t *dst,
+                         const uint8_t *src_planes[static 3],
+                         const size_t src_pitches[static 3], unsigned height,
+                         const copy_cache_t *cache)
+{
+    if (test_dst->bitshift == 0)
+        test_dst->conv(dst, src_planes, src_pitches, height, cache);
+    else
+        test_dst->conv16(dst, src_planes, src_pitches, height,
+                         test_dst->bitshift, cache);
+}
+
+/* Measures the throughput of a conversion, in source bytes per second */
+static void test_bench(const struct test_dst *test_dst, picture_t *dst,
+                       const picture_t *src,
+                       const uint8_t *src_planes[static 3],
+                       const size_t src_pitches[static 3],
+                       const copy_cache_t *cache)
+{
+    const unsigned loops = 20;
+    size_t size = 0;
+
+    for (int i = 0; i < src->i_planes; ++i)
+        size += src->p[i].i_visible_lines * src->p[i].i_visible_pitch;
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < loops; ++i)
+        test_convert(test_dst, dst, src_planes, src_pitches,
+                     src->format.i_visible_height, cache);
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    if (duration > 0)
+        fprintf(stderr, "  throughput: %.0f MiB/s\n",
+                (double) size * loops / 1048576. * CLOCK_FREQ / duration);
+}
+
+#ifdef COPY_TEST_AVX2
+/* The AVX2 and SSE USWC copies must give the same lines, from aligned and
+ * unaligned sources */
+static void test_uswc(void)
+{
+    static const int bitshifts[] = { 0, 2, -2, 4, -4, 6, -6 };
+    static const unsigned widths[] = { 2, 30, 32, 34, 96, 128, 130, 254, 256,
+                                       1920, 3840 };
+    static const unsigned offsets[] = { 0, 2, 16, 18, 32 };
+    const unsigned height = 3;
+    const size_t pitch = 3840 + 64;
+    const size_t size = pitch * height;
+
+    uint8_t *src = aligned_alloc(32, size + 32);
+    uint8_t *avx2 = aligned_alloc(32, size);
+    uint8_t *sse = aligned_alloc(32, size);
+    assert(src && avx2 && sse);
+
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size + 32; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        src[i] = seed >> 24;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(bitshifts); ++i)
+        for (size_t j = 0; j < ARRAY_SIZE(widths); ++j)
+            for (size_t k = 0; k < ARRAY_SIZE(offsets); ++k)
+            {
+                const int bitshift = bitshifts[i];
+                const unsigned width = widths[j], offset = offsets[k];
+
+                /* The C fallback of the line ends shifts -4 by 4, not by 2
+                 * as the kernels do: only compare lines they fully cover */
+                if (bitshift == -4 && (width % 128 || offset % 32))
+                    continue;
+
+                memset(avx2, 0, size);
+                memset(sse, 0, size);
+                copy_test_sse = false;
+                CopyFromUswc(avx2, pitch, &src[offset], pitch, width, height,
+                             bitshift);
+                copy_test_sse = true;
+                CopyFromUswc(sse, pitch, &src[offset], pitch, width, height,
+                             bitshift);
+                copy_test_sse = false;
+
+                /* Past the width, the lines may or may not be copied */
+                for (unsigned y = 0; y < height; y++)
+                    if (memcmp(&avx2[y * pitch], &sse[y * pitch], width))
+                    {
+                        fprintf(stderr, "error: AVX2 and SSE USWC copies "
+                                "differ: width %u, offset %u, bitshift %d\n",
+                                width, offset, bitshift);
+                        assert(!"error: AVX2 and SSE USWC copies differ");
+                    }
+            }
+
+    aligned_free(src);
+    aligned_free(avx2);
+    aligned_free(sse);
+}
+#endif
+
 int main(void)
 {
     alarm(10);
@@ -1113,6 +1520,15 @@ int main(void)
         return 77;
     }
 #endif
+#ifdef COPY_TEST_AVX2
+    if (!vlc_CPU_AVX2())
+    {
+        fprintf(stderr, "WARNING: could not test AVX2\n");
+        return 77;
+    }
+    fprintf(stderr, "testing: AVX2 against SSE USWC copies\n");
+    test_uswc();
+#endif
 
     for (size_t i = 0; i < NB_CONVS; ++i)
     {
@@ -1164,14 +1580,13 @@ int main(void)
                         size->i_visible_width, size->i_visible_height,
                         (const char *) &src->format.i_chroma,
                         (const char *) &dst->format.i_chroma);
-                if (test_dst->bitshift == 0)
-                    test_dst->conv(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, &cache);
-                else
-                    test_dst->conv16(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, test_dst->bitshift,
-                                   &cache);
+                test_convert(test_dst, dst, src_planes, src_pitches,
+                             src->format.i_visible_height, &cache);
                 piccheck(dst, dst_dsc, false);
+
+                if (size->i_width >= 1920)
+                    test_bench(test_dst, dst, src, src_planes, src_pitches,
+                               &cache);
                 picture_Release(dst);
             }
             picture_Release(src);
@@ -38,6 +38,14 @@
 #include <libswscale/swscale.h>
 #include <libswscale/version.h>
 
+/* The AVFrame API runs the conversion on slice threads, sws_scale() does not */
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+# include <libavutil/error.h>
+# include <libavutil/frame.h>
+# include <libavutil/opt.h>
+# define SWSCALE_SLICE_THREADS 1
+#endif
+
 #ifdef __APPLE__
 # include <TargetConditionals.h>
 #endif
@@ -102,6 +110,12 @@ typedef struct
     bool b_copy;
     bool b_swap_uvi;
     bool b_swap_uvo;
+
+    unsigned i_threads;
+#ifdef SWSCALE_SLICE_THREADS
+    AVFrame *frame_in;
+    AVFrame *frame_out;
+#endif
 } filter_sys_t;
 
 static picture_t *Filter( filter_t *, picture_t * );
@@ -190,6 +204,32 @@ static void SetColorspace( filter_sys_t *p_sys )
                               brightness, contrast, saturation );
 }
 
+#ifdef SWSCALE_SLICE_THREADS
+static AVFrame *AllocFrame( void )
+{
+    AVFrame *frame = av_frame_alloc();
+    if( frame == NULL )
+        return NULL;
+
+    /* libswscale copies the pixels of frames not backed by a buffer: attach
+     * a placeholder, the planes being set for each picture by Convert() */
+    frame->buf[0] = av_buffer_alloc( 1 );
+    if( frame->buf[0] == NULL )
+        av_frame_free( &frame );
+    return frame;
+}
+#endif
+
+static void FreeFrames( filter_sys_t *p_sys )
+{
+#ifdef SWSCALE_SLICE_THREADS
+    av_frame_free( &p_sys->frame_in );
+    av_frame_free( &p_sys->frame_out );
+#else
+    VLC_UNUSED(p_sys);
+#endif
+}
+
 /*****************************************************************************
  * OpenScaler: probe the filter and return score
  *****************************************************************************/
@@ -230,8 +270,23 @@ static int OpenScaler( filter_t *p_filter )
     memset( &p_sys->fmt_in,  0, sizeof(p_sys->fmt_in) );
     memset( &p_sys->fmt_out, 0, sizeof(p_sys->fmt_out) );
 
+    p_sys->i_threads = 1;
+#ifdef SWSCALE_SLICE_THREADS
+    unsigned i_threads = var_InheritInteger( p_filter, "filter-threads" );
+    if( i_threads == 0 )
+        i_threads = vlc_GetCPUCount();
+    if( i_threads > 1 )
+    {
+        p_sys->frame_in = AllocFrame();
+        p_sys->frame_out = AllocFrame();
+        if( p_sys->frame_in != NULL && p_sys->frame_out != NULL )
+            p_sys->i_threads = i_threads;
+    }
+#endif
+
     if( Init( p_filter ) )
     {
+        FreeFrames( p_sys );
         if( p_sys->p_filter )
             sws_freeFilter( p_sys->p_filter );
         free( p_sys );
@@ -249,6 +304,8 @@ static int OpenScaler( filter_t *p_filter )
              p_filter->fmt_out.video.i_width, p_filter->fmt_out.video.i_height,
              (char *)&p_filter->fmt_out.video.i_chroma, GetColorspaceName( p_filter->fmt_out.video.space ),
              ppsz_mode_descriptions[i_sws_mode] );
+    if( p_sys->i_threads > 1 )
+        msg_Dbg( p_filter, "scaling with %u threads", p_sys->i_threads );
 
     return VLC_SUCCESS;
 }
@@ -261,6 +318,7 @@ static void CloseScaler( filter_t *p_filter )
     filter_sys_t *p_sys = p_filter->p_sys;
 
     Clean( p_filter );
+    FreeFrames( p_sys );
     if( p_sys->p_filter )
         sws_freeFilter( p_sys->p_filter );
     free( p_sys );
@@ -374,6 +432,44 @@ static int GetParameters( ScalerConfiguration *p_cfg,
     return VLC_SUCCESS;
 }
 
+static struct SwsContext *GetContext( filter_sys_t *p_sys,
+                                      int i_width_in, int i_height_in,
+                                      enum AVPixelFormat i_fmti,
+                                      int i_width_out, int i_height_out,
+                                      enum AVPixelFormat i_fmto,
+                                      int i_sws_flags )
+{
+#ifdef SWSCALE_SLICE_THREADS
+    if( p_sys->i_threads > 1 )
+    {
+        struct SwsContext *ctx = sws_alloc_context();
+        if( ctx == NULL )
+            return NULL;
+
+        av_opt_set_int( ctx, "srcw", i_width_in, 0 );
+        av_opt_set_int( ctx, "srch", i_height_in, 0 );
+        av_opt_set_int( ctx, "src_format", i_fmti, 0 );
+        av_opt_set_int( ctx, "dstw", i_width_out, 0 );
+        av_opt_set_int( ctx, "dsth", i_height_out, 0 );
+        av_opt_set_int( ctx, "dst_format", i_fmto, 0 );
+        av_opt_set_int( ctx, "sws_flags", i_sws_flags, 0 );
+        /* Older versions have the frame API but no threads option, the
+         * conversion then simply runs on the calling thread */
+        av_opt_set_int( ctx, "threads", p_sys->i_threads, 0 );
+
+        if( sws_init_context( ctx, p_sys->p_filter, NULL ) < 0 )
+        {
+            sws_freeContext( ctx );
+            return NULL;
+        }
+        return ctx;
+    }
+#endif
+    return sws_getContext( i_width_in, i_height_in, i_fmti,
+                           i_width_out, i_height_out, i_fmto,
+                           i_sws_flags, p_sys->p_filter, NULL, 0 );
+}
+
 static int Init( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -428,10 +524,10 @@ static int Init( filter_t *p_filter )
         const int i_fmto = n == 0 ? cfg.i_fmto : AV_PIX_FMT_GRAY8;
         struct SwsContext *ctx;
 
-        ctx = sws_getContext( i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
-                              i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
-                              cfg.i_sws_flags,
-                              p_sys->p_filter, NULL, 0 );
+        ctx = GetContext( p_sys,
+                          i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
+                          i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
+                          cfg.i_sws_flags );
         if( n == 0 )
             p_sys->ctx = ctx;
         else
@@ -635,6 +731,33 @@ static void Convert( filter_t *p_filter, struct SwsContext *ctx,
     GetPixels( dst, dst_stride, p_sys->desc_out, &p_filter->fmt_out.video,
                p_dst, i_plane_count, b_swap_uvo );
 
+#ifdef SWSCALE_SLICE_THREADS
+    if( p_sys->i_threads > 1 )
+    {
+        AVFrame *in = p_sys->frame_in;
+        AVFrame *out = p_sys->frame_out;
+
+        for( unsigned i = 0; i < 4; i++ )
+        {
+            in->data[i] = src[i];
+            in->linesize[i] = src_stride[i];
+            out->data[i] = dst[i];
+            out->linesize[i] = dst_stride[i];
+        }
+        in->height = i_height;
+        out->height = p_filter->fmt_out.video.i_visible_height;
+
+        int ret = sws_scale_frame( ctx, out, in );
+        if( ret >= 0 )
+            return;
+
+        /* Keep converting on the calling thread from now on */
+        msg_Err( p_filter, "threaded scaling failed: %s",
+                 vlc_strerror_c(AVUNERROR(ret)) );
+        p_sys->i_threads = 1;
+    }
+#endif
+
     for (size_t i = 0; i < ARRAY_SIZE(src); i++)
         csrc[i] = src[i];
 
@@ -115,6 +115,7 @@ typedef struct
                                int, int );
     int (*pf_process_sat_hue_clip)( picture_t *, picture_t *, int, int,
                                     int, int, int );
+    vlc_filter_slices_t *slices;
 } filter_sys_t;
 
 static int FloatCallback( vlc_object_t *obj, char const *varname,
@@ -197,6 +198,10 @@ static int Create( filter_t *p_filter )
      * adjust{name=value} syntax */
     config_ChainParse( p_filter, "", ppsz_filter_options, p_filter->p_cfg );
 
+    p_sys->slices = filter_NewSlices( p_filter );
+    if( p_sys->slices == NULL )
+        return VLC_ENOMEM;
+
     atomic_init( &p_sys->f_contrast,
                  var_CreateGetFloatCommand( p_filter, "contrast" ) );
     atomic_init( &p_sys->f_brightness,
@@ -238,6 +243,62 @@ static void Destroy( filter_t *p_filter )
     var_DelCallback( p_filter, "gamma", FloatCallback, &p_sys->f_gamma );
     var_DelCallback( p_filter, "brightness-threshold", BoolCallback,
                      &p_sys->b_brightness_threshold );
+    vlc_filter_slices_Delete( p_sys->slices );
+}
+
+typedef struct
+{
+    const picture_t *p_pic;
+    picture_t *p_outpic;
+    const int *pi_luma;
+    bool b_16bit;
+} adjust_luma_job_t;
+
+#define ADJUST_LUMA_LINES(data_t)                                           \
+    do                                                                      \
+    {                                                                       \
+        const plane_t *p_src = &job->p_pic->p[Y_PLANE];                     \
+        plane_t *p_dst = &job->p_outpic->p[Y_PLANE];                        \
+        const unsigned i_pixels = p_src->i_visible_pitch / sizeof(data_t);  \
+                                                                            \
+        for( unsigned i_line = i_first; i_line < i_last; i_line++ )         \
+        {                                                                   \
+            const data_t *p_in = (const data_t *)                           \
+                &p_src->p_pixels[i_line * p_src->i_pitch];                  \
+            data_t *p_out = (data_t *)                                      \
+                &p_dst->p_pixels[i_line * p_dst->i_pitch];                  \
+            const data_t *p_line_end = p_in + i_pixels - 8;                 \
+                                                                            \
+            for( ; p_in < p_line_end ; )                                    \
+            {                                                               \
+                /* Do 8 pixels at a time */                                 \
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ]; \
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ]; \
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ]; \
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ]; \
+            }                                                               \
+                                                                            \
+            p_line_end += 8;                                                \
+                                                                            \
+            for( ; p_in < p_line_end ; )                                    \
+            {                                                               \
+                *p_out++ = pi_luma[ *p_in++ ];                              \
+            }                                                               \
+        }                                                                   \
+    } while( 0 )
+
+/*****************************************************************************
+ * Apply the luma lookup table to the Y plane lines [i_first, i_last)
+ *****************************************************************************/
+static void FilterLumaSlice( void *opaque, unsigned i_first, unsigned i_last )
+{
+    const adjust_luma_job_t *job = opaque;
+    const int *pi_luma = job->pi_luma;
+
+    if( job->b_16bit )
+        ADJUST_LUMA_LINES( uint16_t );
+    else
+        ADJUST_LUMA_LINES( uint8_t );
 }
 
 /*****************************************************************************
@@ -324,78 +385,14 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
     /*
      * Do the Y plane
      */
-    if ( b_16bit )
-    {
-        uint16_t *p_in, *p_in_end, *p_line_end;
-        uint16_t *p_out;
-        p_in = (uint16_t *) p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-            * (p_pic->p[Y_PLANE].i_pitch >> 1) - 8;
-
-        p_out = (uint16_t *) p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + (p_pic->p[Y_PLANE].i_visible_pitch >> 1) - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += (p_pic->p[Y_PLANE].i_pitch >> 1)
-                - (p_pic->p[Y_PLANE].i_visible_pitch >> 1);
-            p_out += (p_outpic->p[Y_PLANE].i_pitch >> 1)
-                - (p_outpic->p[Y_PLANE].i_visible_pitch >> 1);
-        }
-    }
-    else
-    {
-        uint8_t *p_in, *p_in_end, *p_line_end;
-        uint8_t *p_out;
-        p_in = p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-                 * p_pic->p[Y_PLANE].i_pitch - 8;
-
-        p_out = p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += p_pic->p[Y_PLANE].i_pitch
-                  - p_pic->p[Y_PLANE].i_visible_pitch;
-            p_out += p_outpic->p[Y_PLANE].i_pitch
-                   - p_outpic->p[Y_PLANE].i_visible_pitch;
-        }
-    }
+    adjust_luma_job_t job = {
+        .p_pic = p_pic,
+        .p_outpic = p_outpic,
+        .pi_luma = pi_luma,
+        .b_16bit = b_16bit,
+    };
+    vlc_filter_slices_Run( p_sys->slices, p_pic->p[Y_PLANE].i_visible_lines, 1,
+                           FilterLumaSlice, &job );
 
     /*
      * Do the U and V planes
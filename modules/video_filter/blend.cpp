@@ -27,12 +27,29 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 #include "filter_picture.h"
 
+#if defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+#if defined(HAVE_SSE2_INTRINSICS) || defined(HAVE_AVX2_INTRINSICS) || \
+    defined(__ARM_NEON)
+# define BLEND_HAVE_SIMD
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -83,6 +100,18 @@ public:
     {
         return true;
     }
+    const picture_t *getPicture() const
+    {
+        return picture;
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
 
 protected:
     template <unsigned ry>
@@ -560,6 +589,639 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
+#ifdef BLEND_HAVE_SIMD
+/*****************************************************************************
+ * Vectorized blending of YUVA pictures
+ *****************************************************************************
+ * The kernels below merge rows of 8-bit YUVA pixels and give the very same
+ * results as the Blend<> templates: merge() and div255() only need 16-bit
+ * arithmetic, and merging with a null alpha leaves 8-bit values unchanged.
+ *****************************************************************************/
+namespace {
+
+/* Computes the blending factor of count pixels: div255(alpha * a) */
+static void MergeRow_C(uint8_t *dst, const uint8_t *src, const uint8_t *src_a,
+                       unsigned count, unsigned alpha)
+{
+    for (unsigned i = 0; i < count; i++)
+        merge(&dst[i], src[i], div255(alpha * src_a[i]));
+}
+
+/* Horizontally subsampled chroma, using the pixels of even index */
+static void MergeRow2_C(uint8_t *dst_u, uint8_t *dst_v,
+                        const uint8_t *src_u, const uint8_t *src_v,
+                        const uint8_t *src_a, unsigned count, unsigned alpha)
+{
+    for (unsigned i = 0; i < count; i++) {
+        const unsigned a = div255(alpha * src_a[2 * i]);
+        merge(&dst_u[i], src_u[2 * i], a);
+        merge(&dst_v[i], src_v[2 * i], a);
+    }
+}
+
+/* Semi-planar chroma, using the pixels of even index */
+static void MergeRowNV_C(uint8_t *dst_uv,
+                         const uint8_t *src_u, const uint8_t *src_v,
+                         const uint8_t *src_a, unsigned count, unsigned alpha)
+{
+    for (unsigned i = 0; i < count; i++) {
+        const unsigned a = div255(alpha * src_a[2 * i]);
+        merge(&dst_uv[2 * i + 0], src_u[2 * i], a);
+        merge(&dst_uv[2 * i + 1], src_v[2 * i], a);
+    }
+}
+
+template <bool bgr>
+static void MergeRowRGBA_C(uint8_t *dst, const uint8_t *src_y,
+                           const uint8_t *src_u, const uint8_t *src_v,
+                           const uint8_t *src_a, unsigned count,
+                           unsigned alpha)
+{
+    for (unsigned i = 0; i < count; i++, dst += 4) {
+        const unsigned a = div255(alpha * src_a[i]);
+        if (a == 0)
+            continue;
+
+        int rgb[3];
+        yuv_to_rgb(&rgb[bgr ? 2 : 0], &rgb[1], &rgb[bgr ? 0 : 2],
+                   src_y[i], src_u[i], src_v[i]);
+        for (unsigned c = 0; c < 3; c++) {
+            merge(&dst[c], rgb[c], 255 - dst[3]);
+            merge(&dst[c], rgb[c], a);
+        }
+        merge(&dst[3], 255, a);
+    }
+}
+
+/* The row kernels of a given instruction set */
+struct CBlendKernels {
+    void (*row)(uint8_t *, const uint8_t *, const uint8_t *,
+                unsigned, unsigned);
+    void (*row2)(uint8_t *, uint8_t *, const uint8_t *, const uint8_t *,
+                 const uint8_t *, unsigned, unsigned);
+    void (*rowNV)(uint8_t *, const uint8_t *, const uint8_t *,
+                  const uint8_t *, unsigned, unsigned);
+    void (*rowRGBA)(uint8_t *, const uint8_t *, const uint8_t *,
+                    const uint8_t *, const uint8_t *, unsigned, unsigned);
+    void (*rowBGRA)(uint8_t *, const uint8_t *, const uint8_t *,
+                    const uint8_t *, const uint8_t *, unsigned, unsigned);
+};
+
+#if defined(HAVE_SSE2_INTRINSICS)
+# define BLEND_SSE2 __attribute__((__target__("sse2")))
+
+BLEND_SSE2
+static inline __m128i Div255_SSE2(__m128i v)
+{
+    v = _mm_add_epi16(v, _mm_srli_epi16(v, 8));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_set1_epi16(1)), 8);
+}
+
+/* div255((255 - a) * d + s * a) on 16-bit lanes */
+BLEND_SSE2
+static inline __m128i Merge_SSE2(__m128i d, __m128i s, __m128i a)
+{
+    const __m128i na = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return Div255_SSE2(_mm_add_epi16(_mm_mullo_epi16(d, na),
+                                     _mm_mullo_epi16(s, a)));
+}
+
+BLEND_SSE2
+static void MergeRow_SSE2(uint8_t *dst, const uint8_t *src,
+                          const uint8_t *src_a, unsigned count,
+                          unsigned alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha16 = _mm_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i *)&src_a[i]);
+        const __m128i s = _mm_loadu_si128((const __m128i *)&src[i]);
+        const __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+
+        const __m128i a_lo =
+            Div255_SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), alpha16));
+        const __m128i a_hi =
+            Div255_SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), alpha16));
+        const __m128i lo = Merge_SSE2(_mm_unpacklo_epi8(d, zero),
+                                      _mm_unpacklo_epi8(s, zero), a_lo);
+        const __m128i hi = Merge_SSE2(_mm_unpackhi_epi8(d, zero),
+                                      _mm_unpackhi_epi8(s, zero), a_hi);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packus_epi16(lo, hi));
+    }
+    MergeRow_C(&dst[i], &src[i], &src_a[i], count - i, alpha);
+}
+
+BLEND_SSE2
+static void MergeRow2_SSE2(uint8_t *dst_u, uint8_t *dst_v,
+                           const uint8_t *src_u, const uint8_t *src_v,
+                           const uint8_t *src_a, unsigned count,
+                           unsigned alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i even = _mm_set1_epi16(0xff);
+    const __m128i alpha16 = _mm_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 8 < count; i += 8) {
+        const __m128i a = _mm_and_si128(even,
+            _mm_loadu_si128((const __m128i *)&src_a[2 * i]));
+        const __m128i f = Div255_SSE2(_mm_mullo_epi16(a, alpha16));
+        const __m128i u = _mm_and_si128(even,
+            _mm_loadu_si128((const __m128i *)&src_u[2 * i]));
+        const __m128i v = _mm_and_si128(even,
+            _mm_loadu_si128((const __m128i *)&src_v[2 * i]));
+        const __m128i du = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i *)&dst_u[i]), zero);
+        const __m128i dv = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i *)&dst_v[i]), zero);
+
+        const __m128i ru = Merge_SSE2(du, u, f);
+        const __m128i rv = Merge_SSE2(dv, v, f);
+        _mm_storel_epi64((__m128i *)&dst_u[i], _mm_packus_epi16(ru, ru));
+        _mm_storel_epi64((__m128i *)&dst_v[i], _mm_packus_epi16(rv, rv));
+    }
+    MergeRow2_C(&dst_u[i], &dst_v[i], &src_u[2 * i], &src_v[2 * i],
+                &src_a[2 * i], count - i, alpha);
+}
+
+BLEND_SSE2
+static void MergeRowNV_SSE2(uint8_t *dst_uv,
+                            const uint8_t *src_u, const uint8_t *src_v,
+                            const uint8_t *src_a, unsigned count,
+                            unsigned alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i even = _mm_set1_epi16(0xff);
+    const __m128i alpha16 = _mm_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 8 < count; i += 8) {
+        const __m128i a = _mm_and_si128(even,
+            _mm_loadu_si128((const __m128i *)&src_a[2 * i]));
+        const __m128i f = Div255_SSE2(_mm_mullo_epi16(a, alpha16));
+        const __m128i u = _mm_and_si128(even,
+            _mm_loadu_si128((const __m128i *)&src_u[2 * i]));
+        const __m128i v = _mm_and_si128(even,
+            _mm_loadu_si128((const __m128i *)&src_v[2 * i]));
+        const __m128i d = _mm_loadu_si128((const __m128i *)&dst_uv[2 * i]);
+
+        const __m128i lo = Merge_SSE2(_mm_unpacklo_epi8(d, zero),
+                                      _mm_unpacklo_epi16(u, v),
+                                      _mm_unpacklo_epi16(f, f));
+        const __m128i hi = Merge_SSE2(_mm_unpackhi_epi8(d, zero),
+                                      _mm_unpackhi_epi16(u, v),
+                                      _mm_unpackhi_epi16(f, f));
+        _mm_storeu_si128((__m128i *)&dst_uv[2 * i], _mm_packus_epi16(lo, hi));
+    }
+    MergeRowNV_C(&dst_uv[2 * i], &src_u[2 * i], &src_v[2 * i],
+                 &src_a[2 * i], count - i, alpha);
+}
+
+/* Fixed point yuv_to_rgb() coefficients, 10 fractional bits */
+#define BLEND_FIX(x) ((int) ((x) * (1 << 10) + 0.5))
+
+/* Converts 4 pixels to 16-bit R, G, B lanes, as yuv_to_rgb() */
+BLEND_SSE2
+static inline void YuvToRgb_SSE2(__m128i y, __m128i u, __m128i v,
+                                 __m128i *r, __m128i *g, __m128i *b)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(1 << 9);
+
+    y = _mm_sub_epi16(_mm_unpacklo_epi8(y, zero), _mm_set1_epi16(16));
+    u = _mm_sub_epi16(_mm_unpacklo_epi8(u, zero), _mm_set1_epi16(128));
+    v = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), _mm_set1_epi16(128));
+
+    const __m128i yu = _mm_unpacklo_epi16(y, u);
+    const __m128i yv = _mm_unpacklo_epi16(y, v);
+    const __m128i v0 = _mm_unpacklo_epi16(v, zero);
+
+    __m128i r32 = _mm_madd_epi16(yv, _mm_set_epi16(
+        BLEND_FIX(1.40200*255.0/224.0), BLEND_FIX(255.0/219.0),
+        BLEND_FIX(1.40200*255.0/224.0), BLEND_FIX(255.0/219.0),
+        BLEND_FIX(1.40200*255.0/224.0), BLEND_FIX(255.0/219.0),
+        BLEND_FIX(1.40200*255.0/224.0), BLEND_FIX(255.0/219.0)));
+    __m128i g32 = _mm_add_epi32(
+        _mm_madd_epi16(yu, _mm_set_epi16(
+            -BLEND_FIX(0.34414*255.0/224.0), BLEND_FIX(255.0/219.0),
+            -BLEND_FIX(0.34414*255.0/224.0), BLEND_FIX(255.0/219.0),
+            -BLEND_FIX(0.34414*255.0/224.0), BLEND_FIX(255.0/219.0),
+            -BLEND_FIX(0.34414*255.0/224.0), BLEND_FIX(255.0/219.0))),
+        _mm_madd_epi16(v0, _mm_set1_epi32(
+            (uint16_t) -BLEND_FIX(0.71414*255.0/224.0))));
+    __m128i b32 = _mm_madd_epi16(yu, _mm_set_epi16(
+        BLEND_FIX(1.77200*255.0/224.0), BLEND_FIX(255.0/219.0),
+        BLEND_FIX(1.77200*255.0/224.0), BLEND_FIX(255.0/219.0),
+        BLEND_FIX(1.77200*255.0/224.0), BLEND_FIX(255.0/219.0),
+        BLEND_FIX(1.77200*255.0/224.0), BLEND_FIX(255.0/219.0)));
+
+    r32 = _mm_srai_epi32(_mm_add_epi32(r32, half), 10);
+    g32 = _mm_srai_epi32(_mm_add_epi32(g32, half), 10);
+    b32 = _mm_srai_epi32(_mm_add_epi32(b32, half), 10);
+
+    /* Saturate to 8 bits, as vlc_uint8() */
+    *r = _mm_packus_epi16(_mm_packs_epi32(r32, r32), zero);
+    *g = _mm_packus_epi16(_mm_packs_epi32(g32, g32), zero);
+    *b = _mm_packus_epi16(_mm_packs_epi32(b32, b32), zero);
+}
+
+/* Blends 2 RGBA pixels on 16-bit lanes, f being the broadcast factor */
+BLEND_SSE2
+static inline __m128i MergeRGBA_SSE2(__m128i d, __m128i s, __m128i f)
+{
+    const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i d_a = _mm_shufflehi_epi16(
+        _mm_shufflelo_epi16(d, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(3, 3, 3, 3));
+
+    /* First blend the existing color based on its alpha, the destination
+     * alpha being kept as is */
+    __m128i c = Merge_SSE2(d, s, _mm_sub_epi16(_mm_set1_epi16(255), d_a));
+    c = _mm_or_si128(_mm_andnot_si128(alpha_lanes, c),
+                     _mm_and_si128(alpha_lanes, d));
+    /* Then blend the new color, and 255 in the alpha lane */
+    c = Merge_SSE2(c, s, f);
+
+    /* Pixels with a null blending factor are left untouched */
+    const __m128i skip = _mm_cmpeq_epi16(f, _mm_setzero_si128());
+    return _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, c));
+}
+
+template <bool bgr>
+BLEND_SSE2
+static void MergeRowRGBA_SSE2(uint8_t *dst, const uint8_t *src_y,
+                              const uint8_t *src_u, const uint8_t *src_v,
+                              const uint8_t *src_a, unsigned count,
+                              unsigned alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha16 = _mm_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        uint32_t y, u, v, a;
+        memcpy(&y, &src_y[i], 4);
+        memcpy(&u, &src_u[i], 4);
+        memcpy(&v, &src_v[i], 4);
+        memcpy(&a, &src_a[i], 4);
+
+        __m128i r, g, b;
+        YuvToRgb_SSE2(_mm_cvtsi32_si128(y), _mm_cvtsi32_si128(u),
+                      _mm_cvtsi32_si128(v), &r, &g, &b);
+        if (bgr) {
+            const __m128i t = r;
+            r = b;
+            b = t;
+        }
+        const __m128i s = _mm_unpacklo_epi16(
+            _mm_unpacklo_epi8(r, g),
+            _mm_unpacklo_epi8(b, _mm_set1_epi8(-1)));
+
+        __m128i f = _mm_unpacklo_epi8(_mm_cvtsi32_si128(a), zero);
+        f = Div255_SSE2(_mm_mullo_epi16(f, alpha16));
+        f = _mm_unpacklo_epi16(f, f);
+
+        const __m128i d = _mm_loadu_si128((const __m128i *)&dst[4 * i]);
+        const __m128i lo = MergeRGBA_SSE2(_mm_unpacklo_epi8(d, zero),
+                                          _mm_unpacklo_epi8(s, zero),
+                                          _mm_unpacklo_epi32(f, f));
+        const __m128i hi = MergeRGBA_SSE2(_mm_unpackhi_epi8(d, zero),
+                                          _mm_unpackhi_epi8(s, zero),
+                                          _mm_unpackhi_epi32(f, f));
+        _mm_storeu_si128((__m128i *)&dst[4 * i], _mm_packus_epi16(lo, hi));
+    }
+    MergeRowRGBA_C<bgr>(&dst[4 * i], &src_y[i], &src_u[i], &src_v[i],
+                        &src_a[i], count - i, alpha);
+}
+
+#undef BLEND_FIX
+
+static const CBlendKernels kernels_sse2 = {
+    MergeRow_SSE2, MergeRow2_SSE2, MergeRowNV_SSE2,
+    MergeRowRGBA_SSE2<false>, MergeRowRGBA_SSE2<true>,
+};
+#endif
+
+#if defined(HAVE_AVX2_INTRINSICS)
+# define BLEND_AVX2 __attribute__((__target__("avx2")))
+
+BLEND_AVX2
+static inline __m256i Div255_AVX2(__m256i v)
+{
+    v = _mm256_add_epi16(v, _mm256_srli_epi16(v, 8));
+    return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_set1_epi16(1)), 8);
+}
+
+BLEND_AVX2
+static inline __m256i Merge_AVX2(__m256i d, __m256i s, __m256i a)
+{
+    const __m256i na = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return Div255_AVX2(_mm256_add_epi16(_mm256_mullo_epi16(d, na),
+                                        _mm256_mullo_epi16(s, a)));
+}
+
+BLEND_AVX2
+static inline __m256i Load16_AVX2(const uint8_t *p)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+/* Packs 2 vectors of 16-bit lanes to 8-bit, in order */
+BLEND_AVX2
+static inline __m256i Pack_AVX2(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi),
+                                    _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+BLEND_AVX2
+static void MergeRow_AVX2(uint8_t *dst, const uint8_t *src,
+                          const uint8_t *src_a, unsigned count,
+                          unsigned alpha)
+{
+    const __m256i alpha16 = _mm256_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        const __m256i a_lo =
+            Div255_AVX2(_mm256_mullo_epi16(Load16_AVX2(&src_a[i]), alpha16));
+        const __m256i a_hi =
+            Div255_AVX2(_mm256_mullo_epi16(Load16_AVX2(&src_a[i + 16]),
+                                           alpha16));
+        const __m256i lo = Merge_AVX2(Load16_AVX2(&dst[i]),
+                                      Load16_AVX2(&src[i]), a_lo);
+        const __m256i hi = Merge_AVX2(Load16_AVX2(&dst[i + 16]),
+                                      Load16_AVX2(&src[i + 16]), a_hi);
+        _mm256_storeu_si256((__m256i *)&dst[i], Pack_AVX2(lo, hi));
+    }
+    MergeRow_C(&dst[i], &src[i], &src_a[i], count - i, alpha);
+}
+
+BLEND_AVX2
+static void MergeRow2_AVX2(uint8_t *dst_u, uint8_t *dst_v,
+                           const uint8_t *src_u, const uint8_t *src_v,
+                           const uint8_t *src_a, unsigned count,
+                           unsigned alpha)
+{
+    const __m256i even = _mm256_set1_epi16(0xff);
+    const __m256i alpha16 = _mm256_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 16 < count; i += 16) {
+        const __m256i a = _mm256_and_si256(even,
+            _mm256_loadu_si256((const __m256i *)&src_a[2 * i]));
+        const __m256i f = Div255_AVX2(_mm256_mullo_epi16(a, alpha16));
+        const __m256i u = _mm256_and_si256(even,
+            _mm256_loadu_si256((const __m256i *)&src_u[2 * i]));
+        const __m256i v = _mm256_and_si256(even,
+            _mm256_loadu_si256((const __m256i *)&src_v[2 * i]));
+
+        const __m256i ru = Merge_AVX2(Load16_AVX2(&dst_u[i]), u, f);
+        const __m256i rv = Merge_AVX2(Load16_AVX2(&dst_v[i]), v, f);
+        _mm_storeu_si128((__m128i *)&dst_u[i],
+                         _mm256_castsi256_si128(Pack_AVX2(ru, ru)));
+        _mm_storeu_si128((__m128i *)&dst_v[i],
+                         _mm256_castsi256_si128(Pack_AVX2(rv, rv)));
+    }
+    MergeRow2_C(&dst_u[i], &dst_v[i], &src_u[2 * i], &src_v[2 * i],
+                &src_a[2 * i], count - i, alpha);
+}
+
+BLEND_AVX2
+static void MergeRowNV_AVX2(uint8_t *dst_uv,
+                            const uint8_t *src_u, const uint8_t *src_v,
+                            const uint8_t *src_a, unsigned count,
+                            unsigned alpha)
+{
+    const __m256i even = _mm256_set1_epi16(0xff);
+    const __m256i alpha16 = _mm256_set1_epi16(alpha);
+    unsigned i = 0;
+
+    for (; i + 16 < count; i += 16) {
+        const __m256i a = _mm256_and_si256(even,
+            _mm256_loadu_si256((const __m256i *)&src_a[2 * i]));
+        const __m256i f = Div255_AVX2(_mm256_mullo_epi16(a, alpha16));
+        const __m256i u = _mm256_and_si256(even,
+            _mm256_loadu_si256((const __m256i *)&src_u[2 * i]));
+        const __m256i v = _mm256_and_si256(even,
+            _mm256_loadu_si256((const __m256i *)&src_v[2 * i]));
+
+        /* Interleave within each 128-bit lane, then restore the order */
+        const __m256i uv_l = _mm256_unpacklo_epi16(u, v);
+        const __m256i uv_h = _mm256_unpackhi_epi16(u, v);
+        const __m256i ff_l = _mm256_unpacklo_epi16(f, f);
+        const __m256i ff_h = _mm256_unpackhi_epi16(f, f);
+
+        const __m256i lo = Merge_AVX2(Load16_AVX2(&dst_uv[2 * i]),
+            _mm256_permute2x128_si256(uv_l, uv_h, 0x20),
+            _mm256_permute2x128_si256(ff_l, ff_h, 0x20));
+        const __m256i hi = Merge_AVX2(Load16_AVX2(&dst_uv[2 * i + 16]),
+            _mm256_permute2x128_si256(uv_l, uv_h, 0x31),
+            _mm256_permute2x128_si256(ff_l, ff_h, 0x31));
+        _mm256_storeu_si256((__m256i *)&dst_uv[2 * i], Pack_AVX2(lo, hi));
+    }
+    MergeRowNV_C(&dst_uv[2 * i], &src_u[2 * i], &src_v[2 * i],
+                 &src_a[2 * i], count - i, alpha);
+}
+
+static const CBlendKernels kernels_avx2 = {
+    MergeRow_AVX2, MergeRow2_AVX2, MergeRowNV_AVX2,
+# if defined(HAVE_SSE2_INTRINSICS)
+    MergeRowRGBA_SSE2<false>, MergeRowRGBA_SSE2<true>,
+# else
+    MergeRowRGBA_C<false>, MergeRowRGBA_C<true>,
+# endif
+};
+#endif
+
+#if defined(__ARM_NEON)
+static inline uint16x8_t Div255_NEON(uint16x8_t v)
+{
+    v = vaddq_u16(v, vshrq_n_u16(v, 8));
+    return vshrq_n_u16(vaddq_u16(v, vdupq_n_u16(1)), 8);
+}
+
+static inline uint8x8_t Merge_NEON(uint8x8_t d, uint8x8_t s, uint16x8_t a)
+{
+    const uint16x8_t na = vsubq_u16(vdupq_n_u16(255), a);
+    const uint16x8_t v = vmlaq_u16(vmulq_u16(vmovl_u8(d), na),
+                                   vmovl_u8(s), a);
+    return vmovn_u16(Div255_NEON(v));
+}
+
+static inline uint16x8_t Factor_NEON(uint8x8_t a, uint16x8_t alpha16)
+{
+    return Div255_NEON(vmulq_u16(vmovl_u8(a), alpha16));
+}
+
+static void MergeRow_NEON(uint8_t *dst, const uint8_t *src,
+                          const uint8_t *src_a, unsigned count,
+                          unsigned alpha)
+{
+    const uint16x8_t alpha16 = vdupq_n_u16(alpha);
+    unsigned i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t a = vld1q_u8(&src_a[i]);
+        const uint8x16_t s = vld1q_u8(&src[i]);
+        const uint8x16_t d = vld1q_u8(&dst[i]);
+
+        const uint8x8_t lo = Merge_NEON(vget_low_u8(d), vget_low_u8(s),
+                                        Factor_NEON(vget_low_u8(a), alpha16));
+        const uint8x8_t hi = Merge_NEON(vget_high_u8(d), vget_high_u8(s),
+                                        Factor_NEON(vget_high_u8(a), alpha16));
+        vst1q_u8(&dst[i], vcombine_u8(lo, hi));
+    }
+    MergeRow_C(&dst[i], &src[i], &src_a[i], count - i, alpha);
+}
+
+static void MergeRow2_NEON(uint8_t *dst_u, uint8_t *dst_v,
+                           const uint8_t *src_u, const uint8_t *src_v,
+                           const uint8_t *src_a, unsigned count,
+                           unsigned alpha)
+{
+    const uint16x8_t alpha16 = vdupq_n_u16(alpha);
+    unsigned i = 0;
+
+    for (; i + 8 < count; i += 8) {
+        /* The even pixels end up in val[0] */
+        const uint16x8_t f = Factor_NEON(vld2_u8(&src_a[2 * i]).val[0],
+                                         alpha16);
+        vst1_u8(&dst_u[i], Merge_NEON(vld1_u8(&dst_u[i]),
+                                      vld2_u8(&src_u[2 * i]).val[0], f));
+        vst1_u8(&dst_v[i], Merge_NEON(vld1_u8(&dst_v[i]),
+                                      vld2_u8(&src_v[2 * i]).val[0], f));
+    }
+    MergeRow2_C(&dst_u[i], &dst_v[i], &src_u[2 * i], &src_v[2 * i],
+                &src_a[2 * i], count - i, alpha);
+}
+
+static void MergeRowNV_NEON(uint8_t *dst_uv,
+                            const uint8_t *src_u, const uint8_t *src_v,
+                            const uint8_t *src_a, unsigned count,
+                            unsigned alpha)
+{
+    const uint16x8_t alpha16 = vdupq_n_u16(alpha);
+    unsigned i = 0;
+
+    for (; i + 8 < count; i += 8) {
+        const uint16x8_t f = Factor_NEON(vld2_u8(&src_a[2 * i]).val[0],
+                                         alpha16);
+        uint8x8x2_t d = vld2_u8(&dst_uv[2 * i]);
+
+        d.val[0] = Merge_NEON(d.val[0], vld2_u8(&src_u[2 * i]).val[0], f);
+        d.val[1] = Merge_NEON(d.val[1], vld2_u8(&src_v[2 * i]).val[0], f);
+        vst2_u8(&dst_uv[2 * i], d);
+    }
+    MergeRowNV_C(&dst_uv[2 * i], &src_u[2 * i], &src_v[2 * i],
+                 &src_a[2 * i], count - i, alpha);
+}
+
+static const CBlendKernels kernels_neon = {
+    MergeRow_NEON, MergeRow2_NEON, MergeRowNV_NEON,
+    MergeRowRGBA_C<false>, MergeRowRGBA_C<true>,
+};
+#endif
+
+/* Source pixel of the first full chroma sample of a destination row */
+static inline unsigned FirstFull(unsigned dst_x, unsigned rx)
+{
+    return (rx - dst_x % rx) % rx;
+}
+
+template <const CBlendKernels *kernels, unsigned rx, unsigned ry, bool swap_uv>
+void BlendYUVAToPlanar(const CPicture &dst_data, const CPicture &src_data,
+                       unsigned width, unsigned height, int alpha)
+{
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    const unsigned dx = dst_data.getX(), dy = dst_data.getY();
+    const unsigned sx = src_data.getX(), sy = src_data.getY();
+    const plane_t *dst_u = &dst->p[swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *dst_v = &dst->p[swap_uv ? U_PLANE : V_PLANE];
+    const unsigned first = FirstFull(dx, rx);
+
+    assert(alpha <= 255);
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *s[4];
+        for (unsigned i = 0; i < 4; i++)
+            s[i] = &src->p[i].p_pixels[(sy + y) * src->p[i].i_pitch + sx];
+
+        kernels->row(&dst->p[Y_PLANE].p_pixels[(dy + y) * dst->p[Y_PLANE].i_pitch + dx],
+                     s[Y_PLANE], s[A_PLANE], width, alpha);
+
+        if ((dy + y) % ry != 0 || first >= width)
+            continue;
+
+        uint8_t *u = &dst_u->p_pixels[(dy + y) / ry * dst_u->i_pitch + (dx + first) / rx];
+        uint8_t *v = &dst_v->p_pixels[(dy + y) / ry * dst_v->i_pitch + (dx + first) / rx];
+        if (rx == 1) {
+            kernels->row(u, s[U_PLANE], s[A_PLANE], width, alpha);
+            kernels->row(v, s[V_PLANE], s[A_PLANE], width, alpha);
+        } else {
+            kernels->row2(u, v, &s[U_PLANE][first], &s[V_PLANE][first],
+                          &s[A_PLANE][first], (width - first + 1) / 2, alpha);
+        }
+    }
+}
+
+template <const CBlendKernels *kernels, bool swap_uv>
+void BlendYUVAToSemiPlanar(const CPicture &dst_data, const CPicture &src_data,
+                           unsigned width, unsigned height, int alpha)
+{
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    const unsigned dx = dst_data.getX(), dy = dst_data.getY();
+    const unsigned sx = src_data.getX(), sy = src_data.getY();
+    const unsigned first = FirstFull(dx, 2);
+
+    assert(alpha <= 255);
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *s[4];
+        for (unsigned i = 0; i < 4; i++)
+            s[i] = &src->p[i].p_pixels[(sy + y) * src->p[i].i_pitch + sx];
+
+        kernels->row(&dst->p[0].p_pixels[(dy + y) * dst->p[0].i_pitch + dx],
+                     s[Y_PLANE], s[A_PLANE], width, alpha);
+
+        if ((dy + y) % 2 != 0 || first >= width)
+            continue;
+
+        uint8_t *uv = &dst->p[1].p_pixels[(dy + y) / 2 * dst->p[1].i_pitch + (dx + first)];
+        kernels->rowNV(uv, &s[swap_uv ? V_PLANE : U_PLANE][first],
+                       &s[swap_uv ? U_PLANE : V_PLANE][first],
+                       &s[A_PLANE][first], (width - first + 1) / 2, alpha);
+    }
+}
+
+template <const CBlendKernels *kernels, bool bgr>
+void BlendYUVAToRGBA(const CPicture &dst_data, const CPicture &src_data,
+                     unsigned width, unsigned height, int alpha)
+{
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    const unsigned dx = dst_data.getX(), dy = dst_data.getY();
+    const unsigned sx = src_data.getX(), sy = src_data.getY();
+
+    assert(alpha <= 255);
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *s[4];
+        for (unsigned i = 0; i < 4; i++)
+            s[i] = &src->p[i].p_pixels[(sy + y) * src->p[i].i_pitch + sx];
+
+        uint8_t *d = &dst->p[0].p_pixels[(dy + y) * dst->p[0].i_pitch + 4 * dx];
+        (bgr ? kernels->rowBGRA : kernels->rowRGBA)(d, s[Y_PLANE], s[U_PLANE],
+                                                    s[V_PLANE], s[A_PLANE],
+                                                    width, alpha);
+    }
+}
+
+} // namespace
+#endif
+
+
 namespace {
 
 static const struct {
@@ -636,6 +1298,49 @@ static const struct {
 #undef YUV
 };
 
+#ifdef BLEND_HAVE_SIMD
+#if defined(HAVE_SSE2_INTRINSICS)
+static bool UsableSSE2(void) { return vlc_CPU_SSE2(); }
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+static bool UsableAVX2(void) { return vlc_CPU_AVX2(); }
+#endif
+#if defined(__ARM_NEON)
+static bool UsableNEON(void) { return vlc_CPU_ARM_NEON(); }
+#endif
+
+/* Vectorized YUVA blending, by order of preference */
+static const struct {
+    vlc_fourcc_t     dst;
+    blend_function_t blend;
+    bool           (*usable)(void);
+} simd_blends[] = {
+#define SIMD(kernels, usable) \
+    { VLC_CODEC_YV12, BlendYUVAToPlanar<&kernels, 2, 2, true>,  usable }, \
+    { VLC_CODEC_J420, BlendYUVAToPlanar<&kernels, 2, 2, false>, usable }, \
+    { VLC_CODEC_I420, BlendYUVAToPlanar<&kernels, 2, 2, false>, usable }, \
+    { VLC_CODEC_J422, BlendYUVAToPlanar<&kernels, 2, 1, false>, usable }, \
+    { VLC_CODEC_I422, BlendYUVAToPlanar<&kernels, 2, 1, false>, usable }, \
+    { VLC_CODEC_J444, BlendYUVAToPlanar<&kernels, 1, 1, false>, usable }, \
+    { VLC_CODEC_I444, BlendYUVAToPlanar<&kernels, 1, 1, false>, usable }, \
+    { VLC_CODEC_NV12, BlendYUVAToSemiPlanar<&kernels, false>,   usable }, \
+    { VLC_CODEC_NV21, BlendYUVAToSemiPlanar<&kernels, true>,    usable }, \
+    { VLC_CODEC_RGBA, BlendYUVAToRGBA<&kernels, false>,         usable }, \
+    { VLC_CODEC_BGRA, BlendYUVAToRGBA<&kernels, true>,          usable }
+
+#if defined(HAVE_AVX2_INTRINSICS)
+    SIMD(kernels_avx2, UsableAVX2),
+#endif
+#if defined(HAVE_SSE2_INTRINSICS)
+    SIMD(kernels_sse2, UsableSSE2),
+#endif
+#if defined(__ARM_NEON)
+    SIMD(kernels_neon, UsableNEON),
+#endif
+#undef SIMD
+};
+#endif
+
 struct filter_sys_t {
     filter_sys_t() : blend(NULL)
     {
@@ -698,6 +1403,14 @@ static int Open(filter_t *filter)
         if (blends[i].src == src && blends[i].dst == dst)
             sys->blend = blends[i].blend;
     }
+#ifdef BLEND_HAVE_SIMD
+    for (size_t i = 0; i < ARRAY_SIZE(simd_blends) && src == VLC_CODEC_YUVA; i++) {
+        if (simd_blends[i].dst == dst && simd_blends[i].usable()) {
+            sys->blend = simd_blends[i].blend;
+            break;
+        }
+    }
+#endif
 
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
@@ -716,3 +1429,117 @@ static void Close(filter_t *filter)
     filter_sys_t *p_sys = reinterpret_cast<filter_sys_t *>( filter->p_sys );
     delete p_sys;
 }
+
+#ifdef BLEND_TEST
+/* Checks that the vectorized blending gives the same pictures as the
+ * generic templates */
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef BLEND_HAVE_SIMD
+static void FillRandom(picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++) {
+        plane_t *p = &pic->p[i];
+        for (int j = 0; j < p->i_lines * p->i_pitch; j++)
+            p->p_pixels[j] = rand();
+    }
+}
+
+static bool SamePictures(const picture_t *a, const picture_t *b)
+{
+    for (int i = 0; i < a->i_planes; i++)
+        if (memcmp(a->p[i].p_pixels, b->p[i].p_pixels,
+                   a->p[i].i_lines * a->p[i].i_pitch))
+            return false;
+    return true;
+}
+
+static blend_function_t FindTemplate(vlc_fourcc_t dst)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(blends); i++)
+        if (blends[i].src == VLC_CODEC_YUVA && blends[i].dst == dst)
+            return blends[i].blend;
+    return NULL;
+}
+
+static void Test(vlc_fourcc_t chroma, blend_function_t blend,
+                 unsigned width, unsigned height,
+                 unsigned x, unsigned y, int alpha)
+{
+    video_format_t dst_fmt, src_fmt;
+
+    video_format_Setup(&dst_fmt, chroma, 2 * width + 7, 2 * height + 5,
+                       2 * width + 7, 2 * height + 5, 1, 1);
+    video_format_Setup(&src_fmt, VLC_CODEC_YUVA, width + 3, height + 1,
+                       width + 3, height + 1, 1, 1);
+    src_fmt.i_x_offset = 3;
+    src_fmt.i_y_offset = 1;
+    src_fmt.i_visible_width = width;
+    src_fmt.i_visible_height = height;
+
+    picture_t *src = picture_NewFromFormat(&src_fmt);
+    picture_t *ref = picture_NewFromFormat(&dst_fmt);
+    picture_t *dst = picture_NewFromFormat(&dst_fmt);
+    assert(src != NULL && ref != NULL && dst != NULL);
+
+    FillRandom(src);
+    /* Fully transparent and opaque pixels are the special cases */
+    for (int j = 0; j < src->p[A_PLANE].i_lines; j++) {
+        src->p[A_PLANE].p_pixels[j * src->p[A_PLANE].i_pitch + j % 5] = 0;
+        src->p[A_PLANE].p_pixels[j * src->p[A_PLANE].i_pitch + 7] = 255;
+    }
+    FillRandom(ref);
+    for (int i = 0; i < ref->i_planes; i++)
+        memcpy(dst->p[i].p_pixels, ref->p[i].p_pixels,
+               ref->p[i].i_lines * ref->p[i].i_pitch);
+
+    const CPicture src_data(src, &src_fmt, src_fmt.i_x_offset,
+                            src_fmt.i_y_offset);
+    FindTemplate(chroma)(CPicture(ref, &dst_fmt, x, y), src_data,
+                         width, height, alpha);
+    blend(CPicture(dst, &dst_fmt, x, y), src_data, width, height, alpha);
+
+    if (!SamePictures(ref, dst)) {
+        fprintf(stderr, "error: %4.4s %ux%u at %u,%u alpha %d mismatch\n",
+                (const char *)&chroma, width, height, x, y, alpha);
+        abort();
+    }
+
+    picture_Release(dst);
+    picture_Release(ref);
+    picture_Release(src);
+}
+
+int main(void)
+{
+    static const struct { unsigned width, height; } sizes[] = {
+        { 1, 1 }, { 2, 2 }, { 7, 3 }, { 17, 9 }, { 33, 4 }, { 64, 16 },
+        { 95, 11 }, { 320, 36 },
+    };
+    static const int alphas[] = { 1, 128, 254, 255 };
+    unsigned tested = 0;
+
+    srand(42);
+    for (size_t i = 0; i < ARRAY_SIZE(simd_blends); i++) {
+        if (!simd_blends[i].usable())
+            continue;
+        for (size_t s = 0; s < ARRAY_SIZE(sizes); s++)
+            for (unsigned off = 0; off < 4; off++)
+                for (size_t a = 0; a < ARRAY_SIZE(alphas); a++)
+                    Test(simd_blends[i].dst, simd_blends[i].blend,
+                         sizes[s].width, sizes[s].height,
+                         off, (off + s) % 3, alphas[a]);
+        tested++;
+    }
+    if (tested == 0)
+        return 77;
+    return 0;
+}
+#else
+int main(void)
+{
+    return 77; /* no vectorized blending to check */
+}
+#endif
+#endif
@@ -39,33 +39,64 @@
 #include "algo_basic.h"
 
 /*****************************************************************************
- * RenderDiscard: only keep TOP or BOTTOM field, discard the other.
+ * Slices: the output lines of a plane are rendered independently, the
+ * algorithms below run over line ranges split by vlc_filter_slices_Run()
  *****************************************************************************/
 
-int RenderDiscard( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+typedef struct
+{
+    filter_sys_t *p_sys;
+    const plane_t *p_in;
+    plane_t *p_out;
+    int i_field;
+} basic_job_t;
+
+static void RenderPlanes( filter_t *p_filter, picture_t *p_outpic,
+                          picture_t *p_pic, int i_field,
+                          vlc_filter_slice_cb pf_slice )
 {
-    VLC_UNUSED(p_filter);
-    int i_plane;
+    filter_sys_t *p_sys = p_filter->p_sys;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    for( int i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
     {
-        uint8_t *p_in, *p_out_end, *p_out;
+        basic_job_t job = {
+            .p_sys = p_sys,
+            .p_in = &p_pic->p[i_plane],
+            .p_out = &p_outpic->p[i_plane],
+            .i_field = i_field,
+        };
+
+        vlc_filter_slices_Run( p_sys->slices,
+                               p_outpic->p[i_plane].i_visible_lines, 1,
+                               pf_slice, &job );
+    }
+}
 
-        p_in = p_pic->p[i_plane].p_pixels;
+/* Whether a BOB output line is copied from the same input line. The lines
+ * of the other field are rebuilt, except the first and the last ones */
+static inline bool BobKeepsLine( unsigned y, unsigned i_lines, int i_field )
+{
+    return (int)(y % 2) == i_field || y == 0 || y + 1 >= i_lines;
+}
 
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
+/*****************************************************************************
+ * RenderDiscard: only keep TOP or BOTTOM field, discard the other.
+ *****************************************************************************/
 
-        for( ; p_out < p_out_end ; )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
+static void DiscardSlice( void *opaque, unsigned i_first, unsigned i_last )
+{
+    const basic_job_t *job = opaque;
+    const plane_t *p_in = job->p_in;
+    plane_t *p_out = job->p_out;
 
-            p_out += p_outpic->p[i_plane].i_pitch;
-            p_in += 2 * p_pic->p[i_plane].i_pitch;
-        }
-    }
+    for( unsigned y = i_first; y < i_last; y++ )
+        memcpy( &p_out->p_pixels[y * p_out->i_pitch],
+                &p_in->p_pixels[2 * y * p_in->i_pitch], p_in->i_pitch );
+}
+
+int RenderDiscard( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    RenderPlanes( p_filter, p_outpic, p_pic, 0, DiscardSlice );
     return VLC_SUCCESS;
 }
 
@@ -73,55 +104,29 @@ int RenderDiscard( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
  * RenderBob: renders a BOB picture - simple copy
  *****************************************************************************/
 
-int RenderBob( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic,
-               int order, int i_field )
+static void BobSlice( void *opaque, unsigned i_first, unsigned i_last )
 {
-    VLC_UNUSED(p_filter);
-    VLC_UNUSED(order);
-    int i_plane;
+    const basic_job_t *job = opaque;
+    const plane_t *p_in = job->p_in;
+    plane_t *p_out = job->p_out;
+    const unsigned i_lines = p_out->i_visible_lines;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    /* Lines of the other field: copy of the line above */
+    for( unsigned y = i_first; y < i_last; y++ )
     {
-        uint8_t *p_in, *p_out_end, *p_out;
-
-        p_in = p_pic->p[i_plane].p_pixels;
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
-
-        /* For BOTTOM field we need to add the first line */
-        if( i_field == 1 )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-            p_in += p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-        }
-
-        p_out_end -= 2 * p_outpic->p[i_plane].i_pitch;
-
-        for( ; p_out < p_out_end ; )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
+        unsigned i_src = BobKeepsLine( y, i_lines, job->i_field ) ? y : y - 1;
 
-            p_out += p_outpic->p[i_plane].i_pitch;
-
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-
-            p_in += 2 * p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-        }
+        memcpy( &p_out->p_pixels[y * p_out->i_pitch],
+                &p_in->p_pixels[i_src * p_in->i_pitch], p_in->i_pitch );
+    }
+}
 
-        memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
+int RenderBob( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic,
+               int order, int i_field )
+{
+    VLC_UNUSED(order);
 
-        /* For TOP field we need to add the last line */
-        if( i_field == 0 )
-        {
-            p_in += p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-        }
-    }
+    RenderPlanes( p_filter, p_outpic, p_pic, i_field, BobSlice );
     return VLC_SUCCESS;
 }
 
@@ -129,58 +134,35 @@ int RenderBob( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic,
  * RenderLinear: BOB with linear interpolation
  *****************************************************************************/
 
+static void LinearSlice( void *opaque, unsigned i_first, unsigned i_last )
+{
+    const basic_job_t *job = opaque;
+    filter_sys_t *p_sys = job->p_sys;
+    const plane_t *p_in = job->p_in;
+    plane_t *p_out = job->p_out;
+    const unsigned i_lines = p_out->i_visible_lines;
+
+    /* Lines of the other field: mean of the lines above and below */
+    for( unsigned y = i_first; y < i_last; y++ )
+    {
+        uint8_t *p_dst = &p_out->p_pixels[y * p_out->i_pitch];
+        const uint8_t *p_src = &p_in->p_pixels[y * p_in->i_pitch];
+
+        if( BobKeepsLine( y, i_lines, job->i_field ) )
+            memcpy( p_dst, p_src, p_in->i_pitch );
+        else
+            Merge( p_dst, p_src - p_in->i_pitch, p_src + p_in->i_pitch,
+                   p_in->i_pitch );
+    }
+    EndMerge();
+}
+
 int RenderLinear( filter_t *p_filter,
                   picture_t *p_outpic, picture_t *p_pic, int order, int i_field )
 {
     VLC_UNUSED(order);
-    int i_plane;
-
-    filter_sys_t *p_sys = p_filter->p_sys;
-
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
-    {
-        uint8_t *p_in, *p_out_end, *p_out;
-
-        p_in = p_pic->p[i_plane].p_pixels;
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
-
-        /* For BOTTOM field we need to add the first line */
-        if( i_field == 1 )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-            p_in += p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-        }
-
-        p_out_end -= 2 * p_outpic->p[i_plane].i_pitch;
-
-        for( ; p_out < p_out_end ; )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-
-            p_out += p_outpic->p[i_plane].i_pitch;
 
-            Merge( p_out, p_in, p_in + 2 * p_pic->p[i_plane].i_pitch,
-                   p_pic->p[i_plane].i_pitch );
-
-            p_in += 2 * p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-        }
-
-        memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-
-        /* For TOP field we need to add the last line */
-        if( i_field == 0 )
-        {
-            p_in += p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-        }
-    }
-    EndMerge();
+    RenderPlanes( p_filter, p_outpic, p_pic, i_field, LinearSlice );
     return VLC_SUCCESS;
 }
 
@@ -188,34 +170,27 @@ int RenderLinear( filter_t *p_filter,
  * RenderMean: Half-resolution blender
  *****************************************************************************/
 
-int RenderMean( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+static void MeanSlice( void *opaque, unsigned i_first, unsigned i_last )
 {
-    int i_plane;
-
-    filter_sys_t *p_sys = p_filter->p_sys;
+    const basic_job_t *job = opaque;
+    filter_sys_t *p_sys = job->p_sys;
+    const plane_t *p_in = job->p_in;
+    plane_t *p_out = job->p_out;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    /* All lines: mean value of a line pair */
+    for( unsigned y = i_first; y < i_last; y++ )
     {
-        uint8_t *p_in, *p_out_end, *p_out;
-
-        p_in = p_pic->p[i_plane].p_pixels;
+        const uint8_t *p_src = &p_in->p_pixels[2 * y * p_in->i_pitch];
 
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
-
-        /* All lines: mean value */
-        for( ; p_out < p_out_end ; )
-        {
-            Merge( p_out, p_in, p_in + p_pic->p[i_plane].i_pitch,
-                   p_pic->p[i_plane].i_pitch );
-
-            p_out += p_outpic->p[i_plane].i_pitch;
-            p_in += 2 * p_pic->p[i_plane].i_pitch;
-        }
+        Merge( &p_out->p_pixels[y * p_out->i_pitch],
+               p_src, p_src + p_in->i_pitch, p_in->i_pitch );
     }
     EndMerge();
+}
+
+int RenderMean( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    RenderPlanes( p_filter, p_outpic, p_pic, 0, MeanSlice );
     return VLC_SUCCESS;
 }
 
@@ -223,37 +198,33 @@ int RenderMean( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
  * RenderBlend: Full-resolution blender
  *****************************************************************************/
 
-int RenderBlend( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+static void BlendSlice( void *opaque, unsigned i_first, unsigned i_last )
 {
-    int i_plane;
-
-    filter_sys_t *p_sys = p_filter->p_sys;
+    const basic_job_t *job = opaque;
+    filter_sys_t *p_sys = job->p_sys;
+    const plane_t *p_in = job->p_in;
+    plane_t *p_out = job->p_out;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    /* First line: simple copy */
+    if( i_first == 0 )
     {
-        uint8_t *p_in, *p_out_end, *p_out;
-
-        p_in = p_pic->p[i_plane].p_pixels;
-
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
-
-        /* First line: simple copy */
-        memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-        p_out += p_outpic->p[i_plane].i_pitch;
+        memcpy( p_out->p_pixels, p_in->p_pixels, p_in->i_pitch );
+        i_first = 1;
+    }
 
-        /* Remaining lines: mean value */
-        for( ; p_out < p_out_end ; )
-        {
-            Merge( p_out, p_in, p_in + p_pic->p[i_plane].i_pitch,
-                   p_pic->p[i_plane].i_pitch );
+    /* Remaining lines: mean value with the line above */
+    for( unsigned y = i_first; y < i_last; y++ )
+    {
+        const uint8_t *p_src = &p_in->p_pixels[y * p_in->i_pitch];
 
-            p_out += p_outpic->p[i_plane].i_pitch;
-            p_in  += p_pic->p[i_plane].i_pitch;
-        }
+        Merge( &p_out->p_pixels[y * p_out->i_pitch],
+               p_src - p_in->i_pitch, p_src, p_in->i_pitch );
     }
     EndMerge();
+}
+
+int RenderBlend( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    RenderPlanes( p_filter, p_outpic, p_pic, 0, BlendSlice );
     return VLC_SUCCESS;
 }
@@ -291,54 +291,79 @@ static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
         XDeintNxN( dst, i_dst, src, i_src, i_modx, 8 );
 }
 
-/*****************************************************************************
- * Public functions
- *****************************************************************************/
+typedef struct
+{
+    const plane_t *p_in;
+    plane_t *p_out;
+} x_job_t;
 
-int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+/* Renders the lines [i_first, i_last) of a plane, by bands of 8 lines */
+static void RenderXSlice( void *opaque, unsigned i_first, unsigned i_last )
 {
-    VLC_UNUSED(p_filter);
-    int i_plane;
+    const x_job_t *job = opaque;
+    const plane_t *p_in = job->p_in;
+    plane_t *p_out = job->p_out;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
-    {
-        const int i_mby = ( p_outpic->p[i_plane].i_visible_lines + 7 )/8 - 1;
-        const int i_mbx = p_outpic->p[i_plane].i_visible_pitch/8;
+    const int i_mby = ( p_out->i_visible_lines + 7 )/8 - 1;
+    const int i_mbx = p_out->i_visible_pitch/8;
+
+    const int i_mody = p_out->i_visible_lines - 8*i_mby;
+    const int i_modx = p_out->i_visible_pitch - 8*i_mbx;
 
-        const int i_mody = p_outpic->p[i_plane].i_visible_lines - 8*i_mby;
-        const int i_modx = p_outpic->p[i_plane].i_visible_pitch - 8*i_mbx;
+    const int i_dst = p_out->i_pitch;
+    const int i_src = p_in->i_pitch;
 
-        const int i_dst = p_outpic->p[i_plane].i_pitch;
-        const int i_src = p_pic->p[i_plane].i_pitch;
+    /* The slices start on band boundaries */
+    const int i_band_end = ( i_last + 7 )/8;
+    int y, x;
 
-        int y, x;
+    for( y = i_first/8; y < __MIN( i_band_end, i_mby ); y++ )
+    {
+        uint8_t *dst = &p_out->p_pixels[8*y*i_dst];
+        uint8_t *src = &p_in->p_pixels[8*y*i_src];
 
-        for( y = 0; y < i_mby; y++ )
+        XDeintBand8x8C( dst, i_dst, src, i_src, i_mbx, i_modx );
+    }
+
+    /* Last line (C only)*/
+    if( i_mody && i_band_end > i_mby )
+    {
+        uint8_t *dst = &p_out->p_pixels[8*y*i_dst];
+        uint8_t *src = &p_in->p_pixels[8*y*i_src];
+
+        for( x = 0; x < i_mbx; x++ )
         {
-            uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
-            uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
+            XDeintNxN( dst, i_dst, src, i_src, 8, i_mody );
 
-            XDeintBand8x8C( dst, i_dst, src, i_src, i_mbx, i_modx );
+            dst += 8;
+            src += 8;
         }
 
-        /* Last line (C only)*/
-        if( i_mody )
-        {
-            uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
-            uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
+        if( i_modx )
+            XDeintNxN( dst, i_dst, src, i_src, i_modx, i_mody );
+    }
+}
 
-            for( x = 0; x < i_mbx; x++ )
-            {
-                XDeintNxN( dst, i_dst, src, i_src, 8, i_mody );
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
 
-                dst += 8;
-                src += 8;
-            }
+int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    int i_plane;
 
-            if( i_modx )
-                XDeintNxN( dst, i_dst, src, i_src, i_modx, i_mody );
-        }
+    /* Copy image and skip lines */
+    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    {
+        x_job_t job = {
+            .p_in = &p_pic->p[i_plane],
+            .p_out = &p_outpic->p[i_plane],
+        };
+
+        vlc_filter_slices_Run( p_sys->slices,
+                               p_outpic->p[i_plane].i_visible_lines, 8,
+                               RenderXSlice, &job );
     }
 
     return VLC_SUCCESS;
@@ -46,6 +46,67 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+typedef struct
+{
+    void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
+                   int w, int prefs, int mrefs, int parity, int mode);
+    const plane_t *prevp;
+    const plane_t *curp;
+    const plane_t *nextp;
+    plane_t *dstp;
+    int i_field;
+    int yadif_parity;
+} yadif_job_t;
+
+/* Renders the lines [first, last) of one plane */
+static void RenderYadifSlice( void *opaque, unsigned first, unsigned last )
+{
+    const yadif_job_t *job = opaque;
+    const plane_t *prevp = job->prevp;
+    const plane_t *curp  = job->curp;
+    const plane_t *nextp = job->nextp;
+    plane_t *dstp        = job->dstp;
+    const int i_field = job->i_field;
+    const int yadif_parity = job->yadif_parity;
+
+    for( int y = __MAX( (int)first, 1 );
+         y < __MIN( (int)last, dstp->i_visible_lines - 1 ); y++ )
+    {
+        if( (y % 2) == i_field  ||  yadif_parity == 2 )
+        {
+            memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                        &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+        }
+        else
+        {
+            int mode;
+            /* Spatial checks only when enough data */
+            mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+            assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+            job->filter( &dstp->p_pixels[y * dstp->i_pitch],
+                         &prevp->p_pixels[y * prevp->i_pitch],
+                         &curp->p_pixels[y * curp->i_pitch],
+                         &nextp->p_pixels[y * nextp->i_pitch],
+                         dstp->i_visible_pitch,
+                         y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                         y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                         yadif_parity,
+                         mode );
+        }
+
+        /* We duplicate the first and last lines */
+        if( y == 1 )
+            memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                       &dstp->p_pixels[ y    * dstp->i_pitch],
+                       dstp->i_pitch);
+        else if( y == dstp->i_visible_lines - 2 )
+            memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                       &dstp->p_pixels[ y    * dstp->i_pitch],
+                       dstp->i_pitch);
+    }
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -127,46 +188,19 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
 
         for( int n = 0; n < p_dst->i_planes; n++ )
         {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
+            yadif_job_t job = {
+                .filter = filter,
+                .prevp = &p_prev->p[n],
+                .curp = &p_cur->p[n],
+                .nextp = &p_next->p[n],
+                .dstp = &p_dst->p[n],
+                .i_field = i_field,
+                .yadif_parity = yadif_parity,
+            };
+
+            /* Keep both lines of a frame line pair in the same slice */
+            vlc_filter_slices_Run( p_sys->slices, p_dst->p[n].i_visible_lines,
+                                   2, RenderYadifSlice, &job );
         }
 
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
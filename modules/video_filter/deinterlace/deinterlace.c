@@ -477,8 +477,11 @@ int Mouse( filter_t *p_filter,
  */
 static void Close( filter_t *p_filter )
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     Flush( p_filter );
-    free( p_filter->p_sys );
+    vlc_filter_slices_Delete( p_sys->slices );
+    free( p_sys );
 }
 
 static const struct vlc_filter_operations filter_ops = {
@@ -533,6 +536,13 @@ notsupp:
 
     p_sys->chroma = chroma;
 
+    p_sys->slices = filter_NewSlices( p_filter );
+    if( !p_sys->slices )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     InitDeinterlacingContext( &p_sys->context );
 
     config_ChainParse( p_filter, FILTER_CFG_PREFIX, ppsz_filter_options,
@@ -542,6 +552,7 @@ notsupp:
     if (ret != VLC_SUCCESS)
     {
         free(psz_mode);
+        vlc_filter_slices_Delete(p_sys->slices);
         free(p_sys);
         return ret;
     }
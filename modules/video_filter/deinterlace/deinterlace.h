@@ -77,6 +77,9 @@ typedef struct
 
     struct deinterlace_ctx   context;
 
+    /** Slice-parallel execution of the line-based algorithms */
+    vlc_filter_slices_t *slices;
+
     /* Algorithm-specific substructures */
     union {
         phosphor_sys_t phosphor; /**< Phosphor algorithm state. */
@@ -0,0 +1,190 @@
+/*****************************************************************************
+ * filterbench.c : video filter benchmark plugin for vlc
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+static int Create( filter_t * );
+static void Destroy( filter_t * );
+
+static picture_t *Filter( filter_t *, picture_t * );
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+
+#define FILTER_TEXT N_("Benchmarked video filter")
+#define FILTER_LONGTEXT N_("Video filter chain to benchmark, using the " \
+    "same syntax as the video-filter option, e.g. \"sharpen{sigma=1}\".")
+
+#define LOOPS_TEXT N_("Number of time to filter")
+#define LOOPS_LONGTEXT N_("The number of time the first picture will be " \
+    "filtered")
+
+#define CFG_PREFIX "filterbench-"
+
+vlc_module_begin ()
+    set_description( N_("Video filter benchmark filter") )
+    set_shortname( N_("Filterbench" ))
+    set_subcategory( SUBCAT_VIDEO_VFILTER )
+
+    set_section( N_("Benchmarking"), NULL )
+    add_string( CFG_PREFIX "filter", NULL, FILTER_TEXT, FILTER_LONGTEXT )
+    add_integer( CFG_PREFIX "loops", 100, LOOPS_TEXT, LOOPS_LONGTEXT )
+
+    set_callback_video_filter( Create )
+vlc_module_end ()
+
+static const char *const ppsz_filter_options[] = {
+    "filter", "loops", NULL
+};
+
+/*****************************************************************************
+ * filter_sys_t: filter method descriptor
+ *****************************************************************************/
+typedef struct
+{
+    bool b_done;
+    int i_loops;
+    char *psz_filter;
+} filter_sys_t;
+
+static const struct vlc_filter_operations filter_ops =
+{
+    .filter_video = Filter, .close = Destroy,
+};
+
+/*****************************************************************************
+ * Create: allocates video thread output method
+ *****************************************************************************/
+static int Create( filter_t *p_filter )
+{
+    filter_sys_t *p_sys;
+
+    if( !es_format_IsSimilar( &p_filter->fmt_in, &p_filter->fmt_out ) )
+        return VLC_EGENERIC;
+
+    config_ChainParse( p_filter, CFG_PREFIX, ppsz_filter_options,
+                       p_filter->p_cfg );
+
+    char *psz_filter = var_InheritString( p_filter, CFG_PREFIX "filter" );
+    if( psz_filter == NULL )
+    {
+        msg_Err( p_filter, "no filter to benchmark" );
+        return VLC_EGENERIC;
+    }
+
+    p_sys = p_filter->p_sys = malloc( sizeof( filter_sys_t ) );
+    if( p_sys == NULL )
+    {
+        free( psz_filter );
+        return VLC_ENOMEM;
+    }
+
+    p_sys->b_done = false;
+    p_sys->psz_filter = psz_filter;
+    p_sys->i_loops = var_InheritInteger( p_filter, CFG_PREFIX "loops" );
+
+    p_filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Destroy: destroy video thread output method
+ *****************************************************************************/
+static void Destroy( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    free( p_sys->psz_filter );
+    free( p_sys );
+}
+
+/*****************************************************************************
+ * Render: benchmarks the filter on the first picture, then passes through
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_sys->b_done )
+        return p_pic;
+    p_sys->b_done = true;
+
+    filter_chain_t *p_chain = filter_chain_NewVideo( p_filter, false, NULL );
+    if( p_chain == NULL )
+        return p_pic;
+
+    filter_chain_Reset( p_chain, &p_filter->fmt_in, p_filter->vctx_in,
+                        &p_filter->fmt_in );
+    if( filter_chain_AppendFromString( p_chain, p_sys->psz_filter ) <= 0 )
+    {
+        msg_Err( p_filter, "cannot load filter \"%s\"", p_sys->psz_filter );
+        filter_chain_Delete( p_chain );
+        return p_pic;
+    }
+
+    /* Each loop filters the same picture, so that only the filter itself is
+     * measured, not the copies of the input */
+    const vlc_tick_t i_date = p_pic->date;
+    unsigned i_frames = 0;
+    vlc_tick_t time = vlc_tick_now();
+    for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
+    {
+        picture_t *p_in = picture_Hold( p_pic );
+
+        p_in->date = i_date + i_iter * VLC_TICK_FROM_MS(40);
+        for( picture_t *p_out = filter_chain_VideoFilter( p_chain, p_in );
+             p_out != NULL; p_out = filter_chain_VideoFilter( p_chain, NULL ) )
+        {
+            i_frames++;
+            picture_Release( p_out );
+        }
+    }
+    time = vlc_tick_now() - time;
+
+    filter_chain_Delete( p_chain );
+    p_pic->date = i_date;
+
+    msg_Info( p_filter, "Filtered %d pictures with \"%s\" in %f sec, "
+              "%u output frames", p_sys->i_loops, p_sys->psz_filter,
+              secf_from_vlc_tick(time), i_frames );
+    if( time > 0 )
+        msg_Info( p_filter, "Speed is: %f frames/second, %f pixels/second",
+                  (float) i_frames / time * CLOCK_FREQ,
+                  (float) i_frames / time * CLOCK_FREQ *
+                      p_pic->format.i_visible_width *
+                      p_pic->format.i_visible_height );
+
+    return p_pic;
+}
@@ -94,6 +94,8 @@ typedef struct
     type_t *pt_distribution;
     type_t *pt_buffer;
     type_t *pt_scale;
+
+    vlc_filter_slices_t *slices;
 } filter_sys_t;
 
 static void gaussianblur_InitDistribution( filter_sys_t *p_sys )
@@ -164,6 +166,14 @@ static int Create( filter_t *p_filter )
     p_sys->pt_buffer = NULL;
     p_sys->pt_scale = NULL;
 
+    p_sys->slices = filter_NewSlices( p_filter );
+    if( p_sys->slices == NULL )
+    {
+        free( p_sys->pt_distribution );
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -175,14 +185,89 @@ static void Destroy( filter_t *p_filter )
     free( p_sys->pt_buffer );
     free( p_sys->pt_scale );
 
+    vlc_filter_slices_Delete( p_sys->slices );
     free( p_sys );
 }
 
+typedef struct
+{
+    const filter_sys_t *p_sys;
+    const plane_t *p_in;
+    plane_t *p_out;
+    int x_factor;
+    int y_factor;
+} gaussianblur_job_t;
+
+static void HorizontalSlice( void *opaque, unsigned i_first, unsigned i_last )
+{
+    const gaussianblur_job_t *job = opaque;
+    const int i_dim = job->p_sys->i_dim;
+    const type_t *pt_distribution = job->p_sys->pt_distribution;
+    type_t *pt_buffer = job->p_sys->pt_buffer;
+
+    const uint8_t *p_in = job->p_in->p_pixels;
+    const int i_visible_pitch = job->p_in->i_visible_pitch;
+    const int i_in_pitch = job->p_in->i_pitch;
+    const int x_factor = job->x_factor;
+
+    for( int i_line = i_first; i_line < (int)i_last; i_line++ )
+    {
+        for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
+        {
+            type_t t_value = 0;
+            const int c = i_line*i_in_pitch+i_col;
+            for( int x = __MAX( -i_dim, -i_col*(x_factor+1) );
+                 x <= __MIN( i_dim, (i_visible_pitch - i_col)*(x_factor+1) + 1 );
+                 x++ )
+            {
+                t_value += pt_distribution[x+i_dim] *
+                           p_in[c+(x>>x_factor)];
+            }
+            pt_buffer[c] = t_value;
+        }
+    }
+}
+
+static void VerticalSlice( void *opaque, unsigned i_first, unsigned i_last )
+{
+    const gaussianblur_job_t *job = opaque;
+    const int i_dim = job->p_sys->i_dim;
+    const type_t *pt_distribution = job->p_sys->pt_distribution;
+    const type_t *pt_buffer = job->p_sys->pt_buffer;
+    const type_t *pt_scale = job->p_sys->pt_scale;
+
+    uint8_t *p_out = job->p_out->p_pixels;
+    const int i_out_pitch = job->p_out->i_pitch;
+    const int i_visible_lines = job->p_in->i_visible_lines;
+    const int i_visible_pitch = job->p_in->i_visible_pitch;
+    const int i_in_pitch = job->p_in->i_pitch;
+    const int x_factor = job->x_factor;
+    const int y_factor = job->y_factor;
+
+    for( int i_line = i_first; i_line < (int)i_last; i_line++ )
+    {
+        for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
+        {
+            type_t t_value = 0;
+            const int c = i_line*i_in_pitch+i_col;
+            for( int y = __MAX( -i_dim, (-i_line)*(y_factor+1) );
+                 y <= __MIN( i_dim, (i_visible_lines - i_line)*(y_factor+1) - 1 );
+                 y++ )
+            {
+                t_value += pt_distribution[y+i_dim] *
+                           pt_buffer[c+(y>>y_factor)*i_in_pitch];
+            }
+
+            const type_t t_scale = pt_scale[(i_line<<y_factor)*(i_in_pitch<<x_factor)+(i_col<<x_factor)];
+            p_out[i_line * i_out_pitch + i_col] = (uint8_t)(t_value / t_scale); // FIXME wouldn't it be better to round instead of trunc ?
+        }
+    }
+}
+
 static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     const int i_dim = p_sys->i_dim;
-    type_t *pt_buffer;
     type_t *pt_scale;
     const type_t *pt_distribution = p_sys->pt_distribution;
 
@@ -193,7 +278,6 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
                                p_pic->p[Y_PLANE].i_pitch * sizeof( type_t ) );
     }
 
-    pt_buffer = p_sys->pt_buffer;
     if( !p_sys->pt_scale )
     {
         const int i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
@@ -226,53 +310,24 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
         }
     }
 
-    pt_scale = p_sys->pt_scale;
     for( int i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
     {
-
-        uint8_t *p_in = p_pic->p[i_plane].p_pixels;
-        uint8_t *p_out = p_outpic->p[i_plane].p_pixels;
-
         const int i_visible_lines = p_pic->p[i_plane].i_visible_lines;
         const int i_visible_pitch = p_pic->p[i_plane].i_visible_pitch;
-        const int i_in_pitch = p_pic->p[i_plane].i_pitch;
-
-        const int x_factor = p_pic->p[Y_PLANE].i_visible_pitch/i_visible_pitch-1;
-        const int y_factor = p_pic->p[Y_PLANE].i_visible_lines/i_visible_lines-1;
-
-        for( int i_line = 0; i_line < i_visible_lines; i_line++ )
-        {
-            for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
-            {
-                type_t t_value = 0;
-                const int c = i_line*i_in_pitch+i_col;
-                for( int x = __MAX( -i_dim, -i_col*(x_factor+1) );
-                     x <= __MIN( i_dim, (i_visible_pitch - i_col)*(x_factor+1) + 1 );
-                     x++ )
-                {
-                    t_value += pt_distribution[x+i_dim] *
-                               p_in[c+(x>>x_factor)];
-                }
-                pt_buffer[c] = t_value;
-            }
-        }
-        for( int i_line = 0; i_line < i_visible_lines; i_line++ )
-        {
-            for( int i_col = 0; i_col < i_visible_pitch; i_col++ )
-            {
-                type_t t_value = 0;
-                const int c = i_line*i_in_pitch+i_col;
-                for( int y = __MAX( -i_dim, (-i_line)*(y_factor+1) );
-                     y <= __MIN( i_dim, (i_visible_lines - i_line)*(y_factor+1) - 1 );
-                     y++ )
-                {
-                    t_value += pt_distribution[y+i_dim] *
-                               pt_buffer[c+(y>>y_factor)*i_in_pitch];
-                }
 
-                const type_t t_scale = pt_scale[(i_line<<y_factor)*(i_in_pitch<<x_factor)+(i_col<<x_factor)];
-                p_out[i_line * p_outpic->p[i_plane].i_pitch + i_col] = (uint8_t)(t_value / t_scale); // FIXME wouldn't it be better to round instead of trunc ?
-            }
-        }
+        gaussianblur_job_t job = {
+            .p_sys = p_sys,
+            .p_in = &p_pic->p[i_plane],
+            .p_out = &p_outpic->p[i_plane],
+            .x_factor = p_pic->p[Y_PLANE].i_visible_pitch/i_visible_pitch-1,
+            .y_factor = p_pic->p[Y_PLANE].i_visible_lines/i_visible_lines-1,
+        };
+
+        /* The vertical pass reads lines of the horizontal pass from the
+         * neighbouring slices */
+        vlc_filter_slices_Run( p_sys->slices, i_visible_lines, 1,
+                               HorizontalSlice, &job );
+        vlc_filter_slices_Run( p_sys->slices, i_visible_lines, 1,
+                               VerticalSlice, &job );
     }
 }
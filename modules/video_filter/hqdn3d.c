@@ -32,11 +32,261 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#if defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 #include "hqdn3d.h"
 
+/*****************************************************************************
+ * Vertical and temporal low-pass
+ *****************************************************************************
+ * Contrary to the horizontal pass, each pixel of a line only depends on the
+ * pixels of the same column, so several columns are filtered at once.
+ * Without a gather instruction, SSE2 and NEON look the coefficients up one
+ * lane at a time, and only vectorize the arithmetic around the lookups.
+ *****************************************************************************/
+typedef void (*denoise_row_t)(unsigned int *, const unsigned int *,
+                              unsigned short *, unsigned char *, int,
+                              const int *, const int *);
+
+#if defined(HAVE_AVX2_INTRINSICS)
+# define HQDN3D_AVX2 __attribute__((__target__("avx2")))
+
+HQDN3D_AVX2
+static inline __m256i LowPassMul_AVX2(__m256i prev, __m256i curr,
+                                      const int *coef)
+{
+    const __m256i bias = _mm256_set1_epi32(0x10007FF);
+    __m256i d = _mm256_srli_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(prev, curr), bias), 12);
+
+    return _mm256_add_epi32(curr, _mm256_i32gather_epi32(coef, d, 4));
+}
+
+HQDN3D_AVX2
+static inline __m128i Pack32_AVX2(__m256i v)
+{
+    return _mm_packus_epi32(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+}
+
+HQDN3D_AVX2
+static void deNoiseVerticalTemporal_AVX2(unsigned int *LineAnt,
+                                         const unsigned int *Horiz,
+                                         unsigned short *FrameAnt,
+                                         unsigned char *FrameDest, int W,
+                                         const int *Vertical,
+                                         const int *Temporal)
+{
+    const __m256i round8 = _mm256_set1_epi32(0x1000007F);
+    const __m256i round16 = _mm256_set1_epi32(0x10007FFF);
+    const __m256i mask8 = _mm256_set1_epi32(0xFF);
+    const __m256i mask16 = _mm256_set1_epi32(0xFFFF);
+    int x = 0;
+
+    for (; x + 8 <= W; x += 8)
+    {
+        __m256i line = _mm256_loadu_si256((const __m256i *)&Horiz[x]);
+        if (Vertical != NULL)
+            line = LowPassMul_AVX2(
+                _mm256_loadu_si256((const __m256i *)&LineAnt[x]), line,
+                Vertical);
+        _mm256_storeu_si256((__m256i *)&LineAnt[x], line);
+
+        __m256i dst = line;
+        if (Temporal != NULL)
+        {
+            __m256i prev = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)&FrameAnt[x]));
+            dst = LowPassMul_AVX2(_mm256_slli_epi32(prev, 8), line, Temporal);
+            _mm_storeu_si128((__m128i *)&FrameAnt[x], Pack32_AVX2(
+                _mm256_and_si256(
+                    _mm256_srli_epi32(_mm256_add_epi32(dst, round8), 8),
+                    mask16)));
+        }
+
+        __m128i pix = Pack32_AVX2(_mm256_and_si256(
+            _mm256_srli_epi32(_mm256_add_epi32(dst, round16), 16), mask8));
+        _mm_storel_epi64((__m128i *)&FrameDest[x], _mm_packus_epi16(pix, pix));
+    }
+
+    deNoiseVerticalTemporal_C(&LineAnt[x], &Horiz[x], &FrameAnt[x],
+                              &FrameDest[x], W - x, Vertical, Temporal);
+}
+#endif
+
+#if defined(HAVE_SSE2_INTRINSICS)
+# define HQDN3D_SSE2 __attribute__((__target__("sse2")))
+
+HQDN3D_SSE2
+static inline __m128i LowPassMul_SSE2(__m128i prev, __m128i curr,
+                                      const int *coef)
+{
+    const __m128i bias = _mm_set1_epi32(0x10007FF);
+    uint32_t d[4];
+
+    _mm_storeu_si128((__m128i *)d, _mm_srli_epi32(
+        _mm_add_epi32(_mm_sub_epi32(prev, curr), bias), 12));
+    return _mm_add_epi32(curr, _mm_setr_epi32(coef[d[0]], coef[d[1]],
+                                              coef[d[2]], coef[d[3]]));
+}
+
+/* Bits 8 to 23 of v + round, sign extended for the saturating pack */
+HQDN3D_SSE2
+static inline __m128i Bits8To23_SSE2(__m128i v, __m128i round)
+{
+    return _mm_srai_epi32(_mm_slli_epi32(_mm_add_epi32(v, round), 8), 16);
+}
+
+HQDN3D_SSE2
+static void deNoiseVerticalTemporal_SSE2(unsigned int *LineAnt,
+                                         const unsigned int *Horiz,
+                                         unsigned short *FrameAnt,
+                                         unsigned char *FrameDest, int W,
+                                         const int *Vertical,
+                                         const int *Temporal)
+{
+    const __m128i round8 = _mm_set1_epi32(0x1000007F);
+    const __m128i round16 = _mm_set1_epi32(0x10007FFF);
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+
+    for (; x + 8 <= W; x += 8)
+    {
+        __m128i dst[2], prev = zero;
+
+        if (Temporal != NULL)
+            prev = _mm_loadu_si128((const __m128i *)&FrameAnt[x]);
+
+        for (int i = 0; i < 2; i++)
+        {
+            __m128i line = _mm_loadu_si128((const __m128i *)&Horiz[x + 4 * i]);
+            if (Vertical != NULL)
+                line = LowPassMul_SSE2(
+                    _mm_loadu_si128((const __m128i *)&LineAnt[x + 4 * i]),
+                    line, Vertical);
+            _mm_storeu_si128((__m128i *)&LineAnt[x + 4 * i], line);
+
+            dst[i] = line;
+            if (Temporal != NULL)
+            {
+                __m128i ant = i ? _mm_unpackhi_epi16(prev, zero)
+                                : _mm_unpacklo_epi16(prev, zero);
+                dst[i] = LowPassMul_SSE2(_mm_slli_epi32(ant, 8), line,
+                                         Temporal);
+            }
+        }
+
+        if (Temporal != NULL)
+            _mm_storeu_si128((__m128i *)&FrameAnt[x], _mm_packs_epi32(
+                Bits8To23_SSE2(dst[0], round8),
+                Bits8To23_SSE2(dst[1], round8)));
+
+        __m128i pix = _mm_packs_epi32(
+            _mm_and_si128(_mm_srli_epi32(_mm_add_epi32(dst[0], round16), 16),
+                          mask8),
+            _mm_and_si128(_mm_srli_epi32(_mm_add_epi32(dst[1], round16), 16),
+                          mask8));
+        _mm_storel_epi64((__m128i *)&FrameDest[x], _mm_packus_epi16(pix, pix));
+    }
+
+    deNoiseVerticalTemporal_C(&LineAnt[x], &Horiz[x], &FrameAnt[x],
+                              &FrameDest[x], W - x, Vertical, Temporal);
+}
+#endif
+
+#if defined(__ARM_NEON)
+static inline uint32x4_t LowPassMul_NEON(uint32x4_t prev, uint32x4_t curr,
+                                         const int *coef)
+{
+    uint32_t d[4];
+
+    vst1q_u32(d, vshrq_n_u32(vaddq_u32(vsubq_u32(prev, curr),
+                                       vdupq_n_u32(0x10007FF)), 12));
+    const uint32_t c[4] = { coef[d[0]], coef[d[1]], coef[d[2]], coef[d[3]] };
+    return vaddq_u32(curr, vld1q_u32(c));
+}
+
+static void deNoiseVerticalTemporal_NEON(unsigned int *LineAnt,
+                                         const unsigned int *Horiz,
+                                         unsigned short *FrameAnt,
+                                         unsigned char *FrameDest, int W,
+                                         const int *Vertical,
+                                         const int *Temporal)
+{
+    const uint32x4_t round8 = vdupq_n_u32(0x1000007F);
+    const uint32x4_t round16 = vdupq_n_u32(0x10007FFF);
+    int x = 0;
+
+    for (; x + 8 <= W; x += 8)
+    {
+        uint32x4_t dst[2];
+        uint16x8_t prev = vdupq_n_u16(0);
+
+        if (Temporal != NULL)
+            prev = vld1q_u16(&FrameAnt[x]);
+
+        for (int i = 0; i < 2; i++)
+        {
+            uint32x4_t line = vld1q_u32(&Horiz[x + 4 * i]);
+            if (Vertical != NULL)
+                line = LowPassMul_NEON(vld1q_u32(&LineAnt[x + 4 * i]), line,
+                                       Vertical);
+            vst1q_u32(&LineAnt[x + 4 * i], line);
+
+            dst[i] = line;
+            if (Temporal != NULL)
+            {
+                uint16x4_t ant = i ? vget_high_u16(prev) : vget_low_u16(prev);
+                dst[i] = LowPassMul_NEON(vshll_n_u16(ant, 8), line, Temporal);
+            }
+        }
+
+        /* The narrowing moves keep the low bits, like the C casts */
+        if (Temporal != NULL)
+            vst1q_u16(&FrameAnt[x], vcombine_u16(
+                vmovn_u32(vshrq_n_u32(vaddq_u32(dst[0], round8), 8)),
+                vmovn_u32(vshrq_n_u32(vaddq_u32(dst[1], round8), 8))));
+
+        uint16x8_t pix = vcombine_u16(
+            vmovn_u32(vshrq_n_u32(vaddq_u32(dst[0], round16), 16)),
+            vmovn_u32(vshrq_n_u32(vaddq_u32(dst[1], round16), 16)));
+        vst1_u8(&FrameDest[x], vmovn_u16(pix));
+    }
+
+    deNoiseVerticalTemporal_C(&LineAnt[x], &Horiz[x], &FrameAnt[x],
+                              &FrameDest[x], W - x, Vertical, Temporal);
+}
+#endif
+
+static denoise_row_t GetDenoiseRow(void)
+{
+#if defined(HAVE_AVX2_INTRINSICS)
+    if (vlc_CPU_AVX2())
+        return deNoiseVerticalTemporal_AVX2;
+#endif
+#if defined(HAVE_SSE2_INTRINSICS)
+    if (vlc_CPU_SSE2())
+        return deNoiseVerticalTemporal_SSE2;
+#endif
+#if defined(__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return deNoiseVerticalTemporal_NEON;
+#endif
+    return deNoiseVerticalTemporal_C;
+}
+
 /*****************************************************************************
  * Local protypes
  *****************************************************************************/
@@ -90,11 +340,95 @@ typedef struct
     int w[3], h[3];
 
     struct vf_priv_s cfg;
+    denoise_row_t denoise_row;
+    vlc_filter_slices_t *slices;
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
 } filter_sys_t;
 
+/*****************************************************************************
+ * Denoise: filters one plane
+ *****************************************************************************
+ * The lines are split between the threads for the horizontal pass, then the
+ * columns for the vertical and temporal one.
+ *****************************************************************************/
+typedef struct
+{
+    const uint8_t *src;
+    uint8_t *dst;
+    int src_pitch, dst_pitch;
+    int w, h;
+
+    unsigned int *line;
+    unsigned int *horiz;
+    unsigned short *frame;
+    const int *horizontal, *vertical, *temporal;
+    denoise_row_t denoise_row;
+} denoise_job_t;
+
+static void DenoiseLines(void *opaque, unsigned first, unsigned last)
+{
+    const denoise_job_t *job = opaque;
+
+    if (first == 0 && job->horizontal && !job->temporal) {
+        deNoiseHorizontalSpacialFirst(job->src, job->horiz, job->w,
+                                      job->horizontal);
+        first = 1;
+    }
+
+    deNoiseHorizontal(&job->src[first * job->src_pitch],
+                      &job->horiz[first * job->w], job->w, last - first,
+                      job->src_pitch, job->horizontal);
+}
+
+static void DenoiseColumns(void *opaque, unsigned first, unsigned last)
+{
+    const denoise_job_t *job = opaque;
+
+    for (int y = 0; y < job->h; y++)
+        job->denoise_row(&job->line[first], &job->horiz[y * job->w + first],
+                         &job->frame[y * job->w + first],
+                         &job->dst[y * job->dst_pitch + first], last - first,
+                         y > 0 ? job->vertical : NULL, job->temporal);
+}
+
+static void Denoise(filter_sys_t *sys, int i_plane,
+                    const plane_t *src, plane_t *dst)
+{
+    struct vf_priv_s *cfg = &sys->cfg;
+    const int w = sys->w[i_plane], h = sys->h[i_plane];
+    const int *spatial = cfg->Coefs[i_plane == 0 ? 0 : 2];
+    const int *temporal = cfg->Coefs[i_plane == 0 ? 1 : 3];
+
+    if (!cfg->Frame[i_plane]) {
+        unsigned short *frame = vlc_alloc(w * h, sizeof (*frame));
+        if (!frame)
+            return;
+        for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++)
+                frame[y * w + x] = src->p_pixels[y * src->i_pitch + x] << 8;
+        cfg->Frame[i_plane] = frame;
+    }
+
+    denoise_job_t job = {
+        .src = src->p_pixels, .dst = dst->p_pixels,
+        .src_pitch = src->i_pitch, .dst_pitch = dst->i_pitch,
+        .w = w, .h = h,
+        .line = cfg->Line, .horiz = cfg->Horiz, .frame = cfg->Frame[i_plane],
+        .horizontal = spatial, .vertical = spatial, .temporal = temporal,
+        .denoise_row = sys->denoise_row,
+    };
+    if (!spatial[0])
+        job.horizontal = job.vertical = NULL;
+    else if (!temporal[0])
+        job.temporal = NULL;
+
+    /* Keep the columns of each thread in separate cache lines */
+    vlc_filter_slices_Run(sys->slices, h, 4, DenoiseLines, &job);
+    vlc_filter_slices_Run(sys->slices, w, 64, DenoiseColumns, &job);
+}
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -106,7 +440,7 @@ static int Open(filter_t *filter)
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
     const vlc_fourcc_t fourcc_out = fmt_out->i_chroma;
-    int wmax = 0;
+    int wmax = 0, smax = 0;
 
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
@@ -133,12 +467,20 @@ static int Open(filter_t *filter)
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
         if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        if (sys->w[i] * sys->h[i] > smax) smax = sys->w[i] * sys->h[i];
     }
     cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
+    cfg->Horiz = vlc_alloc(smax, sizeof(unsigned int));
+    sys->slices = filter_NewSlices(filter);
+    if (!cfg->Line || !cfg->Horiz || !sys->slices) {
+        if (sys->slices)
+            vlc_filter_slices_Delete(sys->slices);
+        free(cfg->Horiz);
+        free(cfg->Line);
         free(sys);
         return VLC_ENOMEM;
     }
+    sys->denoise_row = GetDenoiseRow();
 
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
@@ -183,7 +525,9 @@ static void Close(filter_t *filter)
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
     }
+    free(cfg->Horiz);
     free(cfg->Line);
+    vlc_filter_slices_Delete(sys->slices);
     free(sys);
 }
 
@@ -219,24 +563,8 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
+    for (int i = 0; i < 3; ++i)
+        Denoise(sys, i, &src->p[i], &dst->p[i]);
 
     if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
     {
@@ -273,3 +601,136 @@ static int DenoiseCallback( vlc_object_t *p_this, char const *psz_var,
 
     return VLC_SUCCESS;
 }
+
+#ifdef HQDN3D_TEST
+/*****************************************************************************
+ * Test: compares the threaded and vectorized filter against the original
+ * implementation. Both passes do the same computations in another order, so
+ * the results must be identical.
+ *****************************************************************************/
+static void FillPlane(uint8_t *p, int w, int h, int pitch, int frame)
+{
+    /* Moving gradient with noise, so that the whole tables are used */
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            p[y * pitch + x] = VLC_CLIP(((x + 3 * frame) * 255 / w
+                                         + y * 255 / h) / 2
+                                        + rand() % 64 - 32, 0, 255);
+}
+
+static bool TestPlane(denoise_row_t denoise_row, vlc_filter_slices_t *slices,
+                      int w, int h, float spat, float temp)
+{
+    const int pitch = w + 13;
+    filter_sys_t *sys = calloc(1, sizeof (*sys));
+    unsigned int *line = malloc(w * sizeof (*line));
+    unsigned short *frame = NULL;
+    uint8_t *src = malloc(pitch * h);
+    uint8_t *dst = malloc(pitch * h);
+    uint8_t *ref = malloc(pitch * h);
+    bool ok = true;
+
+    assert(sys && line && src && dst && ref);
+    sys->w[0] = w;
+    sys->h[0] = h;
+    sys->denoise_row = denoise_row;
+    sys->slices = slices;
+    sys->cfg.Line = malloc(w * sizeof (unsigned int));
+    sys->cfg.Horiz = malloc(w * h * sizeof (unsigned int));
+    assert(sys->cfg.Line && sys->cfg.Horiz);
+    PrecalcCoefs(sys->cfg.Coefs[0], spat);
+    PrecalcCoefs(sys->cfg.Coefs[1], temp);
+
+    for (int f = 0; f < 5 && ok; f++)
+    {
+        FillPlane(src, w, h, pitch, f);
+
+        plane_t src_plane = { .p_pixels = src, .i_pitch = pitch };
+        plane_t dst_plane = { .p_pixels = dst, .i_pitch = pitch };
+        Denoise(sys, 0, &src_plane, &dst_plane);
+        deNoise(src, ref, line, &frame, w, h, pitch, pitch,
+                sys->cfg.Coefs[0], sys->cfg.Coefs[0], sys->cfg.Coefs[1]);
+        assert(sys->cfg.Frame[0] && frame);
+
+        for (int y = 0; y < h && ok; y++)
+            if (memcmp(&dst[y * pitch], &ref[y * pitch], w))
+            {
+                fprintf(stderr, "error: %dx%d (%.1f, %.1f) frame %d, "
+                        "line %d mismatch\n", w, h, spat, temp, f, y);
+                ok = false;
+            }
+        if (ok && memcmp(sys->cfg.Frame[0], frame, w * h * sizeof (*frame)))
+        {
+            fprintf(stderr, "error: %dx%d (%.1f, %.1f) frame %d, "
+                    "temporal state mismatch\n", w, h, spat, temp, f);
+            ok = false;
+        }
+    }
+
+    free(ref);
+    free(dst);
+    free(src);
+    free(frame);
+    free(line);
+    free(sys->cfg.Frame[0]);
+    free(sys->cfg.Horiz);
+    free(sys->cfg.Line);
+    free(sys);
+    return ok;
+}
+
+int main(void)
+{
+    const struct
+    {
+        const char *name;
+        denoise_row_t denoise_row;
+        bool usable;
+    } impls[] = {
+        { "C", deNoiseVerticalTemporal_C, true },
+#if defined(HAVE_AVX2_INTRINSICS)
+        { "AVX2", deNoiseVerticalTemporal_AVX2, vlc_CPU_AVX2() },
+#endif
+#if defined(HAVE_SSE2_INTRINSICS)
+        { "SSE2", deNoiseVerticalTemporal_SSE2, vlc_CPU_SSE2() },
+#endif
+#if defined(__ARM_NEON)
+        { "NEON", deNoiseVerticalTemporal_NEON, vlc_CPU_ARM_NEON() },
+#endif
+    };
+    static const int sizes[][2] = {
+        { 1, 1 }, { 7, 5 }, { 33, 17 }, { 130, 67 }, { 320, 180 },
+    };
+    static const float strengths[][2] = {
+        { 4.0, 6.0 }, { 3.0, 4.5 }, { 0.0, 6.0 }, { 4.0, 0.0 },
+        { 0.0, 0.0 }, { 30.0, 50.0 }, { 254.0, 254.0 },
+    };
+    vlc_filter_slices_t *slices = vlc_filter_slices_New(4);
+    int ret = 0;
+
+    assert(slices != NULL);
+    srand(0);
+    for (size_t i = 0; i < ARRAY_SIZE(impls); i++)
+    {
+        if (!impls[i].usable)
+            continue;
+
+        for (size_t j = 0; j < ARRAY_SIZE(sizes); j++)
+            for (size_t k = 0; k < ARRAY_SIZE(strengths); k++)
+            {
+                const int w = sizes[j][0], h = sizes[j][1];
+                const float spat = strengths[k][0], temp = strengths[k][1];
+
+                if (!TestPlane(impls[i].denoise_row, NULL, w, h, spat, temp)
+                 || !TestPlane(impls[i].denoise_row, slices, w, h, spat, temp))
+                {
+                    fprintf(stderr, "%s failed\n", impls[i].name);
+                    ret = 1;
+                }
+            }
+    }
+
+    vlc_filter_slices_Delete(slices);
+    return ret;
+}
+#endif
@@ -33,19 +33,115 @@
 struct vf_priv_s {
         int Coefs[4][512*16];
         unsigned int *Line;
+        unsigned int *Horiz;
         unsigned short *Frame[3];
 };
 
 
 /***************************************************************************/
 
-static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int CurrMul, int* Coef){
+static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int CurrMul, const int* Coef){
 //    int dMul= (PrevMul&0xFFFFFF)-(CurrMul&0xFFFFFF);
     int dMul= PrevMul-CurrMul;
     unsigned int d=((dMul+0x10007FF)>>12);
     return CurrMul + Coef[d];
 }
 
+/* The 3D filter is split in two passes, so that each of them can run in
+ * parallel: the horizontal low-pass only depends on the previous pixel of the
+ * same line, the vertical and temporal ones on the pixel of the same column in
+ * the previous line and frame. Both passes give exactly the same results as
+ * the original single pass implementation below. */
+
+static void deNoiseHorizontal(
+                    const unsigned char *Frame,  // mpi->planes[x]
+                    unsigned int *FrameDest,     // vf->priv->Horiz
+                    int W, int H, int sStride,
+                    const int *Horizontal)       // NULL for temporal only
+{
+    long Y = 0;
+
+    if(!Horizontal){
+        for (; Y < H; Y++){
+            for (long X = 0; X < W; X++)
+                FrameDest[Y*W+X] = Frame[Y*sStride+X]<<16;
+        }
+        return;
+    }
+
+    /* Each line is a chain of dependent lookups in the coefficients table:
+     * filter 4 lines together to hide the latency of the loads. */
+    for (; Y + 4 <= H; Y += 4){
+        const unsigned char *F0 = &Frame[Y*sStride], *F1 = F0 + sStride,
+                            *F2 = F1 + sStride, *F3 = F2 + sStride;
+        unsigned int *D0 = &FrameDest[Y*W], *D1 = D0 + W,
+                     *D2 = D1 + W, *D3 = D2 + W;
+        unsigned int A0, A1, A2, A3;
+
+        /* First pixel on each line doesn't have previous pixel */
+        D0[0] = A0 = F0[0]<<16;
+        D1[0] = A1 = F1[0]<<16;
+        D2[0] = A2 = F2[0]<<16;
+        D3[0] = A3 = F3[0]<<16;
+        for (long X = 1; X < W; X++){
+            D0[X] = A0 = LowPassMul(A0, F0[X]<<16, Horizontal);
+            D1[X] = A1 = LowPassMul(A1, F1[X]<<16, Horizontal);
+            D2[X] = A2 = LowPassMul(A2, F2[X]<<16, Horizontal);
+            D3[X] = A3 = LowPassMul(A3, F3[X]<<16, Horizontal);
+        }
+    }
+
+    for (; Y < H; Y++){
+        const unsigned char *F0 = &Frame[Y*sStride];
+        unsigned int *D0 = &FrameDest[Y*W];
+        unsigned int A0;
+
+        D0[0] = A0 = F0[0]<<16;
+        for (long X = 1; X < W; X++)
+            D0[X] = A0 = LowPassMul(A0, F0[X]<<16, Horizontal);
+    }
+}
+
+/* Without temporal filtering, the first line of the plane is filtered
+ * against its first pixel rather than the previous one */
+static void deNoiseHorizontalSpacialFirst(
+                    const unsigned char *Frame,  // mpi->planes[x]
+                    unsigned int *FrameDest,     // vf->priv->Horiz
+                    int W,
+                    const int *Horizontal)
+{
+    const unsigned int PixelAnt = Frame[0]<<16;
+
+    FrameDest[0] = PixelAnt;
+    for (long X = 1; X < W; X++)
+        FrameDest[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
+}
+
+static void deNoiseVerticalTemporal_C(
+                    unsigned int *LineAnt,       // vf->priv->Line
+                    const unsigned int *Horiz,   // one line of vf->priv->Horiz
+                    unsigned short *FrameAnt,    // one line of previous frame
+                    unsigned char *FrameDest,    // one line of dmpi->planes[x]
+                    int W,
+                    const int *Vertical,         // NULL on first line
+                    const int *Temporal)         // NULL for spatial only
+{
+    unsigned int PixelDst;
+
+    for (long X = 0; X < W; X++){
+        LineAnt[X] = Vertical ? LowPassMul(LineAnt[X], Horiz[X], Vertical)
+                              : Horiz[X];
+        if(Temporal){
+            PixelDst = LowPassMul(FrameAnt[X]<<8, LineAnt[X], Temporal);
+            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
+        } else
+            PixelDst = LineAnt[X];
+        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+    }
+}
+
+#ifdef HQDN3D_TEST
+/* Original single pass implementation, used as reference by the test */
 static void deNoiseTemporal(
                     unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
@@ -175,6 +271,8 @@ static void deNoise(unsigned char *Frame,        // mpi->planes[x]
 }
 
 
+#endif
+
 //===========================================================================//
 
 static void PrecalcCoefs(int *Ct, double Dist25)
@@ -87,6 +87,7 @@ static const char *const ppsz_filter_options[] = {
 typedef struct
 {
     atomic_int sigma;
+    vlc_filter_slices_t *slices;
 } filter_sys_t;
 
 /*****************************************************************************
@@ -112,6 +113,13 @@ static int Create( filter_t *p_filter )
         return VLC_ENOMEM;
     p_filter->p_sys = p_sys;
 
+    p_sys->slices = filter_NewSlices( p_filter );
+    if( p_sys->slices == NULL )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     p_filter->ops = &Filter_ops;
 
     config_ChainParse( p_filter, FILTER_PREFIX, ppsz_filter_options,
@@ -138,6 +146,7 @@ static void Destroy( filter_t *p_filter )
     filter_sys_t *p_sys = p_filter->p_sys;
 
     var_DelCallback( p_filter, FILTER_PREFIX "sigma", SharpenCallback, p_sys );
+    vlc_filter_slices_Delete( p_sys->slices );
     free( p_sys );
 }
 
@@ -152,7 +161,16 @@ static void Destroy( filter_t *p_filter )
 #define IS_YUV_420_10BITS(fmt) (fmt == VLC_CODEC_I420_10L ||    \
                                 fmt == VLC_CODEC_I420_10B)
 
-#define SHARPEN_FRAME(maxval, data_t)                                   \
+typedef struct
+{
+    const picture_t *p_pic;
+    picture_t *p_outpic;
+    int sigma;
+} sharpen_job_t;
+
+/* Sharpens the luma lines [i_first, i_last), the first and last lines of the
+ * picture being copied as is */
+#define SHARPEN_LINES(maxval, data_t)                                   \
     do                                                                  \
     {                                                                   \
         assert((maxval) >= 0);                                          \
@@ -161,11 +179,12 @@ static void Destroy( filter_t *p_filter )
         const unsigned data_sz = sizeof(data_t);                        \
         const int i_src_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
         const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_sys->sigma);         \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
+        if( i_first == 0 )                                              \
+            memcpy(p_out, p_src, i_visible_pitch);                      \
                                                                         \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = __MAX(i_first, 1);                            \
+             i < __MIN(i_last, i_visible_lines - 1); i++ )              \
         {                                                               \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
@@ -192,24 +211,40 @@ static void Destroy( filter_t *p_filter )
             p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
                 p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
+        if( i_last == i_visible_lines )                                 \
+            memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],      \
+                   &p_src[(i_visible_lines - 1) * i_src_line_len],      \
+                   i_visible_pitch);                                    \
     } while (0)
 
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+static void SharpenSlice( void *opaque, unsigned i_first, unsigned i_last )
 {
+    const sharpen_job_t *job = opaque;
+    const picture_t *p_pic = job->p_pic;
+    picture_t *p_outpic = job->p_outpic;
+    const int sigma = job->sigma;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
     const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
     const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
 
-    filter_sys_t *p_sys = p_filter->p_sys;
-
     if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
-        SHARPEN_FRAME(255, uint8_t);
+        SHARPEN_LINES(255, uint8_t);
     else
-        SHARPEN_FRAME(1023, uint16_t);
+        SHARPEN_LINES(1023, uint16_t);
+}
+
+static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    sharpen_job_t job = {
+        .p_pic = p_pic,
+        .p_outpic = p_outpic,
+        .sigma = atomic_load(&p_sys->sigma),
+    };
+
+    vlc_filter_slices_Run( p_sys->slices, p_pic->p[Y_PLANE].i_visible_lines,
+                           1, SharpenSlice, &job );
 
     plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
     plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
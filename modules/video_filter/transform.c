@@ -112,8 +112,10 @@ static void R270(int *sx, int *sy, int w, int h, int dx, int dy)
 }
 typedef void (*convert_t)(int *, int *, int, int, int, int);
 
+/* The plane functions render the destination lines [first, last) */
 #define PLANE(f,bits) \
-static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src) \
+static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src, \
+                              int first, int last) \
 { \
     const uint##bits##_t *src_pixels = (const void *)src->p_pixels; \
     uint##bits##_t *restrict dst_pixels = (void *)dst->p_pixels; \
@@ -121,7 +123,7 @@ static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src
     const unsigned dst_width = dst->i_pitch / sizeof (*dst_pixels); \
     const unsigned dst_visible_width = dst->i_visible_pitch / sizeof (*dst_pixels); \
  \
-    for (int y = 0; y < dst->i_visible_lines; y++) { \
+    for (int y = first; y < last; y++) { \
         for (unsigned x = 0; x < dst_visible_width; x++) { \
             int sx, sy; \
             (f)(&sx, &sy, dst_visible_width, dst->i_visible_lines, x, y); \
@@ -131,13 +133,14 @@ static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src
     } \
 }
 
-static void Plane_VFlip(plane_t *restrict dst, const plane_t *restrict src)
+static void Plane_VFlip(plane_t *restrict dst, const plane_t *restrict src,
+                        int first, int last)
 {
-    const uint8_t *src_pixels = src->p_pixels;
+    const uint8_t *src_pixels = src->p_pixels + src->i_pitch * first;
     uint8_t *restrict dst_pixels = dst->p_pixels;
 
-    dst_pixels += dst->i_pitch * dst->i_visible_lines;
-    for (int y = 0; y < dst->i_visible_lines; y++) {
+    dst_pixels += dst->i_pitch * (dst->i_visible_lines - first);
+    for (int y = first; y < last; y++) {
         dst_pixels -= dst->i_pitch;
         memcpy(dst_pixels, src_pixels, dst->i_visible_pitch);
         src_pixels += src->i_pitch;
@@ -145,9 +148,10 @@ static void Plane_VFlip(plane_t *restrict dst, const plane_t *restrict src)
 }
 
 #define I422(f) \
-static void Plane422_##f(plane_t *restrict dst, const plane_t *restrict src) \
+static void Plane422_##f(plane_t *restrict dst, const plane_t *restrict src, \
+                         int first, int last) \
 { \
-    for (int y = 0; y < dst->i_visible_lines; y += 2) { \
+    for (int y = first; y < last; y += 2) { \
         for (int x = 0; x < dst->i_visible_pitch; x++) { \
             int sx, sy, uv; \
             (f)(&sx, &sy, dst->i_visible_pitch, dst->i_visible_lines / 2, \
@@ -161,11 +165,12 @@ static void Plane422_##f(plane_t *restrict dst, const plane_t *restrict src) \
 }
 
 #define YUY2(f) \
-static void PlaneYUY2_##f(plane_t *restrict dst, const plane_t *restrict src) \
+static void PlaneYUY2_##f(plane_t *restrict dst, const plane_t *restrict src, \
+                          int first, int last) \
 { \
     unsigned dst_visible_width = dst->i_visible_pitch / 2; \
  \
-    for (int y = 0; y < dst->i_visible_lines; y += 2) { \
+    for (int y = first; y < last; y += 2) { \
         for (unsigned x = 0; x < dst_visible_width; x+= 2) { \
             int sx0, sy0, sx1, sy1; \
             (f)(&sx0, &sy0, dst_visible_width, dst->i_visible_lines, x, y); \
@@ -225,16 +230,19 @@ YUY2(AntiTranspose)
 YUY2(R90)
 YUY2(R270)
 
+typedef void (*plane_render_t)(plane_t *dst, const plane_t *src,
+                               int first, int last);
+
 typedef struct {
     char      name[16];
     convert_t convert;
     convert_t iconvert;
     video_transform_t operation;
-    void      (*plane8) (plane_t *dst, const plane_t *src);
-    void      (*plane16)(plane_t *dst, const plane_t *src);
-    void      (*plane32)(plane_t *dst, const plane_t *src);
-    void      (*i422)(plane_t *dst, const plane_t *src);
-    void      (*yuyv)(plane_t *dst, const plane_t *src);
+    plane_render_t plane8;
+    plane_render_t plane16;
+    plane_render_t plane32;
+    plane_render_t i422;
+    plane_render_t yuyv;
 } transform_description_t;
 
 #define DESC(str, f, invf, op) \
@@ -259,10 +267,25 @@ static bool dsc_is_rotated(const transform_description_t *dsc)
 typedef struct
 {
     const vlc_chroma_description_t *chroma;
-    void (*plane[PICTURE_PLANE_MAX])(plane_t *, const plane_t *);
+    plane_render_t plane[PICTURE_PLANE_MAX];
     convert_t convert;
+    vlc_filter_slices_t *slices;
 } filter_sys_t;
 
+typedef struct
+{
+    plane_render_t render;
+    plane_t *dst;
+    const plane_t *src;
+} transform_job_t;
+
+static void TransformSlice(void *opaque, unsigned first, unsigned last)
+{
+    const transform_job_t *job = opaque;
+
+    job->render(job->dst, job->src, first, last);
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -274,8 +297,17 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
 
     const vlc_chroma_description_t *chroma = sys->chroma;
-    for (unsigned i = 0; i < chroma->plane_count; i++)
-         (sys->plane[i])(&dst->p[i], &src->p[i]);
+    for (unsigned i = 0; i < chroma->plane_count; i++) {
+        transform_job_t job = {
+            .render = sys->plane[i],
+            .dst = &dst->p[i],
+            .src = &src->p[i],
+        };
+
+        /* The 4:2:2 and YUY2 rotations render lines by pairs */
+        vlc_filter_slices_Run(sys->slices, dst->p[i].i_visible_lines, 2,
+                              TransformSlice, &job);
+    }
 
     picture_CopyProperties(dst, src);
     picture_Release(src);
@@ -296,6 +328,13 @@ static int Mouse(filter_t *filter, vlc_mouse_t *mouse,
     return VLC_SUCCESS;
 }
 
+static void Close(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    vlc_filter_slices_Delete(sys->slices);
+}
+
 static int Open(filter_t *filter)
 {
     const video_format_t *src = &filter->fmt_in.video;
@@ -425,10 +464,15 @@ static int Open(filter_t *filter)
             return VLC_EGENERIC;
     }
 
+    sys->slices = filter_NewSlices(filter);
+    if (sys->slices == NULL)
+        return VLC_ENOMEM;
+
     static const struct vlc_filter_operations filter_ops =
     {
         .filter_video = Filter,
         .video_mouse = Mouse,
+        .close = Close,
     };
     filter->ops = &filter_ops;
     filter->p_sys           = sys;
@@ -405,6 +405,11 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define FILTER_THREADS_TEXT N_("Video filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of slices of each picture that video filters supporting it " \
+    "process in parallel. 0 uses the number of CPUs, 1 disables threading.")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -893,6 +898,11 @@ static const char* const ppsz_restore_playback_desc[] = {
     "However allocation of port numbers below 1025 is usually restricted " \
     "by the operating system." )
 
+#define HTTPD_THREADS_TEXT N_( "HTTP server threads" )
+#define HTTPD_THREADS_LONGTEXT N_( \
+    "Number of threads serving the clients of each HTTP, HTTPS or RTSP " \
+    "server. More threads help when many clients pull the same stream." )
+
 #define HTTPS_PORT_TEXT N_( "HTTPS server port" )
 #define HTTPS_PORT_LONGTEXT N_( \
     "The HTTPS server will listen on this TCP port. " \
@@ -1733,6 +1743,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer( "filter-threads", 0, FILTER_THREADS_TEXT,
+                 FILTER_THREADS_LONGTEXT )
+        change_integer_range( 0, 64 )
 
 #if 0
     add_string( "pixel-ratio", "1", PIXEL_RATIO_TEXT, PIXEL_RATIO_TEXT )
@@ -1889,6 +1902,9 @@ vlc_module_begin ()
         change_integer_range( 1, 65535 )
     add_integer( "https-port", 8443, HTTPS_PORT_TEXT, HTTPS_PORT_LONGTEXT )
         change_integer_range( 1, 65535 )
+    add_integer( "httpd-threads", 1, HTTPD_THREADS_TEXT,
+                 HTTPD_THREADS_LONGTEXT )
+        change_integer_range( 1, 64 )
     add_string( "rtsp-host", NULL, RTSP_HOST_TEXT, RTSP_HOST_LONGTEXT )
     add_integer( "rtsp-port", 554, RTSP_PORT_TEXT, RTSP_PORT_LONGTEXT )
         change_integer_range( 1, 65535 )
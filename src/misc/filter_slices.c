@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * filter_slices.c : slice-parallel execution of video filter kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_executor.h>
+#include <vlc_filter.h>
+
+/* Slices smaller than this are not worth the synchronization */
+#define SLICE_MIN_LINES 16
+#define SLICE_MAX_COUNT 64
+
+/* Worker pool shared by all the contexts */
+static vlc_mutex_t pool_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *pool;
+static unsigned pool_refs;
+
+struct vlc_filter_slices
+{
+    unsigned threads;
+};
+
+struct slice_job
+{
+    vlc_filter_slice_cb cb;
+    void *opaque;
+
+    vlc_mutex_t lock;
+    vlc_cond_t done;
+    unsigned pending;
+};
+
+struct slice_task
+{
+    struct vlc_runnable runnable;
+    struct slice_job *job;
+    unsigned first;
+    unsigned last;
+};
+
+static void RunSlice(void *userdata)
+{
+    struct slice_task *task = userdata;
+    struct slice_job *job = task->job;
+
+    job->cb(job->opaque, task->first, task->last);
+
+    vlc_mutex_lock(&job->lock);
+    assert(job->pending > 0);
+    if (--job->pending == 0)
+        vlc_cond_signal(&job->done);
+    vlc_mutex_unlock(&job->lock);
+}
+
+vlc_filter_slices_t *vlc_filter_slices_New(unsigned threads)
+{
+    vlc_filter_slices_t *slices = malloc(sizeof (*slices));
+    if (unlikely(slices == NULL))
+        return NULL;
+
+    if (threads == 0)
+        threads = vlc_GetCPUCount();
+    slices->threads = __MIN(threads, SLICE_MAX_COUNT);
+
+    if (slices->threads > 1)
+    {
+        vlc_mutex_lock(&pool_lock);
+        if (pool == NULL)
+            pool = vlc_executor_New(vlc_GetCPUCount());
+        if (pool != NULL)
+            pool_refs++;
+        else
+            slices->threads = 1;
+        vlc_mutex_unlock(&pool_lock);
+    }
+    return slices;
+}
+
+void vlc_filter_slices_Delete(vlc_filter_slices_t *slices)
+{
+    if (slices->threads > 1)
+    {
+        vlc_executor_t *last = NULL;
+
+        vlc_mutex_lock(&pool_lock);
+        assert(pool_refs > 0);
+        if (--pool_refs == 0)
+        {
+            last = pool;
+            pool = NULL;
+        }
+        vlc_mutex_unlock(&pool_lock);
+
+        if (last != NULL)
+            vlc_executor_Delete(last);
+    }
+    free(slices);
+}
+
+void vlc_filter_slices_Run(vlc_filter_slices_t *slices, unsigned lines,
+                           unsigned align, vlc_filter_slice_cb cb,
+                           void *opaque)
+{
+    unsigned count = slices != NULL ? slices->threads : 1;
+
+    if (align == 0)
+        align = 1;
+    count = __MIN(count, lines / SLICE_MIN_LINES);
+    if (count <= 1)
+    {
+        cb(opaque, 0, lines);
+        return;
+    }
+
+    unsigned size = (lines + count - 1) / count;
+    size = (size + align - 1) / align * align;
+    count = (lines + size - 1) / size;
+
+    struct slice_job job = {
+        .cb = cb,
+        .opaque = opaque,
+        .pending = count - 1,
+    };
+    struct slice_task tasks[SLICE_MAX_COUNT];
+
+    vlc_mutex_init(&job.lock);
+    vlc_cond_init(&job.done);
+
+    /* The calling thread runs the first slice, the pool the others */
+    for (unsigned i = 1; i < count; i++)
+    {
+        struct slice_task *task = &tasks[i];
+
+        task->runnable.run = RunSlice;
+        task->runnable.userdata = task;
+        task->job = &job;
+        task->first = i * size;
+        task->last = __MIN(lines, (i + 1) * size);
+        vlc_executor_Submit(pool, &task->runnable);
+    }
+
+    cb(opaque, 0, __MIN(lines, size));
+
+    /* Run the slices that no worker picked up yet, rather than waiting for
+     * workers busy with other filters */
+    for (unsigned i = count - 1; i >= 1; i--)
+        if (vlc_executor_Cancel(pool, &tasks[i].runnable))
+            RunSlice(&tasks[i]);
+
+    vlc_mutex_lock(&job.lock);
+    while (job.pending > 0)
+        vlc_cond_wait(&job.done, &job.lock);
+    vlc_mutex_unlock(&job.lock);
+}
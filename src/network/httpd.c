@@ -68,10 +68,30 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* Stream data is kept in chunks of that size, shared by all the clients */
+#define HTTPD_STREAM_CHUNK (64 * 1024)
+/* Maximum number of chunks handed to a single writev() */
+#define HTTPD_STREAM_IOV 16
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static void httpd_AppendData(httpd_stream_t *stream, const uint8_t *p_data,
+                             size_t i_data);
+
+/* each worker serves a subset of the host clients in its own thread */
+struct httpd_worker
+{
+    httpd_host_t *host;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+
+    size_t client_count;
+    struct vlc_list clients;
+
+    /* wakes the worker up when a new client is handed over to it,
+     * unused (-1) for the first worker which accepts connections */
+    int wakefd[2];
+};
 
-/* each host run in his own thread */
 struct httpd_host_t
 {
     struct vlc_object_t obj;
@@ -85,17 +105,20 @@ struct httpd_host_t
     unsigned     nfd;
     unsigned     port;
 
-    vlc_thread_t thread;
+    /* protects the url list and serializes the url callbacks */
     vlc_mutex_t lock;
 
+    /* the first worker accepts connections and dispatches them */
+    struct httpd_worker *workers;
+    unsigned worker_count;
+    unsigned next_worker;
+
     /* all registered url (becarefull that 2 httpd_url_t could point at the same url)
      * This will slow down the url research but make my live easier
      * All url will have their cb trigger, but only the first one can answer
      * */
     struct vlc_list urls;
 
-    size_t client_count;
-    struct vlc_list clients;
     unsigned timeout_sec;
 
     /* TLS data */
@@ -129,7 +152,7 @@ enum
     HTTPD_CLIENT_SENDING,
     HTTPD_CLIENT_SEND_DONE,
 
-    HTTPD_CLIENT_WAITING,
+    HTTPD_CLIENT_STREAMING,
 
     HTTPD_CLIENT_DEAD,
 
@@ -144,7 +167,7 @@ struct httpd_client_t
 
     struct vlc_list node;
 
-    bool    b_stream_mode;
+    httpd_stream_t *stream; /* set once the client pulls a stream */
     uint8_t i_state;
 
     vlc_tick_t i_timeout_date;
@@ -593,6 +616,24 @@ void httpd_RedirectDelete(httpd_redirect_t *rdir)
 /*****************************************************************************
  * High Level Functions: httpd_stream_t
  *****************************************************************************/
+/* Stream data chunk, refcounted so that clients can send it without copy */
+struct httpd_stream_chunk
+{
+    atomic_uint refs;
+    struct vlc_list node;
+
+    int64_t pos;        /* absolute position of the first byte */
+    size_t  size;       /* only grows, and only while this is the last chunk */
+    size_t  capacity;
+    uint8_t data[];
+};
+
+static void httpd_ChunkRelease(struct httpd_stream_chunk *chunk)
+{
+    if (atomic_fetch_sub_explicit(&chunk->refs, 1, memory_order_acq_rel) == 1)
+        free(chunk);
+}
+
 struct httpd_stream_t
 {
     vlc_mutex_t lock;
@@ -612,9 +653,10 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
-    /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* stream data, oldest chunk first */
+    size_t      i_buffer_size;      /* amount of data to keep */
+    size_t      i_chunks_size;      /* amount of data in chunks */
+    struct vlc_list chunks;
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
@@ -632,120 +674,78 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
     if (!answer || !query || !cl)
         return VLC_SUCCESS;
 
-    if (answer->i_body_offset > 0) {
-        int     i_pos;
+    /* Only the answer is built here: once it is sent, the stream data is
+     * pushed from the shared chunks by httpd_ClientStream(). */
+    answer->i_proto  = HTTPD_PROTO_HTTP;
+    answer->i_version= 0;
+    answer->i_type   = HTTPD_MSG_ANSWER;
 
-        if (answer->i_body_offset >= stream->i_buffer_pos)
-            return VLC_EGENERIC;    /* wait, no data available */
+    answer->i_status = 200;
 
-        if (cl->i_keyframe_wait_to_pass >= 0) {
-            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
-                /* still waiting for the next keyframe */
-                return VLC_EGENERIC;
+    bool b_has_content_type = false;
+    bool b_has_cache_control = false;
 
-            /* seek to the new keyframe */
-            answer->i_body_offset = stream->i_last_keyframe_seen_pos;
-            cl->i_keyframe_wait_to_pass = -1;
+    vlc_mutex_lock(&stream->lock);
+    for (size_t i = 0; i < stream->i_http_headers; i++)
+        if (strncasecmp(stream->p_http_headers[i].name, "Content-Length", 14)) {
+            httpd_MsgAdd(answer, stream->p_http_headers[i].name, "%s",
+                          stream->p_http_headers[i].value);
+
+            if (!strncasecmp(stream->p_http_headers[i].name, "Content-Type", 12))
+                b_has_content_type = true;
+            else if (!strncasecmp(stream->p_http_headers[i].name, "Cache-Control", 13))
+                b_has_cache_control = true;
         }
+    vlc_mutex_unlock(&stream->lock);
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
-            answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
-
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
-
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
-            return VLC_EGENERIC;    /* wait, no data available */
-
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
-
-        /* using HTTPD_MSG_ANSWER -> data available */
-        answer->i_proto  = HTTPD_PROTO_HTTP;
-        answer->i_version= 0;
-        answer->i_type   = HTTPD_MSG_ANSWER;
-
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
-
-        answer->i_body_offset += i_write;
-
-        return VLC_SUCCESS;
-    } else {
-        answer->i_proto  = HTTPD_PROTO_HTTP;
-        answer->i_version= 0;
-        answer->i_type   = HTTPD_MSG_ANSWER;
-
-        answer->i_status = 200;
-
-        bool b_has_content_type = false;
-        bool b_has_cache_control = false;
-
+    if (query->i_type != HTTPD_MSG_HEAD) {
+        cl->stream = stream;
         vlc_mutex_lock(&stream->lock);
-        for (size_t i = 0; i < stream->i_http_headers; i++)
-            if (strncasecmp(stream->p_http_headers[i].name, "Content-Length", 14)) {
-                httpd_MsgAdd(answer, stream->p_http_headers[i].name, "%s",
-                              stream->p_http_headers[i].value);
-
-                if (!strncasecmp(stream->p_http_headers[i].name, "Content-Type", 12))
-                    b_has_content_type = true;
-                else if (!strncasecmp(stream->p_http_headers[i].name, "Cache-Control", 13))
-                    b_has_cache_control = true;
-            }
-        vlc_mutex_unlock(&stream->lock);
-
-        if (query->i_type != HTTPD_MSG_HEAD) {
-            cl->b_stream_mode = true;
-            vlc_mutex_lock(&stream->lock);
-            /* Send the header */
-            if (stream->i_header > 0) {
-                answer->i_body = stream->i_header;
-                answer->p_body = xmalloc(stream->i_header);
-                memcpy(answer->p_body, stream->p_header, stream->i_header);
-            }
-            answer->i_body_offset = stream->i_buffer_last_pos;
-            if (stream->b_has_keyframes)
-                cl->i_keyframe_wait_to_pass = stream->i_last_keyframe_seen_pos;
-            else
-                cl->i_keyframe_wait_to_pass = -1;
-            vlc_mutex_unlock(&stream->lock);
-        } else {
-            httpd_MsgAdd(answer, "Content-Length", "0");
-            answer->i_body_offset = 0;
+        /* Send the header */
+        if (stream->i_header > 0) {
+            answer->i_body = stream->i_header;
+            answer->p_body = xmalloc(stream->i_header);
+            memcpy(answer->p_body, stream->p_header, stream->i_header);
         }
+        answer->i_body_offset = stream->i_buffer_last_pos;
+        if (stream->b_has_keyframes)
+            cl->i_keyframe_wait_to_pass = stream->i_last_keyframe_seen_pos;
+        else
+            cl->i_keyframe_wait_to_pass = -1;
+        vlc_mutex_unlock(&stream->lock);
+    } else {
+        httpd_MsgAdd(answer, "Content-Length", "0");
+        answer->i_body_offset = 0;
+    }
 
-        /* FIXME: move to http access_output */
-        if (!strcmp(stream->psz_mime, "video/x-ms-asf-stream")) {
-            bool b_xplaystream = false;
+    /* FIXME: move to http access_output */
+    if (!strcmp(stream->psz_mime, "video/x-ms-asf-stream")) {
+        bool b_xplaystream = false;
 
-            httpd_MsgAdd(answer, "Content-type", "application/octet-stream");
-            httpd_MsgAdd(answer, "Server", "Cougar 4.1.0.3921");
-            httpd_MsgAdd(answer, "Pragma", "no-cache");
-            httpd_MsgAdd(answer, "Pragma", "client-id=%lu",
-                          vlc_mrand48()&0x7fff);
-            httpd_MsgAdd(answer, "Pragma", "features=\"broadcast\"");
+        httpd_MsgAdd(answer, "Content-type", "application/octet-stream");
+        httpd_MsgAdd(answer, "Server", "Cougar 4.1.0.3921");
+        httpd_MsgAdd(answer, "Pragma", "no-cache");
+        httpd_MsgAdd(answer, "Pragma", "client-id=%lu",
+                      vlc_mrand48()&0x7fff);
+        httpd_MsgAdd(answer, "Pragma", "features=\"broadcast\"");
 
-            /* Check if there is a xPlayStrm=1 */
-            for (size_t i = 0; i < query->i_headers; i++)
-                if (!strcasecmp(query->p_headers[i].name,  "Pragma") &&
-                    strstr(query->p_headers[i].value, "xPlayStrm=1"))
-                    b_xplaystream = true;
+        /* Check if there is a xPlayStrm=1 */
+        for (size_t i = 0; i < query->i_headers; i++)
+            if (!strcasecmp(query->p_headers[i].name,  "Pragma") &&
+                strstr(query->p_headers[i].value, "xPlayStrm=1"))
+                b_xplaystream = true;
 
-            if (!b_xplaystream)
-                answer->i_body_offset = 0;
-        } else if (!b_has_content_type)
-            httpd_MsgAdd(answer, "Content-type", "%s", stream->psz_mime);
+        if (!b_xplaystream)
+            answer->i_body_offset = 0;
+    } else if (!b_has_content_type)
+        httpd_MsgAdd(answer, "Content-type", "%s", stream->psz_mime);
 
-        if (!b_has_cache_control)
-            httpd_MsgAdd(answer, "Cache-Control", "no-cache");
+    if (!b_has_cache_control)
+        httpd_MsgAdd(answer, "Cache-Control", "no-cache");
 
-        httpd_MsgAdd(answer, "Connection", "close");
+    httpd_MsgAdd(answer, "Connection", "close");
 
-        return VLC_SUCCESS;
-    }
+    return VLC_SUCCESS;
 }
 
 httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
@@ -757,7 +757,6 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
         return NULL;
 
     stream->psz_mime = NULL;
-    stream->p_buffer = NULL;
 
     stream->url = httpd_UrlNew(host, psz_url, psz_user, psz_password);
     if (!stream->url)
@@ -774,10 +773,8 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_header = 0;
     stream->p_header = NULL;
     stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
-
-    stream->p_buffer = malloc(stream->i_buffer_size);
-    if (stream->p_buffer == NULL)
-        goto error;
+    stream->i_chunks_size = 0;
+    vlc_list_init(&stream->chunks);
 
     /* We set to 1 to make life simpler
      * (this way i_body_offset can never be 0) */
@@ -824,22 +821,55 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+static void httpd_AppendData(httpd_stream_t *stream, const uint8_t *p_data,
+                             size_t i_data)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
+    struct httpd_stream_chunk *chunk =
+        vlc_list_last_entry_or_null(&stream->chunks,
+                                    struct httpd_stream_chunk, node);
+
+    while (i_data > 0) {
+        if (chunk == NULL || chunk->size == chunk->capacity) {
+            size_t capacity = __MAX(i_data, HTTPD_STREAM_CHUNK);
+
+            chunk = malloc(sizeof (*chunk) + capacity);
+            if (unlikely(chunk == NULL)) {
+                /* Data is lost, clients will skip over the gap */
+                stream->i_buffer_pos += i_data;
+                break;
+            }
 
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
+            atomic_init(&chunk->refs, 1);
+            chunk->pos = stream->i_buffer_pos;
+            chunk->size = 0;
+            chunk->capacity = capacity;
+            vlc_list_append(&chunk->node, &stream->chunks);
+        }
 
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
+        /* Clients only ever read below the size they saw under the lock,
+         * so the chunk can be filled in place. */
+        size_t i_copy = __MIN(i_data, chunk->capacity - chunk->size);
+
+        memcpy(&chunk->data[chunk->size], p_data, i_copy);
+        chunk->size += i_copy;
+        stream->i_chunks_size += i_copy;
+        stream->i_buffer_pos += i_copy;
+        p_data += i_copy;
+        i_data -= i_copy;
     }
 
-    stream->i_buffer_pos += i_data;
+    /* Drop the oldest chunks; clients still sending them hold a reference */
+    while (stream->i_chunks_size > stream->i_buffer_size) {
+        chunk = vlc_list_first_entry_or_null(&stream->chunks,
+                                             struct httpd_stream_chunk, node);
+        if (chunk == vlc_list_last_entry_or_null(&stream->chunks,
+                                           struct httpd_stream_chunk, node))
+            break;
+
+        vlc_list_remove(&chunk->node);
+        stream->i_chunks_size -= chunk->size;
+        httpd_ChunkRelease(chunk);
+    }
 }
 
 int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
@@ -865,22 +895,25 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
 
 void httpd_StreamDelete(httpd_stream_t *stream)
 {
+    struct httpd_stream_chunk *chunk;
+
     httpd_UrlDelete(stream->url);
     for (size_t i = 0; i < stream->i_http_headers; i++) {
         free(stream->p_http_headers[i].name);
         free(stream->p_http_headers[i].value);
     }
+    vlc_list_foreach(chunk, &stream->chunks, node)
+        httpd_ChunkRelease(chunk);
     free(stream->p_http_headers);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
     free(stream);
 }
 
 /*****************************************************************************
  * Low level
  *****************************************************************************/
-static void* httpd_HostThread(void *);
+static void* httpd_WorkerThread(void *);
 static httpd_host_t *httpd_HostCreate(vlc_object_t *, const char *,
                                       const char *, vlc_tls_server_t *,
                                       unsigned);
@@ -927,6 +960,77 @@ static struct httpd
     struct vlc_list hosts;
 } httpd = { VLC_STATIC_MUTEX, VLC_LIST_INITIALIZER(&httpd.hosts) };
 
+static void httpd_WorkerStop(struct httpd_worker *w)
+{
+    httpd_client_t *client;
+
+    vlc_cancel(w->thread);
+    vlc_join(w->thread, NULL);
+
+    vlc_list_foreach(client, &w->clients, node) {
+        msg_Warn(w->host, "client still connected");
+        httpd_ClientDestroy(client);
+    }
+
+    if (w->wakefd[0] != -1) {
+        net_Close(w->wakefd[0]);
+        net_Close(w->wakefd[1]);
+    }
+}
+
+static int httpd_WorkersStart(httpd_host_t *host, unsigned count)
+{
+    host->workers = vlc_alloc(count, sizeof (*host->workers));
+    if (unlikely(host->workers == NULL))
+        return VLC_ENOMEM;
+
+    for (unsigned i = 0; i < count; i++) {
+        struct httpd_worker *w = &host->workers[i];
+
+        w->host = host;
+        vlc_mutex_init(&w->lock);
+        w->client_count = 0;
+        vlc_list_init(&w->clients);
+        w->wakefd[0] = w->wakefd[1] = -1;
+    }
+
+    /* The accepting worker dispatches to the others: start it last, once
+     * the worker count is final. */
+    host->worker_count = 1;
+    host->next_worker = 0;
+
+    for (unsigned i = 1; i < count; i++) {
+        struct httpd_worker *w = &host->workers[i];
+
+        if (vlc_socketpair(PF_LOCAL, SOCK_STREAM, 0, w->wakefd, true)) {
+            msg_Warn(host, "cannot create HTTP worker: %s",
+                     vlc_strerror_c(errno));
+            break;
+        }
+
+        if (vlc_clone(&w->thread, httpd_WorkerThread, w,
+                      VLC_THREAD_PRIORITY_LOW)) {
+            net_Close(w->wakefd[0]);
+            net_Close(w->wakefd[1]);
+            msg_Warn(host, "cannot spawn HTTP worker thread");
+            break;
+        }
+        host->worker_count++;
+    }
+
+    if (vlc_clone(&host->workers[0].thread, httpd_WorkerThread,
+                  &host->workers[0], VLC_THREAD_PRIORITY_LOW)) {
+        for (unsigned i = 1; i < host->worker_count; i++)
+            httpd_WorkerStop(&host->workers[i]);
+        free(host->workers);
+        host->workers = NULL;
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg(host, "HTTP host served by %u thread(s)", host->worker_count);
+    return VLC_SUCCESS;
+}
+
 static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
                                        const char *hostvar,
                                        const char *portvar,
@@ -976,14 +1080,12 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     host->port     = port;
     vlc_list_init(&host->urls);
-    host->client_count = 0;
-    vlc_list_init(&host->clients);
     host->timeout_sec = timeout_sec;
     host->p_tls    = p_tls;
 
-    /* create the thread */
-    if (vlc_clone(&host->thread, httpd_HostThread, host,
-                   VLC_THREAD_PRIORITY_LOW)) {
+    /* create the threads */
+    int64_t threads = var_InheritInteger(p_this, "httpd-threads");
+    if (httpd_WorkersStart(host, __MAX(threads, 1))) {
         msg_Err(p_this, "cannot spawn http host thread");
         goto error;
     }
@@ -1009,8 +1111,6 @@ error:
 /* delete a host */
 void httpd_HostDelete(httpd_host_t *host)
 {
-    httpd_client_t *client;
-
     vlc_mutex_lock(&httpd.mutex);
 
     if (atomic_fetch_sub_explicit(&host->ref, 1, memory_order_relaxed) > 1) {
@@ -1021,15 +1121,13 @@ void httpd_HostDelete(httpd_host_t *host)
     }
 
     vlc_list_remove(&host->node);
-    vlc_cancel(host->thread);
-    vlc_join(host->thread, NULL);
 
-    msg_Dbg(host, "HTTP host removed");
+    /* stop the accepting worker first, so that no client gets dispatched */
+    for (unsigned i = 0; i < host->worker_count; i++)
+        httpd_WorkerStop(&host->workers[i]);
+    free(host->workers);
 
-    vlc_list_foreach(client, &host->clients, node) {
-        msg_Warn(host, "client still connected");
-        httpd_ClientDestroy(client);
-    }
+    msg_Dbg(host, "HTTP host removed");
 
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
@@ -1118,22 +1216,30 @@ void httpd_UrlDelete(httpd_url_t *url)
 
     vlc_mutex_lock(&host->lock);
     vlc_list_remove(&url->node);
+    vlc_mutex_unlock(&host->lock);
 
-    free(url->psz_url);
-    free(url->psz_user);
-    free(url->psz_password);
+    /* Once removed from the list, the url can only be reached through
+     * clients, which each worker only touches with its lock held. */
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *w = &host->workers[i];
 
-    vlc_list_foreach(client, &host->clients, node) {
-        if (client->url != url)
-            continue;
+        vlc_mutex_lock(&w->lock);
+        vlc_list_foreach(client, &w->clients, node) {
+            if (client->url != url)
+                continue;
 
-        /* TODO complete it */
-        msg_Warn(host, "force closing connections");
-        host->client_count--;
-        httpd_ClientDestroy(client);
+            /* TODO complete it */
+            msg_Warn(host, "force closing connections");
+            w->client_count--;
+            httpd_ClientDestroy(client);
+        }
+        vlc_mutex_unlock(&w->lock);
     }
+
+    free(url->psz_url);
+    free(url->psz_user);
+    free(url->psz_password);
     free(url);
-    vlc_mutex_unlock(&host->lock);
 }
 
 static void httpd_MsgInit(httpd_message_t *msg)
@@ -1239,7 +1345,7 @@ static httpd_client_t *httpd_ClientNew(vlc_tls_t *sock)
     cl->i_buffer = 0;
     cl->p_buffer = xmalloc(cl->i_buffer_size);
     cl->i_keyframe_wait_to_pass = -1;
-    cl->b_stream_mode = false;
+    cl->stream = NULL;
 
     httpd_MsgInit(&cl->query);
     httpd_MsgInit(&cl->answer);
@@ -1624,16 +1730,31 @@ static int httpd_ClientSend(httpd_client_t *cl)
     cl->i_buffer += i_len;
 
     if (cl->i_buffer >= cl->i_buffer_size) {
+        if (cl->stream != NULL
+         && cl->answer.i_body == 0 && cl->answer.i_body_offset > 0) {
+            /* answer sent, now send the stream data */
+            free(cl->p_buffer);
+            cl->p_buffer = NULL;
+            cl->i_buffer = 0;
+            cl->i_buffer_size = 0;
+
+            cl->i_state = HTTPD_CLIENT_STREAMING;
+            return 0;
+        }
+
         if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
             /* catch more body data */
+            httpd_host_t *host = cl->url->host;
             int     i_msg = cl->query.i_type;
             int64_t i_offset = cl->answer.i_body_offset;
 
             httpd_MsgClean(&cl->answer);
             cl->answer.i_body_offset = i_offset;
 
+            vlc_mutex_lock(&host->lock);
             cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
                                      &cl->answer, &cl->query);
+            vlc_mutex_unlock(&host->lock);
         }
 
         if (cl->answer.i_body > 0) {
@@ -1651,6 +1772,105 @@ static int httpd_ClientSend(httpd_client_t *cl)
     return 0;
 }
 
+/* Sends stream data straight from the shared chunks.
+ * Returns 0 on progress, -1 if the socket is full, 1 if no data is ready. */
+static int httpd_ClientStream(httpd_client_t *cl)
+{
+    httpd_stream_t *stream = cl->stream;
+    struct httpd_stream_chunk *chunks[HTTPD_STREAM_IOV], *chunk;
+    struct iovec iov[HTTPD_STREAM_IOV];
+    unsigned count = 0;
+    int64_t i_offset = cl->answer.i_body_offset;
+
+    vlc_mutex_lock(&stream->lock);
+    if (i_offset >= stream->i_buffer_pos)
+        goto wait; /* no data available */
+
+    if (cl->i_keyframe_wait_to_pass >= 0) {
+        if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
+            /* still waiting for the next keyframe */
+            goto wait;
+
+        /* seek to the new keyframe */
+        i_offset = stream->i_last_keyframe_seen_pos;
+        cl->i_keyframe_wait_to_pass = -1;
+    }
+
+    chunk = vlc_list_first_entry_or_null(&stream->chunks,
+                                         struct httpd_stream_chunk, node);
+    if (chunk == NULL)
+        goto wait;
+    if (i_offset < chunk->pos)
+        i_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
+
+    /* most clients are close to the live edge: search from the end */
+    chunk = vlc_list_last_entry_or_null(&stream->chunks,
+                                        struct httpd_stream_chunk, node);
+    while (chunk->pos > i_offset) {
+        struct httpd_stream_chunk *prev =
+            vlc_list_prev_entry_or_null(&stream->chunks, chunk,
+                                        struct httpd_stream_chunk, node);
+        if (prev == NULL)
+            break;
+        chunk = prev;
+    }
+
+    int64_t i_end = i_offset;
+    while (chunk != NULL && count < HTTPD_STREAM_IOV) {
+        if (i_end < chunk->pos) {
+            /* data was lost, skip the gap */
+            if (count > 0)
+                break;
+            i_offset = i_end = chunk->pos;
+        }
+
+        size_t i_skip = i_end - chunk->pos;
+        if (i_skip < chunk->size) {
+            atomic_fetch_add_explicit(&chunk->refs, 1, memory_order_relaxed);
+            chunks[count] = chunk;
+            iov[count].iov_base = &chunk->data[i_skip];
+            iov[count].iov_len = chunk->size - i_skip;
+            count++;
+            i_end = chunk->pos + chunk->size;
+        }
+
+        chunk = vlc_list_next_entry_or_null(&stream->chunks, chunk,
+                                            struct httpd_stream_chunk, node);
+    }
+    vlc_mutex_unlock(&stream->lock);
+
+    cl->answer.i_body_offset = i_offset;
+    if (count == 0)
+        return 1;
+
+    vlc_tls_t *sock = cl->sock;
+    ssize_t i_len = sock->ops->writev(sock, iov, count);
+
+    for (unsigned i = 0; i < count; i++)
+        httpd_ChunkRelease(chunks[i]);
+
+    if (i_len < 0) {
+#if defined(_WIN32)
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+        if (errno == EAGAIN)
+#endif
+            return -1;
+
+        /* Connection failed, or hung up (EPIPE) */
+        cl->i_state = HTTPD_CLIENT_DEAD;
+        return 0;
+    }
+
+    cl->answer.i_body_offset += i_len;
+    return 0;
+
+wait:
+    vlc_mutex_unlock(&stream->lock);
+    cl->answer.i_body_offset = i_offset;
+    return 1;
+}
+
 static void httpd_ClientTlsHandshake(httpd_host_t *host, httpd_client_t *cl)
 {
     switch (vlc_tls_SessionHandshake(host->p_tls, cl->sock))
@@ -1702,24 +1922,47 @@ auth_failed:
     return false;
 }
 
-static void httpdLoop(httpd_host_t *host)
+static void httpd_WorkerAdd(struct httpd_worker *w, httpd_client_t *cl)
+{
+    vlc_mutex_lock(&w->lock);
+    w->client_count++;
+    vlc_list_append(&cl->node, &w->clients);
+    vlc_mutex_unlock(&w->lock);
+
+    if (w->wakefd[1] != -1)
+        vlc_send(w->wakefd[1], &(char){ 0 }, 1, 0);
+}
+
+static void httpdLoop(struct httpd_worker *w)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
+    httpd_host_t *host = w->host;
+    /* only the first worker listens */
+    const unsigned nlisten = (w == host->workers) ? host->nfd : 0;
+
+    int canc = vlc_savecancel();
+    vlc_mutex_lock(&w->lock);
+
+    struct pollfd ufd[nlisten + 1 + w->client_count];
     unsigned nfd;
-    for (nfd = 0; nfd < host->nfd; nfd++) {
+    for (nfd = 0; nfd < nlisten; nfd++) {
         ufd[nfd].fd = host->fds[nfd];
         ufd[nfd].events = POLLIN;
         ufd[nfd].revents = 0;
     }
+    if (w->wakefd[0] != -1) {
+        ufd[nfd].fd = w->wakefd[0];
+        ufd[nfd].events = POLLIN;
+        ufd[nfd].revents = 0;
+        nfd++;
+    }
+    const unsigned nserv = nfd;
 
-    vlc_mutex_lock(&host->lock);
     /* add all socket that should be read/write and close dead connection */
     vlc_tick_t now = vlc_tick_now();
     int delay = -1;
     httpd_client_t *cl;
 
-    int canc = vlc_savecancel();
-    vlc_list_foreach(cl, &host->clients, node) {
+    vlc_list_foreach(cl, &w->clients, node) {
         int val = -1;
 
         switch (cl->i_state) {
@@ -1729,6 +1972,9 @@ static void httpdLoop(httpd_host_t *host)
             case HTTPD_CLIENT_SENDING:
                 val = httpd_ClientSend(cl);
                 break;
+            case HTTPD_CLIENT_STREAMING:
+                val = httpd_ClientStream(cl);
+                break;
             case HTTPD_CLIENT_TLS_HS_IN:
             case HTTPD_CLIENT_TLS_HS_OUT:
                 httpd_ClientTlsHandshake(host, cl);
@@ -1737,7 +1983,7 @@ static void httpdLoop(httpd_host_t *host)
 
         if (cl->i_state == HTTPD_CLIENT_DEAD
          || (host->timeout_sec > 0 && cl->i_timeout_date < now)) {
-            host->client_count--;
+            w->client_count--;
             httpd_ClientDestroy(cl);
             continue;
         }
@@ -1763,6 +2009,11 @@ static void httpdLoop(httpd_host_t *host)
                 pufd->events = POLLOUT;
                 break;
 
+            case HTTPD_CLIENT_STREAMING:
+                if (val < 0)
+                    pufd->events = POLLOUT;
+                break;
+
             case HTTPD_CLIENT_RECEIVE_DONE: {
                 httpd_message_t *answer = &cl->answer;
                 httpd_message_t *query  = &cl->query;
@@ -1849,6 +2100,7 @@ static void httpdLoop(httpd_host_t *host)
                         bool b_auth_failed = false;
 
                         /* Search the url and trigger callbacks */
+                        vlc_mutex_lock(&host->lock);
                         vlc_list_foreach(url, &host->urls, node) {
                             if (strcmp(url->psz_url, query->psz_url))
                                 continue;
@@ -1876,6 +2128,7 @@ static void httpdLoop(httpd_host_t *host)
                             if (!cl->url)
                                 cl->url = url;
                         }
+                        vlc_mutex_unlock(&host->lock);
 
                         if (answer) {
                             answer->i_proto  = query->i_proto;
@@ -1907,68 +2160,37 @@ static void httpdLoop(httpd_host_t *host)
                 break;
             }
 
-            case HTTPD_CLIENT_SEND_DONE:
-                if (!cl->b_stream_mode || cl->answer.i_body_offset == 0) {
-                    bool do_close = false;
+            case HTTPD_CLIENT_SEND_DONE: {
+                bool do_close = false;
 
-                    cl->url = NULL;
+                cl->url = NULL;
+                cl->stream = NULL;
 
-                    if (cl->query.i_proto != HTTPD_PROTO_HTTP
-                     || cl->query.i_version > 0)
-                    {
-                        const char *psz_connection = httpd_MsgGet(&cl->answer,
-                                                                 "Connection");
-                        if (psz_connection != NULL)
-                            do_close = !strcasecmp(psz_connection, "close");
-                    }
-                    else
-                        do_close = true;
-
-                    if (!do_close) {
-                        httpd_MsgClean(&cl->query);
-                        httpd_MsgInit(&cl->query);
-
-                        cl->i_buffer = 0;
-                        cl->i_buffer_size = 1000;
-                        free(cl->p_buffer);
-                        // Allocate an extra byte for the null terminating byte
-                        cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
-                        cl->i_state = HTTPD_CLIENT_RECEIVING;
-                    } else
-                        cl->i_state = HTTPD_CLIENT_DEAD;
-                    httpd_MsgClean(&cl->answer);
-                } else {
-                    int64_t i_offset = cl->answer.i_body_offset;
-                    httpd_MsgClean(&cl->answer);
+                if (cl->query.i_proto != HTTPD_PROTO_HTTP
+                 || cl->query.i_version > 0)
+                {
+                    const char *psz_connection = httpd_MsgGet(&cl->answer,
+                                                             "Connection");
+                    if (psz_connection != NULL)
+                        do_close = !strcasecmp(psz_connection, "close");
+                }
+                else
+                    do_close = true;
 
-                    cl->answer.i_body_offset = i_offset;
-                    free(cl->p_buffer);
-                    cl->p_buffer = NULL;
-                    cl->i_buffer = 0;
-                    cl->i_buffer_size = 0;
+                if (!do_close) {
+                    httpd_MsgClean(&cl->query);
+                    httpd_MsgInit(&cl->query);
 
-                    cl->i_state = HTTPD_CLIENT_WAITING;
-                }
+                    cl->i_buffer = 0;
+                    cl->i_buffer_size = 1000;
+                    free(cl->p_buffer);
+                    // Allocate an extra byte for the null terminating byte
+                    cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
+                    cl->i_state = HTTPD_CLIENT_RECEIVING;
+                } else
+                    cl->i_state = HTTPD_CLIENT_DEAD;
+                httpd_MsgClean(&cl->answer);
                 break;
-
-            case HTTPD_CLIENT_WAITING: {
-                int64_t i_offset = cl->answer.i_body_offset;
-                int i_msg = cl->query.i_type;
-
-                httpd_MsgInit(&cl->answer);
-                cl->answer.i_body_offset = i_offset;
-
-                cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
-                        &cl->answer, &cl->query);
-                if (cl->answer.i_type != HTTPD_MSG_NONE) {
-                    /* we have new data, so re-enter send mode */
-                    cl->i_buffer      = 0;
-                    cl->p_buffer      = cl->answer.p_body;
-                    cl->i_buffer_size = cl->answer.i_body;
-                    cl->answer.p_body = NULL;
-                    cl->answer.i_body = 0;
-                    cl->i_state = HTTPD_CLIENT_SENDING;
-                }
             }
         }
 
@@ -1976,11 +2198,11 @@ static void httpdLoop(httpd_host_t *host)
 
         if (pufd->events != 0)
             nfd++;
-        /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
+        /* we will wait 20ms (not too big) if HTTPD_CLIENT_STREAMING */
         else if (delay != 0)
             delay = 20;
     }
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&w->lock);
     vlc_restorecancel(canc);
 
     while (poll(ufd, nfd, delay) < 0)
@@ -1990,14 +2212,18 @@ static void httpdLoop(httpd_host_t *host)
     }
 
     canc = vlc_savecancel();
-    vlc_mutex_lock(&host->lock);
 
-    /* Handle client sockets */
+    /* Drain the wake-up socket, new clients are already in the list */
+    if (nlisten < nserv && ufd[nlisten].revents != 0) {
+        char buf[64];
+
+        while (recv(w->wakefd[0], buf, sizeof (buf), 0) > 0);
+    }
+
     now = vlc_tick_now();
-    nfd = host->nfd;
 
     /* Handle server sockets (accept new connections) */
-    for (nfd = 0; nfd < host->nfd; nfd++) {
+    for (nfd = 0; nfd < nlisten; nfd++) {
         int fd = ufd[nfd].fd;
 
         assert (fd == host->fds[nfd]);
@@ -2045,20 +2271,21 @@ static void httpdLoop(httpd_host_t *host)
             cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
 
         cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
-        host->client_count++;
-        vlc_list_append(&cl->node, &host->clients);
+
+        /* spread the connections over the workers */
+        httpd_WorkerAdd(&host->workers[host->next_worker], cl);
+        host->next_worker = (host->next_worker + 1) % host->worker_count;
     }
 
-    vlc_mutex_unlock(&host->lock);
     vlc_restorecancel(canc);
 }
 
-static void* httpd_HostThread(void *data)
+static void* httpd_WorkerThread(void *data)
 {
-    httpd_host_t *host = data;
+    struct httpd_worker *w = data;
 
-    while (atomic_load_explicit(&host->ref, memory_order_relaxed) > 0)
-        httpdLoop(host);
+    while (atomic_load_explicit(&w->host->ref, memory_order_relaxed) > 0)
+        httpdLoop(w);
     return NULL;
 }
 
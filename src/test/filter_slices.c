@@ -0,0 +1,141 @@
+/*****************************************************************************
+ * src/test/filter_slices.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_filter.h>
+
+#define MAX_LINES 1080
+
+struct data
+{
+    unsigned lines;
+    unsigned align;
+    atomic_uint slices;
+    atomic_uint hits[MAX_LINES];
+};
+
+static void InitData(struct data *data, unsigned lines, unsigned align)
+{
+    assert(lines <= MAX_LINES);
+    data->lines = lines;
+    data->align = align;
+    atomic_init(&data->slices, 0);
+    for (unsigned i = 0; i < MAX_LINES; i++)
+        atomic_init(&data->hits[i], 0);
+}
+
+static void Slice(void *opaque, unsigned first, unsigned last)
+{
+    struct data *data = opaque;
+
+    assert(first < last);
+    assert(last <= data->lines);
+    /* Only the end of the last slice may be unaligned */
+    assert(first % data->align == 0);
+    assert(last == data->lines || last % data->align == 0);
+
+    atomic_fetch_add(&data->slices, 1);
+    for (unsigned i = first; i < last; i++)
+        atomic_fetch_add(&data->hits[i], 1);
+}
+
+static unsigned Check(vlc_filter_slices_t *slices, unsigned lines,
+                      unsigned align)
+{
+    struct data data;
+
+    InitData(&data, lines, align);
+    vlc_filter_slices_Run(slices, lines, align, Slice, &data);
+
+    for (unsigned i = 0; i < MAX_LINES; i++)
+        assert(atomic_load(&data.hits[i]) == (i < lines ? 1u : 0u));
+    return atomic_load(&data.slices);
+}
+
+static void test_inline(void)
+{
+    /* Without context, everything runs in a single call */
+    assert(Check(NULL, 720, 2) == 1);
+
+    vlc_filter_slices_t *slices = vlc_filter_slices_New(1);
+    assert(slices);
+    assert(Check(slices, 1080, 4) == 1);
+    vlc_filter_slices_Delete(slices);
+
+    /* Too few lines to be split */
+    slices = vlc_filter_slices_New(8);
+    assert(slices);
+    assert(Check(slices, 15, 1) == 1);
+    vlc_filter_slices_Delete(slices);
+}
+
+static void test_split(void)
+{
+    vlc_filter_slices_t *slices = vlc_filter_slices_New(4);
+    assert(slices);
+
+    assert(Check(slices, 1080, 1) == 4);
+    assert(Check(slices, 1080, 2) == 4);
+    assert(Check(slices, 577, 2) >= 2);
+    assert(Check(slices, 100, 16) >= 2);
+    /* The alignment is larger than half the picture */
+    assert(Check(slices, 40, 32) >= 1);
+
+    for (unsigned i = 0; i < 100; i++)
+        Check(slices, 1 + i * 10, 1 + i % 4);
+
+    vlc_filter_slices_Delete(slices);
+}
+
+static void test_shared_pool(void)
+{
+    vlc_filter_slices_t *a = vlc_filter_slices_New(3);
+    vlc_filter_slices_t *b = vlc_filter_slices_New(0);
+    assert(a && b);
+
+    Check(a, 480, 2);
+    Check(b, 480, 2);
+    vlc_filter_slices_Delete(a);
+    Check(b, 1080, 2);
+    vlc_filter_slices_Delete(b);
+
+    /* The pool is recreated on demand */
+    a = vlc_filter_slices_New(2);
+    assert(a);
+    assert(Check(a, 1080, 2) == 2);
+    vlc_filter_slices_Delete(a);
+}
+
+int main(void)
+{
+    test_inline();
+    test_split();
+    test_shared_pool();
+    return 0;
+}
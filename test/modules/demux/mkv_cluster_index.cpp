@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * mkv_cluster_index.cpp: MKV cluster index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+
+#include "../../../modules/demux/mkv/cluster_index_file.hpp"
+
+#undef NDEBUG
+#include <cassert>
+#include <cstring>
+
+using namespace mkv;
+
+static void CheckVint( const uint8_t *p, size_t i_size, bool b_id,
+                       size_t i_len, uint64_t i_value, bool b_unknown )
+{
+    uint64_t i_read = ~UINT64_C(0);
+    bool b_read_unknown = !b_unknown;
+    assert( ReadVint( p, i_size, i_read, b_id, &b_read_unknown ) == i_len );
+    if( i_len == 0 )
+        return;
+    assert( i_read == i_value );
+    assert( b_read_unknown == b_unknown );
+}
+
+static void TestVint( void )
+{
+    /* sizes: the length marker is dropped */
+    static const uint8_t size1[] = { 0x81 };
+    CheckVint( size1, 1, false, 1, 1, false );
+    static const uint8_t size2[] = { 0x40, 0x02 };
+    CheckVint( size2, 2, false, 2, 2, false );
+    static const uint8_t size8[] = { 0x01, 0x00, 0x00, 0x00, 0x12, 0x34, 0x56, 0x78 };
+    CheckVint( size8, 8, false, 8, 0x12345678, false );
+
+    /* all value bits set means unknown size */
+    static const uint8_t unknown1[] = { 0xFF };
+    CheckVint( unknown1, 1, false, 1, 0x7F, true );
+    static const uint8_t unknown8[] = { 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    CheckVint( unknown8, 8, false, 8, UINT64_C(0xFFFFFFFFFFFFFF), true );
+
+    /* IDs keep the marker, and are at most 4 bytes */
+    static const uint8_t cluster[] = { 0x1F, 0x43, 0xB6, 0x75, 0x01 };
+    CheckVint( cluster, sizeof(cluster), true, 4, 0x1F43B675, false );
+    static const uint8_t timecode[] = { 0xE7 };
+    CheckVint( timecode, 1, true, 1, 0xE7, false );
+    CheckVint( size8, 8, true, 0, 0, false );
+
+    /* truncated, or no length marker in the first byte */
+    CheckVint( cluster, 3, true, 0, 0, false );
+    CheckVint( size8, 7, false, 0, 0, false );
+    static const uint8_t zero[] = { 0x00, 0x81 };
+    CheckVint( zero, 2, false, 0, 0, false );
+    CheckVint( size1, 0, false, 0, 0, false );
+}
+
+static ClusterIndexFile MakeIndex( void )
+{
+    ClusterIndexFile index;
+    index.i_file_size = 1000000;
+    for( size_t i = 0; i < sizeof(index.segment_uid); i++ )
+        index.segment_uid[i] = i * 17;
+    index.i_first_cluster = 4096;
+    index.i_timescale = 1000000;
+    index.i_resume_pos = 900000;
+    for( unsigned i = 0; i < 200; i++ )
+    {
+        ClusterIndexFile::Entry entry = {
+            index.i_first_cluster + i * 4000, 4000,
+            VLC_TICK_FROM_MS( i * 2000 )
+        };
+        index.entries.push_back( entry );
+    }
+    return index;
+}
+
+static void TestRoundTrip( void )
+{
+    const ClusterIndexFile index = MakeIndex();
+
+    FILE *p_file = tmpfile();
+    assert( p_file );
+    assert( index.Write( p_file ) );
+
+    /* made for a larger file */
+    ClusterIndexFile loaded;
+    rewind( p_file );
+    assert( !loaded.Read( p_file, index.i_file_size - 1 ) );
+
+    rewind( p_file );
+    assert( loaded.Read( p_file, index.i_file_size ) );
+    assert( loaded.i_file_size == index.i_file_size );
+    assert( !memcmp( loaded.segment_uid, index.segment_uid,
+                     sizeof(index.segment_uid) ) );
+    assert( loaded.i_first_cluster == index.i_first_cluster );
+    assert( loaded.i_timescale == index.i_timescale );
+    assert( loaded.i_resume_pos == index.i_resume_pos );
+    assert( loaded.entries.size() == index.entries.size() );
+    for( size_t i = 0; i < index.entries.size(); i++ )
+    {
+        assert( loaded.entries[i].fpos == index.entries[i].fpos );
+        assert( loaded.entries[i].size == index.entries[i].size );
+        assert( loaded.entries[i].pts == index.entries[i].pts );
+    }
+
+    /* the file grew since */
+    rewind( p_file );
+    assert( loaded.Read( p_file, index.i_file_size * 2 ) );
+    assert( loaded.i_file_size == index.i_file_size );
+
+    /* truncated */
+    long i_length = ftell( p_file );
+    assert( i_length > 0 );
+    FILE *p_short = tmpfile();
+    assert( p_short );
+    rewind( p_file );
+    for( long i = 0; i < i_length - 1; i++ )
+        fputc( fgetc( p_file ), p_short );
+    rewind( p_short );
+    assert( !loaded.Read( p_short, index.i_file_size ) );
+    fclose( p_short );
+    fclose( p_file );
+}
+
+static void TestInvalid( void )
+{
+    /* not in position order */
+    ClusterIndexFile index = MakeIndex();
+    std::swap( index.entries[10], index.entries[11] );
+    FILE *p_file = tmpfile();
+    assert( p_file );
+    assert( index.Write( p_file ) );
+    rewind( p_file );
+    ClusterIndexFile loaded;
+    assert( !loaded.Read( p_file, index.i_file_size ) );
+    fclose( p_file );
+
+    /* cluster before the first one */
+    index = MakeIndex();
+    index.entries[0].fpos = index.i_first_cluster - 1;
+    p_file = tmpfile();
+    assert( p_file );
+    assert( index.Write( p_file ) );
+    rewind( p_file );
+    assert( !loaded.Read( p_file, index.i_file_size ) );
+    fclose( p_file );
+
+    /* cluster beyond the end of the file */
+    index = MakeIndex();
+    index.entries.back().fpos = index.i_file_size;
+    p_file = tmpfile();
+    assert( p_file );
+    assert( index.Write( p_file ) );
+    rewind( p_file );
+    assert( !loaded.Read( p_file, index.i_file_size ) );
+    fclose( p_file );
+
+    /* bad magic */
+    p_file = tmpfile();
+    assert( p_file );
+    assert( MakeIndex().Write( p_file ) );
+    rewind( p_file );
+    fputc( 'X', p_file );
+    rewind( p_file );
+    assert( !loaded.Read( p_file, index.i_file_size ) );
+    fclose( p_file );
+}
+
+int main(void)
+{
+    TestVint();
+    TestRoundTrip();
+    TestInvalid();
+    return 0;
+}
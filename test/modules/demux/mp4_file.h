@@ -0,0 +1,275 @@
+/*****************************************************************************
+ * mp4_file.h: synthetic MP4 files for the mp4 demuxer tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Video tracks of 25 fps samples with B-frames like composition offsets and
+ * a sync sample every GOP_SAMPLES. The chunks of the tracks are interleaved
+ * in the mdat, and the moov comes last. */
+
+#define TIMESCALE       1000
+#define SAMPLE_DELTA    40 /* 25 fps */
+#define GOP_SAMPLES     50
+
+typedef struct
+{
+    uint8_t *p;
+    size_t   i_size;
+    size_t   i_alloc;
+} buffer_t;
+
+static void Put( buffer_t *b, const void *p_data, size_t i_data )
+{
+    if( b->i_size + i_data > b->i_alloc )
+    {
+        b->i_alloc = ( b->i_size + i_data ) * 2;
+        b->p = realloc( b->p, b->i_alloc );
+        assert( b->p );
+    }
+    if( p_data )
+        memcpy( &b->p[b->i_size], p_data, i_data );
+    else
+        memset( &b->p[b->i_size], 0, i_data );
+    b->i_size += i_data;
+}
+
+static void Put16( buffer_t *b, uint16_t i ) { uint8_t d[2]; SetWBE( d, i ); Put( b, d, 2 ); }
+static void Put32( buffer_t *b, uint32_t i ) { uint8_t d[4]; SetDWBE( d, i ); Put( b, d, 4 ); }
+
+static size_t BoxStart( buffer_t *b, const char *psz_type )
+{
+    size_t i_pos = b->i_size;
+    Put32( b, 0 );
+    Put( b, psz_type, 4 );
+    return i_pos;
+}
+
+static size_t FullBoxStart( buffer_t *b, const char *psz_type, uint32_t i_flags )
+{
+    size_t i_pos = BoxStart( b, psz_type );
+    Put32( b, i_flags ); /* version 0 */
+    return i_pos;
+}
+
+static void BoxEnd( buffer_t *b, size_t i_pos )
+{
+    SetDWBE( &b->p[i_pos], b->i_size - i_pos );
+}
+
+static uint32_t SampleSize( uint32_t i )
+{
+    return 16 + i % 16;
+}
+
+/* B-frames like composition offsets */
+static uint32_t SampleOffset( uint32_t i )
+{
+    return ( i % 3 == 0 ) ? 2 * SAMPLE_DELTA : 0;
+}
+
+static const uint32_t matrix[9] = { 0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000 };
+
+static void WriteStbl( buffer_t *b, uint32_t i_samples, uint32_t i_chunk_samples,
+                       const uint32_t *pi_chunk_offsets )
+{
+    size_t stbl = BoxStart( b, "stbl" );
+
+    size_t stsd = FullBoxStart( b, "stsd", 0 );
+    Put32( b, 1 );
+    size_t jpeg = BoxStart( b, "jpeg" );
+    Put( b, NULL, 6 );
+    Put16( b, 1 );          /* data reference index */
+    Put( b, NULL, 16 );
+    Put16( b, 320 );
+    Put16( b, 240 );
+    Put32( b, 0x00480000 ); /* 72 dpi */
+    Put32( b, 0x00480000 );
+    Put32( b, 0 );
+    Put16( b, 1 );          /* frame count */
+    Put( b, NULL, 32 );     /* compressor name */
+    Put16( b, 24 );
+    Put16( b, 0xFFFF );
+    BoxEnd( b, jpeg );
+    BoxEnd( b, stsd );
+
+    size_t stts = FullBoxStart( b, "stts", 0 );
+    Put32( b, 1 );
+    Put32( b, i_samples );
+    Put32( b, SAMPLE_DELTA );
+    BoxEnd( b, stts );
+
+    size_t ctts = FullBoxStart( b, "ctts", 0 );
+    size_t i_count_pos = b->i_size;
+    uint32_t i_entries = 0;
+    Put32( b, 0 );
+    for( uint32_t i = 0; i < i_samples; )
+    {
+        uint32_t i_run = 1;
+        while( i + i_run < i_samples &&
+               SampleOffset( i + i_run ) == SampleOffset( i ) )
+            i_run++;
+        Put32( b, i_run );
+        Put32( b, SampleOffset( i ) );
+        i += i_run;
+        i_entries++;
+    }
+    SetDWBE( &b->p[i_count_pos], i_entries );
+    BoxEnd( b, ctts );
+
+    size_t stss = FullBoxStart( b, "stss", 0 );
+    Put32( b, ( i_samples + GOP_SAMPLES - 1 ) / GOP_SAMPLES );
+    for( uint32_t i = 0; i < i_samples; i += GOP_SAMPLES )
+        Put32( b, i + 1 );
+    BoxEnd( b, stss );
+
+    size_t stsc = FullBoxStart( b, "stsc", 0 );
+    Put32( b, 1 );
+    Put32( b, 1 );
+    Put32( b, i_chunk_samples );
+    Put32( b, 1 );
+    BoxEnd( b, stsc );
+
+    size_t stsz = FullBoxStart( b, "stsz", 0 );
+    Put32( b, 0 );
+    Put32( b, i_samples );
+    for( uint32_t i = 0; i < i_samples; i++ )
+        Put32( b, SampleSize( i ) );
+    BoxEnd( b, stsz );
+
+    const uint32_t i_chunks = i_samples / i_chunk_samples;
+    size_t stco = FullBoxStart( b, "stco", 0 );
+    Put32( b, i_chunks );
+    for( uint32_t i = 0; i < i_chunks; i++ )
+        Put32( b, pi_chunk_offsets[i] );
+    BoxEnd( b, stco );
+
+    BoxEnd( b, stbl );
+}
+
+static void WriteTrak( buffer_t *b, unsigned i_track_id, uint32_t i_samples,
+                       uint32_t i_chunk_samples, const uint32_t *pi_chunk_offsets )
+{
+    const uint32_t i_duration = i_samples * SAMPLE_DELTA;
+
+    size_t trak = BoxStart( b, "trak" );
+
+    size_t tkhd = FullBoxStart( b, "tkhd", 0x7 ); /* enabled, in movie */
+    Put32( b, 0 );
+    Put32( b, 0 );
+    Put32( b, i_track_id );
+    Put32( b, 0 );
+    Put32( b, i_duration );
+    Put( b, NULL, 8 );
+    Put16( b, 0 );
+    Put16( b, 0 );
+    Put16( b, 0 );
+    Put16( b, 0 );
+    for( int i = 0; i < 9; i++ )
+        Put32( b, matrix[i] );
+    Put32( b, 320 << 16 );
+    Put32( b, 240 << 16 );
+    BoxEnd( b, tkhd );
+
+    size_t mdia = BoxStart( b, "mdia" );
+
+    size_t mdhd = FullBoxStart( b, "mdhd", 0 );
+    Put32( b, 0 );
+    Put32( b, 0 );
+    Put32( b, TIMESCALE );
+    Put32( b, i_duration );
+    Put16( b, 0x55C4 );     /* und */
+    Put16( b, 0 );
+    BoxEnd( b, mdhd );
+
+    size_t hdlr = FullBoxStart( b, "hdlr", 0 );
+    Put32( b, 0 );
+    Put( b, "vide", 4 );
+    Put( b, NULL, 12 );
+    Put( b, NULL, 1 );      /* empty name */
+    BoxEnd( b, hdlr );
+
+    size_t minf = BoxStart( b, "minf" );
+
+    size_t vmhd = FullBoxStart( b, "vmhd", 1 );
+    Put( b, NULL, 8 );
+    BoxEnd( b, vmhd );
+
+    size_t dinf = BoxStart( b, "dinf" );
+    size_t dref = FullBoxStart( b, "dref", 0 );
+    Put32( b, 1 );
+    size_t url = FullBoxStart( b, "url ", 1 ); /* self contained */
+    BoxEnd( b, url );
+    BoxEnd( b, dref );
+    BoxEnd( b, dinf );
+
+    WriteStbl( b, i_samples, i_chunk_samples, pi_chunk_offsets );
+
+    BoxEnd( b, minf );
+    BoxEnd( b, mdia );
+    BoxEnd( b, trak );
+}
+
+/* i_samples must be a multiple of i_chunk_samples */
+static void WriteFile( buffer_t *b, unsigned i_tracks, uint32_t i_samples,
+                       uint32_t i_chunk_samples )
+{
+    const uint32_t i_chunks = i_samples / i_chunk_samples;
+    uint32_t *pi_offsets = malloc( sizeof(*pi_offsets) * i_tracks * i_chunks );
+    assert( pi_offsets );
+
+    size_t ftyp = BoxStart( b, "ftyp" );
+    Put( b, "isom", 4 );
+    Put32( b, 0 );
+    Put( b, "isom", 4 );
+    BoxEnd( b, ftyp );
+
+    size_t mdat = BoxStart( b, "mdat" );
+    for( uint32_t i_chunk = 0; i_chunk < i_chunks; i_chunk++ )
+    {
+        for( unsigned i_track = 0; i_track < i_tracks; i_track++ )
+        {
+            pi_offsets[i_track * i_chunks + i_chunk] = b->i_size;
+            for( uint32_t i = 0; i < i_chunk_samples; i++ )
+                Put( b, NULL, SampleSize( i_chunk * i_chunk_samples + i ) );
+        }
+    }
+    BoxEnd( b, mdat );
+
+    size_t moov = BoxStart( b, "moov" );
+
+    size_t mvhd = FullBoxStart( b, "mvhd", 0 );
+    Put32( b, 0 );
+    Put32( b, 0 );
+    Put32( b, TIMESCALE );
+    Put32( b, i_samples * SAMPLE_DELTA );
+    Put32( b, 0x00010000 ); /* rate */
+    Put16( b, 0x0100 );     /* volume */
+    Put( b, NULL, 10 );
+    for( int i = 0; i < 9; i++ )
+        Put32( b, matrix[i] );
+    Put( b, NULL, 24 );
+    Put32( b, i_tracks + 1 ); /* next track ID */
+    BoxEnd( b, mvhd );
+
+    for( unsigned i_track = 0; i_track < i_tracks; i_track++ )
+        WriteTrak( b, i_track + 1, i_samples, i_chunk_samples,
+                   &pi_offsets[i_track * i_chunks] );
+
+    BoxEnd( b, moov );
+    free( pi_offsets );
+}
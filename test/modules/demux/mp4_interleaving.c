@@ -0,0 +1,214 @@
+/*****************************************************************************
+ * mp4_interleaving.c: MP4 demuxer interleaving tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* On streams that can't seek fast, the demuxer reads the chunks in file
+ * order and switches track at each interleaved chunk, tables loaded at open
+ * or deferred to the track selection. */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include "../../libvlc/test.h"
+
+#include "mp4_file.h"
+
+#define TRACKS          2
+#define SAMPLES         1000
+#define CHUNK_SAMPLES   25 /* 1s, well below the demuxer preload */
+
+/*****************************************************************************
+ * Stream: seekable, but not fast
+ *****************************************************************************/
+static ssize_t SlowRead( stream_t *s, void *buf, size_t len )
+{
+    return vlc_stream_ReadPartial( s->p_sys, buf, len );
+}
+
+static int SlowSeek( stream_t *s, uint64_t pos )
+{
+    return vlc_stream_Seek( s->p_sys, pos );
+}
+
+static int SlowControl( stream_t *s, int query, va_list args )
+{
+    if( query == STREAM_CAN_FASTSEEK )
+    {
+        *va_arg( args, bool * ) = false;
+        return VLC_SUCCESS;
+    }
+    return vlc_stream_vaControl( s->p_sys, query, args );
+}
+
+static void SlowDestroy( stream_t *s )
+{
+    vlc_stream_Delete( s->p_sys );
+}
+
+static stream_t *SlowStreamNew( vlc_object_t *obj, const buffer_t *p_file )
+{
+    stream_t *mem = vlc_stream_MemoryNew( obj, p_file->p, p_file->i_size, true );
+    assert( mem );
+    stream_t *s = vlc_stream_CommonNew( obj, SlowDestroy );
+    assert( s );
+    s->p_sys = mem;
+    s->pf_read = SlowRead;
+    s->pf_seek = SlowSeek;
+    s->pf_control = SlowControl;
+    return s;
+}
+
+/*****************************************************************************
+ * ES output: everything selected, counts the blocks sent in a row
+ *****************************************************************************/
+struct es_out_id_t
+{
+    unsigned i_blocks;
+};
+
+struct test_es_out_t
+{
+    es_out_t out;
+    struct es_out_id_t ids[TRACKS];
+    unsigned i_ids;
+    es_out_id_t *p_last;
+    unsigned i_run;
+    unsigned i_max_run;
+};
+
+static es_out_id_t *EsOutAdd( es_out_t *out, input_source_t *in,
+                              const es_format_t *fmt )
+{
+    struct test_es_out_t *ctx = (struct test_es_out_t *) out;
+    VLC_UNUSED(in); VLC_UNUSED(fmt);
+    assert( ctx->i_ids < TRACKS );
+    return &ctx->ids[ctx->i_ids++];
+}
+
+static int EsOutSend( es_out_t *out, es_out_id_t *id, block_t *block )
+{
+    struct test_es_out_t *ctx = (struct test_es_out_t *) out;
+
+    id->i_blocks++;
+    if( id != ctx->p_last )
+    {
+        ctx->p_last = id;
+        ctx->i_run = 0;
+    }
+    if( ++ctx->i_run > ctx->i_max_run )
+        ctx->i_max_run = ctx->i_run;
+
+    block_Release( block );
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel( es_out_t *out, es_out_id_t *id )
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl( es_out_t *out, input_source_t *in, int query,
+                         va_list args )
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    switch( query )
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg( args, es_out_id_t * );
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_EMPTY:
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_PCR_SYSTEM:
+        case ES_OUT_MODIFY_PCR_SYSTEM:
+            return VLC_EGENERIC;
+        default:
+            return VLC_SUCCESS;
+    }
+}
+
+static void EsOutDestroy( es_out_t *out )
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/*****************************************************************************
+ * Tests
+ *****************************************************************************/
+static void Test( int argc, const char **argv, const buffer_t *p_file )
+{
+    libvlc_instance_t *vlc = libvlc_new( argc, argv );
+    assert( vlc );
+
+    stream_t *s = SlowStreamNew( VLC_OBJECT(vlc->p_libvlc_int), p_file );
+    struct test_es_out_t ctx = { .out = { .cbs = &es_out_cbs } };
+
+    demux_t *p_demux = demux_New( VLC_OBJECT(s), "mp4", "vlc://nop", s,
+                                  &ctx.out );
+    assert( p_demux );
+
+    while( demux_Demux( p_demux ) == VLC_DEMUXER_SUCCESS );
+
+    assert( ctx.i_ids == TRACKS );
+    for( unsigned i = 0; i < TRACKS; i++ )
+        assert( ctx.ids[i].i_blocks == SAMPLES );
+    /* Not reading ahead past the other track chunks */
+    assert( ctx.i_max_run <= CHUNK_SAMPLES );
+
+    demux_Delete( p_demux );
+    vlc_stream_Delete( s );
+    libvlc_release( vlc );
+}
+
+int main( void )
+{
+    test_init();
+
+    buffer_t file = { NULL, 0, 0 };
+    WriteFile( &file, TRACKS, SAMPLES, CHUNK_SAMPLES );
+
+    static const char *default_args[] = { "-v", "--ignore-config" };
+    static const char *defer_args[] = { "-v", "--ignore-config",
+                                        "--mp4-defer-tables" };
+
+    Test( ARRAY_SIZE(default_args), default_args, &file );
+    /* The chunk runs can only be known once all the tables are loaded */
+    Test( ARRAY_SIZE(defer_args), defer_args, &file );
+
+    free( file.p );
+    return 0;
+}
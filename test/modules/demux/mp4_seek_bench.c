@@ -0,0 +1,188 @@
+/*****************************************************************************
+ * mp4_seek_bench.c: MP4 sample tables benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Builds a long single track file in memory, then times the opening, random
+ * seeks and sequential demuxing with and without the flattened sample table.
+ * Not run by "make check":
+ *   make -C test test_modules_demux_mp4_seek_bench
+ *   VLC_TEST_TIMEOUT=0 ./test/test_modules_demux_mp4_seek_bench [samples]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include "../../libvlc/test.h"
+
+#include "mp4_file.h"
+
+#define CHUNK_SAMPLES   10
+#define SEEK_COUNT      2000
+#define DEMUX_COUNT     100000
+
+/*****************************************************************************
+ * ES output: everything selected, blocks dropped
+ *****************************************************************************/
+static es_out_id_t *EsOutAdd( es_out_t *out, input_source_t *in,
+                              const es_format_t *fmt )
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(fmt);
+    return (es_out_id_t *) out; /* any non NULL id */
+}
+
+static int EsOutSend( es_out_t *out, es_out_id_t *id, block_t *block )
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+    block_Release( block );
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel( es_out_t *out, es_out_id_t *id )
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl( es_out_t *out, input_source_t *in, int query,
+                         va_list args )
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    switch( query )
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg( args, es_out_id_t * );
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_EMPTY:
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_PCR_SYSTEM:
+        case ES_OUT_MODIFY_PCR_SYSTEM:
+            return VLC_EGENERIC;
+        default:
+            return VLC_SUCCESS;
+    }
+}
+
+static void EsOutDestroy( es_out_t *out )
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+static void Run( const char *psz_name, int argc, const char **argv,
+                 const buffer_t *p_file, uint32_t i_samples )
+{
+    libvlc_instance_t *vlc = libvlc_new( argc, argv );
+    assert( vlc );
+
+    stream_t *s = vlc_stream_MemoryNew( VLC_OBJECT(vlc->p_libvlc_int),
+                                        p_file->p, p_file->i_size, true );
+    assert( s );
+    es_out_t out = { .cbs = &es_out_cbs };
+
+    vlc_tick_t i_start = vlc_tick_now();
+    demux_t *p_demux = demux_New( VLC_OBJECT(s), "mp4", "vlc://nop", s, &out );
+    assert( p_demux );
+    const vlc_tick_t i_open = vlc_tick_now() - i_start;
+
+    /* The first demux call selects the track and loads its tables */
+    i_start = vlc_tick_now();
+    assert( demux_Demux( p_demux ) == VLC_DEMUXER_SUCCESS );
+    const vlc_tick_t i_select = vlc_tick_now() - i_start;
+
+    const vlc_tick_t i_duration =
+        VLC_TICK_FROM_MS( (vlc_tick_t) i_samples * SAMPLE_DELTA );
+    uint32_t i_seed = 1;
+    i_start = vlc_tick_now();
+    for( unsigned i = 0; i < SEEK_COUNT; i++ )
+    {
+        i_seed = i_seed * 1103515245 + 12345;
+        vlc_tick_t i_time = i_duration / 65536 * ( i_seed >> 16 );
+        assert( demux_SetTime( p_demux, i_time, false, true ) == VLC_SUCCESS );
+        demux_Demux( p_demux );
+    }
+    const vlc_tick_t i_seeks = vlc_tick_now() - i_start;
+
+    assert( demux_SetTime( p_demux, 0, false, true ) == VLC_SUCCESS );
+    unsigned i_demuxed = 0;
+    i_start = vlc_tick_now();
+    while( i_demuxed < DEMUX_COUNT &&
+           demux_Demux( p_demux ) == VLC_DEMUXER_SUCCESS )
+        i_demuxed++;
+    const vlc_tick_t i_demux = vlc_tick_now() - i_start;
+
+    printf( "%-24s open %7.2f ms, select %7.2f ms, seek %7.2f us, "
+            "demux %6.1f ns/call\n", psz_name,
+            i_open / 1000., i_select / 1000., (double) i_seeks / SEEK_COUNT,
+            i_demuxed ? 1000. * i_demux / i_demuxed : 0. );
+
+    demux_Delete( p_demux );
+    vlc_stream_Delete( s );
+    libvlc_release( vlc );
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t i_samples = 500000;
+    if( argc > 1 )
+        i_samples = strtoul( argv[1], NULL, 0 );
+    i_samples -= i_samples % CHUNK_SAMPLES;
+    assert( i_samples > 0 );
+
+    test_init();
+
+    buffer_t file = { NULL, 0, 0 };
+    WriteFile( &file, 1, i_samples, CHUNK_SAMPLES );
+    printf( "%"PRIu32" samples, %.1f hours, %zu bytes\n", i_samples,
+            (double) i_samples * SAMPLE_DELTA / TIMESCALE / 3600, file.i_size );
+
+    static const char *default_args[] = { "-v", "--ignore-config" };
+    static const char *table_args[] = { "-v", "--ignore-config",
+                                        "--mp4-sample-table" };
+    static const char *defer_args[] = { "-v", "--ignore-config",
+                                        "--mp4-sample-table",
+                                        "--mp4-defer-tables" };
+
+    Run( "default", ARRAY_SIZE(default_args), default_args, &file, i_samples );
+    Run( "sample table", ARRAY_SIZE(table_args), table_args, &file, i_samples );
+    Run( "deferred + sample table", ARRAY_SIZE(defer_args), defer_args,
+         &file, i_samples );
+
+    free( file.p );
+    return 0;
+}
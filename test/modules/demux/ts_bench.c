@@ -0,0 +1,294 @@
+/*****************************************************************************
+ * ts_bench.c: TS demuxer throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Builds a single program TS in memory, one video and several audio PIDs,
+ * then times demuxing it with per packet and batched reads.
+ * Not run by "make check":
+ *   make -C test test_modules_demux_ts_bench
+ *   VLC_TEST_TIMEOUT=0 ./test/test_modules_demux_ts_bench [packets]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include "../../libvlc/test.h"
+
+#define TS_PACKET       188
+#define PMT_PID         0x100
+#define VIDEO_PID       0x101
+#define AUDIO_PID       0x102
+#define AUDIO_PIDS      3
+#define VIDEO_PACKETS   20 /* per 40ms frame */
+#define AUDIO_PACKETS   2
+#define PSI_INTERVAL    25 /* frames, 1s */
+
+typedef struct
+{
+    uint8_t *p;
+    size_t   i_size;
+    size_t   i_alloc;
+    uint8_t  cc[AUDIO_PID + AUDIO_PIDS];
+} ts_file_t;
+
+static uint8_t *NewPacket( ts_file_t *f, uint16_t i_pid, bool b_start )
+{
+    if( f->i_size + TS_PACKET > f->i_alloc )
+    {
+        f->i_alloc = ( f->i_size + TS_PACKET ) * 2;
+        f->p = realloc( f->p, f->i_alloc );
+        assert( f->p );
+    }
+    uint8_t *p = &f->p[f->i_size];
+    f->i_size += TS_PACKET;
+
+    memset( p, 0xFF, TS_PACKET );
+    p[0] = 0x47;
+    p[1] = ( b_start ? 0x40 : 0 ) | ( i_pid >> 8 );
+    p[2] = i_pid & 0xFF;
+    p[3] = 0x10 | ( f->cc[i_pid]++ & 0xF ); /* payload only */
+    return p;
+}
+
+static uint32_t CRC32( const uint8_t *p, size_t i )
+{
+    uint32_t i_crc = 0xFFFFFFFF;
+    while( i-- )
+    {
+        i_crc ^= (uint32_t) *p++ << 24;
+        for( int j = 0; j < 8; j++ )
+            i_crc = ( i_crc << 1 ) ^ ( ( i_crc & 0x80000000 ) ? 0x04C11DB7 : 0 );
+    }
+    return i_crc;
+}
+
+/* Section of i_data bytes after the 8 bytes header, then the CRC */
+static void WriteSection( ts_file_t *f, uint16_t i_pid, uint8_t i_table,
+                          uint16_t i_ext, const uint8_t *p_data, size_t i_data )
+{
+    uint8_t *p = NewPacket( f, i_pid, true );
+    p[4] = 0; /* pointer field */
+    uint8_t *s = &p[5];
+    s[0] = i_table;
+    SetWBE( &s[1], 0xB000 | ( 5 + i_data + 4 ) );
+    SetWBE( &s[3], i_ext );
+    s[5] = 0xC1; /* version 0, current */
+    s[6] = 0;
+    s[7] = 0;
+    memcpy( &s[8], p_data, i_data );
+    SetDWBE( &s[8 + i_data], CRC32( s, 8 + i_data ) );
+}
+
+static void WritePSI( ts_file_t *f )
+{
+    uint8_t pat[4];
+    SetWBE( &pat[0], 1 ); /* program number */
+    SetWBE( &pat[2], 0xE000 | PMT_PID );
+    WriteSection( f, 0, 0x00, 1, pat, sizeof(pat) );
+
+    uint8_t pmt[4 + 5 * (1 + AUDIO_PIDS)];
+    SetWBE( &pmt[0], 0xE000 | VIDEO_PID ); /* PCR PID */
+    SetWBE( &pmt[2], 0xF000 );
+    uint8_t *es = &pmt[4];
+    for( unsigned i = 0; i < 1 + AUDIO_PIDS; i++, es += 5 )
+    {
+        es[0] = i ? 0x04 : 0x02; /* MPEG audio, MPEG-2 video */
+        SetWBE( &es[1], 0xE000 | ( VIDEO_PID + i ) );
+        SetWBE( &es[3], 0xF000 );
+    }
+    WriteSection( f, PMT_PID, 0x02, 1, pmt, sizeof(pmt) );
+}
+
+static void SetTimestamp( uint8_t *p, uint8_t i_prefix, uint64_t i_ts )
+{
+    p[0] = ( i_prefix << 4 ) | ( ( i_ts >> 29 ) & 0x0E ) | 0x01;
+    p[1] = i_ts >> 22;
+    p[2] = ( ( i_ts >> 14 ) & 0xFE ) | 0x01;
+    p[3] = i_ts >> 7;
+    p[4] = ( ( i_ts << 1 ) & 0xFE ) | 0x01;
+}
+
+/* PES of i_packets, the first one starting with the header */
+static void WritePES( ts_file_t *f, uint16_t i_pid, uint8_t i_stream_id,
+                      unsigned i_packets, uint64_t i_pts, bool b_pcr )
+{
+    for( unsigned i = 0; i < i_packets; i++ )
+    {
+        uint8_t *p = NewPacket( f, i_pid, i == 0 );
+        uint8_t *h = &p[4];
+        if( i == 0 && b_pcr )
+        {
+            p[3] |= 0x20;
+            h[0] = 7;    /* adaptation field length */
+            h[1] = 0x10; /* PCR flag */
+            uint64_t i_pcr = i_pts - 9000;
+            SetDWBE( &h[2], i_pcr >> 1 );
+            h[6] = ( ( i_pcr & 1 ) << 7 ) | 0x7E;
+            h[7] = 0;
+            h += 8;
+        }
+        if( i == 0 )
+        {
+            h[0] = 0; h[1] = 0; h[2] = 1;
+            h[3] = i_stream_id;
+            SetWBE( &h[4], 0 ); /* unbounded */
+            h[6] = 0x80;
+            h[7] = 0x80; /* PTS */
+            h[8] = 5;
+            SetTimestamp( &h[9], 0x2, i_pts );
+            h += 14;
+        }
+        memset( h, i, &p[TS_PACKET] - h );
+    }
+}
+
+static void WriteFile( ts_file_t *f, unsigned i_packets )
+{
+    for( uint64_t i_frame = 0; f->i_size / TS_PACKET < i_packets; i_frame++ )
+    {
+        if( i_frame % PSI_INTERVAL == 0 )
+            WritePSI( f );
+
+        const uint64_t i_pts = 90000 + i_frame * 3600;
+        WritePES( f, VIDEO_PID, 0xE0, VIDEO_PACKETS, i_pts, true );
+        for( unsigned i = 0; i < AUDIO_PIDS; i++ )
+            WritePES( f, AUDIO_PID + i, 0xC0 + i, AUDIO_PACKETS, i_pts, false );
+    }
+}
+
+/*****************************************************************************
+ * ES output: everything selected, blocks dropped
+ *****************************************************************************/
+static es_out_id_t *EsOutAdd( es_out_t *out, input_source_t *in,
+                              const es_format_t *fmt )
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(fmt);
+    return (es_out_id_t *) out; /* any non NULL id */
+}
+
+static int EsOutSend( es_out_t *out, es_out_id_t *id, block_t *block )
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+    block_ChainRelease( block );
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel( es_out_t *out, es_out_id_t *id )
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl( es_out_t *out, input_source_t *in, int query,
+                         va_list args )
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    switch( query )
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg( args, es_out_id_t * );
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_EMPTY:
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_PCR_SYSTEM:
+        case ES_OUT_MODIFY_PCR_SYSTEM:
+            return VLC_EGENERIC;
+        default:
+            return VLC_SUCCESS;
+    }
+}
+
+static void EsOutDestroy( es_out_t *out )
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+static void Run( const char *psz_name, int argc, const char **argv,
+                 const ts_file_t *p_file )
+{
+    libvlc_instance_t *vlc = libvlc_new( argc, argv );
+    assert( vlc );
+
+    stream_t *s = vlc_stream_MemoryNew( VLC_OBJECT(vlc->p_libvlc_int),
+                                        p_file->p, p_file->i_size, true );
+    assert( s );
+    es_out_t out = { .cbs = &es_out_cbs };
+
+    demux_t *p_demux = demux_New( VLC_OBJECT(s), "ts", "vlc://nop", s, &out );
+    assert( p_demux );
+
+    vlc_tick_t i_start = vlc_tick_now();
+    while( demux_Demux( p_demux ) == VLC_DEMUXER_SUCCESS );
+    const vlc_tick_t i_demux = vlc_tick_now() - i_start;
+
+    const size_t i_packets = p_file->i_size / TS_PACKET;
+    printf( "%-16s %7.2f ms, %6.2f Mpackets/s, %7.1f MB/s\n", psz_name,
+            i_demux / 1000., (double) i_packets / i_demux,
+            (double) p_file->i_size / i_demux );
+
+    demux_Delete( p_demux );
+    vlc_stream_Delete( s );
+    libvlc_release( vlc );
+}
+
+int main( int argc, char **argv )
+{
+    unsigned i_packets = 500000;
+    if( argc > 1 )
+        i_packets = strtoul( argv[1], NULL, 0 );
+    assert( i_packets > 0 );
+
+    test_init();
+
+    ts_file_t file = { 0 };
+    WriteFile( &file, i_packets );
+    printf( "%zu packets, %zu bytes, %u PIDs\n", file.i_size / TS_PACKET,
+            file.i_size, 1 + AUDIO_PIDS );
+
+    static const char *default_args[] = { "-v", "--ignore-config" };
+    static const char *batch_args[] = { "-v", "--ignore-config",
+                                        "--ts-read-batch=64" };
+
+    Run( "per packet", ARRAY_SIZE(default_args), default_args, &file );
+    Run( "batched reads", ARRAY_SIZE(batch_args), batch_args, &file );
+
+    free( file.p );
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * ts_csa.c: CSA batched descrambling tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+
+#include "../../../modules/mux/mpeg/csa.h"
+
+#include "../../libvlc/test.h"
+
+const char vlc_module_name[] = "test_ts_csa";
+
+#define MAX_PKTS 600
+
+static uint32_t seed = 0x12345678;
+
+static uint8_t Rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+/* Builds a scrambled packet, with an adaptation field one time out of 4 */
+static void MakePacket(csa_t *csa, uint8_t *pkt, int i_pkt_size)
+{
+    for (int i = 0; i < 188; i++)
+        pkt[i] = Rand();
+
+    pkt[0] = 0x47;
+    pkt[3] = 0x10 | (pkt[3] & 0x0f);
+    if ((Rand() & 3) == 0)
+    {
+        pkt[3] |= 0x20;
+        pkt[4] = Rand() % 184;
+    }
+
+    switch (Rand() & 3)
+    {
+        case 0: /* left in clear */
+            break;
+        case 1:
+            csa_UseKey(NULL, csa, true);
+            csa_Encrypt(csa, pkt, i_pkt_size);
+            break;
+        default:
+            csa_UseKey(NULL, csa, false);
+            csa_Encrypt(csa, pkt, i_pkt_size);
+            break;
+    }
+}
+
+static int TestBatch(csa_t *csa, size_t count, int i_pkt_size)
+{
+    static uint8_t ref[MAX_PKTS][188], out[MAX_PKTS][188];
+    static uint8_t *pkts[MAX_PKTS];
+
+    assert(count <= MAX_PKTS);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        MakePacket(csa, ref[i], i_pkt_size);
+        memcpy(out[i], ref[i], 188);
+        pkts[i] = out[i];
+    }
+
+    /* reference scalar code */
+    for (size_t i = 0; i < count; i++)
+        csa_Decrypt(csa, ref[i], i_pkt_size);
+
+    csa_DecryptBatch(csa, pkts, count, i_pkt_size);
+
+    for (size_t i = 0; i < count; i++)
+        if (memcmp(ref[i], out[i], 188))
+        {
+            fprintf(stderr, "packet %zu/%zu of %d bytes differs\n",
+                    i, count, i_pkt_size);
+            return 1;
+        }
+    return 0;
+}
+
+int main(void)
+{
+    static const size_t counts[] = {
+        1, 7, 8, 9, 63, 64, 65, 127, 128, 129, 255, 256, 257, 600,
+    };
+    static const int sizes[] = { 188, 184, 100, 64 };
+    char odd_ck[] = "0x0123456789abcdef";
+    char even_ck[] = "fedcba9876543210";
+
+    test_init();
+
+    csa_t *csa = csa_New();
+    assert(csa);
+    assert(csa_SetCW(NULL, csa, odd_ck, true) == VLC_SUCCESS);
+    assert(csa_SetCW(NULL, csa, even_ck, false) == VLC_SUCCESS);
+
+    /* the batch must not alter packets in clear */
+    uint8_t clear[188], copy[188];
+    uint8_t *p_clear = clear;
+    for (int i = 0; i < 188; i++)
+        clear[i] = Rand();
+    clear[3] = 0x10;
+    memcpy(copy, clear, 188);
+    csa_DecryptBatch(csa, &p_clear, 1, 188);
+    assert(!memcmp(clear, copy, 188));
+
+    /* check the reference round trip */
+    for (int i = 0; i < 188; i++)
+        clear[i] = Rand();
+    clear[3] = 0x10;
+    memcpy(copy, clear, 188);
+    csa_UseKey(NULL, csa, true);
+    csa_Encrypt(csa, clear, 188);
+    assert(memcmp(clear, copy, 188));
+    csa_Decrypt(csa, clear, 188);
+    assert(!memcmp(clear, copy, 188));
+
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(counts); j++)
+            if (TestBatch(csa, counts[j], sizes[i]))
+                return 1;
+
+    csa_Delete(csa);
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*****************************************************************************
+ * ts_index.c: TS seek index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+
+#include "../../../modules/demux/mpeg/timestamps.h"
+#include "../../../modules/demux/mpeg/ts_index.h"
+
+#include "../../libvlc/test.h"
+
+#define PKT 188
+#define PCR_FIRST (0x1FFFFFFFF - 90000 * 10) /* wraps after 10s */
+#define SIZE (2000 * 100 * PKT)
+#define MTIME 1767225600
+
+/* One PCR every 40ms, 100 packets apart */
+static stime_t PCRAt( unsigned i )
+{
+    return (PCR_FIRST + i * 3600) & 0x1FFFFFFFF;
+}
+
+static void Play( ts_index_t *p_index, unsigned i_from, unsigned i_to )
+{
+    ts_index_Break( p_index );
+    for( unsigned i = i_from; i < i_to; i++ )
+        ts_index_Add( p_index, 1, (uint64_t) i * 100 * PKT, PCRAt( i ) );
+}
+
+static void CheckLookup( ts_index_t *p_index, stime_t i_time,
+                         bool b_found, bool b_linked )
+{
+    ts_index_entry_t before, after;
+    bool b_ret = ts_index_Lookup( p_index, 1, PCR_FIRST, i_time, &before, &after );
+    assert( b_ret == b_found );
+    if( !b_found )
+        return;
+    stime_t i_before = TimeStampWrapAround( PCR_FIRST, before.i_pcr );
+    assert( i_before <= i_time );
+    assert( i_time - i_before < TS_INDEX_INTERVAL + 3600 );
+    if( b_linked )
+    {
+        assert( after.i_pos != UINT64_MAX );
+        assert( after.b_linked );
+        assert( TimeStampWrapAround( PCR_FIRST, after.i_pcr ) > i_time );
+    }
+}
+
+/* 0s to 20s, then the PCR jump back to 12s and go on to 32s */
+static void TestDiscontinuity( void )
+{
+    ts_index_t *p_index = ts_index_New();
+    assert( p_index );
+
+    ts_index_Break( p_index );
+    for( unsigned i = 0; i < 1000; i++ )
+        ts_index_Add( p_index, 1, (uint64_t) i * 100 * PKT,
+                      PCRAt( i < 500 ? i : i - 500 + 300 ) );
+
+    const uint64_t i_jump = 500 * 100 * PKT;
+    ts_index_entry_t before, after;
+
+    /* covered twice, the first run wins */
+    for( unsigned i = 300; i < 495; i += 7 )
+    {
+        stime_t i_time = PCR_FIRST + i * 3600;
+        CheckLookup( p_index, i_time, true, true );
+        assert( ts_index_Lookup( p_index, 1, PCR_FIRST, i_time, &before, &after ) );
+        assert( before.i_pos < i_jump && after.i_pos < i_jump );
+    }
+    /* only covered after the jump */
+    for( unsigned i = 505; i < 790; i += 7 )
+    {
+        stime_t i_time = PCR_FIRST + i * 3600;
+        CheckLookup( p_index, i_time, true, true );
+        assert( ts_index_Lookup( p_index, 1, PCR_FIRST, i_time, &before, &after ) );
+        assert( before.i_pos >= i_jump && after.i_pos > before.i_pos );
+    }
+    /* past the end */
+    assert( ts_index_Lookup( p_index, 1, PCR_FIRST, PCR_FIRST + 90000 * 40,
+                             &before, &after ) );
+    assert( before.i_pos >= i_jump );
+    assert( after.i_pos == UINT64_MAX );
+
+    ts_index_Delete( p_index );
+}
+
+int main(void)
+{
+    test_init();
+
+    ts_index_t *p_index = ts_index_New();
+    assert( p_index );
+
+    /* nothing known */
+    ts_index_entry_t before, after;
+    assert( !ts_index_Lookup( p_index, 1, PCR_FIRST, PCR_FIRST, &before, &after ) );
+
+    /* first 20s, then 40s to 60s after a seek */
+    Play( p_index, 0, 500 );
+    Play( p_index, 1000, 1500 );
+    assert( ts_index_IsModified( p_index ) );
+
+    /* no entry for another program */
+    assert( !ts_index_Lookup( p_index, 2, PCR_FIRST, PCR_FIRST, &before, &after ) );
+
+    CheckLookup( p_index, PCR_FIRST + 90000 * 5, true, true );
+    /* across the PCR wrap */
+    CheckLookup( p_index, PCR_FIRST + 90000 * 15, true, true );
+    /* in the unread gap, bounded by the two read ranges */
+    assert( ts_index_Lookup( p_index, 1, PCR_FIRST, PCR_FIRST + 90000 * 30,
+                             &before, &after ) );
+    assert( !after.b_linked );
+    assert( before.i_pos < 500 * 100 * PKT );
+    assert( after.i_pos == 1000 * 100 * PKT );
+    CheckLookup( p_index, PCR_FIRST + 90000 * 50, true, true );
+
+    /* reading the gap links the whole range */
+    Play( p_index, 450, 1100 );
+    CheckLookup( p_index, PCR_FIRST + 90000 * 30, true, true );
+
+    /* sidecar round trip */
+    FILE *p_file = tmpfile();
+    assert( p_file );
+    assert( ts_index_Save( p_index, p_file, SIZE, MTIME ) == VLC_SUCCESS );
+    assert( !ts_index_IsModified( p_index ) );
+
+    ts_index_t *p_loaded = ts_index_New();
+    assert( p_loaded );
+    rewind( p_file );
+    /* made for another file */
+    assert( ts_index_Load( p_loaded, p_file, 1000, MTIME ) != VLC_SUCCESS );
+    rewind( p_file );
+    assert( ts_index_Load( p_loaded, p_file, SIZE + PKT, MTIME ) != VLC_SUCCESS );
+    /* same size, but modified since */
+    rewind( p_file );
+    assert( ts_index_Load( p_loaded, p_file, SIZE, MTIME + 1 ) != VLC_SUCCESS );
+    rewind( p_file );
+    assert( ts_index_Load( p_loaded, p_file, SIZE, MTIME ) == VLC_SUCCESS );
+    for( unsigned i = 0; i < 1500; i += 7 )
+    {
+        ts_index_entry_t b1, a1, b2, a2;
+        stime_t i_time = PCR_FIRST + i * 3600;
+        assert( ts_index_Lookup( p_index, 1, PCR_FIRST, i_time, &b1, &a1 ) );
+        assert( ts_index_Lookup( p_loaded, 1, PCR_FIRST, i_time, &b2, &a2 ) );
+        assert( b1.i_pos == b2.i_pos && b1.i_pcr == b2.i_pcr &&
+                b1.b_linked == b2.b_linked );
+        assert( a1.i_pos == a2.i_pos );
+    }
+
+    /* a full read links what was read in several runs */
+    Play( p_loaded, 0, 1500 );
+    for( unsigned i = 0; i < 1490; i += 11 )
+        CheckLookup( p_loaded, PCR_FIRST + i * 3600, true, true );
+
+    /* then replaying it doesn't alter the index anymore */
+    rewind( p_file );
+    assert( ts_index_Save( p_loaded, p_file, SIZE, MTIME ) == VLC_SUCCESS );
+    Play( p_loaded, 0, 1500 );
+    assert( !ts_index_IsModified( p_loaded ) );
+    fclose( p_file );
+
+    ts_index_Delete( p_loaded );
+    ts_index_Delete( p_index );
+
+    TestDiscontinuity();
+    return 0;
+}